@@ -132,6 +132,7 @@ const UserDef U_default = {
 
     .prefetchframes = 0,
     .pad_rot_angle = 15,
+    .compositor_cache_limit = 1024,
     .rvisize = 25,
     .rvibright = 8,
     .recent_files = 10,
@@ -226,6 +227,7 @@ const UserDef U_default = {
     .sequencer_disk_cache_compression = 0,
     .sequencer_disk_cache_size_limit = 100,
     .sequencer_disk_cache_flag = 0,
+    .sequencer_prefetch_threads = 1,
 
     .collection_instance_empty_size = 1.0f,
 
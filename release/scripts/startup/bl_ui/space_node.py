@@ -650,7 +650,14 @@ class NODE_PT_quality(bpy.types.Panel):
         col = layout.column()
         col.prop(tree, "render_quality", text="Render")
         col.prop(tree, "edit_quality", text="Edit")
-        col.prop(tree, "chunk_size")
+        col.prop(tree, "execution_mode")
+        sub = col.column()
+        sub.active = tree.execution_mode == 'TILED'
+        sub.prop(tree, "chunk_size")
+        sub = col.column()
+        sub.active = tree.execution_mode == 'FULL_FRAME'
+        sub.prop(tree, "use_half_float_buffers")
+        sub.prop(tree, "use_constant_buffers")
 
         col = layout.column()
         col.prop(tree, "use_opencl")
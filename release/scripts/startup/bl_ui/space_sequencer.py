@@ -1963,6 +1963,8 @@ class SEQUENCER_PT_view(SequencerButtonsPanel_Output, Panel):
 
         if ed:
             col.prop(ed, "use_prefetch")
+            if ed.use_prefetch:
+                col.prop(ed, "prefetch_frame_rate", text="Frame Rate")
 
 
 class SEQUENCER_PT_frame_overlay(SequencerButtonsPanel_Output, Panel):
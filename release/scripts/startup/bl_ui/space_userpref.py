@@ -612,10 +612,16 @@ class USERPREF_PT_system_memory(SystemPanel, CenterAlignMixIn, Panel):
         col = layout.column()
         col.prop(edit, "undo_steps", text="Undo Steps")
         col.prop(edit, "undo_memory_limit", text="Undo Memory Limit")
+        col.prop(edit, "undo_compress_steps", text="Compress Undo Steps")
         col.prop(edit, "use_global_undo")
 
         layout.separator()
 
+        col = layout.column()
+        col.prop(system, "compositor_cache_limit", text="Compositor Cache Limit")
+
+        layout.separator()
+
         col = layout.column()
         col.prop(system, "scrollback", text="Console Scrollback Lines")
 
@@ -641,6 +647,7 @@ class USERPREF_PT_system_video_sequencer(SystemPanel, CenterAlignMixIn, Panel):
         edit = prefs.edit
 
         layout.prop(system, "memory_cache_limit")
+        layout.prop(system, "sequencer_prefetch_threads")
 
         layout.separator()
 
@@ -2220,6 +2227,7 @@ class USERPREF_PT_experimental_debugging(ExperimentalPanel, Panel):
             context, (
                 ({"property": "use_undo_legacy"}, "T60695"),
                 ({"property": "use_cycles_debug"}, None),
+                ({"property": "use_depsgraph_priority_scheduling"}, None),
             ),
         )
 
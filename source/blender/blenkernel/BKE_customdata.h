@@ -109,6 +109,15 @@ bool CustomData_bmesh_has_free(const struct CustomData *data);
  */
 bool CustomData_has_referenced(const struct CustomData *data);
 
+/**
+ * Adds the memory used by the layers to \a r_referenced or \a r_owned, depending on whether the
+ * layer references data owned by another CustomData.
+ */
+void CustomData_memory_usage_add(const struct CustomData *data,
+                                 int totelem,
+                                 size_t *r_referenced,
+                                 size_t *r_owned);
+
 /* copies the "value" (e.g. mloopuv uv or mloopcol colors) from one block to
  * another, while not overwriting anything else (e.g. flags).  probably only
  * implemented for mloopuv/mloopcol, for now.*/
@@ -231,6 +240,15 @@ void *CustomData_duplicate_referenced_layer_named(struct CustomData *data,
                                                   const int type,
                                                   const char *name,
                                                   const int totelem);
+/**
+ * Makes the referenced layers of \a data which point to layers owned by \a source keep that
+ * data alive (#CD_FLAG_SHARED), so \a data can outlive \a source. Other referenced layers are
+ * duplicated. The shared layers of \a source get tagged (#CD_FLAG_SHARED_SOURCE), which is a
+ * runtime flag only, changed atomically.
+ */
+void CustomData_share_referenced_layers(const struct CustomData *source,
+                                        struct CustomData *data,
+                                        int totelem);
 bool CustomData_is_referenced_layer(struct CustomData *data, int type);
 
 /* set the CD_FLAG_NOCOPY flag in custom data layers where the mask is
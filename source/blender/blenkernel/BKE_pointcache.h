@@ -152,6 +152,19 @@ typedef struct PTCacheID {
                             float cfra2,
                             const float *old_data);
 
+  /* Optional batched variants of the point callbacks above, for the points [start, end) of the
+   * frame data in `pm`. Unlike the per point callbacks these can run from multiple threads
+   * (for different ranges of points), #write_points is only used when all points are written. */
+  void (*write_points)(void *calldata, struct PTCacheMem *pm, int start, int end, int cfra);
+  void (*read_points)(void *calldata, struct PTCacheMem *pm, int start, int end, float cfra);
+  void (*interpolate_points)(void *calldata,
+                             struct PTCacheMem *pm,
+                             int start,
+                             int end,
+                             float cfra,
+                             float cfra1,
+                             float cfra2);
+
   /* copies point data to cache data */
   int (*write_stream)(PTCacheFile *pf, void *calldata);
   /* copies cache cata to point data */
@@ -369,6 +382,9 @@ void BKE_ptcache_disk_cache_rename(struct PTCacheID *pid,
                                    const char *name_src,
                                    const char *name_dst);
 
+/* Convert the disk cache files after toggling between one file per frame and a single file. */
+void BKE_ptcache_disk_cache_single_file_toggle(struct PTCacheID *pid);
+
 /* Loads simulation from external (disk) cache files. */
 void BKE_ptcache_load_external(struct PTCacheID *pid);
 
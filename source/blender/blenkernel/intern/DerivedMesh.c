@@ -799,6 +799,9 @@ static void mesh_calc_modifier_final_normals(const Mesh *mesh_input,
     if (!CustomData_has_layer(&mesh_final->pdata, CD_NORMAL)) {
       float(*polynors)[3] = CustomData_add_layer(
           &mesh_final->pdata, CD_NORMAL, CD_CALLOC, NULL, mesh_final->totpoly);
+      /* Vertex normals are written as well, the vertices might be shared with the input. */
+      mesh_final->mvert = CustomData_duplicate_referenced_layer(
+          &mesh_final->vdata, CD_MVERT, mesh_final->totvert);
       BKE_mesh_calc_normals_poly(mesh_final->mvert,
                                  NULL,
                                  mesh_final->totvert,
@@ -1419,6 +1422,9 @@ static void editbmesh_calc_modifier_final_normals(Mesh *mesh_final,
     if (!CustomData_has_layer(&mesh_final->pdata, CD_NORMAL)) {
       float(*polynors)[3] = CustomData_add_layer(
           &mesh_final->pdata, CD_NORMAL, CD_CALLOC, NULL, mesh_final->totpoly);
+      /* Vertex normals are written as well, the vertices might be shared with the input. */
+      mesh_final->mvert = CustomData_duplicate_referenced_layer(
+          &mesh_final->vdata, CD_MVERT, mesh_final->totvert);
       BKE_mesh_calc_normals_poly(mesh_final->mvert,
                                  NULL,
                                  mesh_final->totvert,
@@ -84,7 +84,10 @@ bool BKE_memfile_undo_decode(MemFileUndoData *mfu,
     if (!use_old_bmain_data) {
       params.skip_flags |= BLO_READ_SKIP_UNDO_OLD_MAIN;
     }
-    success = BKE_blendfile_read_from_memfile(C, &mfu->memfile, &params, NULL);
+    /* Cold undo steps may be compressed, see #BLO_memfile_compress_begin. */
+    if (BLO_memfile_decompress(&mfu->memfile)) {
+      success = BKE_blendfile_read_from_memfile(C, &mfu->memfile, &params, NULL);
+    }
   }
 
   /* Restore, bmain has been re-allocated. */
@@ -124,11 +127,20 @@ MemFileUndoData *BKE_memfile_undo_encode(Main *bmain, MemFileUndoData *mfu_prev)
   }
   else {
     MemFile *prevfile = (mfu_prev) ? &(mfu_prev->memfile) : NULL;
+    /* The previous step may have been compressed (see #BLO_memfile_compress_begin) when newer
+     * steps were written on top of it and undone since. Its buffers are compared with the new
+     * data, write without sharing when it can't be decompressed. */
+    if (prevfile && !BLO_memfile_decompress(prevfile)) {
+      prevfile = NULL;
+    }
     if (prevfile) {
       BLO_memfile_clear_future(prevfile);
     }
     /* success = */ /* UNUSED */ BLO_write_file_mem(bmain, prevfile, &mfu->memfile, G.fileflags);
     mfu->undo_size = mfu->memfile.size;
+    if (G.debug & G_DEBUG_WM) {
+      BLO_memfile_stats_print(&mfu->memfile);
+    }
   }
 
   bmain->is_memfile_undo_written = true;
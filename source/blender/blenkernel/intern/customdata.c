@@ -26,6 +26,8 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 /* Since we have versioning code here (CustomData_verify_versions()). */
 #define DNA_DEPRECATED_ALLOW
 
@@ -36,12 +38,14 @@
 
 #include "BLI_bitmap.h"
 #include "BLI_endian_switch.h"
+#include "BLI_ghash.h"
 #include "BLI_math.h"
 #include "BLI_math_color_blend.h"
 #include "BLI_mempool.h"
 #include "BLI_path_util.h"
 #include "BLI_string.h"
 #include "BLI_string_utils.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
 #include "BLT_translation.h"
@@ -2073,6 +2077,89 @@ static bool customdata_typemap_is_valid(const CustomData *data)
 }
 #endif
 
+/* -------------------------------------------------------------------- */
+/** \name Shared Layers
+ *
+ * Evaluated copies of original geometry reference layers of the original instead of copying
+ * them (#CD_FLAG_SHARED), and every such reference is a user of the data. When the owner frees
+ * or reallocates a layer which is still used (#CD_FLAG_SHARED_SOURCE), the data is kept until
+ * the last user releases it.
+ * Only layers of types without nested allocations are shared, since nested data is freed by the
+ * owner in place.
+ * \{ */
+
+typedef struct SharedLayer {
+  int users;
+  /* The owner does not use the data anymore, it is freed together with the last user. */
+  bool is_orphan;
+} SharedLayer;
+
+static struct {
+  GHash *layers;
+  ThreadMutex mutex;
+} g_shared_layers = {NULL, BLI_MUTEX_INITIALIZER};
+
+static void customdata_shared_layer_add_user(void *data)
+{
+  BLI_mutex_lock(&g_shared_layers.mutex);
+  if (g_shared_layers.layers == NULL) {
+    g_shared_layers.layers = BLI_ghash_ptr_new(__func__);
+  }
+  void **shared_p;
+  if (!BLI_ghash_ensure_p(g_shared_layers.layers, data, &shared_p)) {
+    *shared_p = MEM_callocN(sizeof(SharedLayer), __func__);
+  }
+  ((SharedLayer *)*shared_p)->users++;
+  BLI_mutex_unlock(&g_shared_layers.mutex);
+}
+
+static void customdata_shared_layer_remove_user(void *data)
+{
+  bool do_free = false;
+  BLI_mutex_lock(&g_shared_layers.mutex);
+  SharedLayer *shared = BLI_ghash_lookup(g_shared_layers.layers, data);
+  BLI_assert(shared != NULL);
+  if (--shared->users == 0) {
+    do_free = shared->is_orphan;
+    BLI_ghash_remove(g_shared_layers.layers, data, NULL, MEM_freeN);
+    if (BLI_ghash_len(g_shared_layers.layers) == 0) {
+      BLI_ghash_free(g_shared_layers.layers, NULL, NULL);
+      g_shared_layers.layers = NULL;
+    }
+  }
+  BLI_mutex_unlock(&g_shared_layers.mutex);
+  if (do_free) {
+    MEM_freeN(data);
+  }
+}
+
+/* Called by the owner of the layer data when it stops using it. Returns true when the data is
+ * still used by other layers, it is then freed by the last user instead.
+ * Only layers which were shared (#CD_FLAG_SHARED_SOURCE) are looked up, so freeing and
+ * reallocating other layers doesn't lock. */
+static bool customdata_shared_layer_orphan(CustomDataLayer *layer)
+{
+  if (!(layer->flag & CD_FLAG_SHARED_SOURCE)) {
+    return false;
+  }
+  layer->flag &= ~CD_FLAG_SHARED_SOURCE;
+  void *data = layer->data;
+
+  bool is_used = false;
+  BLI_mutex_lock(&g_shared_layers.mutex);
+  if (g_shared_layers.layers != NULL) {
+    SharedLayer *shared = BLI_ghash_lookup(g_shared_layers.layers, data);
+    if (shared != NULL) {
+      shared->is_orphan = true;
+      is_used = true;
+    }
+  }
+  BLI_mutex_unlock(&g_shared_layers.mutex);
+  return is_used;
+}
+
+/** \} */
+
 bool CustomData_merge(const struct CustomData *source,
                       struct CustomData *dest,
                       CustomDataMask mask,
@@ -2147,6 +2234,10 @@ bool CustomData_merge(const struct CustomData *source,
       newlayer->active_clone = lastclone;
       newlayer->active_mask = lastmask;
       newlayer->flag |= flag & (CD_FLAG_EXTERNAL | CD_FLAG_IN_MEMORY);
+      if (alloctype == CD_ASSIGN) {
+        /* The user or owner of shared data is moved to the new layer. */
+        newlayer->flag |= flag & (CD_FLAG_SHARED | CD_FLAG_SHARED_SOURCE);
+      }
       changed = true;
     }
   }
@@ -2165,7 +2256,17 @@ void CustomData_realloc(CustomData *data, int totelem)
       continue;
     }
     typeInfo = layerType_getInfo(layer->type);
-    layer->data = MEM_reallocN(layer->data, (size_t)totelem * typeInfo->size);
+    if (customdata_shared_layer_orphan(layer)) {
+      /* Users of the data keep the old array. */
+      void *new_data = MEM_malloc_arrayN((size_t)totelem, typeInfo->size, __func__);
+      memcpy(new_data,
+             layer->data,
+             MIN2(MEM_allocN_len(layer->data), (size_t)totelem * typeInfo->size));
+      layer->data = new_data;
+    }
+    else {
+      layer->data = MEM_reallocN(layer->data, (size_t)totelem * typeInfo->size);
+    }
   }
 }
 
@@ -2188,14 +2289,17 @@ static void customData_free_layer__internal(CustomDataLayer *layer, int totelem)
 {
   const LayerTypeInfo *typeInfo;
 
-  if (!(layer->flag & CD_FLAG_NOFREE) && layer->data) {
+  if (layer->flag & CD_FLAG_SHARED) {
+    customdata_shared_layer_remove_user(layer->data);
+  }
+  else if (!(layer->flag & CD_FLAG_NOFREE) && layer->data) {
     typeInfo = layerType_getInfo(layer->type);
 
     if (typeInfo->free) {
       typeInfo->free(layer->data, totelem, typeInfo->size);
     }
 
-    if (layer->data) {
+    if (layer->data && !customdata_shared_layer_orphan(layer)) {
       MEM_freeN(layer->data);
     }
   }
@@ -2745,6 +2849,7 @@ static void *customData_duplicate_referenced_layer_index(CustomData *data,
   CustomDataLayer *layer = &data->layers[layer_index];
 
   if (layer->flag & CD_FLAG_NOFREE) {
+    void *src_data = layer->data;
     /* MEM_dupallocN won't work in case of complex layers, like e.g.
      * CD_MDEFORMVERT, which has pointers to allocated data...
      * So in case a custom copy function is defined, use it!
@@ -2761,7 +2866,10 @@ static void *customData_duplicate_referenced_layer_index(CustomData *data,
       layer->data = MEM_dupallocN(layer->data);
     }
 
-    layer->flag &= ~CD_FLAG_NOFREE;
+    if (layer->flag & CD_FLAG_SHARED) {
+      customdata_shared_layer_remove_user(src_data);
+    }
+    layer->flag &= ~(CD_FLAG_NOFREE | CD_FLAG_SHARED);
   }
 
   return layer->data;
@@ -2797,6 +2905,36 @@ void *CustomData_duplicate_referenced_layer_named(CustomData *data,
   return customData_duplicate_referenced_layer_index(data, layer_index, totelem);
 }
 
+void CustomData_share_referenced_layers(const CustomData *source,
+                                        CustomData *data,
+                                        const int totelem)
+{
+  for (int i = 0; i < data->totlayer; i++) {
+    CustomDataLayer *layer = &data->layers[i];
+    if ((layer->flag & (CD_FLAG_NOFREE | CD_FLAG_SHARED)) != CD_FLAG_NOFREE ||
+        layer->data == NULL) {
+      continue;
+    }
+    const CustomDataLayer *source_layer = NULL;
+    for (int j = 0; j < source->totlayer; j++) {
+      if (source->layers[j].data == layer->data) {
+        source_layer = &source->layers[j];
+        break;
+      }
+    }
+    if (source_layer != NULL && !(source_layer->flag & CD_FLAG_NOFREE) &&
+        layerType_getInfo(layer->type)->free == NULL) {
+      customdata_shared_layer_add_user(layer->data);
+      layer->flag |= CD_FLAG_SHARED;
+      /* Several dependency graphs can share the same source layer at the same time. */
+      atomic_fetch_and_or_int32((int32_t *)&source_layer->flag, CD_FLAG_SHARED_SOURCE);
+    }
+    else {
+      customData_duplicate_referenced_layer_index(data, i, totelem);
+    }
+  }
+}
+
 bool CustomData_is_referenced_layer(struct CustomData *data, int type)
 {
   /* get the layer index of the first layer of type */
@@ -3866,6 +4004,26 @@ bool CustomData_has_referenced(const struct CustomData *data)
   return false;
 }
 
+void CustomData_memory_usage_add(const struct CustomData *data,
+                                 const int totelem,
+                                 size_t *r_referenced,
+                                 size_t *r_owned)
+{
+  for (int i = 0; i < data->totlayer; i++) {
+    const CustomDataLayer *layer = &data->layers[i];
+    if (layer->data == NULL) {
+      continue;
+    }
+    const size_t size = (size_t)layerType_getInfo(layer->type)->size * (size_t)totelem;
+    if (layer->flag & CD_FLAG_NOFREE) {
+      *r_referenced += size;
+    }
+    else {
+      *r_owned += size;
+    }
+  }
+}
+
 /* copies the "value" (e.g. mloopuv uv or mloopcol colors) from one block to
  * another, while not overwriting anything else (e.g. flags)*/
 void CustomData_data_copy_value(int type, const void *source, void *dest)
@@ -5173,7 +5331,7 @@ void CustomData_blend_read(BlendDataReader *reader, CustomData *data, int count)
       layer->flag &= ~CD_FLAG_IN_MEMORY;
     }
 
-    layer->flag &= ~CD_FLAG_NOFREE;
+    layer->flag &= ~(CD_FLAG_NOFREE | CD_FLAG_SHARED | CD_FLAG_SHARED_SOURCE);
 
     if (CustomData_verify_versions(data, i)) {
       BLO_read_data_address(reader, &layer->data);
@@ -1806,6 +1806,9 @@ void BKE_mesh_calc_normals_split_ex(Mesh *mesh, MLoopNorSpaceArray *r_lnors_spac
   }
   else {
     polynors = MEM_malloc_arrayN(mesh->totpoly, sizeof(float[3]), __func__);
+    /* Vertex normals are written as well. This will just return the pointer if it wasn't a
+     * referenced layer. */
+    mesh->mvert = CustomData_duplicate_referenced_layer(&mesh->vdata, CD_MVERT, mesh->totvert);
     BKE_mesh_calc_normals_poly(mesh->mvert,
                                NULL,
                                mesh->totvert,
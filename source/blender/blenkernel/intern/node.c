@@ -224,6 +224,11 @@ static void ntree_free_data(ID *id)
     }
   }
 
+  /* Compositor results computed from node groups of the main database are outdated. */
+  if (ntree->type == NTREE_COMPOSIT && (ntree->id.tag & LIB_TAG_NO_MAIN) == 0) {
+    ntreeCompositClearResultCache();
+  }
+
   /* XXX not nice, but needed to free localized node groups properly */
   free_localized_node_groups(ntree);
 
@@ -21,6 +21,7 @@
  * \ingroup bke
  */
 
+#include <fcntl.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -46,13 +47,17 @@
 #include "BLI_blenlib.h"
 #include "BLI_endian_switch.h"
 #include "BLI_math.h"
+#include "BLI_mmap.h"
 #include "BLI_string.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BLT_translation.h"
 
 #include "PIL_time.h"
 
+#include "atomic_ops.h"
+
 #include "BKE_appdir.h"
 #include "BKE_cloth.h"
 #include "BKE_collection.h"
@@ -95,8 +100,10 @@
 /* needed for directory lookup */
 #ifndef WIN32
 #  include <dirent.h>
+#  include <unistd.h>
 #else
 #  include "BLI_winstuff.h"
+#  include <io.h>
 #endif
 
 #define PTCACHE_DATA_FROM(data, type, from) \
@@ -116,6 +123,9 @@
 /* could be made into a pointcache option */
 #define DURIAN_POINTCACHE_LIB_OK 1
 
+/* Number of points processed by each task of the batched point callbacks. */
+#define PTCACHE_POINTS_CHUNK_SIZE 4096
+
 static CLG_LogRef LOG = {"bke.pointcache"};
 
 static int ptcache_data_size[] = {
@@ -141,6 +151,7 @@ static int ptcache_file_compressed_write(
     PTCacheFile *pf, unsigned char *in, unsigned int in_len, unsigned char *out, int mode);
 static int ptcache_file_write(PTCacheFile *pf, const void *f, unsigned int tot, unsigned int size);
 static int ptcache_file_read(PTCacheFile *pf, void *f, unsigned int tot, unsigned int size);
+static void ptcache_mem_pointers_init_at(PTCacheMem *pm, int point, void *cur[BPHYS_TOT_DATA]);
 
 /* Common functions */
 static int ptcache_basic_header_read(PTCacheFile *pf)
@@ -188,6 +199,55 @@ static void ptcache_add_extra_data(PTCacheMem *pm,
 
   BLI_addtail(&pm->extradata, extra);
 }
+
+/* Batched variants of the point callbacks, for types where each point only accesses its own
+ * data, so ranges of points can be processed from different threads. */
+typedef void (*PTCacheReadPointFn)(
+    int index, void *calldata, void **data, float cfra, const float *old_data);
+typedef void (*PTCacheInterpolatePointFn)(int index,
+                                          void *calldata,
+                                          void **data,
+                                          float cfra,
+                                          float cfra1,
+                                          float cfra2,
+                                          const float *old_data);
+
+static void ptcache_read_points_foreach(PTCacheReadPointFn read_point,
+                                        void *calldata,
+                                        PTCacheMem *pm,
+                                        int start,
+                                        int end,
+                                        float cfra)
+{
+  void *cur[BPHYS_TOT_DATA];
+  ptcache_mem_pointers_init_at(pm, start, cur);
+
+  for (int i = start; i < end; i++) {
+    const int index = cur[BPHYS_DATA_INDEX] ? *(int *)cur[BPHYS_DATA_INDEX] : i;
+    read_point(index, calldata, cur, cfra, NULL);
+    BKE_ptcache_mem_pointers_incr(cur);
+  }
+}
+
+static void ptcache_interpolate_points_foreach(PTCacheInterpolatePointFn interpolate_point,
+                                               void *calldata,
+                                               PTCacheMem *pm,
+                                               int start,
+                                               int end,
+                                               float cfra,
+                                               float cfra1,
+                                               float cfra2)
+{
+  void *cur[BPHYS_TOT_DATA];
+  ptcache_mem_pointers_init_at(pm, start, cur);
+
+  for (int i = start; i < end; i++) {
+    const int index = cur[BPHYS_DATA_INDEX] ? *(int *)cur[BPHYS_DATA_INDEX] : i;
+    interpolate_point(index, calldata, cur, cfra, cfra1, cfra2, NULL);
+    BKE_ptcache_mem_pointers_incr(cur);
+  }
+}
+
 /* Softbody functions */
 static int ptcache_softbody_write(int index, void *soft_v, void **data, int UNUSED(cfra))
 {
@@ -254,6 +314,49 @@ static void ptcache_softbody_interpolate(int index,
   copy_v3_v3(bp->pos, keys->co);
   copy_v3_v3(bp->vec, keys->vel);
 }
+static void ptcache_softbody_write_points(
+    void *soft_v, PTCacheMem *pm, int start, int end, int UNUSED(cfra))
+{
+  SoftBody *soft = soft_v;
+  float(*loc)[3] = pm->data[BPHYS_DATA_LOCATION];
+  float(*vel)[3] = pm->data[BPHYS_DATA_VELOCITY];
+
+  for (int i = start; i < end; i++) {
+    const BodyPoint *bp = &soft->bpoint[i];
+    if (loc) {
+      copy_v3_v3(loc[i], bp->pos);
+    }
+    if (vel) {
+      copy_v3_v3(vel[i], bp->vec);
+    }
+  }
+}
+static void ptcache_softbody_read_points(
+    void *soft_v, PTCacheMem *pm, int start, int end, float UNUSED(cfra))
+{
+  SoftBody *soft = soft_v;
+  const float(*loc)[3] = pm->data[BPHYS_DATA_LOCATION];
+  const float(*vel)[3] = pm->data[BPHYS_DATA_VELOCITY];
+
+  BLI_assert(pm->data[BPHYS_DATA_INDEX] == NULL);
+
+  if (loc) {
+    for (int i = start; i < end; i++) {
+      copy_v3_v3(soft->bpoint[i].pos, loc[i]);
+    }
+  }
+  if (vel) {
+    for (int i = start; i < end; i++) {
+      copy_v3_v3(soft->bpoint[i].vec, vel[i]);
+    }
+  }
+}
+static void ptcache_softbody_interpolate_points(
+    void *soft_v, PTCacheMem *pm, int start, int end, float cfra, float cfra1, float cfra2)
+{
+  ptcache_interpolate_points_foreach(
+      ptcache_softbody_interpolate, soft_v, pm, start, end, cfra, cfra1, cfra2);
+}
 static int ptcache_softbody_totpoint(void *soft_v, int UNUSED(cfra))
 {
   SoftBody *soft = soft_v;
@@ -470,6 +573,18 @@ static void ptcache_particle_interpolate(int index,
   pa->state.time = cfra;
 }
 
+static void ptcache_particle_read_points(
+    void *psys_v, PTCacheMem *pm, int start, int end, float cfra)
+{
+  ptcache_read_points_foreach(ptcache_particle_read, psys_v, pm, start, end, cfra);
+}
+static void ptcache_particle_interpolate_points(
+    void *psys_v, PTCacheMem *pm, int start, int end, float cfra, float cfra1, float cfra2)
+{
+  ptcache_interpolate_points_foreach(
+      ptcache_particle_interpolate, psys_v, pm, start, end, cfra, cfra1, cfra2);
+}
+
 static int ptcache_particle_totpoint(void *psys_v, int UNUSED(cfra))
 {
   ParticleSystem *psys = psys_v;
@@ -616,6 +731,62 @@ static void ptcache_cloth_interpolate(int index,
   /* should vert->xconst be interpolated somehow too? - jahka */
 }
 
+static void ptcache_cloth_write_points(
+    void *cloth_v, PTCacheMem *pm, int start, int end, int UNUSED(cfra))
+{
+  ClothModifierData *clmd = cloth_v;
+  Cloth *cloth = clmd->clothObject;
+  float(*loc)[3] = pm->data[BPHYS_DATA_LOCATION];
+  float(*vel)[3] = pm->data[BPHYS_DATA_VELOCITY];
+  float(*xconst)[3] = pm->data[BPHYS_DATA_XCONST];
+
+  for (int i = start; i < end; i++) {
+    const ClothVertex *vert = &cloth->verts[i];
+    if (loc) {
+      copy_v3_v3(loc[i], vert->x);
+    }
+    if (vel) {
+      copy_v3_v3(vel[i], vert->v);
+    }
+    if (xconst) {
+      copy_v3_v3(xconst[i], vert->xconst);
+    }
+  }
+}
+static void ptcache_cloth_read_points(
+    void *cloth_v, PTCacheMem *pm, int start, int end, float UNUSED(cfra))
+{
+  ClothModifierData *clmd = cloth_v;
+  Cloth *cloth = clmd->clothObject;
+  const float(*loc)[3] = pm->data[BPHYS_DATA_LOCATION];
+  const float(*vel)[3] = pm->data[BPHYS_DATA_VELOCITY];
+  const float(*xconst)[3] = pm->data[BPHYS_DATA_XCONST];
+
+  BLI_assert(pm->data[BPHYS_DATA_INDEX] == NULL);
+
+  if (loc) {
+    for (int i = start; i < end; i++) {
+      copy_v3_v3(cloth->verts[i].x, loc[i]);
+    }
+  }
+  if (vel) {
+    for (int i = start; i < end; i++) {
+      copy_v3_v3(cloth->verts[i].v, vel[i]);
+    }
+  }
+  if (xconst) {
+    for (int i = start; i < end; i++) {
+      copy_v3_v3(cloth->verts[i].xconst, xconst[i]);
+    }
+  }
+}
+static void ptcache_cloth_interpolate_points(
+    void *cloth_v, PTCacheMem *pm, int start, int end, float cfra, float cfra1, float cfra2)
+{
+  ptcache_interpolate_points_foreach(
+      ptcache_cloth_interpolate, cloth_v, pm, start, end, cfra, cfra1, cfra2);
+}
+
 static void ptcache_cloth_extra_write(void *cloth_v, PTCacheMem *pm, int UNUSED(cfra))
 {
   ClothModifierData *clmd = cloth_v;
@@ -886,6 +1057,9 @@ void BKE_ptcache_id_from_softbody(PTCacheID *pid, Object *ob, SoftBody *sb)
   pid->write_point = ptcache_softbody_write;
   pid->read_point = ptcache_softbody_read;
   pid->interpolate_point = ptcache_softbody_interpolate;
+  pid->write_points = ptcache_softbody_write_points;
+  pid->read_points = ptcache_softbody_read_points;
+  pid->interpolate_points = ptcache_softbody_interpolate_points;
 
   pid->write_stream = NULL;
   pid->read_stream = NULL;
@@ -929,6 +1103,8 @@ void BKE_ptcache_id_from_particles(PTCacheID *pid, Object *ob, ParticleSystem *p
   pid->write_point = ptcache_particle_write;
   pid->read_point = ptcache_particle_read;
   pid->interpolate_point = ptcache_particle_interpolate;
+  pid->read_points = ptcache_particle_read_points;
+  pid->interpolate_points = ptcache_particle_interpolate_points;
 
   pid->write_stream = NULL;
   pid->read_stream = NULL;
@@ -985,6 +1161,9 @@ void BKE_ptcache_id_from_cloth(PTCacheID *pid, Object *ob, ClothModifierData *cl
   pid->write_point = ptcache_cloth_write;
   pid->read_point = ptcache_cloth_read;
   pid->interpolate_point = ptcache_cloth_interpolate;
+  pid->write_points = ptcache_cloth_write_points;
+  pid->read_points = ptcache_cloth_read_points;
+  pid->interpolate_points = ptcache_cloth_interpolate_points;
 
   pid->write_stream = NULL;
   pid->read_stream = NULL;
@@ -1779,6 +1958,15 @@ void BKE_ptcache_mem_pointers_init(PTCacheMem *pm, void *cur[BPHYS_TOT_DATA])
   }
 }
 
+static void ptcache_mem_pointers_init_at(PTCacheMem *pm, int point, void *cur[BPHYS_TOT_DATA])
+{
+  for (int i = 0; i < BPHYS_TOT_DATA; i++) {
+    cur[i] = ((pm->data_types & (1 << i)) && pm->data[i]) ?
+                 (char *)pm->data[i] + (size_t)point * (size_t)ptcache_data_size[i] :
+                 NULL;
+  }
+}
+
 void BKE_ptcache_mem_pointers_incr(void *cur[BPHYS_TOT_DATA])
 {
   int i;
@@ -1938,8 +2126,889 @@ static void ptcache_find_frames_around(PTCacheID *pid, unsigned int frame, int *
   }
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Single File Disk Cache
+ *
+ * With #PTCACHE_DISK_SINGLE_FILE, all the frames of a cache are stored in one file instead of
+ * one file per frame. Point data is stored per channel (one array for each #BPHYS_DATA_INDEX...
+ * type and for each extra data), each channel is compressed separately.
+ *
+ * File layout:
+ * - #PTCacheArchiveHeader, storing the location of the frame index.
+ * - Frame records: a #PTCacheArchiveRecord, its #PTCacheArchiveBlock table and the channel data.
+ * - The frame index: #PTCacheArchiveIndexEntry array sorted by frame.
+ * - Frame records written after the index.
+ *
+ * New frames are appended at the end of the file. Records after the index describe themselves,
+ * readers find them by walking from the end of the index, so the index only needs to be written
+ * again once these records are numerous compared to the indexed ones. When removed and replaced
+ * records take more space than the frames in use, the archive is rewritten without them.
+ *
+ * Files are read through a memory mapping, which is kept with the #PointCache until the archive
+ * is modified. So reading a frame only touches the index and the channels of that frame which
+ * are actually used. Structs are copied out of the mapping, records are not aligned.
+ * \{ */
+
+#define PTCACHE_ARCHIVE_EXT ".bpcache"
+#define PTCACHE_ARCHIVE_VERSION 2
+/** Flag of #PTCacheArchiveBlock.type for extra data blocks. */
+#define PTCACHE_ARCHIVE_BLOCK_EXTRA (1u << 31)
+/** Records after the index which don't cause the index to be written again. */
+#define PTCACHE_ARCHIVE_TAIL_LEN_MIN 32
+/** Unused space which never causes the archive to be rewritten. */
+#define PTCACHE_ARCHIVE_UNUSED_SIZE_MIN (1 << 20)
+
+typedef struct PTCacheArchiveHeader {
+  /** "BPHYSARC". */
+  char magic[8];
+  uint32_t version;
+  /** #PTCACHE_TYPE_SOFTBODY... */
+  uint32_t type;
+  uint64_t index_offset;
+  uint32_t index_len;
+  uint32_t _pad;
+} PTCacheArchiveHeader;
+
+typedef struct PTCacheArchiveIndexEntry {
+  int32_t frame;
+  uint32_t _pad;
+  uint64_t record_offset;
+  uint64_t record_size;
+} PTCacheArchiveIndexEntry;
+
+typedef struct PTCacheArchiveRecord {
+  int32_t frame;
+  uint32_t totpoint;
+  uint32_t data_types;
+  uint32_t blocks_len;
+  /** Size of the record including the blocks and their data. */
+  uint64_t size;
+} PTCacheArchiveRecord;
+
+typedef struct PTCacheArchiveBlock {
+  /** #BPHYS_DATA_INDEX... or #PTCACHE_ARCHIVE_BLOCK_EXTRA with the extra data type. */
+  uint32_t type;
+  /** #PTCACHE_COMPRESS_NO... */
+  uint32_t compression;
+  /** Number of elements. */
+  uint32_t len;
+  /** Stored size in bytes. */
+  uint32_t size;
+  /** Offset of the data from the start of the record. */
+  uint64_t offset;
+} PTCacheArchiveBlock;
+
+/** A memory mapped archive, stored in #PointCache.archive. */
+typedef struct PTCacheArchive {
+  char filepath[MAX_PTCACHE_FILE];
+  /** #g_ptcache_archive_generation when the archive was opened. */
+  uint32_t generation;
+  int file;
+  BLI_mmap_file *mmap_file;
+  const char *memory;
+  size_t length;
+  PTCacheArchiveHeader header;
+  /** Frames of the index and of the records after it, sorted by frame. */
+  PTCacheArchiveIndexEntry *index;
+  uint32_t index_len;
+  /** Number of records after the index. */
+  uint32_t tail_len;
+  /** End of the last record after the index, the file length unless a write was interrupted. */
+  uint64_t end_offset;
+} PTCacheArchive;
+
+/**
+ * Incremented whenever an archive file is modified, renamed or removed, so archives which are
+ * mapped by any #PointCache (evaluated copies for e.g.) are opened again.
+ */
+static uint32_t g_ptcache_archive_generation = 0;
+
+static uint32_t ptcache_archive_generation_get(void)
+{
+  return atomic_add_and_fetch_uint32(&g_ptcache_archive_generation, 0);
+}
+
+static void ptcache_archive_tag_modified(void)
+{
+  atomic_add_and_fetch_uint32(&g_ptcache_archive_generation, 1);
+}
+
+static bool ptcache_archive_use(const PTCacheID *pid)
+{
+  /* Stream caches (smoke, dynamic paint) and external caches keep using a file per frame. */
+  return (pid->cache->flag & PTCACHE_DISK_SINGLE_FILE) &&
+         (pid->cache->flag & PTCACHE_EXTERNAL) == 0 && pid->write_stream == NULL &&
+         pid->read_stream == NULL;
+}
+
+static bool ptcache_archive_filepath(PTCacheID *pid, char *filepath)
+{
+  /* PointCaches are inserted in object's list on demand, we need a valid index now. */
+  if (pid->cache->index < 0) {
+    BLI_assert(GS(pid->owner_id->name) == ID_OB);
+    pid->cache->index = pid->stack_index = BKE_object_insert_ptcache((Object *)pid->owner_id);
+  }
+
+  const int len = ptcache_filename(pid, filepath, 0, true, false);
+  if (len == 0) {
+    return false;
+  }
+  BLI_snprintf(filepath + len,
+               MAX_PTCACHE_FILE - (size_t)len,
+               "_%02u" PTCACHE_ARCHIVE_EXT,
+               pid->stack_index);
+  return true;
+}
+
+/**
+ * \return The compressed data (NULL when compression is disabled or does not reduce the size).
+ */
+static unsigned char *ptcache_archive_compress(int mode,
+                                               const unsigned char *in,
+                                               size_t in_len,
+                                               size_t *r_out_len)
+{
+#ifdef WITH_LZO
+  if (mode == PTCACHE_COMPRESS_LZO) {
+    size_t out_len = LZO_OUT_LEN(in_len);
+    unsigned char *out = MEM_mallocN(out_len, "pointcache_lzo_buffer");
+    LZO_HEAP_ALLOC(wrkmem, LZO1X_MEM_COMPRESS);
+
+    if (lzo1x_1_compress(in, (lzo_uint)in_len, out, (lzo_uint *)&out_len, wrkmem) == LZO_E_OK &&
+        out_len < in_len) {
+      *r_out_len = out_len;
+      return out;
+    }
+    MEM_freeN(out);
+  }
+#endif
+#ifdef WITH_LZMA
+  if (mode == PTCACHE_COMPRESS_LZMA) {
+    /* The LZMA properties are stored before the compressed data. */
+    size_t out_len = in_len, props_len = LZMA_PROPS_SIZE;
+    unsigned char *out = MEM_mallocN(LZMA_PROPS_SIZE + in_len, "pointcache_lzma_buffer");
+
+    if (LzmaCompress(out + LZMA_PROPS_SIZE,
+                     &out_len,
+                     in,
+                     in_len,
+                     out,
+                     &props_len,
+                     5,
+                     1 << 24,
+                     3,
+                     0,
+                     2,
+                     32,
+                     2) == SZ_OK &&
+        props_len == LZMA_PROPS_SIZE && LZMA_PROPS_SIZE + out_len < in_len) {
+      *r_out_len = LZMA_PROPS_SIZE + out_len;
+      return out;
+    }
+    MEM_freeN(out);
+  }
+#endif
+  UNUSED_VARS(mode, in, in_len, r_out_len);
+  return NULL;
+}
+
+static bool ptcache_archive_decompress(
+    int mode, const unsigned char *in, size_t in_len, unsigned char *out, size_t out_len)
+{
+  switch (mode) {
+    case PTCACHE_COMPRESS_NO:
+      if (in_len != out_len) {
+        return false;
+      }
+      memcpy(out, in, out_len);
+      return true;
+#ifdef WITH_LZO
+    case PTCACHE_COMPRESS_LZO: {
+      lzo_uint len = (lzo_uint)out_len;
+      return lzo1x_decompress_safe(in, (lzo_uint)in_len, out, &len, NULL) == LZO_E_OK &&
+             len == out_len;
+    }
+#endif
+#ifdef WITH_LZMA
+    case PTCACHE_COMPRESS_LZMA: {
+      if (in_len < LZMA_PROPS_SIZE) {
+        return false;
+      }
+      size_t leni = in_len - LZMA_PROPS_SIZE, leno = out_len;
+      return LzmaUncompress(out, &leno, in + LZMA_PROPS_SIZE, &leni, in, LZMA_PROPS_SIZE) ==
+                 SZ_OK &&
+             leno == out_len;
+    }
+#endif
+  }
+  return false;
+}
+
+static void ptcache_archive_free(PTCacheArchive *archive)
+{
+  if (archive->mmap_file) {
+    BLI_mmap_free(archive->mmap_file);
+  }
+  if (archive->file != -1) {
+    close(archive->file);
+  }
+  MEM_SAFE_FREE(archive->index);
+  MEM_freeN(archive);
+}
+
+/** Unmap the archive of \a cache, must be done before the file is modified. */
+static void ptcache_archive_release(PointCache *cache)
+{
+  if (cache->archive) {
+    ptcache_archive_free(cache->archive);
+    cache->archive = NULL;
+  }
+}
+
+static bool ptcache_archive_header_check(const PTCacheArchiveHeader *header, size_t length)
+{
+  return STREQLEN(header->magic, "BPHYSARC", 8) && header->version == PTCACHE_ARCHIVE_VERSION &&
+         header->index_offset >= sizeof(PTCacheArchiveHeader) &&
+         header->index_offset + (uint64_t)header->index_len * sizeof(PTCacheArchiveIndexEntry) <=
+             length;
+}
+
+static int ptcache_archive_index_entry_cmp(const void *a, const void *b)
+{
+  const PTCacheArchiveIndexEntry *entry_a = a, *entry_b = b;
+  if (entry_a->frame != entry_b->frame) {
+    return (entry_a->frame < entry_b->frame) ? -1 : 1;
+  }
+  /* Records written later replace earlier ones. */
+  if (entry_a->record_offset != entry_b->record_offset) {
+    return (entry_a->record_offset < entry_b->record_offset) ? -1 : 1;
+  }
+  return 0;
+}
+
+/** Read the index and the records after it, the header must be valid. */
+static void ptcache_archive_index_load(PTCacheArchive *archive)
+{
+  const PTCacheArchiveHeader *header = &archive->header;
+  uint32_t index_alloc_len = header->index_len + PTCACHE_ARCHIVE_TAIL_LEN_MIN;
+  archive->index = MEM_mallocN(sizeof(*archive->index) * index_alloc_len,
+                               "pointcache archive index");
+  archive->index_len = header->index_len;
+  archive->tail_len = 0;
+  memcpy(archive->index,
+         archive->memory + header->index_offset,
+         sizeof(*archive->index) * header->index_len);
+
+  uint64_t offset = header->index_offset + sizeof(*archive->index) * header->index_len;
+  PTCacheArchiveRecord record;
+  while (offset + sizeof(record) <= archive->length) {
+    memcpy(&record, archive->memory + offset, sizeof(record));
+    /* A record which was not completely written ends the archive. */
+    if (record.size < sizeof(record) ||
+        (record.size - sizeof(record)) / sizeof(PTCacheArchiveBlock) < record.blocks_len ||
+        record.size > archive->length - offset) {
+      break;
+    }
+    if (archive->index_len == index_alloc_len) {
+      index_alloc_len *= 2;
+      archive->index = MEM_reallocN(archive->index, sizeof(*archive->index) * index_alloc_len);
+    }
+    PTCacheArchiveIndexEntry *entry = &archive->index[archive->index_len++];
+    entry->frame = record.frame;
+    entry->_pad = 0;
+    entry->record_offset = offset;
+    entry->record_size = record.size;
+    archive->tail_len++;
+    offset += record.size;
+  }
+  archive->end_offset = offset;
+
+  if (archive->tail_len != 0) {
+    qsort(archive->index,
+          archive->index_len,
+          sizeof(*archive->index),
+          ptcache_archive_index_entry_cmp);
+    /* Keep the last record of every frame. */
+    uint32_t index_len = 0;
+    for (uint32_t i = 0; i < archive->index_len; i++) {
+      if (index_len != 0 && archive->index[index_len - 1].frame == archive->index[i].frame) {
+        index_len--;
+      }
+      archive->index[index_len++] = archive->index[i];
+    }
+    archive->index_len = index_len;
+  }
+}
+
+static PTCacheArchive *ptcache_archive_load(PTCacheID *pid, const char *filepath)
+{
+  PTCacheArchive *archive = MEM_callocN(sizeof(*archive), __func__);
+  BLI_strncpy(archive->filepath, filepath, sizeof(archive->filepath));
+  archive->generation = ptcache_archive_generation_get();
+
+  archive->file = BLI_open(filepath, O_BINARY | O_RDONLY, 0);
+  if (archive->file == -1) {
+    ptcache_archive_free(archive);
+    return NULL;
+  }
+  archive->mmap_file = BLI_mmap_open(archive->file);
+  if (archive->mmap_file == NULL) {
+    ptcache_archive_free(archive);
+    return NULL;
+  }
+  archive->memory = BLI_mmap_get_pointer(archive->mmap_file);
+  archive->length = BLI_mmap_get_length(archive->mmap_file);
+
+  if (archive->length < sizeof(archive->header)) {
+    ptcache_archive_free(archive);
+    return NULL;
+  }
+  memcpy(&archive->header, archive->memory, sizeof(archive->header));
+  if (!ptcache_archive_header_check(&archive->header, archive->length) ||
+      archive->header.type != pid->type) {
+    ptcache_archive_free(archive);
+    return NULL;
+  }
+
+  ptcache_archive_index_load(archive);
+
+  if (BLI_mmap_any_io_error(archive->mmap_file)) {
+    ptcache_archive_free(archive);
+    return NULL;
+  }
+  return archive;
+}
+
+/**
+ * The mapped archive of \a pid, opened when it was not yet or when it was modified since.
+ * \return NULL when there is no valid archive for this cache.
+ */
+static PTCacheArchive *ptcache_archive_get(PTCacheID *pid)
+{
+  PointCache *cache = pid->cache;
+  char filepath[MAX_PTCACHE_FILE];
+
+  if (!ptcache_archive_filepath(pid, filepath)) {
+    ptcache_archive_release(cache);
+    return NULL;
+  }
+
+  PTCacheArchive *archive = cache->archive;
+  if (archive && (archive->generation != ptcache_archive_generation_get() ||
+                  !STREQ(archive->filepath, filepath))) {
+    ptcache_archive_release(cache);
+    archive = NULL;
+  }
+  if (archive == NULL) {
+    archive = cache->archive = ptcache_archive_load(pid, filepath);
+  }
+  return archive;
+}
+
+static const PTCacheArchiveIndexEntry *ptcache_archive_index_find(
+    const PTCacheArchiveIndexEntry *index, uint32_t index_len, int frame)
+{
+  uint32_t low = 0, high = index_len;
+  while (low < high) {
+    const uint32_t mid = (low + high) / 2;
+    if (index[mid].frame < frame) {
+      low = mid + 1;
+    }
+    else {
+      high = mid;
+    }
+  }
+  return (low < index_len && index[low].frame == frame) ? &index[low] : NULL;
+}
+
+static bool ptcache_archive_frame_exists(PTCacheID *pid, int cfra)
+{
+  PTCacheArchive *archive = ptcache_archive_get(pid);
+  return archive && ptcache_archive_index_find(archive->index, archive->index_len, cfra) != NULL;
+}
+
+typedef struct PTCacheArchiveDecode {
+  const PTCacheArchiveBlock *block;
+  const unsigned char *src;
+  void *dst;
+  size_t dst_len;
+  bool ok;
+} PTCacheArchiveDecode;
+
+static void ptcache_archive_decode_cb(void *__restrict userdata,
+                                      const int i,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  PTCacheArchiveDecode *decode = &((PTCacheArchiveDecode *)userdata)[i];
+  decode->ok = ptcache_archive_decompress((int)decode->block->compression,
+                                          decode->src,
+                                          decode->block->size,
+                                          decode->dst,
+                                          decode->dst_len);
+}
+
+/**
+ * Read a frame from the archive, only decoding the channels in \a data_types.
+ * Channels are decoded in parallel.
+ */
+static PTCacheMem *ptcache_archive_frame_read(PTCacheID *pid, int cfra, unsigned int data_types)
+{
+  PTCacheArchive *archive = ptcache_archive_get(pid);
+  PTCacheMem *pm = NULL;
+  bool error = false;
+
+  if (archive == NULL) {
+    return NULL;
+  }
+
+  const PTCacheArchiveIndexEntry *entry = ptcache_archive_index_find(
+      archive->index, archive->index_len, cfra);
+  if (entry == NULL) {
+    return NULL;
+  }
+
+  const char *record_data = archive->memory + entry->record_offset;
+  PTCacheArchiveRecord record;
+  PTCacheArchiveBlock *blocks = NULL;
+
+  if (entry->record_offset + entry->record_size > archive->length ||
+      entry->record_size < sizeof(record)) {
+    error = true;
+  }
+  else {
+    memcpy(&record, record_data, sizeof(record));
+    if (record.frame != cfra || record.size != entry->record_size ||
+        (entry->record_size - sizeof(record)) / sizeof(*blocks) < record.blocks_len) {
+      error = true;
+    }
+  }
+
+  if (!error) {
+    blocks = MEM_mallocN(sizeof(*blocks) * MAX2(record.blocks_len, 1), __func__);
+    memcpy(blocks, record_data + sizeof(record), sizeof(*blocks) * record.blocks_len);
+
+    pm = MEM_callocN(sizeof(PTCacheMem), "Pointcache mem");
+    pm->frame = (unsigned int)cfra;
+    pm->totpoint = record.totpoint;
+    pm->data_types = record.data_types & data_types;
+    ptcache_data_alloc(pm);
+
+    PTCacheArchiveDecode *decodes = MEM_mallocN(
+        sizeof(*decodes) * MAX2(record.blocks_len, 1), __func__);
+    int decodes_len = 0;
+
+    for (uint32_t i = 0; i < record.blocks_len; i++) {
+      const PTCacheArchiveBlock *block = &blocks[i];
+      PTCacheArchiveDecode *decode = &decodes[decodes_len];
+
+      if (block->offset + block->size > entry->record_size) {
+        error = true;
+        break;
+      }
+
+      if (block->type & PTCACHE_ARCHIVE_BLOCK_EXTRA) {
+        const uint32_t extra_type = block->type & ~PTCACHE_ARCHIVE_BLOCK_EXTRA;
+        if (extra_type == 0 || extra_type >= ARRAY_SIZE(ptcache_extra_datasize)) {
+          error = true;
+          break;
+        }
+        PTCacheExtra *extra = MEM_callocN(sizeof(PTCacheExtra), "Pointcache extradata");
+        extra->type = extra_type;
+        extra->totdata = block->len;
+        decode->dst_len = (size_t)extra->totdata * (size_t)ptcache_extra_datasize[extra_type];
+        extra->data = MEM_callocN(decode->dst_len, "Pointcache extradata->data");
+        BLI_addtail(&pm->extradata, extra);
+        decode->dst = extra->data;
+      }
+      else {
+        /* Channels which are not used are not even read. */
+        if (block->type >= BPHYS_TOT_DATA || (pm->data_types & (1 << block->type)) == 0) {
+          continue;
+        }
+        if (block->len != pm->totpoint) {
+          error = true;
+          break;
+        }
+        decode->dst = pm->data[block->type];
+        decode->dst_len = (size_t)pm->totpoint * (size_t)ptcache_data_size[block->type];
+      }
+      decode->block = block;
+      decode->src = (const unsigned char *)record_data + block->offset;
+      decodes_len++;
+    }
+
+    if (!error) {
+      TaskParallelSettings settings;
+      BLI_parallel_range_settings_defaults(&settings);
+      settings.min_iter_per_thread = 1;
+      settings.use_threading = (pm->totpoint >= PTCACHE_POINTS_CHUNK_SIZE);
+      BLI_task_parallel_range(0, decodes_len, decodes, ptcache_archive_decode_cb, &settings);
+
+      for (int i = 0; i < decodes_len; i++) {
+        error |= !decodes[i].ok;
+      }
+    }
+    MEM_freeN(decodes);
+    MEM_freeN(blocks);
+  }
+
+  if (BLI_mmap_any_io_error(archive->mmap_file)) {
+    error = true;
+  }
+
+  if (error) {
+    if (pm) {
+      ptcache_mem_clear(pm);
+      MEM_freeN(pm);
+      pm = NULL;
+    }
+    if (G.debug & G_DEBUG) {
+      printf("Error reading from disk cache\n");
+    }
+  }
+
+  return pm;
+}
+
+/**
+ * Write \a index at \a index_offset (the end of the file) and update the header.
+ */
+static bool ptcache_archive_index_write(FILE *fp,
+                                        PTCacheArchiveHeader *header,
+                                        const PTCacheArchiveIndexEntry *index,
+                                        uint32_t index_len,
+                                        uint64_t index_offset)
+{
+  header->index_offset = index_offset;
+  header->index_len = index_len;
+
+  return BLI_fseek(fp, (int64_t)index_offset, SEEK_SET) == 0 &&
+         fwrite(index, sizeof(*index), index_len, fp) == index_len &&
+         BLI_fseek(fp, 0, SEEK_SET) == 0 && fwrite(header, sizeof(*header), 1, fp) == 1;
+}
+
+/**
+ * Rewrite the archive with only the records of \a index, when removed and replaced records use
+ * more space than the frames which are still used.
+ */
+static void ptcache_archive_compact_if_needed(PTCacheID *pid)
+{
+  PTCacheArchive *archive = ptcache_archive_get(pid);
+  if (archive == NULL) {
+    return;
+  }
+
+  uint64_t used_size = sizeof(PTCacheArchiveHeader) +
+                       sizeof(PTCacheArchiveIndexEntry) * archive->index_len;
+  for (uint32_t i = 0; i < archive->index_len; i++) {
+    used_size += archive->index[i].record_size;
+  }
+  const uint64_t unused_size = archive->length - MIN2(used_size, archive->length);
+  if (unused_size < PTCACHE_ARCHIVE_UNUSED_SIZE_MIN || unused_size < used_size) {
+    return;
+  }
+
+  char filepath_tmp[MAX_PTCACHE_FILE + 4];
+  BLI_snprintf(filepath_tmp, sizeof(filepath_tmp), "%s.tmp", archive->filepath);
+  FILE *fp = BLI_fopen(filepath_tmp, "wb");
+  if (fp == NULL) {
+    return;
+  }
+
+  PTCacheArchiveHeader header = archive->header;
+  PTCacheArchiveIndexEntry *index = MEM_dupallocN(archive->index);
+  uint64_t offset = sizeof(header);
+  bool error = BLI_fseek(fp, (int64_t)offset, SEEK_SET) != 0;
+
+  for (uint32_t i = 0; i < archive->index_len && !error; i++) {
+    const size_t size = (size_t)index[i].record_size;
+    if (index[i].record_offset + size > archive->length) {
+      error = true;
+      break;
+    }
+    error = fwrite(archive->memory + index[i].record_offset, 1, size, fp) != size;
+    index[i].record_offset = offset;
+    offset += size;
+  }
+  error |= BLI_mmap_any_io_error(archive->mmap_file);
+  if (!error) {
+    error = !ptcache_archive_index_write(fp, &header, index, archive->index_len, offset);
+  }
+  error |= fclose(fp) != 0;
+  MEM_freeN(index);
+
+  /* The file can't be replaced while it's mapped on some platforms. */
+  char filepath[MAX_PTCACHE_FILE];
+  BLI_strncpy(filepath, archive->filepath, sizeof(filepath));
+  ptcache_archive_release(pid->cache);
+  ptcache_archive_tag_modified();
+
+  if (error || BLI_rename(filepath_tmp, filepath) != 0) {
+    BLI_delete(filepath_tmp, false, false);
+    if (G.debug & G_DEBUG) {
+      printf("Error compacting disk cache\n");
+    }
+  }
+}
+
+static bool ptcache_archive_block_write(FILE *fp,
+                                        PTCacheID *pid,
+                                        PTCacheArchiveBlock *block,
+                                        uint32_t type,
+                                        uint32_t len,
+                                        const void *data,
+                                        size_t data_len,
+                                        uint64_t *record_size)
+{
+  size_t size = data_len;
+  unsigned char *compressed = ptcache_archive_compress(
+      pid->cache->compression, data, data_len, &size);
+
+  block->type = type;
+  block->compression = compressed ? (uint32_t)pid->cache->compression : PTCACHE_COMPRESS_NO;
+  block->len = len;
+  block->size = (uint32_t)size;
+  block->offset = *record_size;
+  *record_size += size;
+
+  const bool ok = (fwrite(compressed ? compressed : data, 1, size, fp) == size);
+  MEM_SAFE_FREE(compressed);
+  return ok;
+}
+
+static bool ptcache_archive_frame_write(PTCacheID *pid, PTCacheMem *pm)
+{
+  PTCacheArchiveHeader header;
+  PTCacheArchiveIndexEntry *index;
+  uint32_t index_len, tail_len;
+  uint64_t record_offset;
+  bool is_index_outdated = false;
+  char filepath[MAX_PTCACHE_FILE];
+  bool error = false;
+
+  /* Take the index over, the archive must not be mapped while it's modified. */
+  PTCacheArchive *archive = ptcache_archive_get(pid);
+  FILE *fp = NULL;
+  if (archive) {
+    header = archive->header;
+    index = archive->index;
+    index_len = archive->index_len;
+    tail_len = archive->tail_len;
+    /* Append after an interrupted write, the index must be written again then,
+     * since the records after it are not found past the incomplete one. */
+    record_offset = archive->length;
+    is_index_outdated = archive->end_offset != archive->length;
+    archive->index = NULL;
+    BLI_strncpy(filepath, archive->filepath, sizeof(filepath));
+    ptcache_archive_release(pid->cache);
+    fp = BLI_fopen(filepath, "rb+");
+    index = MEM_reallocN(index, sizeof(*index) * (index_len + 1));
+  }
+  else if (ptcache_archive_filepath(pid, filepath)) {
+    /* Start a new archive (also replacing invalid or outdated ones). */
+    BLI_make_existing_file(filepath);
+    fp = BLI_fopen(filepath, "wb+");
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "BPHYSARC", 8);
+    header.version = PTCACHE_ARCHIVE_VERSION;
+    header.type = pid->type;
+    header.index_offset = sizeof(header);
+    index = MEM_mallocN(sizeof(*index), "pointcache archive index");
+    index_len = 0;
+    tail_len = 0;
+    record_offset = sizeof(header);
+    if (fp) {
+      error = fwrite(&header, sizeof(header), 1, fp) != 1;
+    }
+  }
+  else {
+    return false;
+  }
+  ptcache_archive_tag_modified();
+
+  if (fp == NULL) {
+    MEM_freeN(index);
+    if (G.debug & G_DEBUG) {
+      printf("Error opening disk cache file for writing\n");
+    }
+    return false;
+  }
+
+  PTCacheArchiveRecord record = {0};
+  record.frame = (int32_t)pm->frame;
+  record.totpoint = pm->totpoint;
+  record.data_types = pm->data_types;
+  for (int i = 0; i < BPHYS_TOT_DATA; i++) {
+    if (pm->data[i]) {
+      record.blocks_len++;
+    }
+  }
+  LISTBASE_FOREACH (PTCacheExtra *, extra, &pm->extradata) {
+    if (extra->data && extra->totdata) {
+      record.blocks_len++;
+    }
+  }
+
+  /* The new record is appended, its header is written last so incomplete records are ignored. */
+  const size_t blocks_size = sizeof(PTCacheArchiveBlock) * record.blocks_len;
+  PTCacheArchiveBlock *blocks = MEM_callocN(MAX2(blocks_size, 1), __func__);
+  uint64_t record_size = sizeof(record) + blocks_size;
+  uint32_t block_index = 0;
+
+  if (!error && BLI_fseek(fp, (int64_t)(record_offset + record_size), SEEK_SET) != 0) {
+    error = true;
+  }
+  for (int i = 0; i < BPHYS_TOT_DATA && !error; i++) {
+    if (pm->data[i]) {
+      error = !ptcache_archive_block_write(fp,
+                                           pid,
+                                           &blocks[block_index++],
+                                           (uint32_t)i,
+                                           pm->totpoint,
+                                           pm->data[i],
+                                           (size_t)pm->totpoint * (size_t)ptcache_data_size[i],
+                                           &record_size);
+    }
+  }
+  LISTBASE_FOREACH (PTCacheExtra *, extra, &pm->extradata) {
+    if (error) {
+      break;
+    }
+    if (extra->data && extra->totdata) {
+      error = !ptcache_archive_block_write(
+          fp,
+          pid,
+          &blocks[block_index++],
+          PTCACHE_ARCHIVE_BLOCK_EXTRA | extra->type,
+          extra->totdata,
+          extra->data,
+          (size_t)extra->totdata * (size_t)ptcache_extra_datasize[extra->type],
+          &record_size);
+    }
+  }
+
+  if (!error) {
+    record.size = record_size;
+    error = BLI_fseek(fp, (int64_t)record_offset, SEEK_SET) != 0 ||
+            fwrite(&record, sizeof(record), 1, fp) != 1 ||
+            fwrite(blocks, sizeof(*blocks), record.blocks_len, fp) != record.blocks_len;
+  }
+  MEM_freeN(blocks);
+
+  if (!error) {
+    /* Insert the frame in the sorted index, replacing any previous version of it. */
+    uint32_t i = 0;
+    while (i < index_len && index[i].frame < (int32_t)pm->frame) {
+      i++;
+    }
+    if (i == index_len || index[i].frame != (int32_t)pm->frame) {
+      memmove(&index[i + 1], &index[i], sizeof(*index) * (index_len - i));
+      index_len++;
+    }
+    index[i].frame = (int32_t)pm->frame;
+    index[i]._pad = 0;
+    index[i].record_offset = record_offset;
+    index[i].record_size = record_size;
+    tail_len++;
+
+    /* Write the index again once walking the records after it gets expensive,
+     * this keeps the total size of index writes linear with the number of frames. */
+    if (is_index_outdated || tail_len >= MAX2(PTCACHE_ARCHIVE_TAIL_LEN_MIN, index_len / 2)) {
+      error = !ptcache_archive_index_write(
+          fp, &header, index, index_len, record_offset + record_size);
+    }
+  }
+
+  MEM_freeN(index);
+  error |= fclose(fp) != 0;
+
+  if (error && G.debug & G_DEBUG) {
+    printf("Error writing to disk cache\n");
+  }
+
+  if (!error) {
+    ptcache_archive_compact_if_needed(pid);
+  }
+
+  return !error;
+}
+
+/**
+ * Remove frames from the archive, like #BKE_ptcache_id_clear does for frame files.
+ */
+static void ptcache_archive_clear(PTCacheID *pid, int mode, int cfra)
+{
+  char filepath[MAX_PTCACHE_FILE];
+
+  if (mode == PTCACHE_CLEAR_ALL) {
+    ptcache_archive_release(pid->cache);
+    if (ptcache_archive_filepath(pid, filepath) && BLI_exists(filepath)) {
+      BLI_delete(filepath, false, false);
+      ptcache_archive_tag_modified();
+    }
+    return;
+  }
+
+  PTCacheArchive *archive = ptcache_archive_get(pid);
+  if (archive == NULL) {
+    return;
+  }
+
+  const int sta = pid->cache->startframe, end = pid->cache->endframe;
+  PTCacheArchiveIndexEntry *index = archive->index;
+  uint32_t index_len = 0;
+  for (uint32_t i = 0; i < archive->index_len; i++) {
+    const int frame = index[i].frame;
+    if ((mode == PTCACHE_CLEAR_FRAME && frame == cfra) ||
+        (mode == PTCACHE_CLEAR_BEFORE && frame < cfra) ||
+        (mode == PTCACHE_CLEAR_AFTER && frame > cfra)) {
+      if (pid->cache->cached_frames && frame >= sta && frame <= end) {
+        pid->cache->cached_frames[frame - sta] = 0;
+      }
+    }
+    else {
+      index[index_len++] = index[i];
+    }
+  }
+  if (index_len == archive->index_len) {
+    return;
+  }
+
+  /* Removed records may be after the index, write an index after them so they are not found
+   * anymore. Their space is reclaimed when the archive is compacted. */
+  PTCacheArchiveHeader header = archive->header;
+  const uint64_t index_offset = archive->length;
+  archive->index = NULL;
+  BLI_strncpy(filepath, archive->filepath, sizeof(filepath));
+  ptcache_archive_release(pid->cache);
+  ptcache_archive_tag_modified();
+
+  FILE *fp = BLI_fopen(filepath, "rb+");
+  bool error = (fp == NULL);
+  if (fp) {
+    error = !ptcache_archive_index_write(fp, &header, index, index_len, index_offset);
+    error |= fclose(fp) != 0;
+  }
+  MEM_freeN(index);
+
+  if (error) {
+    if (G.debug & G_DEBUG) {
+      printf("Error writing to disk cache\n");
+    }
+    return;
+  }
+
+  ptcache_archive_compact_if_needed(pid);
+}
+
+/** \} */
+
 static PTCacheMem *ptcache_disk_frame_to_mem(PTCacheID *pid, int cfra)
 {
+  if (ptcache_archive_use(pid)) {
+    return ptcache_archive_frame_read(pid, cfra, pid->data_types | pid->info_types);
+  }
+
   PTCacheFile *pf = ptcache_file_open(pid, PTCACHE_FILE_READ, cfra);
   PTCacheMem *pm = NULL;
   unsigned int i, error = 0;
@@ -2034,6 +3103,11 @@ static int ptcache_mem_frame_to_disk(PTCacheID *pid, PTCacheMem *pm)
   PTCacheFile *pf = NULL;
   unsigned int i, error = 0;
 
+  if (ptcache_archive_use(pid)) {
+    /* Replaces any previous version of the frame. */
+    return ptcache_archive_frame_write(pid, pm);
+  }
+
   BKE_ptcache_id_clear(pid, PTCACHE_CLEAR_FRAME, pm->frame);
 
   pf = ptcache_file_open(pid, PTCACHE_FILE_WRITE, pm->frame);
@@ -2173,6 +3247,58 @@ static int ptcache_read_stream(PTCacheID *pid, int cfra)
   return error == 0;
 }
 
+typedef enum ePTCacheBatchMode {
+  PTCACHE_BATCH_WRITE,
+  PTCACHE_BATCH_READ,
+  PTCACHE_BATCH_INTERPOLATE,
+} ePTCacheBatchMode;
+
+typedef struct PTCacheBatchData {
+  PTCacheID *pid;
+  PTCacheMem *pm;
+  ePTCacheBatchMode mode;
+  int totpoint;
+  float cfra, cfra1, cfra2;
+} PTCacheBatchData;
+
+static void ptcache_points_batch_cb(void *__restrict userdata,
+                                    const int chunk,
+                                    const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const PTCacheBatchData *data = userdata;
+  PTCacheID *pid = data->pid;
+  const int start = chunk * PTCACHE_POINTS_CHUNK_SIZE;
+  const int end = MIN2(start + PTCACHE_POINTS_CHUNK_SIZE, data->totpoint);
+
+  switch (data->mode) {
+    case PTCACHE_BATCH_WRITE:
+      pid->write_points(pid->calldata, data->pm, start, end, (int)data->cfra);
+      break;
+    case PTCACHE_BATCH_READ:
+      pid->read_points(pid->calldata, data->pm, start, end, data->cfra);
+      break;
+    case PTCACHE_BATCH_INTERPOLATE:
+      pid->interpolate_points(
+          pid->calldata, data->pm, start, end, data->cfra, data->cfra1, data->cfra2);
+      break;
+  }
+}
+
+/**
+ * Run the batched point callbacks on ranges of points, in parallel for large caches.
+ */
+static void ptcache_points_batch_run(PTCacheBatchData *data)
+{
+  const int chunks_len = (data->totpoint + PTCACHE_POINTS_CHUNK_SIZE - 1) /
+                         PTCACHE_POINTS_CHUNK_SIZE;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+  settings.use_threading = (chunks_len > 1);
+  BLI_task_parallel_range(0, chunks_len, data, ptcache_points_batch_cb, &settings);
+}
+
 static int ptcache_read(PTCacheID *pid, int cfra)
 {
   PTCacheMem *pm = NULL;
@@ -2204,17 +3330,29 @@ static int ptcache_read(PTCacheID *pid, int cfra)
       }
     }
 
-    void *cur[BPHYS_TOT_DATA];
-    BKE_ptcache_mem_pointers_init(pm, cur);
+    if (pid->read_points) {
+      PTCacheBatchData data = {
+          .pid = pid,
+          .pm = pm,
+          .mode = PTCACHE_BATCH_READ,
+          .totpoint = totpoint,
+          .cfra = (float)pm->frame,
+      };
+      ptcache_points_batch_run(&data);
+    }
+    else {
+      void *cur[BPHYS_TOT_DATA];
+      BKE_ptcache_mem_pointers_init(pm, cur);
 
-    for (i = 0; i < totpoint; i++) {
-      if (pm->data_types & (1 << BPHYS_DATA_INDEX)) {
-        index = cur[BPHYS_DATA_INDEX];
-      }
+      for (i = 0; i < totpoint; i++) {
+        if (pm->data_types & (1 << BPHYS_DATA_INDEX)) {
+          index = cur[BPHYS_DATA_INDEX];
+        }
 
-      pid->read_point(*index, pid->calldata, cur, (float)pm->frame, NULL);
+        pid->read_point(*index, pid->calldata, cur, (float)pm->frame, NULL);
 
-      BKE_ptcache_mem_pointers_incr(cur);
+        BKE_ptcache_mem_pointers_incr(cur);
+      }
     }
 
     if (pid->read_extra_data && pm->extradata.first) {
@@ -2261,16 +3399,31 @@ static int ptcache_interpolate(PTCacheID *pid, float cfra, int cfra1, int cfra2)
       }
     }
 
-    void *cur[BPHYS_TOT_DATA];
-    BKE_ptcache_mem_pointers_init(pm, cur);
+    if (pid->interpolate_points) {
+      PTCacheBatchData data = {
+          .pid = pid,
+          .pm = pm,
+          .mode = PTCACHE_BATCH_INTERPOLATE,
+          .totpoint = totpoint,
+          .cfra = cfra,
+          .cfra1 = (float)cfra1,
+          .cfra2 = (float)cfra2,
+      };
+      ptcache_points_batch_run(&data);
+    }
+    else {
+      void *cur[BPHYS_TOT_DATA];
+      BKE_ptcache_mem_pointers_init(pm, cur);
 
-    for (i = 0; i < totpoint; i++) {
-      if (pm->data_types & (1 << BPHYS_DATA_INDEX)) {
-        index = cur[BPHYS_DATA_INDEX];
-      }
+      for (i = 0; i < totpoint; i++) {
+        if (pm->data_types & (1 << BPHYS_DATA_INDEX)) {
+          index = cur[BPHYS_DATA_INDEX];
+        }
 
-      pid->interpolate_point(*index, pid->calldata, cur, cfra, (float)cfra1, (float)cfra2, NULL);
-      BKE_ptcache_mem_pointers_incr(cur);
+        pid->interpolate_point(
+            *index, pid->calldata, cur, cfra, (float)cfra1, (float)cfra2, NULL);
+        BKE_ptcache_mem_pointers_incr(cur);
+      }
     }
 
     if (pid->interpolate_extra_data && pm->extradata.first) {
@@ -2452,7 +3605,18 @@ static int ptcache_write(PTCacheID *pid, int cfra, int overwrite)
     }
   }
 
-  if (pid->write_point) {
+  if (pid->write_points && pm->totpoint == totpoint) {
+    /* Every point is written, no need to care about newly born points. */
+    PTCacheBatchData data = {
+        .pid = pid,
+        .pm = pm,
+        .mode = PTCACHE_BATCH_WRITE,
+        .totpoint = totpoint,
+        .cfra = (float)cfra,
+    };
+    ptcache_points_batch_run(&data);
+  }
+  else if (pid->write_point) {
     for (i = 0; i < totpoint; i++) {
       int write = pid->write_point(i, pid->calldata, cur, cfra);
       if (write) {
@@ -2632,7 +3796,17 @@ void BKE_ptcache_id_clear(PTCacheID *pid, int mode, unsigned int cfra)
     case PTCACHE_CLEAR_ALL:
     case PTCACHE_CLEAR_BEFORE:
     case PTCACHE_CLEAR_AFTER:
-      if (pid->cache->flag & PTCACHE_DISK_CACHE) {
+      if ((pid->cache->flag & PTCACHE_DISK_CACHE) && ptcache_archive_use(pid)) {
+        ptcache_archive_clear(pid, mode, (int)cfra);
+
+        if (mode == PTCACHE_CLEAR_ALL) {
+          pid->cache->last_exact = MIN2(pid->cache->startframe, 0);
+          if (pid->cache->cached_frames) {
+            memset(pid->cache->cached_frames, 0, MEM_allocN_len(pid->cache->cached_frames));
+          }
+        }
+      }
+      else if (pid->cache->flag & PTCACHE_DISK_CACHE) {
         ptcache_path(pid, path);
 
         dir = opendir(path);
@@ -2720,7 +3894,10 @@ void BKE_ptcache_id_clear(PTCacheID *pid, int mode, unsigned int cfra)
       break;
 
     case PTCACHE_CLEAR_FRAME:
-      if (pid->cache->flag & PTCACHE_DISK_CACHE) {
+      if ((pid->cache->flag & PTCACHE_DISK_CACHE) && ptcache_archive_use(pid)) {
+        ptcache_archive_clear(pid, mode, (int)cfra);
+      }
+      else if (pid->cache->flag & PTCACHE_DISK_CACHE) {
         if (BKE_ptcache_id_exist(pid, cfra)) {
           ptcache_filename(pid, filename, cfra, 1, 1); /* no path */
           BLI_delete(filename, false, false);
@@ -2763,6 +3940,10 @@ int BKE_ptcache_id_exist(PTCacheID *pid, int cfra)
   if (pid->cache->flag & PTCACHE_DISK_CACHE) {
     char filename[MAX_PTCACHE_FILE];
 
+    if (ptcache_archive_use(pid)) {
+      return ptcache_archive_frame_exists(pid, cfra);
+    }
+
     ptcache_filename(pid, filename, cfra, 1, 1);
 
     return BLI_exists(filename);
@@ -2828,7 +4009,19 @@ void BKE_ptcache_id_time(
     cache->cached_frames = MEM_callocN(sizeof(char) * cache->cached_frames_len,
                                        "cached frames array");
 
-    if (pid->cache->flag & PTCACHE_DISK_CACHE) {
+    if ((pid->cache->flag & PTCACHE_DISK_CACHE) && ptcache_archive_use(pid)) {
+      PTCacheArchive *archive = ptcache_archive_get(pid);
+
+      if (archive) {
+        for (uint32_t i = 0; i < archive->index_len; i++) {
+          const int frame = archive->index[i].frame;
+          if (frame >= sta && frame <= end) {
+            cache->cached_frames[frame - sta] = 1;
+          }
+        }
+      }
+    }
+    else if (pid->cache->flag & PTCACHE_DISK_CACHE) {
       /* mode is same as fopen's modes */
       DIR *dir;
       struct dirent *de;
@@ -3031,9 +4224,11 @@ void BKE_ptcache_remove(void)
       if (FILENAME_IS_CURRPAR(de->d_name)) {
         /* do nothing */
       }
-      else if (strstr(de->d_name, PTCACHE_EXT)) { /* do we have the right extension?*/
+      else if (strstr(de->d_name, PTCACHE_EXT) ||
+               strstr(de->d_name, PTCACHE_ARCHIVE_EXT)) { /* do we have the right extension?*/
         BLI_join_dirfile(path_full, sizeof(path_full), path, de->d_name);
         BLI_delete(path_full, false, false);
+        ptcache_archive_tag_modified();
       }
       else {
         rmdir = 0; /* unknown file, don't remove the dir */
@@ -3089,6 +4284,7 @@ void BKE_ptcache_free(PointCache *cache)
   if (cache->cached_frames) {
     MEM_freeN(cache->cached_frames);
   }
+  ptcache_archive_release(cache);
   MEM_freeN(cache);
 }
 void BKE_ptcache_free_list(ListBase *ptcaches)
@@ -3139,6 +4335,7 @@ static PointCache *ptcache_copy(PointCache *cache, const bool copy_data)
 
   /* hmm, should these be copied over instead? */
   ncache->edit = NULL;
+  ncache->archive = NULL;
 
   return ncache;
 }
@@ -3577,9 +4774,72 @@ void BKE_ptcache_disk_cache_rename(PTCacheID *pid, const char *name_src, const c
   }
   closedir(dir);
 
+  /* Single file cache. */
+  BLI_strncpy(pid->cache->name, name_src, sizeof(pid->cache->name));
+  if (ptcache_archive_filepath(pid, old_path_full) && BLI_exists(old_path_full)) {
+    BLI_strncpy(pid->cache->name, name_dst, sizeof(pid->cache->name));
+    if (ptcache_archive_filepath(pid, new_path_full)) {
+      ptcache_archive_release(pid->cache);
+      BLI_rename(old_path_full, new_path_full);
+      ptcache_archive_tag_modified();
+    }
+  }
+
   BLI_strncpy(pid->cache->name, old_name, sizeof(pid->cache->name));
 }
 
+/**
+ * Convert the disk cache to the layout set by #PTCACHE_DISK_SINGLE_FILE,
+ * the flag must already be toggled.
+ */
+void BKE_ptcache_disk_cache_single_file_toggle(PTCacheID *pid)
+{
+  PointCache *cache = pid->cache;
+  const int baked = cache->flag & PTCACHE_BAKED;
+  const int last_exact = cache->last_exact;
+  ListBase frames = {NULL, NULL};
+  PTCacheMem *pm;
+
+  if ((cache->flag & PTCACHE_DISK_CACHE) == 0 || !G.relbase_valid) {
+    return;
+  }
+
+  if (cache->cached_frames) {
+    MEM_freeN(cache->cached_frames);
+    cache->cached_frames = NULL;
+    cache->cached_frames_len = 0;
+  }
+
+  /* Read the frames stored with the previous layout (including the info frame of bakes). */
+  cache->flag ^= PTCACHE_DISK_SINGLE_FILE;
+  if (cache->startframe > 0 && (pm = ptcache_disk_frame_to_mem(pid, 0))) {
+    BLI_addtail(&frames, pm);
+  }
+  for (int cfra = cache->startframe; cfra <= cache->endframe; cfra++) {
+    if ((pm = ptcache_disk_frame_to_mem(pid, cfra))) {
+      BLI_addtail(&frames, pm);
+    }
+  }
+
+  /* Remove possible bake flag to allow clear */
+  cache->flag &= ~PTCACHE_BAKED;
+  BKE_ptcache_id_clear(pid, PTCACHE_CLEAR_ALL, 0);
+
+  cache->flag ^= PTCACHE_DISK_SINGLE_FILE;
+  for (pm = frames.first; pm; pm = pm->next) {
+    ptcache_mem_frame_to_disk(pid, pm);
+  }
+
+  /* restore possible bake flag */
+  cache->flag |= baked;
+  cache->last_exact = last_exact;
+
+  BKE_ptcache_free_mem(&frames);
+
+  BKE_ptcache_id_time(pid, NULL, 0.0f, NULL, NULL, NULL);
+  cache->flag |= PTCACHE_FLAG_INFO_DIRTY;
+}
+
 void BKE_ptcache_load_external(PTCacheID *pid)
 {
   /*todo*/
@@ -3900,6 +5160,7 @@ static void direct_link_pointcache(BlendDataReader *reader, PointCache *cache)
   cache->free_edit = NULL;
   cache->cached_frames = NULL;
   cache->cached_frames_len = 0;
+  cache->archive = NULL;
 }
 
 void BKE_ptcache_blend_read_data(BlendDataReader *reader,
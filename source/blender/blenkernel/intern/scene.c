@@ -254,6 +254,15 @@ static void scene_copy_data(Main *bmain, ID *id_dst, const ID *id_src, const int
   scene_dst->depsgraph_hash = NULL;
   scene_dst->fps_info = NULL;
 
+  /* Only used by the dependency graphs of scenes in Main, not needed for evaluated copies. */
+  if (scene_src->depsgraph_costs && (flag & LIB_ID_CREATE_NO_MAIN) == 0) {
+    scene_dst->depsgraph_costs = MEM_dupallocN(scene_src->depsgraph_costs);
+  }
+  else {
+    scene_dst->depsgraph_costs = NULL;
+    scene_dst->depsgraph_costs_num = 0;
+  }
+
   /* Master Collection */
   if (scene_src->master_collection) {
     BKE_id_copy_ex(bmain,
@@ -378,6 +387,10 @@ static void scene_free_data(ID *id)
 
   /* is no lib link block, but scene extension */
   if (scene->nodetree) {
+    /* The embedded tree is outside of the main database, check the scene owning it. */
+    if ((scene->id.tag & LIB_TAG_NO_MAIN) == 0) {
+      ntreeCompositClearResultCache();
+    }
     ntreeFreeEmbeddedTree(scene->nodetree);
     MEM_freeN(scene->nodetree);
     scene->nodetree = NULL;
@@ -410,6 +423,7 @@ static void scene_free_data(ID *id)
   scene->toolsettings = NULL;
 
   BKE_scene_free_depsgraph_hash(scene);
+  MEM_SAFE_FREE(scene->depsgraph_costs);
 
   MEM_SAFE_FREE(scene->fps_info);
 
@@ -800,6 +814,18 @@ static void scene_blend_write(BlendWriter *writer, ID *id, const void *id_addres
     memset(&sce->cursor, 0, sizeof(sce->cursor));
   }
 
+  /* Gather the evaluation cost profile from the dependency graphs, keep what is stored for undo
+   * steps since the evaluation is not part of the undo history. */
+  DepsgraphOperationCost *depsgraph_costs = NULL;
+  if ((sce->flag & SCE_DEPSGRAPH_COST_PROFILE) == 0) {
+    sce->depsgraph_costs = NULL;
+    sce->depsgraph_costs_num = 0;
+  }
+  else if (!BLO_write_is_undo(writer)) {
+    depsgraph_costs = DEG_cost_profile_export(sce, &sce->depsgraph_costs_num);
+    sce->depsgraph_costs = depsgraph_costs;
+  }
+
   /* write LibData */
   BLO_write_id_struct(writer, Scene, id_address, &sce->id);
   BKE_id_blend_write(writer, &sce->id);
@@ -1023,6 +1049,12 @@ static void scene_blend_write(BlendWriter *writer, ID *id, const void *id_addres
 
   BKE_screen_view3d_shading_blend_write(writer, &sce->display.shading);
 
+  if (sce->depsgraph_costs) {
+    BLO_write_struct_array(
+        writer, DepsgraphOperationCost, sce->depsgraph_costs_num, sce->depsgraph_costs);
+  }
+  MEM_SAFE_FREE(depsgraph_costs);
+
   /* Freed on doversion. */
   BLI_assert(sce->layer_properties == NULL);
 }
@@ -1055,6 +1087,11 @@ static void scene_blend_read_data(BlendDataReader *reader, ID *id)
   sce->depsgraph_hash = NULL;
   sce->fps_info = NULL;
 
+  BLO_read_data_address(reader, &sce->depsgraph_costs);
+  if (sce->depsgraph_costs == NULL) {
+    sce->depsgraph_costs_num = 0;
+  }
+
   memset(&sce->customdata_mask, 0, sizeof(sce->customdata_mask));
   memset(&sce->customdata_mask_modal, 0, sizeof(sce->customdata_mask_modal));
 
@@ -21,6 +21,7 @@
 #include <string>
 
 #include "BLI_sys_types.h"
+#include "BLI_trace.h"
 
 namespace blender::timeit {
 
@@ -52,6 +53,27 @@ class ScopedTimer {
   }
 };
 
+/**
+ * Records the scope in the trace when tracing is enabled, see `BLI_trace.h`.
+ * Unlike #ScopedTimer this is cheap enough to be left in release code.
+ */
+class ScopedTrace {
+ public:
+  ScopedTrace(const char *category, const char *name)
+  {
+    BLI_trace_begin(category, name);
+  }
+
+  ~ScopedTrace()
+  {
+    BLI_trace_end();
+  }
+
+  ScopedTrace(const ScopedTrace &other) = delete;
+  ScopedTrace &operator=(const ScopedTrace &other) = delete;
+};
+
 }  // namespace blender::timeit
 
 #define SCOPED_TIMER(name) blender::timeit::ScopedTimer scoped_timer(name)
+#define TRACE_SCOPE(category, name) blender::timeit::ScopedTrace scoped_trace(category, name)
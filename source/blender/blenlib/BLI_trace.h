@@ -0,0 +1,69 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ *
+ * Low overhead tracing of nested scopes, for finding out where time is spent without attaching
+ * a profiler (on render farm nodes for example).
+ *
+ * Every thread records completed scopes into its own fixed size ring buffer, so recording never
+ * allocates or locks once a thread has traced its first scope. When a buffer is full the oldest
+ * events are overwritten. The events of all threads can be exported as Chrome trace JSON, which
+ * can be opened in `chrome://tracing` or https://ui.perfetto.dev.
+ *
+ * Tracing is disabled by default, in which case #BLI_trace_begin and #BLI_trace_end only check
+ * a flag. Use the `--trace <filepath>` command line argument to enable it.
+ *
+ * C++ code should use #TRACE_SCOPE from `BLI_timeit.hh`.
+ */
+
+#include "BLI_compiler_attrs.h"
+#include "BLI_utildefines.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Start recording, the trace is written to `filepath` by #BLI_trace_exit
+ * (may be NULL to only record in memory, see #BLI_trace_write_json). */
+void BLI_trace_init(const char *filepath);
+/* Write the trace file passed to #BLI_trace_init (if any), stop recording and free all events.
+ * Must not be called while other threads are recording. */
+void BLI_trace_exit(void);
+
+bool BLI_trace_is_enabled(void) ATTR_WARN_UNUSED_RESULT;
+
+/* Begin a nested scope on the calling thread, must be paired with #BLI_trace_end on the same
+ * thread. The `category` string is not copied and must be static, `name` is copied
+ * (and truncated to #BLI_TRACE_NAME_MAX). */
+void BLI_trace_begin(const char *category, const char *name) ATTR_NONNULL(1, 2);
+void BLI_trace_end(void);
+
+/* Write all recorded events as Chrome trace JSON, returns false when the file can't be written.
+ * Scopes that are still open are not included. */
+bool BLI_trace_write_json(const char *filepath) ATTR_NONNULL(1);
+
+/* Number of events currently held in the ring buffers of all threads. */
+size_t BLI_trace_events_len(void);
+
+#define BLI_TRACE_NAME_MAX 64
+
+#ifdef __cplusplus
+}
+#endif
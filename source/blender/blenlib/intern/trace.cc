@@ -0,0 +1,262 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup bli
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "BLI_fileops.h"
+#include "BLI_string.h"
+#include "BLI_threads.h"
+#include "BLI_trace.h"
+
+namespace blender::trace {
+
+using Clock = std::chrono::steady_clock;
+
+/** Number of completed events kept per thread, older events are overwritten. */
+static constexpr int64_t RING_BUFFER_SIZE = 1 << 14;
+/** Deeper scopes are not recorded, but begin/end stay balanced. */
+static constexpr int STACK_SIZE = 64;
+
+struct TraceEvent {
+  char name[BLI_TRACE_NAME_MAX];
+  const char *category;
+  int64_t start_ns;
+  int64_t duration_ns;
+};
+
+struct ThreadBuffer {
+  /* Only accessed by the owning thread. */
+  TraceEvent stack[STACK_SIZE];
+  int stack_depth = 0;
+
+  /* Protects the ring buffer against a concurrent export, not contended while recording. */
+  std::mutex mutex;
+  std::unique_ptr<TraceEvent[]> events{new TraceEvent[RING_BUFFER_SIZE]};
+  /** Total number of events recorded, the ring buffer holds the last #RING_BUFFER_SIZE. */
+  int64_t events_num = 0;
+
+  int thread_id = 0;
+  bool is_main_thread = false;
+};
+
+static struct {
+  std::atomic<bool> enabled{false};
+  /** Incremented by #BLI_trace_exit, so threads register new buffers after they were freed. */
+  std::atomic<int> generation{0};
+  Clock::time_point time_start;
+  std::string filepath;
+
+  std::mutex mutex;
+  std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+} g_trace;
+
+static thread_local ThreadBuffer *tls_buffer = nullptr;
+static thread_local int tls_generation = -1;
+
+static ThreadBuffer *thread_buffer_ensure()
+{
+  const int generation = g_trace.generation.load(std::memory_order_acquire);
+  if (tls_buffer != nullptr && tls_generation == generation) {
+    return tls_buffer;
+  }
+
+  std::unique_ptr<ThreadBuffer> buffer = std::make_unique<ThreadBuffer>();
+  buffer->is_main_thread = BLI_thread_is_main();
+
+  std::lock_guard<std::mutex> lock(g_trace.mutex);
+  buffer->thread_id = int(g_trace.buffers.size()) + 1;
+  tls_buffer = buffer.get();
+  tls_generation = generation;
+  g_trace.buffers.push_back(std::move(buffer));
+  return tls_buffer;
+}
+
+static int64_t time_now_ns()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - g_trace.time_start)
+      .count();
+}
+
+static void write_json_string(FILE *file, const char *str)
+{
+  fputc('"', file);
+  for (const char *c = str; *c; c++) {
+    switch (*c) {
+      case '"':
+        fputs("\\\"", file);
+        break;
+      case '\\':
+        fputs("\\\\", file);
+        break;
+      default:
+        if ((unsigned char)*c < 0x20) {
+          fprintf(file, "\\u%04x", (unsigned char)*c);
+        }
+        else {
+          fputc(*c, file);
+        }
+        break;
+    }
+  }
+  fputc('"', file);
+}
+
+static void write_json_events(FILE *file)
+{
+  bool is_first = true;
+  int64_t events_lost = 0;
+
+  std::lock_guard<std::mutex> lock(g_trace.mutex);
+  for (const std::unique_ptr<ThreadBuffer> &buffer : g_trace.buffers) {
+    std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+
+    fprintf(file,
+            "%s\n{\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"name\":\"thread_name\","
+            "\"args\":{\"name\":\"%s %d\"}}",
+            is_first ? "" : ",",
+            buffer->thread_id,
+            buffer->is_main_thread ? "Main" : "Worker",
+            buffer->thread_id);
+    is_first = false;
+
+    const int64_t events_len = std::min(buffer->events_num, RING_BUFFER_SIZE);
+    events_lost += buffer->events_num - events_len;
+    for (int64_t i = buffer->events_num - events_len; i < buffer->events_num; i++) {
+      const TraceEvent &event = buffer->events[i % RING_BUFFER_SIZE];
+      fprintf(file, ",\n{\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"cat\":", buffer->thread_id);
+      write_json_string(file, event.category);
+      fputs(",\"name\":", file);
+      write_json_string(file, event.name);
+      fprintf(file,
+              ",\"ts\":%.3f,\"dur\":%.3f}",
+              double(event.start_ns) / 1e3,
+              double(event.duration_ns) / 1e3);
+    }
+  }
+
+  if (events_lost != 0) {
+    printf("Trace: %lld oldest events were overwritten, the ring buffers were full\n",
+           (long long)events_lost);
+  }
+}
+
+}  // namespace blender::trace
+
+using namespace blender::trace;
+
+void BLI_trace_init(const char *filepath)
+{
+  g_trace.filepath = filepath ? filepath : "";
+  g_trace.time_start = Clock::now();
+  g_trace.enabled.store(true, std::memory_order_release);
+}
+
+void BLI_trace_exit(void)
+{
+  if (!g_trace.enabled.load(std::memory_order_acquire)) {
+    return;
+  }
+  g_trace.enabled.store(false, std::memory_order_release);
+
+  if (!g_trace.filepath.empty()) {
+    if (BLI_trace_write_json(g_trace.filepath.c_str())) {
+      printf("Trace written to '%s'\n", g_trace.filepath.c_str());
+    }
+    else {
+      printf("Error: could not write trace to '%s'\n", g_trace.filepath.c_str());
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(g_trace.mutex);
+  g_trace.buffers.clear();
+  g_trace.filepath.clear();
+  g_trace.generation.fetch_add(1, std::memory_order_release);
+}
+
+bool BLI_trace_is_enabled(void)
+{
+  return g_trace.enabled.load(std::memory_order_relaxed);
+}
+
+void BLI_trace_begin(const char *category, const char *name)
+{
+  if (!g_trace.enabled.load(std::memory_order_relaxed)) {
+    return;
+  }
+  ThreadBuffer *buffer = thread_buffer_ensure();
+  if (buffer->stack_depth < STACK_SIZE) {
+    TraceEvent &event = buffer->stack[buffer->stack_depth];
+    BLI_strncpy(event.name, name, sizeof(event.name));
+    event.category = category;
+    event.start_ns = time_now_ns();
+  }
+  buffer->stack_depth++;
+}
+
+void BLI_trace_end(void)
+{
+  /* Tracing may have been enabled inside of this scope. */
+  ThreadBuffer *buffer = tls_buffer;
+  if (buffer == nullptr || tls_generation != g_trace.generation.load(std::memory_order_relaxed) ||
+      buffer->stack_depth == 0) {
+    return;
+  }
+  buffer->stack_depth--;
+  if (buffer->stack_depth >= STACK_SIZE) {
+    return;
+  }
+
+  TraceEvent &event = buffer->stack[buffer->stack_depth];
+  event.duration_ns = time_now_ns() - event.start_ns;
+
+  std::lock_guard<std::mutex> lock(buffer->mutex);
+  buffer->events[buffer->events_num % RING_BUFFER_SIZE] = event;
+  buffer->events_num++;
+}
+
+bool BLI_trace_write_json(const char *filepath)
+{
+  FILE *file = BLI_fopen(filepath, "w");
+  if (file == nullptr) {
+    return false;
+  }
+  fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", file);
+  write_json_events(file);
+  fputs("\n]}\n", file);
+  return fclose(file) == 0;
+}
+
+size_t BLI_trace_events_len(void)
+{
+  size_t len = 0;
+  std::lock_guard<std::mutex> lock(g_trace.mutex);
+  for (const std::unique_ptr<ThreadBuffer> &buffer : g_trace.buffers) {
+    std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+    len += size_t(std::min(buffer->events_num, RING_BUFFER_SIZE));
+  }
+  return len;
+}
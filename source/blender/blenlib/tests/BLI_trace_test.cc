@@ -0,0 +1,95 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <fstream>
+#include <sstream>
+
+#include "BLI_task.h"
+#include "BLI_threads.h"
+#include "BLI_timeit.hh"
+#include "BLI_trace.h"
+
+namespace blender::tests {
+
+static std::string read_file(const std::string &filepath)
+{
+  std::ifstream stream(filepath);
+  std::stringstream buffer;
+  buffer << stream.rdbuf();
+  return buffer.str();
+}
+
+TEST(trace, Disabled)
+{
+  EXPECT_FALSE(BLI_trace_is_enabled());
+  {
+    TRACE_SCOPE("test", "disabled");
+  }
+  EXPECT_EQ(BLI_trace_events_len(), 0);
+}
+
+TEST(trace, NestedScopes)
+{
+  BLI_trace_init(nullptr);
+  EXPECT_TRUE(BLI_trace_is_enabled());
+  {
+    TRACE_SCOPE("test", "outer");
+    {
+      TRACE_SCOPE("test", "inner \"quoted\"");
+    }
+    BLI_trace_begin("test", "manual");
+    BLI_trace_end();
+  }
+  /* Unbalanced end is ignored. */
+  BLI_trace_end();
+  EXPECT_EQ(BLI_trace_events_len(), 3);
+
+  const std::string filepath = ::testing::TempDir() + "BLI_trace_test.json";
+  EXPECT_TRUE(BLI_trace_write_json(filepath.c_str()));
+  const std::string json = read_file(filepath);
+  EXPECT_NE(json.find("\"name\":\"outer\""), std::string::npos);
+  EXPECT_NE(json.find("\"name\":\"inner \\\"quoted\\\"\""), std::string::npos);
+  EXPECT_NE(json.find("\"name\":\"manual\""), std::string::npos);
+  EXPECT_NE(json.find("\"ph\":\"X\""), std::string::npos);
+
+  BLI_trace_exit();
+  EXPECT_FALSE(BLI_trace_is_enabled());
+  EXPECT_EQ(BLI_trace_events_len(), 0);
+}
+
+TEST(trace, Threads)
+{
+  BLI_threadapi_init();
+  BLI_trace_init(nullptr);
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(
+      0,
+      100,
+      nullptr,
+      [](void *__restrict UNUSED(userdata),
+         const int UNUSED(i),
+         const TaskParallelTLS *__restrict UNUSED(tls)) { TRACE_SCOPE("test", "task"); },
+      &settings);
+  EXPECT_EQ(BLI_trace_events_len(), 100);
+
+  BLI_trace_exit();
+  BLI_threadapi_exit();
+}
+
+TEST(trace, RingBufferOverflow)
+{
+  BLI_trace_init(nullptr);
+  for (int i = 0; i < 100000; i++) {
+    TRACE_SCOPE("test", "overflow");
+  }
+  const size_t events_len = BLI_trace_events_len();
+  EXPECT_GT(events_len, 0);
+  EXPECT_LT(events_len, 100000);
+  BLI_trace_exit();
+}
+
+}  // namespace blender::tests
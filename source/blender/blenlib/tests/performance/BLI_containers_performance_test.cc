@@ -0,0 +1,708 @@
+/* Apache License, Version 2.0 */
+
+/**
+ * Benchmarks for the blenlib containers, comparing the C containers (GHash, EdgeHash, mempool)
+ * with the C++ containers (Map, Set, VectorSet) and the probing strategies against each other.
+ *
+ * Every case uses keys from a fixed random seed and reports the best of `--perf-repeat` runs as
+ * nanoseconds per element. Pass `--perf-json=<filepath>` to write the results as JSON, so they
+ * can be compared between revisions, and `--perf-max-size` to limit the largest container size.
+ *
+ * Build all blenlib benchmarks with the `blenlib_perf` target.
+ */
+
+#include "testing/testing.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "atomic_ops.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_edgehash.h"
+#include "BLI_ghash.h"
+#include "BLI_kdopbvh.h"
+#include "BLI_map.hh"
+#include "BLI_mempool.h"
+#include "BLI_rand.h"
+#include "BLI_set.hh"
+#include "BLI_span.hh"
+#include "BLI_timeit.hh"
+#include "BLI_vector.hh"
+#include "BLI_vector_set.hh"
+
+DEFINE_string(perf_json, "", "Write the benchmark results to this file as JSON.");
+DEFINE_int32(perf_repeat, 5, "Number of runs per benchmark, the fastest run is reported.");
+DEFINE_int32(perf_max_size, 1000000, "Largest number of elements to benchmark.");
+
+namespace blender::tests {
+
+using timeit::Clock;
+using timeit::Nanoseconds;
+using Edge = std::pair<int, int>;
+
+static const int64_t benchmark_sizes[] = {1000, 100000, 1000000};
+
+/* -------------------------------------------------------------------- */
+/** \name Results
+ * \{ */
+
+struct BenchmarkResult {
+  std::string benchmark;
+  std::string container;
+  std::string operation;
+  int64_t size;
+  double ns_per_element;
+};
+
+static Vector<BenchmarkResult> &benchmark_results()
+{
+  static Vector<BenchmarkResult> results;
+  return results;
+}
+
+static void benchmark_result_add(StringRef benchmark,
+                                 StringRef container,
+                                 StringRef operation,
+                                 const int64_t size,
+                                 const Nanoseconds duration)
+{
+  const double ns_per_element = double(duration.count()) / double(std::max<int64_t>(size, 1));
+  benchmark_results().append({benchmark, container, operation, size, ns_per_element});
+  printf("%-12s %-36s %-12s %9lld: %10.2f ns\n",
+         std::string(benchmark).c_str(),
+         std::string(container).c_str(),
+         std::string(operation).c_str(),
+         (long long)size,
+         ns_per_element);
+}
+
+static void benchmark_results_write_json(const char *filepath)
+{
+  FILE *file = fopen(filepath, "w");
+  if (file == nullptr) {
+    ADD_FAILURE() << "Can't write benchmark results to " << filepath;
+    return;
+  }
+  fprintf(file, "{\n  \"repeat\": %d,\n  \"results\": [", FLAGS_perf_repeat);
+  bool is_first = true;
+  for (const BenchmarkResult &result : benchmark_results()) {
+    fprintf(file,
+            "%s\n    {\"benchmark\": \"%s\", \"container\": \"%s\", \"operation\": \"%s\", "
+            "\"size\": %lld, \"ns_per_element\": %.3f}",
+            is_first ? "" : ",",
+            result.benchmark.c_str(),
+            result.container.c_str(),
+            result.operation.c_str(),
+            (long long)result.size,
+            result.ns_per_element);
+    is_first = false;
+  }
+  fprintf(file, "\n  ]\n}\n");
+  fclose(file);
+}
+
+/** Writes the JSON file once all benchmarks ran. */
+class BenchmarkEnvironment : public ::testing::Environment {
+ public:
+  void TearDown() override
+  {
+    if (!FLAGS_perf_json.empty()) {
+      benchmark_results_write_json(FLAGS_perf_json.c_str());
+    }
+    benchmark_results().clear_and_make_inline();
+  }
+};
+
+static ::testing::Environment *const benchmark_environment = ::testing::AddGlobalTestEnvironment(
+    new BenchmarkEnvironment());
+
+/** Time of a single run of a benchmark, keeping the fastest run. */
+class BestTime {
+ private:
+  Nanoseconds best_ = Nanoseconds::max();
+  Clock::time_point start_;
+
+ public:
+  void start()
+  {
+    start_ = Clock::now();
+  }
+
+  void stop()
+  {
+    best_ = std::min<Nanoseconds>(best_, Clock::now() - start_);
+  }
+
+  Nanoseconds best() const
+  {
+    return best_;
+  }
+};
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Keys
+ *
+ * Every size uses unique keys generated from the same seed, and the same number of keys that are
+ * not in the container to measure failed lookups.
+ * \{ */
+
+template<typename Key> struct BenchmarkKeys {
+  Vector<Key> keys;
+  Vector<Key> missing_keys;
+};
+
+template<typename Key, typename GenerateFn>
+static BenchmarkKeys<Key> benchmark_keys_generate(const int64_t size, const GenerateFn &generate)
+{
+  RNG *rng = BLI_rng_new(0);
+  Set<Key> used_keys;
+  BenchmarkKeys<Key> result;
+  while (result.missing_keys.size() < size) {
+    Key key = generate(rng);
+    if (!used_keys.add(key)) {
+      continue;
+    }
+    if (result.keys.size() < size) {
+      result.keys.append(std::move(key));
+    }
+    else {
+      result.missing_keys.append(std::move(key));
+    }
+  }
+  BLI_rng_free(rng);
+  return result;
+}
+
+static BenchmarkKeys<int> int_keys_generate(const int64_t size)
+{
+  return benchmark_keys_generate<int>(size, [](RNG *rng) { return BLI_rng_get_int(rng); });
+}
+
+static BenchmarkKeys<std::string> string_keys_generate(const int64_t size)
+{
+  return benchmark_keys_generate<std::string>(size, [](RNG *rng) {
+    return "key_" + std::to_string(BLI_rng_get_uint(rng));
+  });
+}
+
+static BenchmarkKeys<Edge> edge_keys_generate(const int64_t size)
+{
+  /* Vertex indices of a mesh are in a limited range, which makes collisions more likely. */
+  const int verts_num = int(std::max<int64_t>(size / 2, 16));
+  return benchmark_keys_generate<Edge>(size, [verts_num](RNG *rng) {
+    const int v1 = BLI_rng_get_int(rng) % verts_num;
+    const int v2 = BLI_rng_get_int(rng) % verts_num;
+    return Edge(std::min(v1, v2), std::max(v1, v2) + 1);
+  });
+}
+
+/** Used to make iteration results depend on the keys, so the loops are not optimized away. */
+static int64_t key_weight(const int key)
+{
+  return key;
+}
+static int64_t key_weight(const std::string &key)
+{
+  return int64_t(key.size());
+}
+static int64_t key_weight(const Edge &key)
+{
+  return key.first;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Container Adapters
+ *
+ * Give all containers the same interface: `insert`, `contains`, `iterate` and `remove`.
+ * \{ */
+
+template<typename Key, typename ProbingStrategy = DefaultProbingStrategy> class MapAdapter {
+  Map<Key, int, 0, ProbingStrategy> map_;
+
+ public:
+  void insert(const Key &key, const int value)
+  {
+    map_.add_new(key, value);
+  }
+  bool contains(const Key &key) const
+  {
+    return map_.lookup_ptr(key) != nullptr;
+  }
+  int64_t iterate() const
+  {
+    int64_t sum = 0;
+    for (auto item : map_.items()) {
+      sum += key_weight(item.key) + item.value;
+    }
+    return sum;
+  }
+  bool remove(const Key &key)
+  {
+    return map_.remove(key);
+  }
+};
+
+template<typename Key> class SetAdapter {
+  Set<Key, 0> set_;
+
+ public:
+  void insert(const Key &key, const int UNUSED(value))
+  {
+    set_.add_new(key);
+  }
+  bool contains(const Key &key) const
+  {
+    return set_.contains(key);
+  }
+  int64_t iterate() const
+  {
+    int64_t sum = 0;
+    for (const Key &key : set_) {
+      sum += key_weight(key);
+    }
+    return sum;
+  }
+  bool remove(const Key &key)
+  {
+    return set_.remove(key);
+  }
+};
+
+template<typename Key> class VectorSetAdapter {
+  VectorSet<Key> set_;
+
+ public:
+  void insert(const Key &key, const int UNUSED(value))
+  {
+    set_.add_new(key);
+  }
+  bool contains(const Key &key) const
+  {
+    return set_.contains(key);
+  }
+  int64_t iterate() const
+  {
+    int64_t sum = 0;
+    for (const Key &key : set_) {
+      sum += key_weight(key);
+    }
+    return sum;
+  }
+  bool remove(const Key &key)
+  {
+    return set_.remove(key);
+  }
+};
+
+template<typename Key> class StdUnorderedMapAdapter {
+  std::unordered_map<Key, int, DefaultHash<Key>> map_;
+
+ public:
+  void insert(const Key &key, const int value)
+  {
+    map_.insert({key, value});
+  }
+  bool contains(const Key &key) const
+  {
+    return map_.find(key) != map_.end();
+  }
+  int64_t iterate() const
+  {
+    int64_t sum = 0;
+    for (const auto &item : map_) {
+      sum += key_weight(item.first) + item.second;
+    }
+    return sum;
+  }
+  bool remove(const Key &key)
+  {
+    return map_.erase(key) != 0;
+  }
+};
+
+class GHashIntAdapter {
+  GHash *ghash_ = BLI_ghash_int_new("GHashIntAdapter");
+
+ public:
+  ~GHashIntAdapter()
+  {
+    BLI_ghash_free(ghash_, nullptr, nullptr);
+  }
+  void insert(const int key, const int value)
+  {
+    BLI_ghash_insert(ghash_, POINTER_FROM_INT(key), POINTER_FROM_INT(value));
+  }
+  bool contains(const int key) const
+  {
+    return BLI_ghash_haskey(ghash_, POINTER_FROM_INT(key));
+  }
+  int64_t iterate() const
+  {
+    int64_t sum = 0;
+    GHASH_FOREACH_BEGIN (void *, value, ghash_) {
+      sum += POINTER_AS_INT(value);
+    }
+    GHASH_FOREACH_END();
+    return sum;
+  }
+  bool remove(const int key)
+  {
+    return BLI_ghash_remove(ghash_, POINTER_FROM_INT(key), nullptr, nullptr);
+  }
+};
+
+/** The strings are owned by the benchmark keys, like strings owned by ID's in practice. */
+class GHashStrAdapter {
+  GHash *ghash_ = BLI_ghash_str_new("GHashStrAdapter");
+
+ public:
+  ~GHashStrAdapter()
+  {
+    BLI_ghash_free(ghash_, nullptr, nullptr);
+  }
+  void insert(const std::string &key, const int value)
+  {
+    BLI_ghash_insert(ghash_, (void *)key.c_str(), POINTER_FROM_INT(value));
+  }
+  bool contains(const std::string &key) const
+  {
+    return BLI_ghash_haskey(ghash_, key.c_str());
+  }
+  int64_t iterate() const
+  {
+    int64_t sum = 0;
+    GHASH_FOREACH_BEGIN (void *, value, ghash_) {
+      sum += POINTER_AS_INT(value);
+    }
+    GHASH_FOREACH_END();
+    return sum;
+  }
+  bool remove(const std::string &key)
+  {
+    return BLI_ghash_remove(ghash_, key.c_str(), nullptr, nullptr);
+  }
+};
+
+class EdgeHashAdapter {
+  EdgeHash *edgehash_ = BLI_edgehash_new("EdgeHashAdapter");
+
+ public:
+  ~EdgeHashAdapter()
+  {
+    BLI_edgehash_free(edgehash_, nullptr);
+  }
+  void insert(const Edge &key, const int value)
+  {
+    BLI_edgehash_insert(edgehash_, key.first, key.second, POINTER_FROM_INT(value));
+  }
+  bool contains(const Edge &key) const
+  {
+    return BLI_edgehash_haskey(edgehash_, key.first, key.second);
+  }
+  int64_t iterate() const
+  {
+    int64_t sum = 0;
+    EdgeHashIterator iter;
+    for (BLI_edgehashIterator_init(&iter, edgehash_); !BLI_edgehashIterator_isDone(&iter);
+         BLI_edgehashIterator_step(&iter)) {
+      sum += POINTER_AS_INT(BLI_edgehashIterator_getValue(&iter));
+    }
+    return sum;
+  }
+  bool remove(const Edge &key)
+  {
+    return BLI_edgehash_remove(edgehash_, key.first, key.second, nullptr);
+  }
+};
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Hash Table Benchmarks
+ * \{ */
+
+template<typename Container, typename Key>
+static void benchmark_container(StringRef benchmark,
+                                StringRef container_name,
+                                const BenchmarkKeys<Key> &keys)
+{
+  const Span<Key> keys_found = keys.keys;
+  const Span<Key> keys_missing = keys.missing_keys;
+  BestTime time_insert, time_lookup, time_lookup_missing, time_iterate, time_remove;
+  int64_t check = 0;
+
+  for (int repeat = 0; repeat < FLAGS_perf_repeat; repeat++) {
+    Container *container = new Container();
+
+    time_insert.start();
+    for (const int64_t i : keys_found.index_range()) {
+      container->insert(keys_found[i], int(i));
+    }
+    time_insert.stop();
+
+    time_lookup.start();
+    for (const Key &key : keys_found) {
+      check += container->contains(key);
+    }
+    time_lookup.stop();
+
+    time_lookup_missing.start();
+    for (const Key &key : keys_missing) {
+      check += container->contains(key);
+    }
+    time_lookup_missing.stop();
+
+    time_iterate.start();
+    check += container->iterate();
+    time_iterate.stop();
+
+    time_remove.start();
+    for (const Key &key : keys_found) {
+      check += container->remove(key);
+    }
+    time_remove.stop();
+
+    delete container;
+  }
+
+  /* Keep the results alive, so the compiler can't skip any of the work. */
+  EXPECT_NE(check, -1);
+
+  const int64_t size = keys_found.size();
+  benchmark_result_add(benchmark, container_name, "insert", size, time_insert.best());
+  benchmark_result_add(benchmark, container_name, "lookup", size, time_lookup.best());
+  benchmark_result_add(
+      benchmark, container_name, "lookup_miss", size, time_lookup_missing.best());
+  benchmark_result_add(benchmark, container_name, "iterate", size, time_iterate.best());
+  benchmark_result_add(benchmark, container_name, "remove", size, time_remove.best());
+}
+
+TEST(containers_performance, IntKeys)
+{
+  for (const int64_t size : benchmark_sizes) {
+    if (size > FLAGS_perf_max_size) {
+      break;
+    }
+    const BenchmarkKeys<int> keys = int_keys_generate(size);
+    benchmark_container<MapAdapter<int>>("int", "Map (python probing)", keys);
+    benchmark_container<MapAdapter<int, LinearProbingStrategy>>(
+        "int", "Map (linear probing)", keys);
+    benchmark_container<MapAdapter<int, QuadraticProbingStrategy>>(
+        "int", "Map (quadratic probing)", keys);
+    benchmark_container<MapAdapter<int, ShuffleProbingStrategy<>>>(
+        "int", "Map (shuffle probing)", keys);
+    benchmark_container<SetAdapter<int>>("int", "Set", keys);
+    benchmark_container<VectorSetAdapter<int>>("int", "VectorSet", keys);
+    benchmark_container<StdUnorderedMapAdapter<int>>("int", "std::unordered_map", keys);
+    benchmark_container<GHashIntAdapter>("int", "GHash", keys);
+  }
+}
+
+TEST(containers_performance, StringKeys)
+{
+  for (const int64_t size : benchmark_sizes) {
+    if (size > FLAGS_perf_max_size) {
+      break;
+    }
+    const BenchmarkKeys<std::string> keys = string_keys_generate(size);
+    benchmark_container<MapAdapter<std::string>>("string", "Map", keys);
+    benchmark_container<SetAdapter<std::string>>("string", "Set", keys);
+    benchmark_container<VectorSetAdapter<std::string>>("string", "VectorSet", keys);
+    benchmark_container<StdUnorderedMapAdapter<std::string>>("string", "std::unordered_map", keys);
+    benchmark_container<GHashStrAdapter>("string", "GHash", keys);
+  }
+}
+
+TEST(containers_performance, EdgeKeys)
+{
+  for (const int64_t size : benchmark_sizes) {
+    if (size > FLAGS_perf_max_size) {
+      break;
+    }
+    const BenchmarkKeys<Edge> keys = edge_keys_generate(size);
+    benchmark_container<MapAdapter<Edge>>("edge", "Map", keys);
+    benchmark_container<SetAdapter<Edge>>("edge", "Set", keys);
+    benchmark_container<StdUnorderedMapAdapter<Edge>>("edge", "std::unordered_map", keys);
+    benchmark_container<EdgeHashAdapter>("edge", "EdgeHash", keys);
+  }
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Allocator Benchmarks
+ * \{ */
+
+struct MempoolElem {
+  float co[3];
+  int index;
+};
+
+TEST(containers_performance, Mempool)
+{
+  for (const int64_t size : benchmark_sizes) {
+    if (size > FLAGS_perf_max_size) {
+      break;
+    }
+    Vector<MempoolElem *> elems(size);
+    BestTime time_alloc, time_iterate, time_free;
+    BestTime time_malloc, time_malloc_free;
+    int64_t check = 0;
+
+    for (int repeat = 0; repeat < FLAGS_perf_repeat; repeat++) {
+      BLI_mempool *pool = BLI_mempool_create(
+          sizeof(MempoolElem), 0, 512, BLI_MEMPOOL_ALLOW_ITER);
+
+      time_alloc.start();
+      for (const int64_t i : elems.index_range()) {
+        elems[i] = (MempoolElem *)BLI_mempool_alloc(pool);
+        elems[i]->index = int(i);
+      }
+      time_alloc.stop();
+
+      time_iterate.start();
+      BLI_mempool_iter iter;
+      BLI_mempool_iternew(pool, &iter);
+      for (MempoolElem *elem = (MempoolElem *)BLI_mempool_iterstep(&iter); elem;
+           elem = (MempoolElem *)BLI_mempool_iterstep(&iter)) {
+        check += elem->index;
+      }
+      time_iterate.stop();
+
+      /* Free in a different order than allocated, like when removing mesh elements. */
+      time_free.start();
+      for (int64_t i = 0; i < size; i += 2) {
+        BLI_mempool_free(pool, elems[i]);
+      }
+      for (int64_t i = 1; i < size; i += 2) {
+        BLI_mempool_free(pool, elems[i]);
+      }
+      time_free.stop();
+
+      BLI_mempool_destroy(pool);
+
+      time_malloc.start();
+      for (const int64_t i : elems.index_range()) {
+        elems[i] = (MempoolElem *)MEM_mallocN(sizeof(MempoolElem), __func__);
+        elems[i]->index = int(i);
+      }
+      time_malloc.stop();
+
+      time_malloc_free.start();
+      for (int64_t i = 0; i < size; i += 2) {
+        MEM_freeN(elems[i]);
+      }
+      for (int64_t i = 1; i < size; i += 2) {
+        MEM_freeN(elems[i]);
+      }
+      time_malloc_free.stop();
+    }
+    EXPECT_NE(check, -1);
+
+    benchmark_result_add("alloc", "BLI_mempool", "alloc", size, time_alloc.best());
+    benchmark_result_add("alloc", "BLI_mempool", "iterate", size, time_iterate.best());
+    benchmark_result_add("alloc", "BLI_mempool", "free", size, time_free.best());
+    benchmark_result_add("alloc", "MEM_mallocN", "alloc", size, time_malloc.best());
+    benchmark_result_add("alloc", "MEM_mallocN", "free", size, time_malloc_free.best());
+  }
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name BVH Tree Benchmarks
+ * \{ */
+
+static bool bvhtree_overlap_count_cb(void *userdata,
+                                     int UNUSED(index_a),
+                                     int UNUSED(index_b),
+                                     int UNUSED(thread))
+{
+  /* Called from multiple threads. */
+  atomic_add_and_fetch_int64((int64_t *)userdata, 1);
+  return false;
+}
+
+TEST(containers_performance, KDopBVH)
+{
+  for (const int64_t size : benchmark_sizes) {
+    if (size > FLAGS_perf_max_size) {
+      break;
+    }
+    /* Small boxes around random points in a unit cube, with a similar density for all sizes. */
+    RNG *rng = BLI_rng_new(0);
+    const float box_size = 0.5f / std::pow(float(size), 1.0f / 3.0f);
+    Vector<std::array<float, 6>> boxes(size);
+    for (std::array<float, 6> &box : boxes) {
+      for (int i = 0; i < 3; i++) {
+        box[i] = BLI_rng_get_float(rng);
+        box[i + 3] = box[i] + box_size;
+      }
+    }
+    /* Limit the number of queries, they get slower with the tree size. */
+    Vector<std::array<float, 3>> queries(std::min<int64_t>(size, 10000));
+    for (std::array<float, 3> &query : queries) {
+      for (float &value : query) {
+        value = BLI_rng_get_float(rng);
+      }
+    }
+    BLI_rng_free(rng);
+
+    BestTime time_build, time_find_nearest, time_overlap;
+    int64_t check = 0;
+
+    for (int repeat = 0; repeat < FLAGS_perf_repeat; repeat++) {
+      time_build.start();
+      BVHTree *tree = BLI_bvhtree_new(int(size), 0.0f, 8, 6);
+      for (const int64_t i : boxes.index_range()) {
+        BLI_bvhtree_insert(tree, int(i), boxes[i].data(), 2);
+      }
+      BLI_bvhtree_balance(tree);
+      time_build.stop();
+
+      time_find_nearest.start();
+      for (const std::array<float, 3> &query : queries) {
+        BVHTreeNearest nearest;
+        nearest.index = -1;
+        nearest.dist_sq = FLT_MAX;
+        check += BLI_bvhtree_find_nearest(tree, query.data(), &nearest, nullptr, nullptr);
+      }
+      time_find_nearest.stop();
+
+      time_overlap.start();
+      uint overlap_len = 0;
+      BVHTreeOverlap *overlap = BLI_bvhtree_overlap(
+          tree, tree, &overlap_len, bvhtree_overlap_count_cb, &check);
+      time_overlap.stop();
+      check += overlap_len;
+      MEM_SAFE_FREE(overlap);
+
+      BLI_bvhtree_free(tree);
+    }
+    EXPECT_NE(check, -1);
+
+    benchmark_result_add("bvh", "BLI_kdopbvh", "build", size, time_build.best());
+    /* Reported per query. */
+    benchmark_result_add("bvh",
+                         "BLI_kdopbvh",
+                         "find_nearest",
+                         size,
+                         time_find_nearest.best() * size / queries.size());
+    benchmark_result_add("bvh", "BLI_kdopbvh", "overlap_self", size, time_overlap.best());
+  }
+}
+
+/** \} */
+
+}  // namespace blender::tests
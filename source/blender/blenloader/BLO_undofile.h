@@ -38,14 +38,47 @@ typedef struct {
    * detect unchanged IDs).
    * Defined when writing the next step (i.e. last undo step has those always false). */
   bool is_identical_future;
+  /** When true, this chunk doesn't own the memory either, it's shared with another chunk with
+   * the same content (from the previous #MemFile, or earlier in this one). Unlike #is_identical
+   * this doesn't mean the data at this position is unchanged, since the content may have moved
+   * or may be duplicated from other IDs. */
+  bool is_content_shared;
   /** Session UUID of the ID being currently written (MAIN_ID_SESSION_UUID_UNSET when not writing
    * ID-related data). Used to find matching chunks in previous memundo step. */
   uint id_session_uuid;
+  /** Hash of the chunk content, used to find chunks with the same content. */
+  uint content_hash;
+  /** When the chunk is compressed, #buf is NULL and the compressed data is stored here instead,
+   * see #BLO_memfile_compress_begin. */
+  char *buf_compressed;
+  size_t buf_compressed_size;
 } MemFileChunk;
 
+typedef struct MemFileStats {
+  /** Number of chunks & bytes shared with the chunk at the same position of the previous step. */
+  int identical_chunks;
+  size_t identical_size;
+  /** Number of chunks & bytes shared with any chunk with the same content. */
+  int content_shared_chunks;
+  size_t content_shared_size;
+  /** Number of chunks & bytes owned by this #MemFile. */
+  int owned_chunks;
+  size_t owned_size;
+  /** Size of the compressed chunks before & after compression. */
+  size_t compressed_size_orig;
+  size_t compressed_size;
+} MemFileStats;
+
 typedef struct MemFile {
   ListBase chunks;
+  /** Memory owned by this #MemFile, not shared with other steps. */
   size_t size;
+  /** Statistics of the sharing with other steps, computed when writing. */
+  MemFileStats stats;
+  /** Compression was started for this #MemFile (it may still be running in the background). */
+  bool is_compressed;
+  /** Background compression which wasn't applied yet, see #BLO_memfile_compress_update. */
+  struct MemFileCompressTask *compress_task;
 } MemFile;
 
 typedef struct MemFileWriteData {
@@ -57,6 +90,8 @@ typedef struct MemFileWriteData {
 
   /** Maps an ID session uuid to its first reference MemFileChunk, if existing. */
   struct GHash *id_session_uuid_mapping;
+  /** Maps a chunk content hash to a chunk from the reference or the written #MemFile. */
+  struct GHash *content_hash_mapping;
 } MemFileWriteData;
 
 typedef struct MemFileUndoData {
@@ -78,6 +113,12 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
 extern void BLO_memfile_free(MemFile *memfile);
 extern void BLO_memfile_merge(MemFile *first, MemFile *second);
 extern void BLO_memfile_clear_future(MemFile *memfile);
+extern void BLO_memfile_stats_print(const MemFile *memfile);
+
+/* Compression of cold undo steps. */
+extern void BLO_memfile_compress_begin(MemFile *memfile, const MemFile *memfile_next);
+extern void BLO_memfile_compress_update(MemFile *memfile);
+extern bool BLO_memfile_decompress(MemFile *memfile);
 
 /* utilities */
 extern struct Main *BLO_memfile_main_get(struct MemFile *memfile,
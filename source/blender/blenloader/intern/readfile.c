@@ -65,7 +65,10 @@
 #include "BLI_math.h"
 #include "BLI_memarena.h"
 #include "BLI_mempool.h"
+#include "BLI_mmap.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
+#include "BLI_trace.h"
 
 #include "BLT_translation.h"
 
@@ -103,6 +106,8 @@
 
 #include "SEQ_sequencer.h"
 
+#include "PIL_time.h"
+
 #include "readfile.h"
 
 #include <errno.h>
@@ -178,6 +183,10 @@
 /* Define this to have verbose debug prints. */
 //#define USE_DEBUG_PRINT
 
+/* Define this to print #OldNewMap statistics (load factor, probe lengths) when freeing the
+ * #FileData, useful to check the efficiency of the hash-map lookups when reading files. */
+//#define USE_OLDNEWMAP_STATS
+
 #ifdef USE_DEBUG_PRINT
 #  define DEBUG_PRINTF(...) printf(__VA_ARGS__)
 #else
@@ -187,6 +196,9 @@
 /* local prototypes */
 static void read_libraries(FileData *basefd, ListBase *mainlist);
 static void *read_struct(FileData *fd, BHead *bh, const char *blockname);
+#ifdef USE_BHEAD_READ_ON_DEMAND
+static void read_file_decode_data_window(FileData *fd, int decode_index);
+#endif
 static BHead *find_bhead_from_code_name(FileData *fd, const short idcode, const char *name);
 static BHead *find_bhead_from_idname(FileData *fd, const char *idname);
 static bool library_link_idcode_needs_tag_check(const short idcode, const int flag);
@@ -198,6 +210,11 @@ typedef struct BHeadN {
   off64_t file_offset;
   /** When set, the remainder of this allocation is the data, otherwise it needs to be read. */
   bool has_data;
+  /** Data already decoded by #read_file_decode_data_window, owned by this block until it's
+   * taken by #read_struct. */
+  void *decoded_data;
+  /** Index in #FileData.decode_bheads, -1 when the data is not decoded in parallel. */
+  int decode_index;
 #endif
   bool is_memchunk_identical;
   struct BHead bhead;
@@ -260,6 +277,19 @@ typedef struct OldNewMap {
   int32_t *map;
 
   int capacity_exp;
+
+#ifdef USE_OLDNEWMAP_STATS
+  struct {
+    uint64_t lookups, lookup_probes;
+    uint64_t inserts, insert_probes;
+    int probes_max;
+    /** Highest number of entries and resulting load factor of the map. */
+    int nentries_max;
+    float load_factor_max;
+    /** Number of times the map had to be resized. */
+    int resizes;
+  } stats;
+#endif
 } OldNewMap;
 
 #define ENTRIES_CAPACITY(onm) (1ll << (onm)->capacity_exp)
@@ -289,9 +319,36 @@ static void oldnewmap_insert_index_in_map(OldNewMap *onm, const void *ptr, int i
   }
 }
 
+#ifdef USE_OLDNEWMAP_STATS
+static void oldnewmap_stats_probes(OldNewMap *onm, int probes, const bool is_insert)
+{
+  if (is_insert) {
+    onm->stats.inserts++;
+    onm->stats.insert_probes += (uint64_t)probes;
+    onm->stats.nentries_max = max_ii(onm->stats.nentries_max, onm->nentries);
+    onm->stats.load_factor_max = max_ff(onm->stats.load_factor_max,
+                                        (float)onm->nentries / (float)MAP_CAPACITY(onm));
+  }
+  else {
+    onm->stats.lookups++;
+    onm->stats.lookup_probes += (uint64_t)probes;
+  }
+  onm->stats.probes_max = max_ii(onm->stats.probes_max, probes);
+}
+#  define OLDNEWMAP_STATS_PROBES(onm, probes, is_insert) \
+    oldnewmap_stats_probes((OldNewMap *)(onm), probes, is_insert)
+#  define OLDNEWMAP_STATS_PROBE_INCR(probes) (probes)++
+#else
+#  define OLDNEWMAP_STATS_PROBES(onm, probes, is_insert)
+#  define OLDNEWMAP_STATS_PROBE_INCR(probes)
+#endif
+
 static void oldnewmap_insert_or_replace(OldNewMap *onm, OldNew entry)
 {
+  int probes = 0;
+  UNUSED_VARS(probes);
   ITER_SLOTS (onm, entry.oldp, slot, index) {
+    OLDNEWMAP_STATS_PROBE_INCR(probes);
     if (index == -1) {
       onm->entries[onm->nentries] = entry;
       onm->map[slot] = onm->nentries;
@@ -303,18 +360,24 @@ static void oldnewmap_insert_or_replace(OldNewMap *onm, OldNew entry)
       break;
     }
   }
+  OLDNEWMAP_STATS_PROBES(onm, probes, true);
 }
 
 static OldNew *oldnewmap_lookup_entry(const OldNewMap *onm, const void *addr)
 {
+  int probes = 0;
+  UNUSED_VARS(probes);
   ITER_SLOTS (onm, addr, slot, index) {
+    OLDNEWMAP_STATS_PROBE_INCR(probes);
     if (index >= 0) {
       OldNew *entry = &onm->entries[index];
       if (entry->oldp == addr) {
+        OLDNEWMAP_STATS_PROBES(onm, probes, false);
         return entry;
       }
     }
     else {
+      OLDNEWMAP_STATS_PROBES(onm, probes, false);
       return NULL;
     }
   }
@@ -325,9 +388,12 @@ static void oldnewmap_clear_map(OldNewMap *onm)
   memset(onm->map, 0xFF, MAP_CAPACITY(onm) * sizeof(*onm->map));
 }
 
-static void oldnewmap_increase_size(OldNewMap *onm)
+static void oldnewmap_resize(OldNewMap *onm, int capacity_exp)
 {
-  onm->capacity_exp++;
+#ifdef USE_OLDNEWMAP_STATS
+  onm->stats.resizes++;
+#endif
+  onm->capacity_exp = capacity_exp;
   onm->entries = MEM_reallocN(onm->entries, sizeof(*onm->entries) * ENTRIES_CAPACITY(onm));
   onm->map = MEM_reallocN(onm->map, sizeof(*onm->map) * MAP_CAPACITY(onm));
   oldnewmap_clear_map(onm);
@@ -336,6 +402,11 @@ static void oldnewmap_increase_size(OldNewMap *onm)
   }
 }
 
+static void oldnewmap_increase_size(OldNewMap *onm)
+{
+  oldnewmap_resize(onm, onm->capacity_exp + 1);
+}
+
 /* Public OldNewMap API */
 
 static OldNewMap *oldnewmap_new(void)
@@ -368,6 +439,22 @@ static void oldnewmap_insert(OldNewMap *onm, const void *oldaddr, void *newaddr,
   oldnewmap_insert_or_replace(onm, entry);
 }
 
+/**
+ * Make sure \a nentries_expected entries can be inserted without having to grow the map
+ * one step at a time (every step rehashes all entries).
+ * Use when the number of entries is known in advance, from the number of blocks in the file.
+ */
+static void oldnewmap_reserve(OldNewMap *onm, int nentries_expected)
+{
+  int capacity_exp = onm->capacity_exp;
+  while ((1ll << capacity_exp) < (int64_t)nentries_expected) {
+    capacity_exp++;
+  }
+  if (capacity_exp != onm->capacity_exp) {
+    oldnewmap_resize(onm, capacity_exp);
+  }
+}
+
 void blo_do_versions_oldnewmap_insert(OldNewMap *onm, const void *oldaddr, void *newaddr, int nr)
 {
   oldnewmap_insert(onm, oldaddr, newaddr, nr);
@@ -418,6 +505,24 @@ static void oldnewmap_clear(OldNewMap *onm)
   onm->nentries = 0;
 }
 
+#ifdef USE_OLDNEWMAP_STATS
+static void oldnewmap_print_stats(const OldNewMap *onm, const char *name)
+{
+  printf("OldNewMap '%s': %d entries max (load factor %.2f), %d resizes\n",
+         name,
+         onm->stats.nentries_max,
+         onm->stats.load_factor_max,
+         onm->stats.resizes);
+  printf("  lookups: %llu (%.3f probes on average), inserts: %llu (%.3f probes on average), "
+         "%d probes max\n",
+         (unsigned long long)onm->stats.lookups,
+         onm->stats.lookups ? (double)onm->stats.lookup_probes / (double)onm->stats.lookups : 0.0,
+         (unsigned long long)onm->stats.inserts,
+         onm->stats.inserts ? (double)onm->stats.insert_probes / (double)onm->stats.inserts : 0.0,
+         onm->stats.probes_max);
+}
+#endif
+
 static void oldnewmap_free(OldNewMap *onm)
 {
   MEM_freeN(onm->entries);
@@ -431,6 +536,8 @@ static void oldnewmap_free(OldNewMap *onm)
 #undef DEFAULT_SIZE_EXP
 #undef PERTURB_SHIFT
 #undef ITER_SLOTS
+#undef OLDNEWMAP_STATS_PROBES
+#undef OLDNEWMAP_STATS_PROBE_INCR
 
 /** \} */
 
@@ -811,6 +918,8 @@ static BHeadN *get_bhead(FileData *fd)
           new_bhead->next = new_bhead->prev = NULL;
           new_bhead->file_offset = fd->file_offset;
           new_bhead->has_data = false;
+          new_bhead->decoded_data = NULL;
+          new_bhead->decode_index = -1;
           new_bhead->is_memchunk_identical = false;
           new_bhead->bhead = bhead;
           off64_t seek_new = fd->seek(fd, bhead.len, SEEK_CUR);
@@ -833,6 +942,8 @@ static BHeadN *get_bhead(FileData *fd)
 #ifdef USE_BHEAD_READ_ON_DEMAND
           new_bhead->file_offset = 0; /* don't seek. */
           new_bhead->has_data = true;
+          new_bhead->decoded_data = NULL;
+          new_bhead->decode_index = -1;
 #endif
           new_bhead->is_memchunk_identical = false;
           new_bhead->bhead = bhead;
@@ -939,6 +1050,28 @@ static bool blo_bhead_read_data(FileData *fd, BHead *thisblock, void *buf)
   return success;
 }
 
+/**
+ * Access the data of a block that wasn't read yet without copying it,
+ * only possible for memory-mapped files.
+ *
+ * \return NULL when the data can't be accessed directly, the data must be read then.
+ */
+static const void *blo_bhead_data_peek(FileData *fd, BHead *thisblock)
+{
+  BHeadN *new_bhead = BHEADN_FROM_BHEAD(thisblock);
+  BLI_assert(new_bhead->has_data == false && new_bhead->file_offset != 0);
+  if ((fd->mmap_file == NULL) || BLI_mmap_any_io_error(fd->mmap_file) ||
+      (new_bhead->file_offset + new_bhead->bhead.len > (off64_t)fd->buffersize)) {
+    return NULL;
+  }
+  const char *data = POINTER_OFFSET(BLI_mmap_get_pointer(fd->mmap_file), new_bhead->file_offset);
+  /* Blocks are only 4 byte aligned in the file, struct reconstruction may need more. */
+  if (((uintptr_t)data & (sizeof(void *) - 1)) != 0) {
+    return NULL;
+  }
+  return data;
+}
+
 static BHead *blo_bhead_read_full(FileData *fd, BHead *thisblock)
 {
   BHeadN *new_bhead = BHEADN_FROM_BHEAD(thisblock);
@@ -946,6 +1079,8 @@ static BHead *blo_bhead_read_full(FileData *fd, BHead *thisblock)
   new_bhead_data->bhead = new_bhead->bhead;
   new_bhead_data->file_offset = new_bhead->file_offset;
   new_bhead_data->has_data = true;
+  new_bhead_data->decoded_data = NULL;
+  new_bhead_data->decode_index = -1;
   new_bhead_data->is_memchunk_identical = false;
   if (!blo_bhead_read_data(fd, thisblock, new_bhead_data + 1)) {
     MEM_freeN(new_bhead_data);
@@ -1124,6 +1259,51 @@ static off64_t fd_seek_data_from_file(FileData *filedata, off64_t offset, int wh
   return filedata->file_offset;
 }
 
+/* Memory-mapped file reading.
+ * By only reading the pages that are accessed, this avoids copying the data of uncompressed
+ * files into intermediate buffers, see #blo_bhead_data_peek. */
+
+static ssize_t fd_read_from_mmap(FileData *filedata,
+                                 void *buffer,
+                                 size_t size,
+                                 bool *UNUSED(r_is_memchunck_identical))
+{
+  /* Don't read more bytes than there are available in the buffer. */
+  size_t readsize = MIN2(size, (size_t)(filedata->buffersize - filedata->file_offset));
+
+  if (!BLI_mmap_read(filedata->mmap_file, buffer, filedata->file_offset, readsize)) {
+    return 0;
+  }
+
+  filedata->file_offset += readsize;
+
+  return (ssize_t)readsize;
+}
+
+static off64_t fd_seek_from_mmap(FileData *filedata, off64_t offset, int whence)
+{
+  off64_t new_pos;
+  if (whence == SEEK_CUR) {
+    new_pos = filedata->file_offset + offset;
+  }
+  else if (whence == SEEK_SET) {
+    new_pos = offset;
+  }
+  else if (whence == SEEK_END) {
+    new_pos = (off64_t)filedata->buffersize + offset;
+  }
+  else {
+    return -1;
+  }
+
+  if (new_pos < 0 || new_pos > (off64_t)filedata->buffersize) {
+    return -1;
+  }
+
+  filedata->file_offset = new_pos;
+  return filedata->file_offset;
+}
+
 /* GZip file reading. */
 
 static ssize_t fd_read_gzip_from_file(FileData *filedata,
@@ -1145,6 +1325,245 @@ static ssize_t fd_read_gzip_from_file(FileData *filedata,
   return readsize;
 }
 
+/* Seekable compressed file reading (independently compressed frames). */
+
+typedef struct BlendZFrameReader {
+  int frames_len;
+  /** Offsets of each frame in the compressed file (`frames_len + 1` items). */
+  off64_t *compressed_offsets;
+  /** Offsets of each frame in the uncompressed data (`frames_len + 1` items). */
+  off64_t *uncompressed_offsets;
+
+  /** Index of the frame decompressed into #frame_buf, -1 when there is none. */
+  int frame_index;
+  char *frame_buf;
+  char *compressed_buf;
+  size_t compressed_buf_size;
+} BlendZFrameReader;
+
+static uint32_t zframe_read_uint32(const uchar *data)
+{
+  return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) |
+         ((uint32_t)data[3] << 24);
+}
+
+static uint64_t zframe_read_uint64(const uchar *data)
+{
+  return (uint64_t)zframe_read_uint32(data) | ((uint64_t)zframe_read_uint32(data + 4) << 32);
+}
+
+/** Inflate a single gzip member, the decompressed size must be known in advance. */
+static bool zframe_inflate(const void *src, size_t src_len, void *dst, size_t dst_len)
+{
+  z_stream strm = {NULL};
+  strm.next_in = (Bytef *)src;
+  strm.avail_in = (uint)src_len;
+  strm.next_out = (Bytef *)dst;
+  strm.avail_out = (uint)dst_len;
+
+  if (inflateInit2(&strm, 16 + MAX_WBITS) != Z_OK) {
+    return false;
+  }
+  const int err = inflate(&strm, Z_FINISH);
+  const bool success = (err == Z_STREAM_END) && (strm.total_out == dst_len);
+  inflateEnd(&strm);
+  return success;
+}
+
+static bool zframe_read_at(int file, off64_t offset, void *buffer, size_t size)
+{
+  if (BLI_lseek(file, offset, SEEK_SET) != offset) {
+    return false;
+  }
+  return read(file, buffer, size) == (ssize_t)size;
+}
+
+static void zframe_reader_free(BlendZFrameReader *zframes)
+{
+  MEM_SAFE_FREE(zframes->compressed_offsets);
+  MEM_SAFE_FREE(zframes->uncompressed_offsets);
+  MEM_SAFE_FREE(zframes->frame_buf);
+  MEM_SAFE_FREE(zframes->compressed_buf);
+  MEM_freeN(zframes);
+}
+
+/**
+ * Read the frame index of a seekable compressed file.
+ *
+ * \return NULL when the file isn't a seekable compressed file (a regular gzip file for e.g.),
+ * in that case the caller should fall back to streaming the file.
+ */
+static BlendZFrameReader *zframe_reader_open(int file)
+{
+  const off64_t file_size = BLI_lseek(file, 0, SEEK_END);
+  if (file_size < BLEND_ZFRAME_FOOTER_SIZE) {
+    return NULL;
+  }
+
+  uchar footer[BLEND_ZFRAME_FOOTER_SIZE];
+  if (!zframe_read_at(file, file_size - BLEND_ZFRAME_FOOTER_SIZE, footer, sizeof(footer))) {
+    return NULL;
+  }
+  /* Gzip magic with the "extra" flag, followed by our own sub-field. */
+  if (!(footer[0] == 0x1f && footer[1] == 0x8b && footer[2] == 8 && footer[3] == 4 &&
+        footer[12] == 'B' && footer[13] == 'Z')) {
+    return NULL;
+  }
+
+  const uchar *extra = footer + BLEND_ZFRAME_FOOTER_EXTRA_OFFSET;
+  const off64_t index_offset = (off64_t)zframe_read_uint64(extra);
+  const uint32_t frames_len = zframe_read_uint32(extra + 8);
+  const uint32_t version = zframe_read_uint32(extra + 12);
+  if (version != BLEND_ZFRAME_VERSION || frames_len == 0 || frames_len > INT_MAX / 8 ||
+      index_offset <= 0 || index_offset >= file_size - BLEND_ZFRAME_FOOTER_SIZE) {
+    return NULL;
+  }
+
+  const size_t index_compressed_len = (size_t)(file_size - BLEND_ZFRAME_FOOTER_SIZE -
+                                               index_offset);
+  const size_t index_len = sizeof(uint32_t[2]) * frames_len;
+  uchar *index_compressed = MEM_mallocN(index_compressed_len, __func__);
+  uchar *index = MEM_mallocN(index_len, __func__);
+  bool success = zframe_read_at(file, index_offset, index_compressed, index_compressed_len) &&
+                 zframe_inflate(index_compressed, index_compressed_len, index, index_len);
+  MEM_freeN(index_compressed);
+
+  BlendZFrameReader *zframes = NULL;
+  if (success) {
+    zframes = MEM_callocN(sizeof(*zframes), __func__);
+    zframes->frames_len = (int)frames_len;
+    zframes->compressed_offsets = MEM_mallocN(sizeof(off64_t) * (frames_len + 1), __func__);
+    zframes->uncompressed_offsets = MEM_mallocN(sizeof(off64_t) * (frames_len + 1), __func__);
+    zframes->frame_index = -1;
+    zframes->compressed_offsets[0] = 0;
+    zframes->uncompressed_offsets[0] = 0;
+
+    for (uint32_t i = 0; i < frames_len; i++) {
+      const uint32_t compressed_len = zframe_read_uint32(&index[i * 8]);
+      const uint32_t uncompressed_len = zframe_read_uint32(&index[i * 8 + 4]);
+      if (compressed_len == 0 || uncompressed_len > BLEND_ZFRAME_SIZE) {
+        success = false;
+        break;
+      }
+      zframes->compressed_offsets[i + 1] = zframes->compressed_offsets[i] + compressed_len;
+      zframes->uncompressed_offsets[i + 1] = zframes->uncompressed_offsets[i] + uncompressed_len;
+      zframes->compressed_buf_size = MAX2(zframes->compressed_buf_size, compressed_len);
+    }
+    /* Frames must exactly fill the space before the index. */
+    if (success && zframes->compressed_offsets[frames_len] != index_offset) {
+      success = false;
+    }
+    if (!success) {
+      zframe_reader_free(zframes);
+      zframes = NULL;
+    }
+  }
+  MEM_freeN(index);
+
+  if (zframes != NULL) {
+    zframes->frame_buf = MEM_mallocN(BLEND_ZFRAME_SIZE, __func__);
+    zframes->compressed_buf = MEM_mallocN(zframes->compressed_buf_size, __func__);
+  }
+  return zframes;
+}
+
+static int zframe_find(const BlendZFrameReader *zframes, off64_t offset)
+{
+  /* Reading is mostly sequential, check the current frame first. */
+  int index = zframes->frame_index;
+  if (index != -1 && offset >= zframes->uncompressed_offsets[index] &&
+      offset < zframes->uncompressed_offsets[index + 1]) {
+    return index;
+  }
+
+  int low = 0, high = zframes->frames_len;
+  while (low < high) {
+    const int mid = (low + high) / 2;
+    if (zframes->uncompressed_offsets[mid + 1] <= offset) {
+      low = mid + 1;
+    }
+    else {
+      high = mid;
+    }
+  }
+  return (low < zframes->frames_len) ? low : -1;
+}
+
+static ssize_t fd_read_zframes_from_file(FileData *filedata,
+                                         void *buffer,
+                                         size_t size,
+                                         bool *UNUSED(r_is_memchunck_identical))
+{
+  BlendZFrameReader *zframes = filedata->zframes;
+  size_t totread = 0;
+
+  while (totread < size) {
+    const int index = zframe_find(zframes, filedata->file_offset);
+    if (index == -1) {
+      /* End of file. */
+      break;
+    }
+
+    if (index != zframes->frame_index) {
+      const off64_t compressed_len = zframes->compressed_offsets[index + 1] -
+                                     zframes->compressed_offsets[index];
+      const off64_t uncompressed_len = zframes->uncompressed_offsets[index + 1] -
+                                       zframes->uncompressed_offsets[index];
+      zframes->frame_index = -1;
+      if (!zframe_read_at(filedata->filedes,
+                          zframes->compressed_offsets[index],
+                          zframes->compressed_buf,
+                          (size_t)compressed_len) ||
+          !zframe_inflate(zframes->compressed_buf,
+                          (size_t)compressed_len,
+                          zframes->frame_buf,
+                          (size_t)uncompressed_len)) {
+        return EOF;
+      }
+      zframes->frame_index = index;
+    }
+
+    const size_t frame_offset = (size_t)(filedata->file_offset -
+                                         zframes->uncompressed_offsets[index]);
+    const size_t frame_len = (size_t)(zframes->uncompressed_offsets[index + 1] -
+                                      zframes->uncompressed_offsets[index]);
+    const size_t readsize = MIN2(size - totread, frame_len - frame_offset);
+
+    memcpy(POINTER_OFFSET(buffer, totread), zframes->frame_buf + frame_offset, readsize);
+    totread += readsize;
+    filedata->file_offset += (off64_t)readsize;
+  }
+
+  return (ssize_t)totread;
+}
+
+static off64_t fd_seek_zframes_from_file(FileData *filedata, off64_t offset, int whence)
+{
+  const BlendZFrameReader *zframes = filedata->zframes;
+  off64_t new_offset;
+
+  switch (whence) {
+    case SEEK_SET:
+      new_offset = offset;
+      break;
+    case SEEK_CUR:
+      new_offset = filedata->file_offset + offset;
+      break;
+    case SEEK_END:
+      new_offset = zframes->uncompressed_offsets[zframes->frames_len] + offset;
+      break;
+    default:
+      return -1;
+  }
+
+  /* Only the offset changes, frames are decompressed on demand when reading. */
+  if (new_offset < 0) {
+    return -1;
+  }
+  filedata->file_offset = new_offset;
+  return new_offset;
+}
+
 /* Memory reading. */
 
 static ssize_t fd_read_from_memory(FileData *filedata,
@@ -1222,6 +1641,8 @@ static ssize_t fd_read_from_memfile(FileData *filedata,
         readsize = chunk->size - chunkoffset;
       }
 
+      /* Compressed memfiles must be decompressed before reading, see #BLO_memfile_decompress. */
+      BLI_assert(chunk->buf != NULL);
       memcpy(POINTER_OFFSET(buffer, totread), chunk->buf + chunkoffset, readsize);
       totread += readsize;
       filedata->file_offset += readsize;
@@ -1290,6 +1711,8 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
   FileDataSeekFn *seek_fn = NULL; /* Optional. */
 
   gzFile gzfile = (gzFile)Z_NULL;
+  BlendZFrameReader *zframes = NULL;
+  BLI_mmap_file *mmap_file = NULL;
 
   char header[7];
 
@@ -1310,6 +1733,25 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
   if (memcmp(header, "BLENDER", sizeof(header)) == 0) {
     read_fn = fd_read_data_from_file;
     seek_fn = fd_seek_data_from_file;
+
+    mmap_file = BLI_mmap_open(file);
+    if (mmap_file != NULL) {
+      read_fn = fd_read_from_mmap;
+      seek_fn = fd_seek_from_mmap;
+    }
+    BLI_lseek(file, 0, SEEK_SET);
+  }
+
+  /* Seekable compressed file (a gzip file with a frame index). */
+  if ((read_fn == NULL) &&
+      /* Check header magic. */
+      (header[0] == 0x1f && header[1] == 0x8b)) {
+    zframes = zframe_reader_open(file);
+    if (zframes != NULL) {
+      read_fn = fd_read_zframes_from_file;
+      seek_fn = fd_seek_zframes_from_file;
+    }
+    BLI_lseek(file, 0, SEEK_SET);
   }
 
   /* Gzip file. */
@@ -1342,6 +1784,11 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
 
   fd->filedes = file;
   fd->gzfiledes = gzfile;
+  fd->zframes = zframes;
+  fd->mmap_file = mmap_file;
+  if (mmap_file != NULL) {
+    fd->buffersize = BLI_mmap_get_length(mmap_file);
+  }
 
   fd->read = read_fn;
   fd->seek = seek_fn;
@@ -1409,20 +1856,26 @@ static ssize_t fd_read_gzip_from_memory(FileData *filedata,
   filedata->strm.next_out = (Bytef *)buffer;
   filedata->strm.avail_out = (uint)size;
 
-  /* Inflate another chunk. */
-  err = inflate(&filedata->strm, Z_SYNC_FLUSH);
+  while (filedata->strm.avail_out != 0) {
+    /* Inflate another chunk. */
+    err = inflate(&filedata->strm, Z_SYNC_FLUSH);
 
-  if (err == Z_STREAM_END) {
-    return 0;
-  }
-  if (err != Z_OK) {
-    printf("fd_read_gzip_from_memory: zlib error\n");
-    return 0;
+    if (err == Z_STREAM_END) {
+      /* Seekable compressed files consist of multiple gzip members, continue with the next. */
+      if ((filedata->strm.avail_in == 0) || (inflateReset(&filedata->strm) != Z_OK)) {
+        break;
+      }
+    }
+    else if (err != Z_OK) {
+      printf("fd_read_gzip_from_memory: zlib error\n");
+      return 0;
+    }
   }
 
-  filedata->file_offset += size;
+  const size_t readsize = size - filedata->strm.avail_out;
+  filedata->file_offset += readsize;
 
-  return (ssize_t)size;
+  return (ssize_t)readsize;
 }
 
 static int fd_read_gzip_from_memory_init(FileData *fd)
@@ -1502,6 +1955,14 @@ void blo_filedata_free(FileData *fd)
       gzclose(fd->gzfiledes);
     }
 
+    if (fd->zframes != NULL) {
+      zframe_reader_free(fd->zframes);
+    }
+
+    if (fd->mmap_file != NULL) {
+      BLI_mmap_free(fd->mmap_file);
+    }
+
     if (fd->strm.next_in) {
       if (inflateEnd(&fd->strm) != Z_OK) {
         printf("close gzip stream error\n");
@@ -1513,6 +1974,17 @@ void blo_filedata_free(FileData *fd)
       fd->buffer = NULL;
     }
 
+#ifdef USE_BHEAD_READ_ON_DEMAND
+    /* Decoded data of blocks that were never read (unused data for e.g.). */
+    LISTBASE_FOREACH (BHeadN *, new_bhead, &fd->bhead_list) {
+      if (new_bhead->decoded_data != NULL) {
+        MEM_freeN(new_bhead->decoded_data);
+      }
+    }
+    MEM_SAFE_FREE(fd->decode_bheads);
+    MEM_SAFE_FREE(fd->decode_allocnames);
+#endif
+
     /* Free all BHeadN data blocks */
 #ifndef NDEBUG
     BLI_freelistN(&fd->bhead_list);
@@ -1536,6 +2008,18 @@ void blo_filedata_free(FileData *fd)
       DNA_reconstruct_info_free(fd->reconstruct_info);
     }
 
+#ifdef USE_OLDNEWMAP_STATS
+    if (fd->datamap) {
+      oldnewmap_print_stats(fd->datamap, "datamap");
+    }
+    if (fd->globmap) {
+      oldnewmap_print_stats(fd->globmap, "globmap");
+    }
+    if (fd->libmap) {
+      oldnewmap_print_stats(fd->libmap, "libmap");
+    }
+#endif
+
     if (fd->datamap) {
       oldnewmap_free(fd->datamap);
     }
@@ -2075,6 +2559,16 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
   if (bh->len) {
 #ifdef USE_BHEAD_READ_ON_DEMAND
     BHead *bh_orig = bh;
+
+    BHeadN *new_bhead = BHEADN_FROM_BHEAD(bh);
+    if (new_bhead->decoded_data == NULL && new_bhead->decode_index >= fd->decode_bheads_done) {
+      read_file_decode_data_window(fd, new_bhead->decode_index);
+    }
+    if (new_bhead->decoded_data != NULL) {
+      temp = new_bhead->decoded_data;
+      new_bhead->decoded_data = NULL;
+      return temp;
+    }
 #endif
 
     /* switch is based on file dna */
@@ -2093,16 +2587,26 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
 
     if (fd->compflags[bh->SDNAnr] != SDNA_CMP_REMOVED) {
       if (fd->compflags[bh->SDNAnr] == SDNA_CMP_NOT_EQUAL) {
+        const void *data = (bh + 1);
 #ifdef USE_BHEAD_READ_ON_DEMAND
         if (BHEADN_FROM_BHEAD(bh)->has_data == false) {
-          bh = blo_bhead_read_full(fd, bh);
-          if (UNLIKELY(bh == NULL)) {
-            fd->flags &= ~FD_FLAGS_FILE_OK;
-            return NULL;
+          /* Reconstruct directly from the memory-mapped file when possible,
+           * avoiding an intermediate copy of the data. */
+          data = blo_bhead_data_peek(fd, bh);
+          if (data == NULL) {
+            bh = blo_bhead_read_full(fd, bh);
+            if (UNLIKELY(bh == NULL)) {
+              fd->flags &= ~FD_FLAGS_FILE_OK;
+              return NULL;
+            }
+            data = (bh + 1);
           }
         }
 #endif
-        temp = DNA_struct_reconstruct(fd->reconstruct_info, bh->SDNAnr, bh->nr, (bh + 1));
+        temp = DNA_struct_reconstruct(fd->reconstruct_info, bh->SDNAnr, bh->nr, data);
+        if (fd->mmap_file != NULL && UNLIKELY(BLI_mmap_any_io_error(fd->mmap_file))) {
+          fd->flags &= ~FD_FLAGS_FILE_OK;
+        }
       }
       else {
         /* SDNA_CMP_EQUAL */
@@ -3232,6 +3736,14 @@ static BHead *read_data_into_datamap(FileData *fd, BHead *bhead, const char *all
 {
   bhead = blo_bhead_next(fd, bhead);
 
+  /* Size the map for all data of this data-block at once, instead of growing it while reading. */
+  int data_len = 0;
+  for (BHead *bhead_iter = bhead; bhead_iter && bhead_iter->code == DATA;
+       bhead_iter = blo_bhead_next(fd, bhead_iter)) {
+    data_len++;
+  }
+  oldnewmap_reserve(fd->datamap, data_len);
+
   while (bhead && bhead->code == DATA) {
     /* The code below is useful for debugging leaks in data read from the blend file.
      * Without this the messages only tell us what ID-type the memory came from,
@@ -3936,6 +4448,195 @@ static BHead *read_userdef(BlendFileData *bfd, FileData *fd, BHead *bhead)
 /** \name Read File (Internal)
  * \{ */
 
+/* -------------------------------------------------------------------- */
+/** \name Parallel Data Decoding
+ *
+ * Decoding the data of a block (reading it from the file, switching endianness and
+ * reconstructing structs from older DNA) doesn't depend on any other block.
+ * So the data of blocks can be decoded on multiple threads before it's needed,
+ * the (serial) reading code then takes the decoded data instead of reading it, see #read_struct.
+ *
+ * Only blocks of data-blocks that are read are queued, and they are decoded in windows of
+ * #DECODE_WINDOW_SIZE bytes once the first block of a window is read. This keeps the memory
+ * used by decoded data that isn't read yet bounded.
+ *
+ * This requires thread-safe random access to the file, only memory-mapped files support it.
+ * \{ */
+
+#ifdef USE_BHEAD_READ_ON_DEMAND
+
+#  define DECODE_WINDOW_SIZE (16 * 1024 * 1024)
+
+typedef struct DecodeDataParallelData {
+  FileData *fd;
+  int decode_index_start;
+} DecodeDataParallelData;
+
+/** Thread-safe version of #read_struct, for blocks that were not read yet. */
+static void *read_struct_decode_threadsafe(FileData *fd, BHeadN *new_bhead, const char *blockname)
+{
+  const BHead *bh = &new_bhead->bhead;
+  const off64_t file_offset = new_bhead->file_offset;
+
+  if (fd->compflags[bh->SDNAnr] == SDNA_CMP_REMOVED) {
+    return NULL;
+  }
+
+  const bool do_endian_switch = bh->SDNAnr && (fd->flags & FD_FLAGS_SWITCH_ENDIAN);
+  if (!do_endian_switch && fd->compflags[bh->SDNAnr] == SDNA_CMP_EQUAL) {
+    /* Read directly into the final memory. */
+    void *temp = MEM_mallocN(bh->len, blockname);
+    if (!BLI_mmap_read(fd->mmap_file, temp, (size_t)file_offset, (size_t)bh->len)) {
+      MEM_freeN(temp);
+      return NULL;
+    }
+    return temp;
+  }
+
+  BHeadN *new_bhead_data = MEM_mallocN(sizeof(BHeadN) + (size_t)bh->len, __func__);
+  new_bhead_data->bhead = *bh;
+  if (!BLI_mmap_read(fd->mmap_file, new_bhead_data + 1, (size_t)file_offset, (size_t)bh->len)) {
+    MEM_freeN(new_bhead_data);
+    return NULL;
+  }
+
+  if (do_endian_switch) {
+    switch_endian_structs(fd->filesdna, &new_bhead_data->bhead);
+  }
+
+  void *temp;
+  if (fd->compflags[bh->SDNAnr] == SDNA_CMP_NOT_EQUAL) {
+    temp = DNA_struct_reconstruct(
+        fd->reconstruct_info, bh->SDNAnr, bh->nr, (&new_bhead_data->bhead + 1));
+  }
+  else {
+    temp = MEM_mallocN(bh->len, blockname);
+    memcpy(temp, (&new_bhead_data->bhead + 1), bh->len);
+  }
+  MEM_freeN(new_bhead_data);
+  return temp;
+}
+
+static void read_file_decode_data_cb(void *__restrict userdata,
+                                     const int iter,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  DecodeDataParallelData *data = userdata;
+  FileData *fd = data->fd;
+  const int decode_index = data->decode_index_start + iter;
+  BHeadN *new_bhead = fd->decode_bheads[decode_index];
+  new_bhead->decoded_data = read_struct_decode_threadsafe(
+      fd, new_bhead, fd->decode_allocnames[decode_index]);
+}
+
+/**
+ * Decode the data of the queued blocks starting at `decode_index` in parallel, up to
+ * #DECODE_WINDOW_SIZE bytes. Queued blocks before `decode_index` which were not decoded yet
+ * are skipped, they are read as usual if they turn out to be needed.
+ */
+static void read_file_decode_data_window(FileData *fd, const int decode_index)
+{
+  BLI_assert(decode_index >= fd->decode_bheads_done);
+  const double time_start = PIL_check_seconds_timer();
+
+  size_t window_size = 0;
+  int decode_index_end = decode_index;
+  while (decode_index_end < fd->decode_bheads_len && window_size < DECODE_WINDOW_SIZE) {
+    window_size += (size_t)fd->decode_bheads[decode_index_end]->bhead.len;
+    decode_index_end++;
+  }
+  fd->decode_bheads_done = decode_index_end;
+
+  DecodeDataParallelData data = {
+      .fd = fd,
+      .decode_index_start = decode_index,
+  };
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 16;
+  BLI_task_parallel_range(
+      0, decode_index_end - decode_index, &data, read_file_decode_data_cb, &settings);
+
+  if (BLI_mmap_any_io_error(fd->mmap_file)) {
+    fd->flags &= ~FD_FLAGS_FILE_OK;
+  }
+
+  fd->decode_bheads_decoded_len += decode_index_end - decode_index;
+  fd->decode_time += PIL_check_seconds_timer() - time_start;
+}
+
+/** Whether the data following `bhead` is read by #blo_read_file_internal. */
+static bool read_file_decode_data_owner_is_read(const FileData *fd, const BHead *bhead)
+{
+  switch (bhead->code) {
+    case DATA:
+    case DNA1:
+    case TEST:
+    case REND:
+    case GLOB:
+    case ENDB:
+    case ID_LINK_PLACEHOLDER:
+      return false;
+    case USER:
+      return (fd->skip_flags & BLO_READ_SKIP_USERDEF) == 0;
+  }
+  return true;
+}
+
+/**
+ * Index all blocks of the file and queue the #DATA blocks of data-blocks that are read for
+ * parallel decoding, see #read_file_decode_data_window.
+ */
+static void read_file_decode_data_init(FileData *fd)
+{
+  if ((fd->mmap_file == NULL) || (fd->memfile != NULL) ||
+      (fd->skip_flags & BLO_READ_SKIP_DATA) || (BLI_system_thread_count() < 2)) {
+    return;
+  }
+
+  /* Reading all block headers is cheap since #DATA blocks are read on demand. */
+  int bheads_len = 0;
+  for (BHead *bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next(fd, bhead)) {
+    if (bhead->code == ENDB) {
+      break;
+    }
+    bheads_len += (bhead->code == DATA);
+  }
+  if (bheads_len == 0) {
+    return;
+  }
+
+  fd->decode_bheads = MEM_mallocN(sizeof(*fd->decode_bheads) * (size_t)bheads_len, __func__);
+  fd->decode_allocnames = MEM_mallocN(sizeof(*fd->decode_allocnames) * (size_t)bheads_len,
+                                      __func__);
+  fd->decode_bheads_len = 0;
+  fd->decode_bheads_done = 0;
+  const char *allocname = dataname(0);
+  bool owner_is_read = false;
+
+  LISTBASE_FOREACH (BHeadN *, new_bhead, &fd->bhead_list) {
+    const BHead *bhead = &new_bhead->bhead;
+    if (bhead->code == ENDB) {
+      break;
+    }
+    if (bhead->code != DATA) {
+      /* Match the allocation names used by #read_libblock. */
+      allocname = dataname(bhead->code);
+      owner_is_read = read_file_decode_data_owner_is_read(fd, bhead);
+    }
+    else if (owner_is_read && !new_bhead->has_data && bhead->len != 0) {
+      new_bhead->decode_index = fd->decode_bheads_len;
+      fd->decode_bheads[fd->decode_bheads_len] = new_bhead;
+      fd->decode_allocnames[fd->decode_bheads_len] = allocname;
+      fd->decode_bheads_len++;
+    }
+  }
+}
+
+#endif /* USE_BHEAD_READ_ON_DEMAND */
+
+/** \} */
+
 BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
 {
   BHead *bhead = blo_bhead_first(fd);
@@ -3946,6 +4647,8 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
     DEBUG_PRINTF("\nUNDO: read step\n");
   }
 
+  BLI_trace_begin("blenloader", fd->memfile ? "Read undo step" : BLI_path_basename(filepath));
+
   bfd = MEM_callocN(sizeof(BlendFileData), "blendfiledata");
 
   bfd->main = BKE_main_new();
@@ -3959,6 +4662,21 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
     BLI_strncpy(bfd->main->name, filepath, sizeof(bfd->main->name));
   }
 
+#ifdef USE_BHEAD_READ_ON_DEMAND
+  read_file_decode_data_init(fd);
+#endif
+
+  /* Reading block headers is cheap when the data can be read on demand,
+   * use the number of data-blocks to size the map in advance. */
+  if ((fd->seek != NULL) && (fd->skip_flags & BLO_READ_SKIP_DATA) == 0) {
+    int id_bheads_len = 0;
+    for (BHead *bhead_iter = bhead; bhead_iter && bhead_iter->code != ENDB;
+         bhead_iter = blo_bhead_next(fd, bhead_iter)) {
+      id_bheads_len += (bhead_iter->code != DATA);
+    }
+    oldnewmap_reserve(fd->libmap, id_bheads_len);
+  }
+
   if (G.background) {
     /* We only read & store .blend thumbnail in background mode
      * (because we cannot re-generate it, no OpenGL available).
@@ -3981,6 +4699,7 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
     }
   }
 
+  BLI_trace_begin("blenloader", "Read data-blocks");
   while (bhead) {
     switch (bhead->code) {
       case DATA:
@@ -4032,8 +4751,21 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
     }
   }
 
+  BLI_trace_end();
+
+#ifdef USE_BHEAD_READ_ON_DEMAND
+  if ((G.debug & G_DEBUG_IO) && fd->decode_bheads != NULL) {
+    printf("Read %s: decoded %d of %d data blocks in parallel in %.3f seconds\n",
+           fd->relabase,
+           fd->decode_bheads_decoded_len,
+           fd->decode_bheads_len,
+           fd->decode_time);
+  }
+#endif
+
   /* do before read_libraries, but skip undo case */
   if (fd->memfile == NULL) {
+    BLI_trace_begin("blenloader", "Versioning");
     if ((fd->skip_flags & BLO_READ_SKIP_DATA) == 0) {
       do_versions(fd, NULL, bfd->main);
     }
@@ -4041,14 +4773,19 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
     if ((fd->skip_flags & BLO_READ_SKIP_USERDEF) == 0) {
       do_versions_userdef(fd, bfd);
     }
+    BLI_trace_end();
   }
 
   if ((fd->skip_flags & BLO_READ_SKIP_DATA) == 0) {
+    BLI_trace_begin("blenloader", "Read libraries");
     read_libraries(fd, &mainlist);
+    BLI_trace_end();
 
     blo_join_main(&mainlist);
 
+    BLI_trace_begin("blenloader", "Link data-blocks");
     lib_link_all(fd, bfd->main);
+    BLI_trace_end();
 
     /* Skip in undo case. */
     if (fd->memfile == NULL) {
@@ -4062,12 +4799,14 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
       BKE_main_id_refcount_recompute(bfd->main, false);
 
       /* Yep, second splitting... but this is a very cheap operation, so no big deal. */
+      BLI_trace_begin("blenloader", "Versioning after linking");
       blo_split_main(&mainlist, bfd->main);
       LISTBASE_FOREACH (Main *, mainvar, &mainlist) {
         BLI_assert(mainvar->versionfile != 0);
         do_versions_after_linking(mainvar, fd->reports);
       }
       blo_join_main(&mainlist);
+      BLI_trace_end();
 
       /* And we have to compute those user-reference-counts again, as `do_versions_after_linking()`
        * does not always properly handle user counts, and/or that function does not take into
@@ -4099,6 +4838,8 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
 
   fd->mainlist = NULL; /* Safety, this is local variable, shall not be used afterward. */
 
+  BLI_trace_end();
+
   return bfd;
 }
 
@@ -33,6 +33,7 @@
 #include "DNA_windowmanager_types.h" /* for ReportType */
 #include "zlib.h"
 
+struct BLI_mmap_file;
 struct BLOCacheStorage;
 struct GSet;
 struct IDNameLib_Map;
@@ -72,6 +73,30 @@ typedef ssize_t(FileDataReadFn)(struct FileData *filedata,
                                 bool *r_is_memchunk_identical);
 typedef off64_t(FileDataSeekFn)(struct FileData *filedata, off64_t offset, int whence);
 
+/**
+ * Seekable compressed files (written when #G_FILE_COMPRESS is set).
+ *
+ * The uncompressed file is split into frames of #BLEND_ZFRAME_SIZE bytes, each one stored as an
+ * independent gzip member. The result is still a valid (multi-member) gzip stream, so `gzread`
+ * and older versions of Blender can read these files as regular gzip compressed files.
+ *
+ * The frames are followed by:
+ * - An index member: its content is an array of little endian `uint32_t` pairs
+ *   (compressed size, uncompressed size), one pair per frame.
+ * - A footer member of #BLEND_ZFRAME_FOOTER_SIZE bytes without any content,
+ *   its gzip "extra" field (sub-field ID `BZ`) stores the offset of the index member (`uint64_t`),
+ *   the number of frames (`uint32_t`) and the format version (`uint32_t`).
+ *
+ * Since the trailing members only follow the `ENDB` block, readers that stream the file
+ * never reach them.
+ */
+#define BLEND_ZFRAME_SIZE (1 << 18)
+#define BLEND_ZFRAME_FOOTER_SIZE 42
+#define BLEND_ZFRAME_FOOTER_EXTRA_OFFSET 16
+#define BLEND_ZFRAME_VERSION 1
+
+struct BlendZFrameReader;
+
 typedef struct FileData {
   /** Linked list of BHeadN's. */
   ListBase bhead_list;
@@ -98,6 +123,19 @@ typedef struct FileData {
   gzFile gzfiledes;
   /** Gzip stream for memory decompression. */
   z_stream strm;
+  /** Seekable compressed file reading, see #BLEND_ZFRAME_SIZE. */
+  struct BlendZFrameReader *zframes;
+  /** Memory-mapped file reading (uncompressed files only), #buffersize is the file length. */
+  struct BLI_mmap_file *mmap_file;
+  /** #DATA blocks to decode in parallel (memory-mapped files only), in file order. */
+  struct BHeadN **decode_bheads;
+  const char **decode_allocnames;
+  int decode_bheads_len;
+  /** Blocks before this index were decoded or skipped already. */
+  int decode_bheads_done;
+  /** Statistics printed with `--debug-io`. */
+  int decode_bheads_decoded_len;
+  double decode_time;
 
   /** Now only in use for library appending. */
   char relabase[FILE_MAX];
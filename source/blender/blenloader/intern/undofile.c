@@ -42,56 +42,87 @@
 
 #include "BLI_blenlib.h"
 #include "BLI_ghash.h"
+#include "BLI_hash_mm2a.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
+
+#include "PIL_time.h"
 
 #include "BLO_readfile.h"
 #include "BLO_undofile.h"
 
+#include "BKE_global.h"
 #include "BKE_lib_id.h"
 #include "BKE_main.h"
 
+#include "zlib.h"
+
 /* keep last */
 #include "BLI_strict_flags.h"
 
 /* **************** support for memory-write, for undo buffers *************** */
 
+static void memfile_compress_finish(MemFile *memfile, const bool cancel, const bool apply);
+
+/* A buffer is shared by any number of chunks, only one of them owns it. */
+BLI_INLINE bool memfile_chunk_owns_buf(const MemFileChunk *chunk)
+{
+  return !(chunk->is_identical || chunk->is_content_shared);
+}
+
 /* not memfile itself */
 void BLO_memfile_free(MemFile *memfile)
 {
   MemFileChunk *chunk;
 
+  /* Background compression may still be reading the buffers. */
+  memfile_compress_finish(memfile, true, false);
+
   while ((chunk = BLI_pophead(&memfile->chunks))) {
-    if (chunk->is_identical == false) {
+    if (memfile_chunk_owns_buf(chunk) && chunk->buf != NULL) {
       MEM_freeN((void *)chunk->buf);
     }
+    MEM_SAFE_FREE(chunk->buf_compressed);
     MEM_freeN(chunk);
   }
+  memfile->is_compressed = false;
   memfile->size = 0;
+  memset(&memfile->stats, 0, sizeof(memfile->stats));
 }
 
 /* to keep list of memfiles consistent, 'first' is always first in list */
 /* result is that 'first' is being freed */
 void BLO_memfile_merge(MemFile *first, MemFile *second)
 {
+  /* Compressed buffers are only owned chunks which are not used by the next step, so they are
+   * freed with the first memfile, but the compression task must not use them anymore. */
+  memfile_compress_finish(first, true, false);
+
   /* We use this mapping to store the memory buffers from second memfile chunks which are not owned
    * by it (i.e. shared with some previous memory steps). */
   GHash *buffer_to_second_memchunk = BLI_ghash_new(
       BLI_ghashutil_ptrhash, BLI_ghashutil_ptrcmp, __func__);
 
-  /* First, detect all memchunks in second memfile that are not owned by it. */
+  /* First, detect all memchunks in second memfile that are not owned by it.
+   * Several chunks may share the same buffer, any of them can take the ownership. */
   for (MemFileChunk *sc = second->chunks.first; sc != NULL; sc = sc->next) {
-    if (sc->is_identical) {
-      BLI_ghash_insert(buffer_to_second_memchunk, (void *)sc->buf, sc);
+    if (!memfile_chunk_owns_buf(sc)) {
+      void **val_p;
+      if (!BLI_ghash_ensure_p(buffer_to_second_memchunk, (void *)sc->buf, &val_p)) {
+        *val_p = sc;
+      }
     }
   }
 
   /* Now, check all chunks from first memfile (the one we are removing), and if a memchunk owned by
    * it is also used by the second memfile, transfer the ownership. */
   for (MemFileChunk *fc = first->chunks.first; fc != NULL; fc = fc->next) {
-    if (!fc->is_identical) {
+    if (memfile_chunk_owns_buf(fc) && fc->buf != NULL) {
       MemFileChunk *sc = BLI_ghash_lookup(buffer_to_second_memchunk, fc->buf);
       if (sc != NULL) {
-        BLI_assert(sc->is_identical);
+        BLI_assert(!memfile_chunk_owns_buf(sc));
         sc->is_identical = false;
+        sc->is_content_shared = false;
         fc->is_identical = true;
       }
       /* Note that if the second memfile does not use that chunk, we assume that the first one
@@ -121,6 +152,23 @@ void BLO_memfile_write_init(MemFileWriteData *mem_data,
   mem_data->reference_memfile = reference_memfile;
   mem_data->reference_current_chunk = reference_memfile ? reference_memfile->chunks.first : NULL;
 
+  /* Chunks with the same content as any chunk of the previous step (or as any chunk written
+   * before in this step) share its buffer, even if the data moved, got reordered or duplicated.
+   * Only chunks of the previous step can be used: when steps get merged, buffers are only kept
+   * alive by the next step, see #BLO_memfile_merge. */
+  mem_data->content_hash_mapping = BLI_ghash_new(
+      BLI_ghashutil_inthash_p_simple, BLI_ghashutil_intcmp, __func__);
+  if (reference_memfile != NULL) {
+    LISTBASE_FOREACH (MemFileChunk *, mem_chunk, &reference_memfile->chunks) {
+      void **entry;
+      if (!BLI_ghash_ensure_p(mem_data->content_hash_mapping,
+                              POINTER_FROM_UINT(mem_chunk->content_hash),
+                              &entry)) {
+        *entry = mem_chunk;
+      }
+    }
+  }
+
   /* If we have a reference memfile, we generate a mapping between the session_uuid's of the
    * IDs stored in that previous undo step, and its first matching memchunk. This will allow
    * us to easily find the existing undo memory storage of IDs even when some re-ordering in
@@ -152,6 +200,9 @@ void BLO_memfile_write_finalize(MemFileWriteData *mem_data)
   if (mem_data->id_session_uuid_mapping != NULL) {
     BLI_ghash_free(mem_data->id_session_uuid_mapping, NULL, NULL);
   }
+  if (mem_data->content_hash_mapping != NULL) {
+    BLI_ghash_free(mem_data->content_hash_mapping, NULL, NULL);
+  }
 }
 
 void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t size)
@@ -163,6 +214,9 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
   curchunk->size = size;
   curchunk->buf = NULL;
   curchunk->is_identical = false;
+  curchunk->is_content_shared = false;
+  curchunk->buf_compressed = NULL;
+  curchunk->buf_compressed_size = 0;
   /* This is unsafe in the sense that an app handler or other code that does not
    * perform an undo push may make changes after the last undo push that
    * will then not be undo. Though it's not entirely clear that is wrong behavior. */
@@ -177,26 +231,350 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
       if (memcmp(compchunk->buf, buf, size) == 0) {
         curchunk->buf = compchunk->buf;
         curchunk->is_identical = true;
+        curchunk->content_hash = compchunk->content_hash;
         compchunk->is_identical_future = true;
+        memfile->stats.identical_chunks++;
+        memfile->stats.identical_size += size;
       }
     }
     *compchunk_step = compchunk->next;
   }
 
+  /* Not equal, look for a chunk with the same content elsewhere. */
+  if (curchunk->buf == NULL) {
+    curchunk->content_hash = BLI_hash_mm2((const uchar *)buf, size, 0);
+
+    void **entry;
+    if (BLI_ghash_ensure_p(mem_data->content_hash_mapping,
+                           POINTER_FROM_UINT(curchunk->content_hash),
+                           &entry)) {
+      const MemFileChunk *content_chunk = *entry;
+      /* Hash collisions are possible, only share when the content is actually the same. */
+      if (content_chunk->size == size && memcmp(content_chunk->buf, buf, size) == 0) {
+        curchunk->buf = content_chunk->buf;
+        curchunk->is_content_shared = true;
+        memfile->stats.content_shared_chunks++;
+        memfile->stats.content_shared_size += size;
+      }
+    }
+    else {
+      *entry = curchunk;
+    }
+  }
+
   /* not equal... */
   if (curchunk->buf == NULL) {
     char *buf_new = MEM_mallocN(size, "Chunk buffer");
     memcpy(buf_new, buf, size);
     curchunk->buf = buf_new;
     memfile->size += size;
+    memfile->stats.owned_chunks++;
+    memfile->stats.owned_size += size;
+  }
+}
+
+void BLO_memfile_stats_print(const MemFile *memfile)
+{
+  const MemFileStats *stats = &memfile->stats;
+  printf("MemFile: %zu bytes owned (%d chunks), shared with previous step: %zu bytes identical "
+         "(%d chunks), %zu bytes with identical content (%d chunks)\n",
+         stats->owned_size,
+         stats->owned_chunks,
+         stats->identical_size,
+         stats->identical_chunks,
+         stats->content_shared_size,
+         stats->content_shared_chunks);
+  if (stats->compressed_size_orig != 0) {
+    printf("MemFile: compressed %zu bytes to %zu bytes\n",
+           stats->compressed_size_orig,
+           stats->compressed_size);
+  }
+}
+
+/* -------------------------------------------------------------------- */
+/** \name Compression of Cold Undo Steps
+ *
+ * Undo steps that are unlikely to be restored soon can have their buffers compressed in the
+ * background to reduce the memory used by the undo stack.
+ *
+ * Only buffers owned by a step and not used by the next step get compressed: buffers shared with
+ * the next step are needed uncompressed to compare and share data when writing new steps
+ * (see #BLO_memfile_chunk_add). Compression tasks only read the buffers, the compressed results
+ * are applied from the main thread once the task of a memfile is done, see
+ * #BLO_memfile_compress_update. The main thread only waits for the task of a memfile that is
+ * read or freed, which cancels the chunks that were not compressed yet.
+ * A compressed step is decompressed before it is read again, see #BLO_memfile_decompress.
+ * \{ */
+
+/* Chunks smaller than this are not worth compressing. */
+#define MEMFILE_COMPRESS_MIN_SIZE 256
+
+typedef struct MemFileCompressTask {
+  MemFileChunk **chunks;
+  int chunks_len;
+  /* Results, a NULL buffer when the chunk could not be compressed. */
+  char **bufs_compressed;
+  size_t *bufs_compressed_size;
+  double time_start;
+
+  /* Protects the flags below, which are shared with the task. */
+  ThreadMutex mutex;
+  ThreadCondition done_cond;
+  bool is_cancelled;
+  bool is_done;
+} MemFileCompressTask;
+
+static struct {
+  /* Runs the compression tasks one after the other, created on demand. */
+  TaskPool *task_pool;
+  /* Number of tasks which were not finished on the main thread yet. */
+  int tasks_len;
+} g_memfile_compress = {NULL};
+
+static bool memfile_compress_task_is_cancelled(MemFileCompressTask *task)
+{
+  BLI_mutex_lock(&task->mutex);
+  const bool is_cancelled = task->is_cancelled;
+  BLI_mutex_unlock(&task->mutex);
+  return is_cancelled;
+}
+
+static void memfile_compress_task_run(TaskPool *__restrict UNUSED(pool), void *taskdata)
+{
+  MemFileCompressTask *task = taskdata;
+
+  for (int i = 0; i < task->chunks_len; i++) {
+    if (memfile_compress_task_is_cancelled(task)) {
+      break;
+    }
+
+    const MemFileChunk *chunk = task->chunks[i];
+    uLongf size_compressed = compressBound((uLong)chunk->size);
+    char *buf_compressed = MEM_mallocN(size_compressed, "Chunk compressed buffer");
+
+    /* Favor speed, the data is often very compressible anyway. */
+    if (compress2((Bytef *)buf_compressed,
+                  &size_compressed,
+                  (const Bytef *)chunk->buf,
+                  (uLong)chunk->size,
+                  Z_BEST_SPEED) != Z_OK ||
+        size_compressed >= chunk->size) {
+      MEM_freeN(buf_compressed);
+      continue;
+    }
+    task->bufs_compressed[i] = MEM_reallocN(buf_compressed, size_compressed);
+    task->bufs_compressed_size[i] = size_compressed;
+  }
+
+  BLI_mutex_lock(&task->mutex);
+  task->is_done = true;
+  BLI_condition_notify_all(&task->done_cond);
+  BLI_mutex_unlock(&task->mutex);
+}
+
+/**
+ * Wait for the compression task of \a memfile and free it.
+ *
+ * \param cancel: Don't compress the chunks the task didn't reach yet.
+ * \param apply: Replace the buffers by their compressed version, otherwise the results are freed.
+ */
+static void memfile_compress_finish(MemFile *memfile, const bool cancel, const bool apply)
+{
+  MemFileCompressTask *task = memfile->compress_task;
+  if (task == NULL) {
+    return;
+  }
+  memfile->compress_task = NULL;
+
+  BLI_mutex_lock(&task->mutex);
+  task->is_cancelled |= cancel;
+  while (!task->is_done) {
+    BLI_condition_wait(&task->done_cond, &task->mutex);
+  }
+  BLI_mutex_unlock(&task->mutex);
+
+  size_t size_orig = 0, size_compressed = 0;
+  for (int i = 0; i < task->chunks_len; i++) {
+    MemFileChunk *chunk = task->chunks[i];
+    if (task->bufs_compressed[i] == NULL) {
+      continue;
+    }
+    if (!apply) {
+      MEM_freeN(task->bufs_compressed[i]);
+      continue;
+    }
+    MEM_freeN((void *)chunk->buf);
+    chunk->buf = NULL;
+    chunk->buf_compressed = task->bufs_compressed[i];
+    chunk->buf_compressed_size = task->bufs_compressed_size[i];
+
+    memfile->size -= chunk->size - chunk->buf_compressed_size;
+    memfile->stats.compressed_size_orig += chunk->size;
+    memfile->stats.compressed_size += chunk->buf_compressed_size;
+    size_orig += chunk->size;
+    size_compressed += chunk->buf_compressed_size;
+  }
+
+  if (apply && (G.debug & G_DEBUG_WM)) {
+    printf("%s: compressed %zu bytes to %zu bytes in %.3f seconds\n",
+           __func__,
+           size_orig,
+           size_compressed,
+           PIL_check_seconds_timer() - task->time_start);
+  }
+
+  BLI_condition_end(&task->done_cond);
+  BLI_mutex_end(&task->mutex);
+  MEM_freeN(task->chunks);
+  MEM_freeN(task->bufs_compressed);
+  MEM_freeN(task->bufs_compressed_size);
+  MEM_freeN(task);
+
+  /* All tasks are done, stop the background thread. */
+  BLI_assert(g_memfile_compress.tasks_len > 0);
+  if (--g_memfile_compress.tasks_len == 0) {
+    BLI_task_pool_free(g_memfile_compress.task_pool);
+    g_memfile_compress.task_pool = NULL;
+  }
+}
+
+/**
+ * Start compressing the buffers owned by \a memfile in the background.
+ *
+ * \param memfile_next: The memfile of the next undo step (can be NULL),
+ * buffers it uses are kept uncompressed.
+ */
+void BLO_memfile_compress_begin(MemFile *memfile, const MemFile *memfile_next)
+{
+  if (memfile->is_compressed) {
+    return;
+  }
+  memfile->is_compressed = true;
+
+  GSet *bufs_next = BLI_gset_ptr_new(__func__);
+  if (memfile_next != NULL) {
+    LISTBASE_FOREACH (const MemFileChunk *, chunk, &memfile_next->chunks) {
+      BLI_gset_add(bufs_next, (void *)chunk->buf);
+    }
+  }
+
+  int chunks_len = 0;
+  LISTBASE_FOREACH (MemFileChunk *, chunk, &memfile->chunks) {
+    if (memfile_chunk_owns_buf(chunk) && chunk->buf != NULL &&
+        chunk->size >= MEMFILE_COMPRESS_MIN_SIZE && !BLI_gset_haskey(bufs_next, chunk->buf)) {
+      chunks_len++;
+    }
+  }
+
+  if (chunks_len != 0) {
+    MemFileCompressTask *task = MEM_callocN(sizeof(*task), __func__);
+    task->chunks = MEM_mallocN(sizeof(*task->chunks) * (size_t)chunks_len, __func__);
+    task->bufs_compressed = MEM_callocN(sizeof(*task->bufs_compressed) * (size_t)chunks_len,
+                                        __func__);
+    task->bufs_compressed_size = MEM_callocN(
+        sizeof(*task->bufs_compressed_size) * (size_t)chunks_len, __func__);
+    task->time_start = PIL_check_seconds_timer();
+    BLI_mutex_init(&task->mutex);
+    BLI_condition_init(&task->done_cond);
+    LISTBASE_FOREACH (MemFileChunk *, chunk, &memfile->chunks) {
+      if (memfile_chunk_owns_buf(chunk) && chunk->buf != NULL &&
+          chunk->size >= MEMFILE_COMPRESS_MIN_SIZE && !BLI_gset_haskey(bufs_next, chunk->buf)) {
+        task->chunks[task->chunks_len++] = chunk;
+      }
+    }
+
+    if (g_memfile_compress.task_pool == NULL) {
+      g_memfile_compress.task_pool = BLI_task_pool_create_background(NULL, TASK_PRIORITY_LOW);
+    }
+    g_memfile_compress.tasks_len++;
+    memfile->compress_task = task;
+    BLI_task_pool_push(g_memfile_compress.task_pool, memfile_compress_task_run, task, false, NULL);
   }
+
+  BLI_gset_free(bufs_next, NULL);
 }
 
+/**
+ * Apply the results of the background compression of \a memfile when it's done, without waiting.
+ * Updates #MemFile.size, so the undo memory limit accounts for the saved memory.
+ */
+void BLO_memfile_compress_update(MemFile *memfile)
+{
+  MemFileCompressTask *task = memfile->compress_task;
+  if (task == NULL) {
+    return;
+  }
+
+  BLI_mutex_lock(&task->mutex);
+  const bool is_done = task->is_done;
+  BLI_mutex_unlock(&task->mutex);
+
+  if (is_done) {
+    memfile_compress_finish(memfile, false, true);
+  }
+}
+
+/**
+ * Restore the compressed buffers of \a memfile, needed before reading it.
+ *
+ * \return false when a buffer could not be decompressed, the memfile can't be read then.
+ */
+bool BLO_memfile_decompress(MemFile *memfile)
+{
+  /* Keep what was compressed already, it's decompressed below. */
+  memfile_compress_finish(memfile, true, true);
+
+  if (!memfile->is_compressed) {
+    return true;
+  }
+
+  const double time_start = PIL_check_seconds_timer();
+  bool is_valid = true;
+  LISTBASE_FOREACH (MemFileChunk *, chunk, &memfile->chunks) {
+    if (chunk->buf_compressed == NULL) {
+      continue;
+    }
+    char *buf = MEM_mallocN(chunk->size, "Chunk buffer");
+    uLongf size = (uLongf)chunk->size;
+    const int ret = uncompress((Bytef *)buf,
+                               &size,
+                               (const Bytef *)chunk->buf_compressed,
+                               (uLong)chunk->buf_compressed_size);
+    if (ret != Z_OK || size != chunk->size) {
+      /* Keep the compressed buffer, the memfile stays unreadable. */
+      printf("%s: error decompressing undo chunk (%d)\n", __func__, ret);
+      MEM_freeN(buf);
+      is_valid = false;
+      continue;
+    }
+
+    memfile->size += chunk->size - chunk->buf_compressed_size;
+    memfile->stats.compressed_size_orig -= chunk->size;
+    memfile->stats.compressed_size -= chunk->buf_compressed_size;
+    MEM_freeN(chunk->buf_compressed);
+    chunk->buf = buf;
+    chunk->buf_compressed = NULL;
+    chunk->buf_compressed_size = 0;
+  }
+  memfile->is_compressed = !is_valid;
+
+  if (G.debug & G_DEBUG_WM) {
+    printf("%s: decompressed in %.3f seconds\n", __func__, PIL_check_seconds_timer() - time_start);
+  }
+
+  return is_valid;
+}
+
+/** \} */
+
 struct Main *BLO_memfile_main_get(struct MemFile *memfile,
                                   struct Main *bmain,
                                   struct Scene **r_scene)
 {
   struct Main *bmain_undo = NULL;
+  if (!BLO_memfile_decompress(memfile)) {
+    return NULL;
+  }
   BlendFileData *bfd = BLO_read_from_memfile(bmain,
                                              BKE_main_blendfile_path(bmain),
                                              memfile,
@@ -241,6 +619,11 @@ bool BLO_memfile_write_file(struct MemFile *memfile, const char *filename)
 #    warning "Symbolic links will be followed on undo save, possibly causing CVE-2008-1103"
 #  endif
 #endif
+  if (!BLO_memfile_decompress(memfile)) {
+    fprintf(stderr, "Unable to save '%s': undo step could not be decompressed\n", filename);
+    return false;
+  }
+
   file = BLI_open(filename, oflags, 0666);
 
   if (file == -1) {
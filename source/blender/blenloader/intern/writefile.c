@@ -70,6 +70,12 @@
  * - write #GLOB (#FileGlobal struct) (some global vars).
  * - write #DNA1 (#SDNA struct)
  * - write #USER (#UserDef struct) if filename is ``~/.config/blender/X.XX/config/startup.blend``.
+ *
+ * COMPRESSION
+ * ===========
+ *
+ * Compressed files are split into independently compressed gzip members followed by a frame
+ * index, so reading can seek into them, see #BLEND_ZFRAME_SIZE.
  */
 
 #include <fcntl.h>
@@ -100,6 +106,7 @@
 #include "BLI_bitmap.h"
 #include "BLI_blenlib.h"
 #include "BLI_mempool.h"
+#include "BLI_trace.h"
 #include "MEM_guardedalloc.h" /* MEM_freeN */
 
 #include "BKE_blender_version.h"
@@ -161,7 +168,7 @@ struct WriteWrap {
   /* internal */
   union {
     int file_handle;
-    gzFile gz_handle;
+    struct WriteWrapZFrames *zframes;
   } _user_data;
 };
 
@@ -191,17 +198,148 @@ static size_t ww_write_none(WriteWrap *ww, const char *buf, size_t buf_len)
 }
 #undef FILE_HANDLE
 
-/* zlib */
-#define FILE_HANDLE(ww) (ww)->_user_data.gz_handle
+/* zlib (seekable frames, see #BLEND_ZFRAME_SIZE) */
+
+typedef struct WriteWrapZFrames {
+  int file_handle;
+  /** Number of bytes written to the file so far. */
+  uint64_t file_offset;
+
+  /** Uncompressed data of the frame being filled. */
+  uchar *frame_buf;
+  size_t frame_buf_used_len;
+  uchar *compress_buf;
+  size_t compress_buf_size;
+
+  /** Pairs of (compressed size, uncompressed size) for each written frame. */
+  uint32_t *index;
+  uint index_len;
+  uint index_alloc_len;
+} WriteWrapZFrames;
+
+#define FILE_HANDLE(ww) (ww)->_user_data.zframes
+
+static void zframe_write_uint32(uchar *data, uint32_t value)
+{
+  data[0] = (uchar)(value);
+  data[1] = (uchar)(value >> 8);
+  data[2] = (uchar)(value >> 16);
+  data[3] = (uchar)(value >> 24);
+}
+
+static bool ww_zframes_write_raw(WriteWrapZFrames *zframes, const void *data, size_t data_len)
+{
+  if (write(zframes->file_handle, data, data_len) != (ssize_t)data_len) {
+    return false;
+  }
+  zframes->file_offset += data_len;
+  return true;
+}
+
+/** Compress \a data as a single gzip member and write it, storing its size in \a r_len. */
+static bool ww_zframes_write_member(WriteWrapZFrames *zframes,
+                                    const void *data,
+                                    size_t data_len,
+                                    uint32_t *r_len)
+{
+  z_stream strm = {NULL};
+  if (deflateInit2(&strm, 1, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+    return false;
+  }
+
+  const size_t bound = deflateBound(&strm, (uLong)data_len);
+  if (bound > zframes->compress_buf_size) {
+    MEM_SAFE_FREE(zframes->compress_buf);
+    zframes->compress_buf = MEM_mallocN(bound, __func__);
+    zframes->compress_buf_size = bound;
+  }
+
+  strm.next_in = (Bytef *)data;
+  strm.avail_in = (uint)data_len;
+  strm.next_out = zframes->compress_buf;
+  strm.avail_out = (uint)zframes->compress_buf_size;
+  const int err = deflate(&strm, Z_FINISH);
+  const size_t compressed_len = strm.total_out;
+  deflateEnd(&strm);
+
+  if (err != Z_STREAM_END) {
+    return false;
+  }
+  *r_len = (uint32_t)compressed_len;
+  return ww_zframes_write_raw(zframes, zframes->compress_buf, compressed_len);
+}
+
+static bool ww_zframes_flush_frame(WriteWrapZFrames *zframes)
+{
+  if (zframes->frame_buf_used_len == 0) {
+    return true;
+  }
+
+  if (zframes->index_len == zframes->index_alloc_len) {
+    zframes->index_alloc_len = MAX2(64, zframes->index_alloc_len * 2);
+    zframes->index = MEM_reallocN(zframes->index,
+                                  sizeof(uint32_t[2]) * zframes->index_alloc_len);
+  }
+
+  uint32_t *index_item = &zframes->index[zframes->index_len * 2];
+  if (!ww_zframes_write_member(
+          zframes, zframes->frame_buf, zframes->frame_buf_used_len, &index_item[0])) {
+    return false;
+  }
+  index_item[1] = (uint32_t)zframes->frame_buf_used_len;
+  zframes->index_len++;
+  zframes->frame_buf_used_len = 0;
+  return true;
+}
+
+/** Write the index and footer members, see #BLEND_ZFRAME_SIZE for details. */
+static bool ww_zframes_write_index(WriteWrapZFrames *zframes)
+{
+  const uint64_t index_offset = zframes->file_offset;
+
+  /* Always little endian. */
+  uchar *index_data = MEM_mallocN(sizeof(uint32_t[2]) * MAX2(zframes->index_len, 1), __func__);
+  for (uint i = 0; i < zframes->index_len * 2; i++) {
+    zframe_write_uint32(&index_data[i * 4], zframes->index[i]);
+  }
+  uint32_t index_compressed_len;
+  const bool success = ww_zframes_write_member(
+      zframes, index_data, sizeof(uint32_t[2]) * zframes->index_len, &index_compressed_len);
+  MEM_freeN(index_data);
+  if (!success) {
+    return false;
+  }
+
+  /* A gzip member without content, using the "extra" field to point to the index. */
+  uchar footer[BLEND_ZFRAME_FOOTER_SIZE] = {
+      /* Magic, deflate, `FEXTRA` flag, no modification time, no extra flags, unknown OS. */
+      0x1f, 0x8b, 8, 4, 0, 0, 0, 0, 0, 0xff,
+      /* Extra field length, sub-field ID & length. */
+      20, 0, 'B', 'Z', 16, 0,
+  };
+  uchar *extra = &footer[BLEND_ZFRAME_FOOTER_EXTRA_OFFSET];
+  zframe_write_uint32(&extra[0], (uint32_t)index_offset);
+  zframe_write_uint32(&extra[4], (uint32_t)(index_offset >> 32));
+  zframe_write_uint32(&extra[8], zframes->index_len);
+  zframe_write_uint32(&extra[12], BLEND_ZFRAME_VERSION);
+  /* Empty final deflate block, the CRC32 & uncompressed size (both zero) follow. */
+  extra[16] = 0x03;
+  extra[17] = 0x00;
+
+  return ww_zframes_write_raw(zframes, footer, sizeof(footer));
+}
 
 static bool ww_open_zlib(WriteWrap *ww, const char *filepath)
 {
-  gzFile file;
+  int file;
 
-  file = BLI_gzopen(filepath, "wb1");
+  file = BLI_open(filepath, O_BINARY + O_WRONLY + O_CREAT + O_TRUNC, 0666);
 
-  if (file != Z_NULL) {
-    FILE_HANDLE(ww) = file;
+  if (file != -1) {
+    WriteWrapZFrames *zframes = MEM_callocN(sizeof(*zframes), __func__);
+    zframes->file_handle = file;
+    zframes->frame_buf = MEM_mallocN(BLEND_ZFRAME_SIZE, __func__);
+    FILE_HANDLE(ww) = zframes;
     return true;
   }
 
@@ -209,11 +347,41 @@ static bool ww_open_zlib(WriteWrap *ww, const char *filepath)
 }
 static bool ww_close_zlib(WriteWrap *ww)
 {
-  return (gzclose(FILE_HANDLE(ww)) == Z_OK);
+  WriteWrapZFrames *zframes = FILE_HANDLE(ww);
+  bool success = ww_zframes_flush_frame(zframes) && ww_zframes_write_index(zframes);
+
+  if (close(zframes->file_handle) == -1) {
+    success = false;
+  }
+
+  MEM_freeN(zframes->frame_buf);
+  MEM_SAFE_FREE(zframes->compress_buf);
+  MEM_SAFE_FREE(zframes->index);
+  MEM_freeN(zframes);
+  FILE_HANDLE(ww) = NULL;
+
+  return success;
 }
 static size_t ww_write_zlib(WriteWrap *ww, const char *buf, size_t buf_len)
 {
-  return gzwrite(FILE_HANDLE(ww), buf, buf_len);
+  WriteWrapZFrames *zframes = FILE_HANDLE(ww);
+  size_t written_len = 0;
+
+  while (written_len < buf_len) {
+    const size_t len = MIN2(buf_len - written_len,
+                            BLEND_ZFRAME_SIZE - zframes->frame_buf_used_len);
+    memcpy(&zframes->frame_buf[zframes->frame_buf_used_len], buf + written_len, len);
+    zframes->frame_buf_used_len += len;
+    written_len += len;
+
+    if (zframes->frame_buf_used_len == BLEND_ZFRAME_SIZE) {
+      if (!ww_zframes_flush_frame(zframes)) {
+        return 0;
+      }
+    }
+  }
+
+  return written_len;
 }
 #undef FILE_HANDLE
 
@@ -918,6 +1086,8 @@ static bool write_file_handle(Main *mainvar,
   char buf[16];
   WriteData *wd;
 
+  BLI_trace_begin("blenloader", current ? "Write undo step" : "Write file");
+
   blo_split_main(&mainlist, mainvar);
 
   wd = mywrite_begin(ww, compare, current);
@@ -1060,7 +1230,11 @@ static bool write_file_handle(Main *mainvar,
 
   blo_join_main(&mainlist);
 
-  return mywrite_end(wd);
+  const bool err = mywrite_end(wd);
+
+  BLI_trace_end();
+
+  return err;
 }
 
 /* do reverse file history: .blend1 -> .blend2, .blend -> .blend1 */
@@ -0,0 +1,88 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "blendfile_loading_base_test.h"
+
+#include "BKE_blender_undo.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+#include "BKE_object.h"
+
+#include "BLI_listbase.h"
+
+#include "BLO_undofile.h"
+
+#include "DNA_object_types.h"
+
+#include "PIL_time.h"
+
+class BlendfileUndoTest : public BlendfileLoadingBaseTest {
+ protected:
+  Main *bmain_ = nullptr;
+
+  void SetUp() override
+  {
+    BlendfileLoadingBaseTest::SetUp();
+    bmain_ = BKE_main_new();
+    Object *ob = BKE_object_add_only_object(bmain_, OB_MESH, "Object");
+    ob->data = BKE_mesh_add(bmain_, "Mesh");
+  }
+
+  void TearDown() override
+  {
+    BKE_main_free(bmain_);
+    BlendfileLoadingBaseTest::TearDown();
+  }
+
+  /* Compress all buffers of the memfile and wait for the background compression. */
+  static void memfile_compress(MemFile *memfile)
+  {
+    BLO_memfile_compress_begin(memfile, nullptr);
+    while (memfile->compress_task != nullptr) {
+      BLO_memfile_compress_update(memfile);
+      PIL_sleep_ms(1);
+    }
+  }
+};
+
+TEST_F(BlendfileUndoTest, EncodeOnCompressedStep)
+{
+  /* A compressed step becomes the reference of the next step after the steps written on top of
+   * it are undone, the next step has to compare its data with the decompressed buffers. */
+  MemFileUndoData *mfu_prev = BKE_memfile_undo_encode(bmain_, nullptr);
+  memfile_compress(&mfu_prev->memfile);
+  ASSERT_TRUE(mfu_prev->memfile.is_compressed);
+  ASSERT_GT(mfu_prev->memfile.stats.compressed_size_orig, 0u);
+
+  MemFileUndoData *mfu = BKE_memfile_undo_encode(bmain_, mfu_prev);
+  EXPECT_FALSE(mfu_prev->memfile.is_compressed);
+  EXPECT_EQ(mfu_prev->memfile.stats.compressed_size_orig, 0u);
+
+  /* Nothing changed, the data is shared with the previous step. */
+  EXPECT_GT(mfu->memfile.stats.identical_chunks, 0);
+  LISTBASE_FOREACH (const MemFileChunk *, chunk, &mfu->memfile.chunks) {
+    EXPECT_NE(chunk->buf, nullptr);
+  }
+
+  /* The new step can be read. */
+  Main *bmain_undo = BLO_memfile_main_get(&mfu->memfile, bmain_, nullptr);
+  ASSERT_NE(bmain_undo, nullptr);
+  EXPECT_EQ(BLI_listbase_count(&bmain_undo->objects), 1);
+  EXPECT_EQ(BLI_listbase_count(&bmain_undo->meshes), 1);
+  BKE_main_free(bmain_undo);
+
+  BKE_memfile_undo_free(mfu);
+  BKE_memfile_undo_free(mfu_prev);
+}
@@ -89,7 +89,9 @@ extern "C" {
  * In ExecutionSystem.execute all priorities are checked.
  * For every priority the ExecutionGroup's are check if the
  * priority do match.
- * When match the ExecutionGroup will be executed (this happens in serial)
+ * When match the chunks of the ExecutionGroup will be scheduled.
+ * Higher priorities are scheduled first, but chunks of all ExecutionGroup's are executed
+ * concurrently.
  *
  * \see ExecutionSystem.execute control of the Render priority
  * \see NodeOperation.getRenderPriority receive the render priority
@@ -114,9 +116,9 @@ extern "C" {
  * When the chunk-order is determined, the first few chunks will be checked if they can be scheduled.
  * Chunks can have three states:
  *  - [@ref ChunkExecutionState.COM_ES_NOT_SCHEDULED]:
- *    Chunk is not yet scheduled, or dependencies are not met.
+ *    Chunk is not yet scheduled.
  *  - [@ref ChunkExecutionState.COM_ES_SCHEDULED]:
- *    All dependencies are met, chunk is scheduled, but not finished.
+ *    Chunk is scheduled, it is executed as soon as its input chunks are executed.
  *  - [@ref ChunkExecutionState.COM_ES_EXECUTED]:
  *    Chunk is finished.
  *
@@ -127,7 +129,7 @@ extern "C" {
  * \section interest Area of interest
  * An ExecutionGroup can have dependencies to other ExecutionGroup's.
  * Data passing from one ExecutionGroup to another one are stored in 'chunks'.
- * If not all input chunks are available the chunk execution will not be scheduled.
+ * If not all input chunks are available the chunk waits for them.
  * <pre>
  * +-------------------------------------+              +--------------------------------------+
  * | ExecutionGroup A                    |              | ExecutionGroup B                     |
@@ -157,8 +159,11 @@ extern "C" {
  * The relevant ExecutionGroup (that can calculate the missing chunks; ExecutionGroup A)
  * is asked to calculate the area ExecutionGroup B is missing.
  * [@ref ExecutionGroup.scheduleAreaWhenPossible]
- * ExecutionGroup B checks what chunks the area spans, and tries to schedule these chunks.
- * If all input data is available these chunks are scheduled [@ref ExecutionGroup.scheduleChunk]
+ * ExecutionGroup A checks what chunks the area spans, and schedules these chunks.
+ * The chunk of ExecutionGroup B is registered to wait for every input chunk that is not executed.
+ * When the last of them is executed, the device that executed it hands the chunk to the
+ * WorkScheduler [@ref ExecutionGroup.scheduleChunk]. Chunks of independent ExecutionGroup's and
+ * chunks whose input area is available run concurrently, without waiting for whole groups.
  *
  * <pre>
  *
@@ -241,12 +246,10 @@ extern "C" {
  * For witching these between the state you need to recompile blender
  *
  * \subsection multithread Multi threaded
- * Default the work-scheduler will place all work as WorkPackage in a queue.
- * For every CPUcore a working thread is created.
- * These working threads will ask the WorkScheduler if there is work
- * for a specific Device.
- * the work-scheduler will find work for the device and the device
- * will be asked to execute the WorkPackage.
+ * Default the work-scheduler will push all CPU work as WorkPackage to a task pool.
+ * The pool is executed by the threads of the task scheduler, idle threads steal
+ * WorkPackages from busy ones. OpenCL work is placed in a queue, for every OpenCL device
+ * a working thread is created that asks the WorkScheduler for work.
  *
  * \subsection singlethread Single threaded
  * For debugging reasons the multi-threading can be disabled.
@@ -356,8 +359,9 @@ void COM_deinitialize(void);
 /**
  * \brief Clear all compositor caches. (Compositor system will still remain available).
  * To deinitialize the compositor use the COM_deinitialize method.
+ * Waits for a running execution to finish.
  */
-// void COM_clearCaches(void); // NOT YET WRITTEN
+void COM_clearCaches(void);
 
 #ifdef __cplusplus
 }
@@ -58,6 +58,18 @@ typedef enum CompositorPriority {
   COM_PRIORITY_LOW = 0,
 } CompositorPriority;
 
+/**
+ * \brief Possible execution models of the compositor
+ * \see CompositorContext.getExecutionModel
+ * \ingroup Execution
+ */
+typedef enum CompositorExecutionModel {
+  /** \brief Execution groups are executed chunk by chunk, see ExecutionGroup */
+  COM_EXECUTION_MODEL_TILED = 0,
+  /** \brief Every operation renders its whole result once, see FullFrameExecutionModel */
+  COM_EXECUTION_MODEL_FULL_FRAME = 1,
+} CompositorExecutionModel;
+
 // configurable items
 
 // chunk size determination
@@ -67,10 +79,11 @@ typedef enum CompositorPriority {
 
 // workscheduler threading models
 /**
- * COM_TM_QUEUE is a multi-threaded model, which uses the BLI_thread_queue pattern.
+ * COM_TM_TASK is a multi-threaded model, which pushes CPU work to a BLI_task pool. The pool is
+ * executed by the work-stealing threads of the task scheduler.
  * This is the default option.
  */
-#define COM_TM_QUEUE 1
+#define COM_TM_TASK 1
 
 /**
  * COM_TM_NOTHREAD is a single threading model, everything is executed in the caller thread.
@@ -79,9 +92,9 @@ typedef enum CompositorPriority {
 #define COM_TM_NOTHREAD 0
 
 /**
- * COM_CURRENT_THREADING_MODEL can be one of the above, COM_TM_QUEUE is currently default.
+ * COM_CURRENT_THREADING_MODEL can be one of the above, COM_TM_TASK is currently default.
  */
-#define COM_CURRENT_THREADING_MODEL COM_TM_QUEUE
+#define COM_CURRENT_THREADING_MODEL COM_TM_TASK
 // chunk order
 /**
  * \brief The order of chunks to be scheduled
@@ -107,3 +120,8 @@ typedef enum OrderOfChunks {
 #define COM_NUM_CHANNELS_COLOR 4
 
 #define COM_BLUR_BOKEH_PIXELS 512
+
+/**
+ * Minimum number of pixels rendered by a thread at once in the full frame execution model.
+ */
+#define COM_FULL_FRAME_BAND_PIXELS (64 * 1024)
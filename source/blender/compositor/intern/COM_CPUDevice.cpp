@@ -18,6 +18,8 @@
 
 #include "COM_CPUDevice.h"
 
+#include "BLI_timeit.hh"
+
 CPUDevice::CPUDevice(int thread_id) : m_thread_id(thread_id)
 {
 }
@@ -28,9 +30,15 @@ void CPUDevice::execute(WorkPackage *work)
   ExecutionGroup *executionGroup = work->getExecutionGroup();
   rcti rect;
 
+  TRACE_SCOPE("compositor", "Chunk");
+
   executionGroup->determineChunkRect(&rect, chunkNumber);
 
-  executionGroup->getOutputOperation()->executeRegion(&rect, chunkNumber);
+  /* After a break the chunk is still finalized, to release the chunks that wait for it. */
+  NodeOperation *operation = executionGroup->getOutputOperation();
+  if (!operation->isBraked()) {
+    operation->executeRegion(&rect, chunkNumber);
+  }
 
   executionGroup->finalizeChunkExecution(chunkNumber, nullptr);
 }
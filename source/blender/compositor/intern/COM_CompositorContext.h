@@ -255,6 +255,17 @@ class CompositorContext {
     return this->getbNodeTree()->chunksize;
   }
 
+  /**
+   * \brief get the execution model of the node tree
+   */
+  CompositorExecutionModel getExecutionModel() const
+  {
+    if (this->getbNodeTree()->execution_mode == NTREE_EXECUTION_MODE_FULL_FRAME) {
+      return COM_EXECUTION_MODEL_FULL_FRAME;
+    }
+    return COM_EXECUTION_MODEL_TILED;
+  }
+
   void setFastCalculation(bool fastCalculation)
   {
     this->m_fastCalculation = fastCalculation;
@@ -267,4 +278,20 @@ class CompositorContext {
   {
     return (this->getbNodeTree()->flag & NTREE_COM_GROUPNODE_BUFFER) != 0;
   }
+
+  /**
+   * \brief are buffers of the full frame execution model stored as half floats
+   */
+  bool isHalfFloatBufferEnabled() const
+  {
+    return (this->getbNodeTree()->flag & NTREE_COM_HALF_FLOAT_BUFFER) != 0;
+  }
+
+  /**
+   * \brief are constant buffers of the full frame execution model stored as a single element
+   */
+  bool isConstantBufferEnabled() const
+  {
+    return (this->getbNodeTree()->flag & NTREE_COM_CONSTANT_BUFFER) != 0;
+  }
 };
@@ -35,6 +35,7 @@
 
 #include "BLI_math.h"
 #include "BLI_string.h"
+#include "BLI_timeit.hh"
 #include "BLT_translation.h"
 #include "MEM_guardedalloc.h"
 #include "PIL_time.h"
@@ -46,6 +47,7 @@ ExecutionGroup::ExecutionGroup()
   this->m_isOutput = false;
   this->m_complex = false;
   this->m_chunkExecutionStates = nullptr;
+  this->m_chunkWaitCounts = nullptr;
   this->m_bTree = nullptr;
   this->m_height = 0;
   this->m_width = 0;
@@ -59,6 +61,14 @@ ExecutionGroup::ExecutionGroup()
   this->m_chunksFinished = 0;
   BLI_rcti_init(&this->m_viewerBorder, 0, 0, 0, 0);
   this->m_executionStartTime = 0;
+  BLI_mutex_init(&this->m_chunkMutex);
+  BLI_condition_init(&this->m_chunkFinishedCondition);
+}
+
+ExecutionGroup::~ExecutionGroup()
+{
+  BLI_condition_end(&this->m_chunkFinishedCondition);
+  BLI_mutex_end(&this->m_chunkMutex);
 }
 
 CompositorPriority ExecutionGroup::getRenderPriotrity()
@@ -124,17 +134,26 @@ void ExecutionGroup::initExecution()
   if (this->m_chunkExecutionStates != nullptr) {
     MEM_freeN(this->m_chunkExecutionStates);
   }
+  if (this->m_chunkWaitCounts != nullptr) {
+    MEM_freeN(this->m_chunkWaitCounts);
+  }
   unsigned int index;
   determineNumberOfChunks();
 
   this->m_chunkExecutionStates = nullptr;
+  this->m_chunkWaitCounts = nullptr;
   if (this->m_numberOfChunks != 0) {
     this->m_chunkExecutionStates = (ChunkExecutionState *)MEM_mallocN(
         sizeof(ChunkExecutionState) * this->m_numberOfChunks, __func__);
+    this->m_chunkWaitCounts = (unsigned int *)MEM_mallocN(
+        sizeof(unsigned int) * this->m_numberOfChunks, __func__);
     for (index = 0; index < this->m_numberOfChunks; index++) {
       this->m_chunkExecutionStates[index] = COM_ES_NOT_SCHEDULED;
+      this->m_chunkWaitCounts[index] = 1;
     }
   }
+  this->m_chunkDependents.clear();
+  this->m_chunkDependents.resize(this->m_numberOfChunks);
 
   unsigned int maxNumber = 0;
 
@@ -156,6 +175,11 @@ void ExecutionGroup::deinitExecution()
     MEM_freeN(this->m_chunkExecutionStates);
     this->m_chunkExecutionStates = nullptr;
   }
+  if (this->m_chunkWaitCounts != nullptr) {
+    MEM_freeN(this->m_chunkWaitCounts);
+    this->m_chunkWaitCounts = nullptr;
+  }
+  this->m_chunkDependents.clear();
   this->m_numberOfChunks = 0;
   this->m_numberOfXChunks = 0;
   this->m_numberOfYChunks = 0;
@@ -205,6 +229,7 @@ void ExecutionGroup::execute(ExecutionSystem *graph)
   if (this->m_numberOfChunks == 0) {
     return;
   } /** \note Early break out. */
+  TRACE_SCOPE("compositor", "Execution group");
   unsigned int chunkNumber;
 
   this->m_executionStartTime = PIL_check_seconds_timer();
@@ -322,51 +347,36 @@ void ExecutionGroup::execute(ExecutionSystem *graph)
   DebugInfo::execution_group_started(this);
   DebugInfo::graphviz(graph);
 
-  bool breaked = false;
-  bool finished = false;
-  unsigned int startIndex = 0;
-  const int maxNumberEvaluated = BLI_system_thread_count() * 2;
-
-  while (!finished && !breaked) {
-    bool startEvaluated = false;
-    finished = true;
-    int numberEvaluated = 0;
-
-    for (index = startIndex;
-         index < this->m_numberOfChunks && numberEvaluated < maxNumberEvaluated;
-         index++) {
-      chunkNumber = chunkOrder[index];
-      int yChunk = chunkNumber / this->m_numberOfXChunks;
-      int xChunk = chunkNumber - (yChunk * this->m_numberOfXChunks);
-      const ChunkExecutionState state = this->m_chunkExecutionStates[chunkNumber];
-      if (state == COM_ES_NOT_SCHEDULED) {
-        scheduleChunkWhenPossible(graph, xChunk, yChunk);
-        finished = false;
-        startEvaluated = true;
-        numberEvaluated++;
-
-        if (bTree->update_draw) {
-          bTree->update_draw(bTree->udh);
-        }
-      }
-      else if (state == COM_ES_SCHEDULED) {
-        finished = false;
-        startEvaluated = true;
-        numberEvaluated++;
-      }
-      else if (state == COM_ES_EXECUTED && !startEvaluated) {
-        startIndex = index + 1;
-      }
+  /* Chunks are handed to the WorkScheduler in chunk order as soon as their input chunks are
+   * executed, so the devices don't wait for the other chunks of this group or of the input
+   * groups. Only a window of chunks ahead of the finished ones is scheduled, so the chunks are
+   * still finished in chunk order (e.g. center out for the viewer) and the editors are redrawn
+   * from this thread instead of from the devices. */
+  const unsigned int maxNumberScheduled = WorkScheduler::get_num_cpu_threads() * 2;
+  unsigned int chunksDrawn = 0;
+  for (index = 0; index < this->m_numberOfChunks; index++) {
+    BLI_mutex_lock(&this->m_chunkMutex);
+    while (index >= this->m_chunksFinished + maxNumberScheduled) {
+      BLI_condition_wait(&this->m_chunkFinishedCondition, &this->m_chunkMutex);
     }
+    const unsigned int chunksFinished = this->m_chunksFinished;
+    BLI_mutex_unlock(&this->m_chunkMutex);
 
-    WorkScheduler::finish();
-
+    if (chunksFinished != chunksDrawn) {
+      chunksDrawn = chunksFinished;
+      if (bTree->update_draw) {
+        bTree->update_draw(bTree->udh);
+      }
+    }
     if (bTree->test_break && bTree->test_break(bTree->tbh)) {
-      breaked = true;
+      break;
     }
+
+    chunkNumber = chunkOrder[index];
+    int yChunk = chunkNumber / this->m_numberOfXChunks;
+    int xChunk = chunkNumber - (yChunk * this->m_numberOfXChunks);
+    scheduleChunkWhenPossible(graph, xChunk, yChunk);
   }
-  DebugInfo::execution_group_finished(this);
-  DebugInfo::graphviz(graph);
 
   MEM_freeN(chunkOrder);
 }
@@ -405,11 +415,22 @@ MemoryBuffer *ExecutionGroup::constructConsolidatedMemoryBuffer(MemoryProxy *mem
 
 void ExecutionGroup::finalizeChunkExecution(int chunkNumber, MemoryBuffer **memoryBuffers)
 {
+  vector<ChunkDependent> dependents;
+  BLI_mutex_lock(&this->m_chunkMutex);
   if (this->m_chunkExecutionStates[chunkNumber] == COM_ES_SCHEDULED) {
     this->m_chunkExecutionStates[chunkNumber] = COM_ES_EXECUTED;
   }
+  dependents.swap(this->m_chunkDependents[chunkNumber]);
+  BLI_mutex_unlock(&this->m_chunkMutex);
+
+  for (const ChunkDependent &dependent : dependents) {
+    dependent.group->releaseChunk(dependent.chunkNumber);
+  }
 
-  atomic_add_and_fetch_u(&this->m_chunksFinished, 1);
+  BLI_mutex_lock(&this->m_chunkMutex);
+  const unsigned int chunksFinished = atomic_add_and_fetch_u(&this->m_chunksFinished, 1);
+  BLI_condition_notify_all(&this->m_chunkFinishedCondition);
+  BLI_mutex_unlock(&this->m_chunkMutex);
   if (memoryBuffers) {
     for (unsigned int index = 0; index < this->m_cachedMaxReadBufferOffset; index++) {
       MemoryBuffer *buffer = memoryBuffers[index];
@@ -424,7 +445,7 @@ void ExecutionGroup::finalizeChunkExecution(int chunkNumber, MemoryBuffer **memo
   }
   if (this->m_bTree) {
     // status report is only performed for top level Execution Groups.
-    float progress = this->m_chunksFinished;
+    float progress = chunksFinished;
     progress /= this->m_numberOfChunks;
     this->m_bTree->progress(this->m_bTree->prh, progress);
 
@@ -432,7 +453,7 @@ void ExecutionGroup::finalizeChunkExecution(int chunkNumber, MemoryBuffer **memo
     BLI_snprintf(buf,
                  sizeof(buf),
                  TIP_("Compositing | Tile %u-%u"),
-                 this->m_chunksFinished,
+                 chunksFinished,
                  this->m_numberOfChunks);
     this->m_bTree->stats_draw(this->m_bTree->sdh, buf);
   }
@@ -481,10 +502,14 @@ MemoryBuffer *ExecutionGroup::allocateOutputBuffer(int /*chunkNumber*/, rcti *re
   return nullptr;
 }
 
-bool ExecutionGroup::scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *area)
+void ExecutionGroup::scheduleAreaWhenPossible(ExecutionSystem *graph,
+                                              rcti *area,
+                                              const ChunkDependent &dependent)
 {
   if (this->m_singleThreaded) {
-    return scheduleChunkWhenPossible(graph, 0, 0);
+    scheduleChunkWhenPossible(graph, 0, 0);
+    addChunkDependent(0, dependent);
+    return;
   }
   // find all chunks inside the rect
   // determine minxchunk, minychunk, maxxchunk, maxychunk where x and y are chunknumbers
@@ -503,56 +528,68 @@ bool ExecutionGroup::scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *area
   maxxchunk = min_ii(maxxchunk, (int)m_numberOfXChunks);
   maxychunk = min_ii(maxychunk, (int)m_numberOfYChunks);
 
-  bool result = true;
   for (indexx = minxchunk; indexx < maxxchunk; indexx++) {
     for (indexy = minychunk; indexy < maxychunk; indexy++) {
-      if (!scheduleChunkWhenPossible(graph, indexx, indexy)) {
-        result = false;
-      }
+      scheduleChunkWhenPossible(graph, indexx, indexy);
+      addChunkDependent(indexy * this->m_numberOfXChunks + indexx, dependent);
     }
   }
+}
 
-  return result;
+void ExecutionGroup::addChunkDependent(unsigned int chunkNumber, const ChunkDependent &dependent)
+{
+  BLI_mutex_lock(&this->m_chunkMutex);
+  if (this->m_chunkExecutionStates[chunkNumber] != COM_ES_EXECUTED) {
+    /* Increase while locked, so the device finalizing this chunk can't release the dependent
+     * before it is counted. */
+    atomic_add_and_fetch_u(&dependent.group->m_chunkWaitCounts[dependent.chunkNumber], 1);
+    this->m_chunkDependents[chunkNumber].push_back(dependent);
+  }
+  BLI_mutex_unlock(&this->m_chunkMutex);
 }
 
-bool ExecutionGroup::scheduleChunk(unsigned int chunkNumber)
+void ExecutionGroup::releaseChunk(unsigned int chunkNumber)
 {
-  if (this->m_chunkExecutionStates[chunkNumber] == COM_ES_NOT_SCHEDULED) {
-    this->m_chunkExecutionStates[chunkNumber] = COM_ES_SCHEDULED;
-    WorkScheduler::schedule(this, chunkNumber);
-    return true;
+  if (atomic_sub_and_fetch_u(&this->m_chunkWaitCounts[chunkNumber], 1) == 0) {
+    scheduleChunk(chunkNumber);
   }
-  return false;
 }
 
-bool ExecutionGroup::scheduleChunkWhenPossible(ExecutionSystem *graph, int xChunk, int yChunk)
+void ExecutionGroup::scheduleChunk(unsigned int chunkNumber)
+{
+  WorkScheduler::schedule(this, chunkNumber);
+}
+
+void ExecutionGroup::scheduleChunkWhenPossible(ExecutionSystem *graph, int xChunk, int yChunk)
 {
   if (xChunk < 0 || xChunk >= (int)this->m_numberOfXChunks) {
-    return true;
+    return;
   }
   if (yChunk < 0 || yChunk >= (int)this->m_numberOfYChunks) {
-    return true;
+    return;
   }
   int chunkNumber = yChunk * this->m_numberOfXChunks + xChunk;
-  // chunk is already executed
-  if (this->m_chunkExecutionStates[chunkNumber] == COM_ES_EXECUTED) {
-    return true;
-  }
 
-  // chunk is scheduled, but not executed
-  if (this->m_chunkExecutionStates[chunkNumber] == COM_ES_SCHEDULED) {
-    return false;
+  // chunk is already scheduled or executed
+  BLI_mutex_lock(&this->m_chunkMutex);
+  const bool isScheduled = this->m_chunkExecutionStates[chunkNumber] != COM_ES_NOT_SCHEDULED;
+  if (!isScheduled) {
+    this->m_chunkExecutionStates[chunkNumber] = COM_ES_SCHEDULED;
+  }
+  BLI_mutex_unlock(&this->m_chunkMutex);
+  if (isScheduled) {
+    return;
   }
 
-  // chunk is nor executed nor scheduled.
+  // schedule the input chunks, the wait count of this chunk holds one until all are added.
   vector<MemoryProxy *> memoryProxies;
   this->determineDependingMemoryProxies(&memoryProxies);
 
   rcti rect;
   determineChunkRect(&rect, xChunk, yChunk);
   unsigned int index;
-  bool canBeExecuted = true;
   rcti area;
+  const ChunkDependent dependent = {this, (unsigned int)chunkNumber};
 
   for (index = 0; index < this->m_cachedReadOperations.size(); index++) {
     ReadBufferOperation *readOperation =
@@ -563,20 +600,14 @@ bool ExecutionGroup::scheduleChunkWhenPossible(ExecutionSystem *graph, int xChun
     ExecutionGroup *group = memoryProxy->getExecutor();
 
     if (group != nullptr) {
-      if (!group->scheduleAreaWhenPossible(graph, &area)) {
-        canBeExecuted = false;
-      }
+      group->scheduleAreaWhenPossible(graph, &area, dependent);
     }
     else {
       throw "ERROR";
     }
   }
 
-  if (canBeExecuted) {
-    scheduleChunk(chunkNumber);
-  }
-
-  return false;
+  releaseChunk(chunkNumber);
 }
 
 void ExecutionGroup::determineDependingAreaOfInterest(rcti *input,
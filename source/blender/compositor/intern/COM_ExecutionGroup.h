@@ -23,6 +23,7 @@
 #endif
 
 #include "BLI_rect.h"
+#include "BLI_threads.h"
 #include "COM_CompositorContext.h"
 #include "COM_Device.h"
 #include "COM_MemoryProxy.h"
@@ -32,6 +33,7 @@
 
 using std::vector;
 
+class ExecutionGroup;
 class ExecutionSystem;
 class MemoryProxy;
 class ReadBufferOperation;
@@ -48,6 +50,7 @@ typedef enum ChunkExecutionState {
   COM_ES_NOT_SCHEDULED = 0,
   /**
    * \brief chunk is scheduled, but not yet executed
+   * \note the chunk can still be waiting for its input chunks
    */
   COM_ES_SCHEDULED = 1,
   /**
@@ -56,6 +59,15 @@ typedef enum ChunkExecutionState {
   COM_ES_EXECUTED = 2,
 } ChunkExecutionState;
 
+/**
+ * \brief a chunk that waits for the execution of a chunk of another ExecutionGroup
+ * \ingroup Execution
+ */
+typedef struct ChunkDependent {
+  ExecutionGroup *group;
+  unsigned int chunkNumber;
+} ChunkDependent;
+
 /**
  * \brief Class ExecutionGroup is a group of Operations that are executed as one.
  * This grouping is used to combine Operations that can be executed as one whole when
@@ -158,6 +170,29 @@ class ExecutionGroup {
    */
   ChunkExecutionState *m_chunkExecutionStates;
 
+  /**
+   * \brief number of input chunks every chunk still waits for, plus one while its inputs are
+   * being scheduled. The chunk is added to the WorkScheduler when this drops to zero.
+   */
+  unsigned int *m_chunkWaitCounts;
+
+  /**
+   * \brief per chunk the chunks of other ExecutionGroup's waiting for it.
+   */
+  vector<vector<ChunkDependent>> m_chunkDependents;
+
+  /**
+   * \brief protects m_chunkExecutionStates and m_chunkDependents, chunks are finalized from the
+   * device threads.
+   */
+  ThreadMutex m_chunkMutex;
+
+  /**
+   * \brief signaled with m_chunkMutex locked when a chunk of this group is finished, the thread
+   * executing this group waits on it to keep the number of scheduled chunks limited.
+   */
+  ThreadCondition m_chunkFinishedCondition;
+
   /**
    * \brief indicator when this ExecutionGroup has valid Operations in its vector for Execution
    * \note When building the ExecutionGroup Operations are added via recursion.
@@ -210,35 +245,45 @@ class ExecutionGroup {
   void determineNumberOfChunks();
 
   /**
-   * \brief try to schedule a specific chunk.
-   * \note scheduling succeeds when all input requirements are met and the chunks hasn't been
-   * scheduled yet.
+   * \brief schedule a specific chunk, to be executed when its input chunks are executed.
+   * \note the input chunks are scheduled first. The chunk is added to the WorkScheduler right
+   * away when all of them are executed, otherwise by the device executing the last of them.
+   * \note nothing happens when the chunk is already scheduled or executed.
    * \param graph:
    * \param xChunk:
    * \param yChunk:
-   * \return [true:false]
-   * true: package(s) are scheduled
-   * false: scheduling is deferred (depending workpackages are scheduled)
    */
-  bool scheduleChunkWhenPossible(ExecutionSystem *graph, int xChunk, int yChunk);
+  void scheduleChunkWhenPossible(ExecutionSystem *graph, int xChunk, int yChunk);
 
   /**
-   * \brief try to schedule a specific area.
-   * \note Check if a certain area is available, when not available this are will be checked.
+   * \brief schedule all chunks of a specific area for a chunk of another ExecutionGroup.
    * \note This method is called from other ExecutionGroup's.
    * \param graph:
    * \param area:
-   * \return [true:false]
-   * true: package(s) are scheduled
-   * false: scheduling is deferred (depending workpackages are scheduled)
+   * \param dependent: the chunk that needs the area, it will wait for the chunks of the area
+   * that are not executed yet.
+   */
+  void scheduleAreaWhenPossible(ExecutionSystem *graph,
+                                rcti *area,
+                                const ChunkDependent &dependent);
+
+  /**
+   * \brief let a chunk of another ExecutionGroup wait for a chunk of this group.
+   * \note the wait count of the dependent is only increased when the chunk isn't executed yet.
+   */
+  void addChunkDependent(unsigned int chunkNumber, const ChunkDependent &dependent);
+
+  /**
+   * \brief an input chunk of a chunk is executed, or all its inputs are scheduled.
+   * \note adds the chunk to the WorkScheduler when it doesn't wait for anything anymore.
    */
-  bool scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *area);
+  void releaseChunk(unsigned int chunkNumber);
 
   /**
    * \brief add a chunk to the WorkScheduler.
    * \param chunknumber:
    */
-  bool scheduleChunk(unsigned int chunkNumber);
+  void scheduleChunk(unsigned int chunkNumber);
 
   /**
    * \brief determine the area of interest of a certain input area
@@ -254,6 +299,7 @@ class ExecutionGroup {
  public:
   // constructors
   ExecutionGroup();
+  ~ExecutionGroup();
 
   // methods
   /**
@@ -370,6 +416,7 @@ class ExecutionGroup {
 
   /**
    * \brief after a chunk is executed the needed resources can be freed or unlocked.
+   * \note chunks that were waiting for this chunk are added to the WorkScheduler.
    * \param chunknumber:
    * \param memorybuffers:
    */
@@ -383,7 +430,8 @@ class ExecutionGroup {
 
   /**
    * \brief schedule an ExecutionGroup
-   * \note this method will return when all chunks have been calculated, or the execution has
+   * \note this method returns when all chunks and the chunks they depend on are scheduled.
+   * WorkScheduler.finish waits until they are calculated, or skipped when the execution has
    * breaked (by user)
    *
    * first the order of the chunks will be determined. This is determined by finding the
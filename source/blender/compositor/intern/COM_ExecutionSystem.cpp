@@ -66,10 +66,14 @@ ExecutionSystem::ExecutionSystem(RenderData *rd,
   this->m_context.setViewSettings(viewSettings);
   this->m_context.setDisplaySettings(displaySettings);
 
+  this->m_fullFrameModel = nullptr;
   {
     NodeOperationBuilder builder(&m_context, editingtree);
     builder.convertToOperations(this);
   }
+  if (this->m_context.getExecutionModel() == COM_EXECUTION_MODEL_FULL_FRAME) {
+    this->m_fullFrameModel = new FullFrameExecutionModel(this->m_context, this->m_operations);
+  }
 
   unsigned int index;
   unsigned int resolution[2];
@@ -103,11 +107,25 @@ ExecutionSystem::ExecutionSystem(RenderData *rd,
     }
   }
 
+  if (this->m_fullFrameModel) {
+    if (rendering && (rd->mode & R_BORDER) && !(rd->mode & R_CROP)) {
+      this->m_fullFrameModel->setRenderBorder(
+          rd->border.xmin, rd->border.xmax, rd->border.ymin, rd->border.ymax);
+    }
+    if (use_viewer_border) {
+      this->m_fullFrameModel->setViewerBorder(
+          viewer_border->xmin, viewer_border->xmax, viewer_border->ymin, viewer_border->ymax);
+    }
+  }
+
   //  DebugInfo::graphviz(this);
 }
 
 ExecutionSystem::~ExecutionSystem()
 {
+  delete this->m_fullFrameModel;
+  this->m_fullFrameModel = nullptr;
+
   unsigned int index;
   for (index = 0; index < this->m_operations.size(); index++) {
     NodeOperation *operation = this->m_operations[index];
@@ -134,6 +152,12 @@ void ExecutionSystem::execute()
 
   DebugInfo::execute_started(this);
 
+  if (this->m_fullFrameModel) {
+    /* Operations are initialized when they are rendered. */
+    this->m_fullFrameModel->execute();
+    return;
+  }
+
   unsigned int order = 0;
   for (vector<NodeOperation *>::iterator iter = this->m_operations.begin();
        iter != this->m_operations.end();
@@ -188,6 +212,13 @@ void ExecutionSystem::execute()
   WorkScheduler::finish();
   WorkScheduler::stop();
 
+  vector<ExecutionGroup *> outputGroups;
+  this->findOutputExecutionGroup(&outputGroups);
+  for (index = 0; index < outputGroups.size(); index++) {
+    DebugInfo::execution_group_finished(outputGroups[index]);
+  }
+  DebugInfo::graphviz(this);
+
   editingtree->stats_draw(editingtree->sdh, TIP_("Compositing | De-initializing execution"));
   for (index = 0; index < this->m_operations.size(); index++) {
     NodeOperation *operation = this->m_operations[index];
@@ -22,6 +22,7 @@ class ExecutionGroup;
 
 #include "BKE_text.h"
 #include "COM_ExecutionGroup.h"
+#include "COM_FullFrameExecutionModel.h"
 #include "COM_Node.h"
 #include "COM_NodeOperation.h"
 #include "DNA_color_types.h"
@@ -107,6 +108,12 @@ class ExecutionGroup;
  * \see ExecutionSystem.addReadWriteBufferOperations
  * \see NodeOperation.isComplex
  * \see ExecutionGroup class representing the ExecutionGroup
+ *
+ * \section EM_FullFrame Full frame execution model
+ * Instead of steps 4 and 5, when the node tree uses the full frame execution model every
+ * operation renders its whole result at once into a MemoryBuffer which is read by the operations
+ * depending on it.
+ * \see FullFrameExecutionModel
  */
 
 /**
@@ -133,6 +140,12 @@ class ExecutionSystem {
    */
   Groups m_groups;
 
+  /**
+   * \brief executes the operations when using the full frame execution model, groups are not
+   * used then
+   */
+  FullFrameExecutionModel *m_fullFrameModel;
+
  private:  // methods
   /**
    * find all execution group with output nodes
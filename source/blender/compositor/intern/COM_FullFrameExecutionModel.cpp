@@ -0,0 +1,355 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2021, Blender Foundation.
+ */
+
+#include <typeinfo>
+
+#include "COM_FullFrameExecutionModel.h"
+
+#include "DNA_userdef_types.h"
+
+#include "BLT_translation.h"
+
+#include "COM_MemoryBuffer.h"
+#include "COM_NodeOperation.h"
+#include "COM_ReadBufferOperation.h"
+#include "COM_ResultCache.h"
+#include "COM_WriteBufferOperation.h"
+
+#ifdef WITH_CXX_GUARDEDALLOC
+#  include "MEM_guardedalloc.h"
+#endif
+
+FullFrameExecutionModel::FullFrameExecutionModel(const CompositorContext &context,
+                                                 const Operations &operations)
+    : m_context(context), m_operations(operations)
+{
+  this->m_useViewerBorder = false;
+  this->m_useRenderBorder = false;
+  this->m_useCache = false;
+  this->m_contextHash = 0;
+}
+
+void FullFrameExecutionModel::setViewerBorder(float xmin, float xmax, float ymin, float ymax)
+{
+  BLI_rctf_init(&this->m_viewerBorder, xmin, xmax, ymin, ymax);
+  this->m_useViewerBorder = true;
+}
+
+void FullFrameExecutionModel::setRenderBorder(float xmin, float xmax, float ymin, float ymax)
+{
+  BLI_rctf_init(&this->m_renderBorder, xmin, xmax, ymin, ymax);
+  this->m_useRenderBorder = true;
+}
+
+void FullFrameExecutionModel::determineOutputArea(NodeOperation *operation, rcti *r_area) const
+{
+  const int width = operation->getWidth();
+  const int height = operation->getHeight();
+  const rctf *border = nullptr;
+
+  /* Same borders as in the tiled execution model, see ExecutionGroup. */
+  if (operation->isViewerOperation() || operation->isPreviewOperation()) {
+    if (this->m_useViewerBorder) {
+      border = &this->m_viewerBorder;
+    }
+  }
+  else if (operation->isOutputOperation(true) && !operation->isFileOutputOperation()) {
+    if (this->m_useRenderBorder) {
+      border = &this->m_renderBorder;
+    }
+  }
+
+  if (border) {
+    BLI_rcti_init(r_area,
+                  border->xmin * width,
+                  border->xmax * width,
+                  border->ymin * height,
+                  border->ymax * height);
+  }
+  else {
+    BLI_rcti_init(r_area, 0, width, 0, height);
+  }
+}
+
+void FullFrameExecutionModel::determineAreasToRender(NodeOperation *operation, const rcti *area)
+{
+  rcti bounds, clamped;
+  BLI_rcti_init(&bounds, 0, operation->getWidth(), 0, operation->getHeight());
+  if (!BLI_rcti_isect(area, &bounds, &clamped)) {
+    return;
+  }
+
+  OperationState &state = this->m_states[operation];
+  if (state.has_area) {
+    if (BLI_rcti_inside_rcti(&state.area, &clamped)) {
+      return;
+    }
+    BLI_rcti_union(&state.area, &clamped);
+  }
+  else {
+    state.area = clamped;
+    state.has_area = true;
+  }
+
+  for (unsigned int index = 0; index < operation->getNumberOfInputSockets(); index++) {
+    NodeOperationInput *input = operation->getInputSocket(index);
+    if (input->isConnected()) {
+      rcti inputArea;
+      operation->getAreaOfInterest(index, &state.area, &inputArea);
+      determineAreasToRender(&input->getLink()->getOperation(), &inputArea);
+    }
+  }
+
+  /* Read buffer operations added by nodes read the whole buffer of their write operation. */
+  if (operation->isReadBufferOperation()) {
+    WriteBufferOperation *writeOperation =
+        ((ReadBufferOperation *)operation)->getMemoryProxy()->getWriteBufferOperation();
+    BLI_rcti_init(&bounds, 0, writeOperation->getWidth(), 0, writeOperation->getHeight());
+    determineAreasToRender(writeOperation, &bounds);
+  }
+}
+
+void FullFrameExecutionModel::determineReaders(NodeOperation *operation,
+                                               std::set<NodeOperation *> &visited)
+{
+  if (!visited.insert(operation).second) {
+    return;
+  }
+
+  for (unsigned int index = 0; index < operation->getNumberOfInputSockets(); index++) {
+    NodeOperationInput *input = operation->getInputSocket(index);
+    if (input->isConnected()) {
+      NodeOperation *inputOperation = &input->getLink()->getOperation();
+      OperationState &inputState = this->m_states[inputOperation];
+      inputState.readers++;
+      if (!operation->isFullFrameOperation() && !operation->isWriteBufferOperation()) {
+        inputState.has_pixel_readers = true;
+      }
+      determineReaders(inputOperation, visited);
+    }
+  }
+
+  if (operation->isReadBufferOperation()) {
+    determineReaders(
+        ((ReadBufferOperation *)operation)->getMemoryProxy()->getWriteBufferOperation(), visited);
+  }
+}
+
+bool FullFrameExecutionModel::determineHash(NodeOperation *operation)
+{
+  OperationState &state = this->m_states[operation];
+  if (state.hash_determined) {
+    return state.has_hash;
+  }
+  state.hash_determined = true;
+
+  OperationHash hash;
+  hash.add(this->m_contextHash);
+  hash.addString(typeid(*operation).name());
+  hash.add(operation->getWidth());
+  hash.add(operation->getHeight());
+  if (operation->getNumberOfOutputSockets() > 0) {
+    hash.add(operation->getOutputSocket()->getDataType());
+  }
+  if (!operation->hashParams(hash)) {
+    return false;
+  }
+
+  for (unsigned int index = 0; index < operation->getNumberOfInputSockets(); index++) {
+    NodeOperationInput *input = operation->getInputSocket(index);
+    if (!input->isConnected()) {
+      hash.add((uint64_t)0);
+      continue;
+    }
+    NodeOperation *inputOperation = &input->getLink()->getOperation();
+    if (!determineHash(inputOperation)) {
+      return false;
+    }
+    hash.add(this->m_states[inputOperation].hash);
+  }
+
+  state.hash = hash.get();
+  state.has_hash = true;
+  return true;
+}
+
+MemoryBuffer *FullFrameExecutionModel::renderOperation(NodeOperation *operation)
+{
+  OperationState &state = this->m_states[operation];
+  if (state.rendered) {
+    return state.buffer;
+  }
+  BLI_assert(operation->getNumberOfOutputSockets() <= 1);
+
+  /* Constant operations are cheaper to render than to keep. */
+  const bool useCache = this->m_useCache && state.has_area && !operation->isSetOperation() &&
+                        operation->getNumberOfOutputSockets() > 0 && determineHash(operation);
+  if (useCache) {
+    MemoryBuffer *buffer = ResultCache::lookup(state.hash, &state.area);
+    if (buffer) {
+      state.buffer = buffer;
+      state.cached = true;
+      if (state.has_pixel_readers && buffer->isPacked()) {
+        /* Stored by an execution with other readers, all readers of this one share a copy. */
+        state.buffer = buffer->inflate();
+        state.cached = false;
+      }
+      state.rendered = true;
+      releaseInputBuffers(operation);
+      return state.buffer;
+    }
+  }
+
+  if (operation->isReadBufferOperation()) {
+    ReadBufferOperation *readOperation = (ReadBufferOperation *)operation;
+    renderOperation(readOperation->getMemoryProxy()->getWriteBufferOperation());
+    readOperation->updateMemoryBuffer();
+  }
+
+  std::vector<MemoryBuffer *> inputs(operation->getNumberOfInputSockets(), nullptr);
+  for (unsigned int index = 0; index < operation->getNumberOfInputSockets(); index++) {
+    NodeOperationInput *input = operation->getInputSocket(index);
+    if (input->isConnected()) {
+      inputs[index] = renderOperation(&input->getLink()->getOperation());
+    }
+  }
+
+  operation->setbNodeTree(this->m_context.getbNodeTree());
+
+  if (operation->isWriteBufferOperation()) {
+    /* The buffer of the memory proxy is read by read buffer operations, so it stays allocated
+     * until all operations are rendered. */
+    WriteBufferOperation *writeOperation = (WriteBufferOperation *)operation;
+    writeOperation->initExecution();
+    if (inputs[0]) {
+      writeOperation->getMemoryProxy()->getBuffer()->copyContentFrom(inputs[0]);
+    }
+    this->m_writeOperations.push_back(writeOperation);
+  }
+  else {
+    rcti bounds;
+    BLI_rcti_init(&bounds, 0, operation->getWidth(), 0, operation->getHeight());
+    if (operation->getNumberOfOutputSockets() > 0) {
+      state.buffer = new MemoryBuffer(operation->getOutputSocket()->getDataType(), &bounds);
+      /* Parts which are not rendered are not read either, but keep them defined. */
+      if (!state.has_area || !BLI_rcti_compare(&state.area, &bounds)) {
+        state.buffer->clear();
+      }
+    }
+    if (state.has_area) {
+      operation->render(state.buffer, &state.area, inputs.data());
+    }
+    /* The buffer is only read from now on, until its last reader is rendered. Operations reading
+     * pixel by pixel would need an unpacked copy, which takes more memory than not packing. */
+    if (state.buffer && !state.has_pixel_readers && !operation->isBraked()) {
+      state.buffer->pack(this->m_context.isConstantBufferEnabled(),
+                         this->m_context.isHalfFloatBufferEnabled());
+    }
+    /* Results of a canceled execution can be incomplete. */
+    if (useCache && !operation->isBraked()) {
+      state.cached = ResultCache::store(state.hash, state.buffer, &state.area);
+    }
+  }
+
+  state.rendered = true;
+  releaseInputBuffers(operation);
+  return state.buffer;
+}
+
+void FullFrameExecutionModel::releaseInputBuffers(NodeOperation *operation)
+{
+  for (unsigned int index = 0; index < operation->getNumberOfInputSockets(); index++) {
+    NodeOperationInput *input = operation->getInputSocket(index);
+    if (!input->isConnected()) {
+      continue;
+    }
+    OperationState &state = this->m_states[&input->getLink()->getOperation()];
+    BLI_assert(state.readers > 0);
+    state.readers--;
+    if (state.readers == 0 && state.buffer) {
+      if (!state.cached) {
+        delete state.buffer;
+      }
+      state.buffer = nullptr;
+    }
+  }
+}
+
+void FullFrameExecutionModel::execute()
+{
+  const bNodeTree *editingtree = this->m_context.getbNodeTree();
+  const bool rendering = this->m_context.isRendering();
+
+  /* Output operations in order of their priority, like the output execution groups of the tiled
+   * execution model. */
+  Operations outputOperations;
+  const CompositorPriority priorities[] = {
+      COM_PRIORITY_HIGH, COM_PRIORITY_MEDIUM, COM_PRIORITY_LOW};
+  for (const CompositorPriority priority : priorities) {
+    if (priority != COM_PRIORITY_HIGH && this->m_context.isFastCalculation()) {
+      break;
+    }
+    for (NodeOperation *operation : this->m_operations) {
+      if (operation->isOutputOperation(rendering) && operation->getRenderPriority() == priority) {
+        outputOperations.push_back(operation);
+      }
+    }
+  }
+
+  editingtree->stats_draw(editingtree->sdh, TIP_("Compositing | Determining areas to render"));
+
+  this->m_useCache = ResultCache::beginExecution(((size_t)U.compositor_cache_limit) * 1024 *
+                                                 1024);
+  OperationHash contextHash;
+  contextHash.add(this->m_context.getQuality());
+  contextHash.add(rendering);
+  contextHash.add(this->m_context.isFastCalculation());
+  contextHash.add(this->m_context.isHalfFloatBufferEnabled());
+  contextHash.addString(this->m_context.getViewName());
+  this->m_contextHash = contextHash.get();
+
+  std::set<NodeOperation *> visited;
+  for (NodeOperation *operation : outputOperations) {
+    rcti area;
+    determineOutputArea(operation, &area);
+    determineAreasToRender(operation, &area);
+    determineReaders(operation, visited);
+  }
+
+  editingtree->stats_draw(editingtree->sdh, TIP_("Compositing | Rendering full frames"));
+
+  for (NodeOperation *operation : outputOperations) {
+    if (editingtree->test_break(editingtree->tbh)) {
+      break;
+    }
+    renderOperation(operation);
+  }
+
+  /* Buffers are left when the execution was canceled. */
+  for (std::pair<NodeOperation *const, OperationState> &item : this->m_states) {
+    if (!item.second.cached) {
+      delete item.second.buffer;
+    }
+    item.second.buffer = nullptr;
+  }
+  ResultCache::endExecution();
+  for (WriteBufferOperation *writeOperation : this->m_writeOperations) {
+    writeOperation->deinitExecution();
+  }
+  this->m_writeOperations.clear();
+}
@@ -0,0 +1,119 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2021, Blender Foundation.
+ */
+
+#pragma once
+
+#include <map>
+#include <set>
+#include <vector>
+
+#include "BLI_rect.h"
+
+#include "COM_CompositorContext.h"
+
+class MemoryBuffer;
+class NodeOperation;
+class WriteBufferOperation;
+
+/**
+ * \brief Executes operations rendering full frames instead of chunks
+ *
+ * Every operation needed by the outputs renders its result into a MemoryBuffer once, after the
+ * operations it depends on. The area to render of an operation is determined beforehand from the
+ * areas of interest of its readers, see NodeOperation.getAreaOfInterest. The buffer of an
+ * operation is freed as soon as all of its readers are rendered.
+ *
+ * Unlike the tiled execution model, no execution groups nor read and write buffer operations are
+ * created, operations read directly from the buffers of their input operations.
+ *
+ * Rendered buffers are packed while they wait for their readers, see MemoryBuffer.pack. Full frame
+ * operations read them row by row. Buffers read by other operations, which read pixel by pixel,
+ * aren't packed.
+ *
+ * Results of operations with a hash are kept in the ResultCache between executions. An operation
+ * found in the cache isn't rendered, nor are its inputs.
+ *
+ * \see ExecutionSystem
+ * \see NodeOperation.render
+ * \ingroup Execution
+ */
+class FullFrameExecutionModel {
+ public:
+  typedef std::vector<NodeOperation *> Operations;
+
+ private:
+  struct OperationState {
+    /** Area of the operation to render. */
+    rcti area;
+    bool has_area;
+    /** Number of input sockets reading the buffer which are not rendered yet. */
+    int readers;
+    /** Read by an operation which isn't a full frame operation, the buffer can't be packed. */
+    bool has_pixel_readers;
+    /** Rendered result, nullptr for operations without outputs. */
+    MemoryBuffer *buffer;
+    bool rendered;
+    /** Hash of the result, only valid when has_hash is set. */
+    uint64_t hash;
+    bool has_hash;
+    bool hash_determined;
+    /** The buffer is owned by the ResultCache. */
+    bool cached;
+  };
+
+  const CompositorContext &m_context;
+  const Operations &m_operations;
+  std::map<NodeOperation *, OperationState> m_states;
+
+  /** Whether results are taken from and stored in the ResultCache. */
+  bool m_useCache;
+  /** Hash of the context settings which influence all results. */
+  uint64_t m_contextHash;
+
+  /** Write buffer operations added by nodes, their buffers are kept until the end. */
+  std::vector<WriteBufferOperation *> m_writeOperations;
+
+  /** Borders relative to the resolution of the outputs, see ExecutionGroup. */
+  rctf m_viewerBorder;
+  bool m_useViewerBorder;
+  rctf m_renderBorder;
+  bool m_useRenderBorder;
+
+ public:
+  FullFrameExecutionModel(const CompositorContext &context, const Operations &operations);
+
+  void setViewerBorder(float xmin, float xmax, float ymin, float ymax);
+  void setRenderBorder(float xmin, float xmax, float ymin, float ymax);
+
+  /**
+   * \brief render all output operations, in order of their priority
+   */
+  void execute();
+
+ private:
+  void determineOutputArea(NodeOperation *operation, rcti *r_area) const;
+  void determineAreasToRender(NodeOperation *operation, const rcti *area);
+  void determineReaders(NodeOperation *operation, std::set<NodeOperation *> &visited);
+  bool determineHash(NodeOperation *operation);
+  MemoryBuffer *renderOperation(NodeOperation *operation);
+  void releaseInputBuffers(NodeOperation *operation);
+
+#ifdef WITH_CXX_GUARDEDALLOC
+  MEM_CXX_CLASS_ALLOC_FUNCS("COM:FullFrameExecutionModel")
+#endif
+};
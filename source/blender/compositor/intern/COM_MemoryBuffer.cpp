@@ -16,6 +16,8 @@
  * Copyright 2011, Blender Foundation.
  */
 
+#include "BLI_task.hh"
+
 #include "COM_MemoryBuffer.h"
 
 #include "MEM_guardedalloc.h"
@@ -23,6 +25,69 @@
 using std::max;
 using std::min;
 
+/* Rows of pixels converted by a single task when packing and inflating. */
+#define COM_PACK_GRAIN_SIZE 16
+
+/* Convert to a half float, rounding to the nearest even value. Values too large for a half
+ * float are clamped to the largest one instead of becoming infinite. */
+static uint16_t float_to_half(float value)
+{
+  uint32_t x;
+  memcpy(&x, &value, sizeof(x));
+  const uint16_t sign = (x >> 16) & 0x8000;
+  x &= 0x7fffffff;
+
+  if (x >= 0x7f800000) {
+    /* Infinity and NaN. */
+    return sign | (x > 0x7f800000 ? 0x7e00 : 0x7c00);
+  }
+  if (x >= 0x477ff000) {
+    return sign | 0x7bff;
+  }
+  if (x < 0x38800000) {
+    /* Denormal half floats. */
+    if (x < 0x33000000) {
+      return sign;
+    }
+    const uint32_t shift = 126 - (x >> 23);
+    const uint32_t mantissa = (x & 0x7fffff) | 0x800000;
+    const uint32_t remainder = mantissa & ((1u << shift) - 1);
+    const uint32_t halfway = 1u << (shift - 1);
+    uint32_t result = mantissa >> shift;
+    if (remainder > halfway || (remainder == halfway && (result & 1))) {
+      result++;
+    }
+    return sign | (uint16_t)result;
+  }
+
+  /* Adjust the exponent bias and round away the lowest 13 bits of the mantissa. */
+  x -= 0x38000000;
+  x += 0x0fff + ((x >> 13) & 1);
+  return sign | (uint16_t)(x >> 13);
+}
+
+static float half_to_float(uint16_t value)
+{
+  const uint32_t sign = (uint32_t)(value & 0x8000) << 16;
+  const uint32_t exponent = (value >> 10) & 0x1f;
+  const uint32_t mantissa = value & 0x3ff;
+  uint32_t x;
+  if (exponent == 0x1f) {
+    x = sign | 0x7f800000 | (mantissa << 13);
+  }
+  else if (exponent != 0) {
+    x = sign | ((exponent + 112) << 23) | (mantissa << 13);
+  }
+  else {
+    /* Zero and denormal half floats. */
+    const float result = (float)mantissa * (1.0f / 16777216.0f);
+    return sign ? -result : result;
+  }
+  float result;
+  memcpy(&result, &x, sizeof(result));
+  return result;
+}
+
 static unsigned int determine_num_channels(DataType datatype)
 {
   switch (datatype) {
@@ -61,6 +126,8 @@ MemoryBuffer::MemoryBuffer(MemoryProxy *memoryProxy, unsigned int chunkNumber, r
   this->m_buffer = (float *)MEM_mallocN_aligned(
       sizeof(float) * determineBufferSize() * this->m_num_channels, 16, "COM_MemoryBuffer");
   this->m_state = COM_MB_ALLOCATED;
+  this->m_half_buffer = nullptr;
+  this->m_is_a_single_elem = false;
   this->m_datatype = memoryProxy->getDataType();
 }
 
@@ -75,6 +142,8 @@ MemoryBuffer::MemoryBuffer(MemoryProxy *memoryProxy, rcti *rect)
   this->m_buffer = (float *)MEM_mallocN_aligned(
       sizeof(float) * determineBufferSize() * this->m_num_channels, 16, "COM_MemoryBuffer");
   this->m_state = COM_MB_TEMPORARILY;
+  this->m_half_buffer = nullptr;
+  this->m_is_a_single_elem = false;
   this->m_datatype = memoryProxy->getDataType();
 }
 MemoryBuffer::MemoryBuffer(DataType dataType, rcti *rect)
@@ -89,21 +158,153 @@ MemoryBuffer::MemoryBuffer(DataType dataType, rcti *rect)
   this->m_buffer = (float *)MEM_mallocN_aligned(
       sizeof(float) * determineBufferSize() * this->m_num_channels, 16, "COM_MemoryBuffer");
   this->m_state = COM_MB_TEMPORARILY;
+  this->m_half_buffer = nullptr;
+  this->m_is_a_single_elem = false;
   this->m_datatype = dataType;
 }
 MemoryBuffer *MemoryBuffer::duplicate()
 {
+  BLI_assert(!isPacked());
   MemoryBuffer *result = new MemoryBuffer(this->m_memoryProxy, &this->m_rect);
   memcpy(result->m_buffer,
          this->m_buffer,
          this->determineBufferSize() * this->m_num_channels * sizeof(float));
   return result;
 }
+const float *MemoryBuffer::readRow(int x, int y, int length, float *r_row)
+{
+  if (y >= m_rect.ymin && y < m_rect.ymax && x >= m_rect.xmin && x + length <= m_rect.xmax) {
+    if (!isPacked()) {
+      return this->getElem(x, y);
+    }
+    readElems(x, y, length, r_row);
+    return r_row;
+  }
+
+  memset(r_row, 0, sizeof(float) * length * this->m_num_channels);
+  if (y >= m_rect.ymin && y < m_rect.ymax) {
+    const int xmin = max(x, m_rect.xmin);
+    const int xmax = min(x + length, m_rect.xmax);
+    if (xmin < xmax) {
+      readElems(xmin, y, xmax - xmin, &r_row[(xmin - x) * this->m_num_channels]);
+    }
+  }
+  return r_row;
+}
+
+/* Read elements inside the rect, in any storage. */
+void MemoryBuffer::readElems(int x, int y, int length, float *r_elems)
+{
+  const int num_channels = this->m_num_channels;
+  if (this->m_is_a_single_elem) {
+    for (int i = 0; i < length; i++) {
+      memcpy(&r_elems[i * num_channels], this->m_buffer, sizeof(float) * num_channels);
+    }
+    return;
+  }
+
+  const size_t offset = ((size_t)this->m_width * (y - m_rect.ymin) + (x - m_rect.xmin)) *
+                        num_channels;
+  if (this->m_half_buffer) {
+    const uint16_t *elems = &this->m_half_buffer[offset];
+    for (int i = 0; i < length * num_channels; i++) {
+      r_elems[i] = half_to_float(elems[i]);
+    }
+    return;
+  }
+  memcpy(r_elems, &this->m_buffer[offset], sizeof(float) * length * num_channels);
+}
+
+void MemoryBuffer::pack(bool use_single_elem, bool use_half_float)
+{
+  BLI_assert(!isPacked());
+  const size_t num_elems = determineBufferSize();
+  const int num_channels = this->m_num_channels;
+  if (num_elems == 0) {
+    return;
+  }
+
+  bool is_a_single_elem = use_single_elem;
+  for (size_t i = 1; is_a_single_elem && i < num_elems; i++) {
+    if (memcmp(&this->m_buffer[i * num_channels], this->m_buffer, sizeof(float) * num_channels)) {
+      is_a_single_elem = false;
+      break;
+    }
+  }
+  if (is_a_single_elem) {
+    float *elem = (float *)MEM_mallocN_aligned(
+        sizeof(float) * num_channels, 16, "COM_MemoryBuffer");
+    memcpy(elem, this->m_buffer, sizeof(float) * num_channels);
+    MEM_freeN(this->m_buffer);
+    this->m_buffer = elem;
+    this->m_is_a_single_elem = true;
+    return;
+  }
+
+  if (!use_half_float || this->m_datatype == COM_DT_VALUE) {
+    return;
+  }
+  const size_t row_size = (size_t)this->m_width * num_channels;
+  uint16_t *half_buffer = (uint16_t *)MEM_mallocN_aligned(
+      sizeof(uint16_t) * num_elems * num_channels, 16, "COM_MemoryBuffer half");
+  blender::parallel_for(blender::IndexRange(this->m_height),
+                        COM_PACK_GRAIN_SIZE,
+                        [&](const blender::IndexRange rows) {
+                          for (const int64_t y : rows) {
+                            const float *src = &this->m_buffer[y * row_size];
+                            uint16_t *dst = &half_buffer[y * row_size];
+                            for (size_t i = 0; i < row_size; i++) {
+                              dst[i] = float_to_half(src[i]);
+                            }
+                          }
+                        });
+  MEM_freeN(this->m_buffer);
+  this->m_buffer = nullptr;
+  this->m_half_buffer = half_buffer;
+}
+
+MemoryBuffer *MemoryBuffer::inflate()
+{
+  MemoryBuffer *result = new MemoryBuffer(this->m_datatype, &this->m_rect);
+  blender::parallel_for(
+      blender::IndexRange(m_rect.ymin, this->m_height),
+      COM_PACK_GRAIN_SIZE,
+      [&](const blender::IndexRange rows) {
+        for (const int64_t y : rows) {
+          readElems(m_rect.xmin, y, this->m_width, result->getElem(m_rect.xmin, y));
+        }
+      });
+  return result;
+}
+
+size_t MemoryBuffer::getMemorySize() const
+{
+  if (this->m_is_a_single_elem) {
+    return sizeof(float) * this->m_num_channels;
+  }
+  const size_t num_values = (size_t)this->m_width * this->m_height * this->m_num_channels;
+  return num_values * (this->m_half_buffer ? sizeof(uint16_t) : sizeof(float));
+}
+
 void MemoryBuffer::clear()
 {
   memset(this->m_buffer, 0, this->determineBufferSize() * this->m_num_channels * sizeof(float));
 }
 
+void MemoryBuffer::fill(const rcti *area, const float *value)
+{
+  const int num_channels = this->m_num_channels;
+  for (int y = area->ymin; y < area->ymax; y++) {
+    float *elem = this->getElem(area->xmin, y);
+    for (int x = area->xmin; x < area->xmax; x++) {
+      for (int c = 0; c < num_channels; c++) {
+        elem[c] = value[c];
+      }
+      elem += num_channels;
+    }
+  }
+}
+
 float MemoryBuffer::getMaximumValue()
 {
   float result = this->m_buffer[0];
@@ -147,6 +348,10 @@ MemoryBuffer::~MemoryBuffer()
     MEM_freeN(this->m_buffer);
     this->m_buffer = nullptr;
   }
+  if (this->m_half_buffer) {
+    MEM_freeN(this->m_half_buffer);
+    this->m_half_buffer = nullptr;
+  }
 }
 
 void MemoryBuffer::copyContentFrom(MemoryBuffer *otherBuffer)
@@ -155,6 +360,7 @@ void MemoryBuffer::copyContentFrom(MemoryBuffer *otherBuffer)
     BLI_assert(0);
     return;
   }
+  BLI_assert(!isPacked());
   unsigned int otherY;
   unsigned int minX = max(this->m_rect.xmin, otherBuffer->m_rect.xmin);
   unsigned int maxX = min(this->m_rect.xmax, otherBuffer->m_rect.xmax);
@@ -164,11 +370,15 @@ void MemoryBuffer::copyContentFrom(MemoryBuffer *otherBuffer)
   int otherOffset;
 
   for (otherY = minY; otherY < maxY; otherY++) {
+    offset = ((otherY - this->m_rect.ymin) * this->m_width + minX - this->m_rect.xmin) *
+             this->m_num_channels;
+    if (otherBuffer->isPacked()) {
+      otherBuffer->readElems(minX, otherY, maxX - minX, &this->m_buffer[offset]);
+      continue;
+    }
     otherOffset = ((otherY - otherBuffer->m_rect.ymin) * otherBuffer->m_width + minX -
                    otherBuffer->m_rect.xmin) *
                   this->m_num_channels;
-    offset = ((otherY - this->m_rect.ymin) * this->m_width + minX - this->m_rect.xmin) *
-             this->m_num_channels;
     memcpy(&this->m_buffer[offset],
            &otherBuffer->m_buffer[otherOffset],
            (maxX - minX) * this->m_num_channels * sizeof(float));
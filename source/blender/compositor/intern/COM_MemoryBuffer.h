@@ -82,9 +82,21 @@ class MemoryBuffer {
 
   /**
    * \brief the actual float buffer/data
+   * A single element when the buffer is packed as a single element, nullptr when it is packed as
+   * half floats.
    */
   float *m_buffer;
 
+  /**
+   * \brief the data as half floats, only set when the buffer is packed as half floats
+   */
+  uint16_t *m_half_buffer;
+
+  /**
+   * \brief all elements of the buffer are the same, only a single element is stored
+   */
+  bool m_is_a_single_elem;
+
   /**
    * \brief the number of channels of a single value in the buffer.
    * For value buffers this is 1, vector 3 and color 4
@@ -134,9 +146,60 @@ class MemoryBuffer {
    */
   float *getBuffer()
   {
+    BLI_assert(!isPacked());
     return this->m_buffer;
   }
 
+  /**
+   * \brief get the element at the given coordinates
+   * \note coordinates must be inside the rect of this MemoryBuffer
+   */
+  float *getElem(int x, int y)
+  {
+    BLI_assert(!isPacked());
+    BLI_assert(x >= m_rect.xmin && x < m_rect.xmax && y >= m_rect.ymin && y < m_rect.ymax);
+    const int offset = (this->m_width * (y - m_rect.ymin) + (x - m_rect.xmin)) *
+                       this->m_num_channels;
+    return &this->m_buffer[offset];
+  }
+
+  /**
+   * \brief get a row of elements for reading
+   * When the row is inside this MemoryBuffer the returned row points to its data, otherwise the
+   * row is read into r_row, with elements outside of this MemoryBuffer being zero.
+   * Packed buffers are always read into r_row, this is the only way to read them in place.
+   * \param r_row: storage for length elements
+   */
+  const float *readRow(int x, int y, int length, float *r_row);
+
+  /**
+   * \brief is the data stored as a single element or as half floats
+   * Packed buffers can only be read with readRow, or after inflating them.
+   * \see pack
+   */
+  bool isPacked() const
+  {
+    return this->m_is_a_single_elem || this->m_half_buffer != nullptr;
+  }
+
+  /**
+   * \brief reduce the memory of a buffer which is only read from now on
+   * When use_single_elem is set and all elements are the same only a single element is kept.
+   * Otherwise color and vector buffers are stored as half floats when use_half_float is set.
+   * Value buffers stay float, they contain depths which don't fit in half floats.
+   */
+  void pack(bool use_single_elem, bool use_half_float);
+
+  /**
+   * \brief create an unpacked copy of this buffer
+   */
+  MemoryBuffer *inflate();
+
+  /**
+   * \brief size of the allocated data in bytes
+   */
+  size_t getMemorySize() const;
+
   /**
    * \brief after execution the state will be set to available by calling this method
    */
@@ -344,6 +407,12 @@ class MemoryBuffer {
    */
   void clear();
 
+  /**
+   * \brief set all elements in an area to the same value
+   * \param value: a single element, with the number of channels of this MemoryBuffer
+   */
+  void fill(const rcti *area, const float *value);
+
   MemoryBuffer *duplicate();
 
   float getMaximumValue();
@@ -351,6 +420,7 @@ class MemoryBuffer {
 
  private:
   unsigned int determineBufferSize();
+  void readElems(int x, int y, int length, float *r_elems);
 
 #ifdef WITH_CXX_GUARDEDALLOC
   MEM_CXX_CLASS_ALLOC_FUNCS("COM:MemoryBuffer")
@@ -19,6 +19,9 @@
 #include <stdio.h>
 #include <typeinfo>
 
+#include "BLI_task.hh"
+
+#include "COM_BufferOperation.h"
 #include "COM_ExecutionSystem.h"
 #include "COM_defines.h"
 
@@ -36,6 +39,7 @@ NodeOperation::NodeOperation()
   this->m_height = 0;
   this->m_isResolutionSet = false;
   this->m_openCL = false;
+  this->m_fullFrame = false;
   this->m_btree = nullptr;
 }
 
@@ -134,6 +138,121 @@ void NodeOperation::deinitExecution()
 {
   /* pass */
 }
+
+void NodeOperation::getAreaOfInterest(int inputIndex, const rcti *outputArea, rcti *r_inputArea)
+{
+  if (this->m_fullFrame) {
+    *r_inputArea = *outputArea;
+  }
+  else {
+    /* Pixels of the inputs are read through the pixel execution, which can read anywhere. */
+    NodeOperation *inputOperation = this->getInputOperation(inputIndex);
+    BLI_rcti_init(r_inputArea, 0, inputOperation->getWidth(), 0, inputOperation->getHeight());
+  }
+}
+
+/* Render an area in bands of rows from multiple threads. Bands have a minimum number of pixels,
+ * so small areas are not split up. */
+template<typename Function> static void render_rows_parallel(const rcti *area, const Function &fn)
+{
+  const int width = BLI_rcti_size_x(area);
+  const int height = BLI_rcti_size_y(area);
+  if (width <= 0 || height <= 0) {
+    return;
+  }
+  const int grain_size = max(1, COM_FULL_FRAME_BAND_PIXELS / width);
+  blender::parallel_for(
+      blender::IndexRange(area->ymin, height), grain_size, [&](const blender::IndexRange rows) {
+        rcti rect;
+        BLI_rcti_init(&rect, area->xmin, area->xmax, rows.first(), rows.one_after_last());
+        fn(&rect);
+      });
+}
+
+void NodeOperation::render(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs)
+{
+  if (!this->m_fullFrame) {
+    renderFullFrameFallback(output, area, inputs);
+    return;
+  }
+
+  initExecution();
+  render_rows_parallel(area, [&](rcti *rect) { updateMemoryBuffer(output, rect, inputs); });
+  deinitExecution();
+}
+
+void NodeOperation::renderFullFrameFallback(MemoryBuffer *output,
+                                            const rcti *area,
+                                            MemoryBuffer **inputs)
+{
+  /* Temporarily link the inputs to operations reading the input buffers, like the read buffer
+   * operations of the tiled execution model. */
+  std::vector<NodeOperationOutput *> links(m_inputs.size(), nullptr);
+  std::vector<BufferOperation *> bufferOperations;
+  for (unsigned int index = 0; index < m_inputs.size(); index++) {
+    NodeOperationInput *input = m_inputs[index];
+    if (!input->isConnected() || inputs[index] == nullptr) {
+      continue;
+    }
+    /* Operations reading pixel by pixel need the input as floats, the full frame execution model
+     * doesn't pack their inputs. */
+    BLI_assert(!inputs[index]->isPacked());
+    links[index] = input->getLink();
+    BufferOperation *bufferOperation = new BufferOperation(inputs[index],
+                                                           links[index]->getDataType());
+    input->setLink(bufferOperation->getOutputSocket());
+    bufferOperations.push_back(bufferOperation);
+  }
+
+  initExecution();
+  const bool isOutput = m_outputs.empty();
+  render_rows_parallel(area, [&](rcti *rect) {
+    if (isOutput) {
+      executeRegion(rect, 0);
+    }
+    else {
+      renderTile(output, rect);
+    }
+  });
+  deinitExecution();
+
+  for (unsigned int index = 0; index < m_inputs.size(); index++) {
+    if (links[index]) {
+      m_inputs[index]->setLink(links[index]);
+    }
+  }
+  for (BufferOperation *bufferOperation : bufferOperations) {
+    delete bufferOperation;
+  }
+}
+
+void NodeOperation::renderTile(MemoryBuffer *output, rcti *rect)
+{
+  const int num_channels = output->get_num_channels();
+  void *data = this->m_complex ? initializeTileData(rect) : nullptr;
+  for (int y = rect->ymin; y < rect->ymax; y++) {
+    float *elem = output->getElem(rect->xmin, y);
+    if (this->m_complex) {
+      for (int x = rect->xmin; x < rect->xmax; x++) {
+        read(elem, x, y, data);
+        elem += num_channels;
+      }
+    }
+    else {
+      for (int x = rect->xmin; x < rect->xmax; x++) {
+        readSampled(elem, x, y, COM_PS_NEAREST);
+        elem += num_channels;
+      }
+    }
+    if (isBraked()) {
+      break;
+    }
+  }
+  if (data) {
+    deinitializeTileData(rect, data);
+  }
+}
+
 SocketReader *NodeOperation::getInputSocketReader(unsigned int inputSocketIndex)
 {
   return this->getInputSocket(inputSocketIndex)->getReader();
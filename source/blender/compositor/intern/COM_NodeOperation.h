@@ -29,6 +29,7 @@
 #include "COM_MemoryBuffer.h"
 #include "COM_MemoryProxy.h"
 #include "COM_Node.h"
+#include "COM_ResultCache.h"
 #include "COM_SocketReader.h"
 
 #include "clew.h"
@@ -102,6 +103,12 @@ class NodeOperation : public SocketReader {
    */
   bool m_openCL;
 
+  /**
+   * \brief does this operation implement updateMemoryBuffer.
+   * \see NodeOperation.updateMemoryBuffer
+   */
+  bool m_fullFrame;
+
   /**
    * \brief mutex reference for very special node initializations
    * \note only use when you really know what you are doing.
@@ -245,6 +252,52 @@ class NodeOperation : public SocketReader {
   }
   virtual void deinitExecution();
 
+  /**
+   * \brief get the area of an input which is needed to render an area of this operation
+   * \note only used by the full frame execution model
+   * \param inputIndex: the index of the input socket
+   * \param outputArea: the area of this operation to render
+   * \param r_inputArea: the result area of the input operation
+   */
+  virtual void getAreaOfInterest(int inputIndex, const rcti *outputArea, rcti *r_inputArea);
+
+  /**
+   * \brief render an area of the result of this operation at once
+   * \ingroup execution
+   * \note only called for full frame operations, from multiple threads for different areas.
+   * Operations implementing this process their area row by row, so inner loops run over
+   * contiguous elements of the buffers.
+   * \param output: buffer of the whole result of this operation, nullptr for output operations
+   * \param area: the area to render
+   * \param inputs: buffers of the input operations, in order of the input sockets
+   */
+  virtual void updateMemoryBuffer(MemoryBuffer * /*output*/,
+                                  const rcti * /*area*/,
+                                  MemoryBuffer ** /*inputs*/)
+  {
+  }
+
+  /**
+   * \brief add the parameters which determine the result of this operation to a hash
+   * \note only used by the full frame execution model. The hash of a result combines the type,
+   * resolution and parameters of the operation with the hashes of its inputs.
+   * \return false when the result depends on data which isn't hashed, like images or the scene.
+   * These results, and results computed from them, are never cached.
+   * \see ResultCache
+   */
+  virtual bool hashParams(OperationHash & /*hash*/)
+  {
+    return false;
+  }
+
+  /**
+   * \brief render an area of this operation in the full frame execution model
+   * Initializes this operation, renders the area and deinitializes it again. Operations which are
+   * not full frame operations are rendered pixel by pixel, while reading from the input buffers.
+   * \see FullFrameExecutionModel
+   */
+  void render(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
+
   bool isResolutionSet()
   {
     return this->m_isResolutionSet;
@@ -343,6 +396,15 @@ class NodeOperation : public SocketReader {
     return this->m_openCL;
   }
 
+  /**
+   * \brief does this NodeOperation render whole areas at once in the full frame execution model
+   * \see NodeOperation.updateMemoryBuffer
+   */
+  bool isFullFrameOperation() const
+  {
+    return this->m_fullFrame;
+  }
+
   virtual bool isViewerOperation() const
   {
     return false;
@@ -420,6 +482,19 @@ class NodeOperation : public SocketReader {
     this->m_openCL = openCL;
   }
 
+  /**
+   * \brief set if this NodeOperation implements updateMemoryBuffer
+   * \note subclasses overriding the pixel execution must implement updateMemoryBuffer as well
+   */
+  void setFullFrame(bool fullFrame)
+  {
+    this->m_fullFrame = fullFrame;
+  }
+
+ private:
+  void renderFullFrameFallback(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
+  void renderTile(MemoryBuffer *output, rcti *rect);
+
   /* allow the DebugInfo class to look at internals */
   friend class DebugInfo;
 
@@ -104,8 +104,13 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
 
   determineResolutions();
 
-  /* surround complex ops with read/write buffer */
-  add_complex_operation_buffers();
+  const bool full_frame = m_context->getExecutionModel() == COM_EXECUTION_MODEL_FULL_FRAME;
+
+  /* surround complex ops with read/write buffer,
+   * not needed when every operation renders into a buffer */
+  if (!full_frame) {
+    add_complex_operation_buffers();
+  }
 
   /* links not available from here on */
   /* XXX make m_links a local variable to avoid confusion! */
@@ -116,8 +121,10 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
   /* ensure topological (link-based) order of nodes */
   /*sort_operations();*/ /* not needed yet */
 
-  /* create execution groups */
-  group_operations();
+  /* create execution groups, the full frame execution model has none */
+  if (!full_frame) {
+    group_operations();
+  }
 
   /* transfer resulting operations to the system */
   system->set_operations(m_operations, m_groups);
@@ -65,6 +65,12 @@ void OpenCLDevice::execute(WorkPackage *work)
   ExecutionGroup *executionGroup = work->getExecutionGroup();
   rcti rect;
 
+  /* After a break the chunk is still finalized, to release the chunks that wait for it. */
+  if (executionGroup->getOutputOperation()->isBraked()) {
+    executionGroup->finalizeChunkExecution(chunkNumber, nullptr);
+    return;
+  }
+
   executionGroup->determineChunkRect(&rect, chunkNumber);
   MemoryBuffer **inputBuffers = executionGroup->getInputBuffersOpenCL(chunkNumber);
   MemoryBuffer *outputBuffer = executionGroup->allocateOutputBuffer(chunkNumber, &rect);
@@ -0,0 +1,157 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2021, Blender Foundation.
+ */
+
+#include <list>
+#include <unordered_map>
+
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "COM_MemoryBuffer.h"
+#include "COM_ResultCache.h"
+
+namespace {
+
+struct CacheEntry {
+  MemoryBuffer *buffer;
+  /** Rendered area of the buffer, the rest is cleared. */
+  rcti area;
+  size_t size;
+  /** Used by the current execution, the buffer can't be freed before it ends. */
+  bool used;
+  /** Position in the least recently used order. */
+  std::list<uint64_t>::iterator order;
+};
+
+}  // namespace
+
+/* Executions are serialized by COM_execute, the mutex protects against the cache being cleared
+ * from other threads. */
+static ThreadMutex g_cacheMutex = BLI_MUTEX_INITIALIZER;
+static std::unordered_map<uint64_t, CacheEntry> g_entries;
+/** Hashes from least to most recently used. */
+static std::list<uint64_t> g_order;
+static size_t g_size = 0;
+static size_t g_limit = 0;
+static bool g_executing = false;
+
+static void remove_entry(std::unordered_map<uint64_t, CacheEntry>::iterator iter)
+{
+  CacheEntry &entry = iter->second;
+  g_size -= entry.size;
+  g_order.erase(entry.order);
+  delete entry.buffer;
+  g_entries.erase(iter);
+}
+
+/* Free the least recently used results which aren't used by the current execution until size
+ * more bytes fit in the cache. */
+static bool make_room(size_t size)
+{
+  if (size > g_limit) {
+    return false;
+  }
+  std::list<uint64_t>::iterator iter = g_order.begin();
+  while (g_size + size > g_limit && iter != g_order.end()) {
+    std::unordered_map<uint64_t, CacheEntry>::iterator entry = g_entries.find(*iter);
+    ++iter;
+    if (!entry->second.used) {
+      remove_entry(entry);
+    }
+  }
+  return g_size + size <= g_limit;
+}
+
+bool ResultCache::beginExecution(size_t limit)
+{
+  BLI_mutex_lock(&g_cacheMutex);
+  g_limit = limit;
+  g_executing = true;
+  make_room(0);
+  BLI_mutex_unlock(&g_cacheMutex);
+  return limit > 0;
+}
+
+void ResultCache::endExecution()
+{
+  BLI_mutex_lock(&g_cacheMutex);
+  for (std::pair<const uint64_t, CacheEntry> &item : g_entries) {
+    item.second.used = false;
+  }
+  g_executing = false;
+  make_room(0);
+  BLI_mutex_unlock(&g_cacheMutex);
+}
+
+MemoryBuffer *ResultCache::lookup(uint64_t hash, const rcti *area)
+{
+  BLI_mutex_lock(&g_cacheMutex);
+  MemoryBuffer *result = nullptr;
+  std::unordered_map<uint64_t, CacheEntry>::iterator iter = g_entries.find(hash);
+  if (iter != g_entries.end()) {
+    CacheEntry &entry = iter->second;
+    if (BLI_rcti_inside_rcti(&entry.area, area)) {
+      entry.used = true;
+      g_order.splice(g_order.end(), g_order, entry.order);
+      result = entry.buffer;
+    }
+  }
+  BLI_mutex_unlock(&g_cacheMutex);
+  return result;
+}
+
+bool ResultCache::store(uint64_t hash, MemoryBuffer *buffer, const rcti *area)
+{
+  BLI_mutex_lock(&g_cacheMutex);
+  std::unordered_map<uint64_t, CacheEntry>::iterator iter = g_entries.find(hash);
+  if (iter != g_entries.end()) {
+    if (iter->second.used) {
+      /* An operation with the same result is read by the current execution. */
+      BLI_mutex_unlock(&g_cacheMutex);
+      return false;
+    }
+    /* Cached for a smaller area. */
+    remove_entry(iter);
+  }
+
+  const size_t size = buffer->getMemorySize();
+  if (!make_room(size)) {
+    BLI_mutex_unlock(&g_cacheMutex);
+    return false;
+  }
+
+  CacheEntry &entry = g_entries[hash];
+  entry.buffer = buffer;
+  entry.area = *area;
+  entry.size = size;
+  entry.used = true;
+  entry.order = g_order.insert(g_order.end(), hash);
+  g_size += size;
+  BLI_mutex_unlock(&g_cacheMutex);
+  return true;
+}
+
+void ResultCache::clear()
+{
+  BLI_mutex_lock(&g_cacheMutex);
+  BLI_assert(!g_executing);
+  while (!g_entries.empty()) {
+    remove_entry(g_entries.begin());
+  }
+  BLI_mutex_unlock(&g_cacheMutex);
+}
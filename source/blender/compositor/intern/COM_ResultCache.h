@@ -0,0 +1,124 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2021, Blender Foundation.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "BLI_rect.h"
+
+#ifdef WITH_CXX_GUARDEDALLOC
+#  include "MEM_guardedalloc.h"
+#endif
+
+class MemoryBuffer;
+
+/**
+ * \brief identifies the result of an operation
+ * A 64 bit FNV-1a hash of the type, resolution and parameters of an operation and of the hashes
+ * of its inputs.
+ * \see NodeOperation.hashParams
+ * \ingroup Execution
+ */
+class OperationHash {
+ private:
+  uint64_t m_hash;
+
+ public:
+  OperationHash() : m_hash(0xcbf29ce484222325ull)
+  {
+  }
+
+  void add(const void *data, size_t size)
+  {
+    const unsigned char *bytes = (const unsigned char *)data;
+    for (size_t index = 0; index < size; index++) {
+      this->m_hash = (this->m_hash ^ bytes[index]) * 0x100000001b3ull;
+    }
+  }
+
+  template<typename T> void add(const T &value)
+  {
+    add(&value, sizeof(T));
+  }
+
+  void addString(const char *str)
+  {
+    /* Include the terminator, so consecutive strings can't be confused. */
+    add(str, str ? strlen(str) + 1 : 0);
+  }
+
+  uint64_t get() const
+  {
+    return this->m_hash;
+  }
+};
+
+/**
+ * \brief keeps results of operations between executions of the compositor
+ *
+ * Results are stored by the full frame execution model under the hash of the operation which
+ * rendered them. When a later execution has an operation with the same hash, its result is taken
+ * from the cache and none of its inputs are rendered, so only branches of the node tree which
+ * changed are evaluated again.
+ *
+ * The memory of the cache is limited by the user preferences. Results which weren't used for the
+ * longest time are freed first, but never those of the current execution.
+ *
+ * \see FullFrameExecutionModel
+ * \ingroup Execution
+ */
+class ResultCache {
+ public:
+  /**
+   * \brief start an execution of the compositor
+   * \param limit: maximum size of the cache in bytes, the cache is disabled when zero.
+   * \return whether the cache is enabled
+   */
+  static bool beginExecution(size_t limit);
+
+  /**
+   * \brief end an execution, results used by it can be freed again.
+   */
+  static void endExecution();
+
+  /**
+   * \brief get a cached result
+   * \return nullptr when there is no result for the hash, or when the cached result doesn't
+   * contain the area. The result is owned by the cache.
+   */
+  static MemoryBuffer *lookup(uint64_t hash, const rcti *area);
+
+  /**
+   * \brief store a result
+   * \param area: the area of the buffer which is rendered
+   * \return whether the cache took ownership of the buffer
+   */
+  static bool store(uint64_t hash, MemoryBuffer *buffer, const rcti *area);
+
+  /**
+   * \brief free all results, not allowed during an execution
+   */
+  static void clear();
+
+#ifdef WITH_CXX_GUARDEDALLOC
+  MEM_CXX_CLASS_ALLOC_FUNCS("COM:ResultCache")
+#endif
+};
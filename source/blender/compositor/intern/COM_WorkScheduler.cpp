@@ -29,6 +29,9 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
+#include "BLI_task.h"
 #include "BLI_threads.h"
 #include "PIL_time.h"
 
@@ -38,22 +41,40 @@
 #  ifndef DEBUG /* test this so we dont get warnings in debug builds */
 #    warning COM_CURRENT_THREADING_MODEL COM_TM_NOTHREAD is activated. Use only for debugging.
 #  endif
-#elif COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+#elif COM_CURRENT_THREADING_MODEL == COM_TM_TASK
 /* do nothing - default */
 #else
 #  error COM_CURRENT_THREADING_MODEL No threading model selected
 #endif
 
-/** \brief list of all CPUDevices. for every hardware thread an instance of CPUDevice is created */
+#if COM_CURRENT_THREADING_MODEL == COM_TM_TASK
+/** \brief number of threads the compositor may use, a single thread executes all work inline. */
+static int g_num_cpu_threads = 0;
+/**
+ * \brief all scheduled work for the CPU, executed by the threads of the task scheduler.
+ * Only used when the compositor may use all threads of the task scheduler.
+ */
+static TaskPool *g_cpupool;
+/**
+ * \brief all scheduled work for the CPU when the number of threads is limited, executed by a
+ * CPUDevice thread per CPU thread.
+ */
+static ThreadQueue *g_cpuqueue;
+/** \brief list of all CPUDevices of the limited number of threads. */
 static vector<CPUDevice *> g_cpudevices;
-static ThreadLocal(CPUDevice *) g_thread_device;
-
-#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
-/** \brief list of all thread for every CPUDevice in cpudevices a thread exists. */
+/** \brief list of all threads of the CPUDevices. */
 static ListBase g_cputhreads;
+/** \brief the CPUDevice of the current thread, when executed by g_cputhreads. */
+static ThreadLocal(CPUDevice *) g_thread_device;
 static bool g_cpuInitialized = false;
-/** \brief all scheduled work for the cpu */
-static ThreadQueue *g_cpuqueue;
+/**
+ * \brief number of scheduled work packages that are not executed yet.
+ * Executing a package can schedule the packages waiting on it, on either device type,
+ * so the execution is only finished when this drops to zero.
+ */
+static unsigned int g_numPendingPackages = 0;
+static ThreadMutex g_pendingMutex;
+static ThreadCondition g_pendingCondition;
 static ThreadQueue *g_gpuqueue;
 #  ifdef COM_OPENCL_ENABLED
 static cl_context g_context;
@@ -69,8 +90,26 @@ static bool g_openclInitialized = false;
 #  endif
 #endif
 
-#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
-void *WorkScheduler::thread_execute_cpu(void *data)
+#if COM_CURRENT_THREADING_MODEL == COM_TM_TASK
+static void work_package_finished()
+{
+  if (atomic_sub_and_fetch_u(&g_numPendingPackages, 1) == 0) {
+    BLI_mutex_lock(&g_pendingMutex);
+    BLI_condition_notify_all(&g_pendingCondition);
+    BLI_mutex_unlock(&g_pendingMutex);
+  }
+}
+
+void WorkScheduler::thread_execute_cpu(TaskPool *__restrict /*pool*/, void *taskdata)
+{
+  WorkPackage *work = (WorkPackage *)taskdata;
+  CPUDevice device(BLI_task_parallel_thread_id(nullptr));
+  device.execute(work);
+  delete work;
+  work_package_finished();
+}
+
+void *WorkScheduler::thread_execute_cpu_device(void *data)
 {
   CPUDevice *device = (CPUDevice *)data;
   WorkPackage *work;
@@ -78,7 +117,9 @@ void *WorkScheduler::thread_execute_cpu(void *data)
   while ((work = (WorkPackage *)BLI_thread_queue_pop(g_cpuqueue))) {
     device->execute(work);
     delete work;
+    work_package_finished();
   }
+  BLI_thread_local_set(g_thread_device, nullptr);
 
   return nullptr;
 }
@@ -91,6 +132,7 @@ void *WorkScheduler::thread_execute_gpu(void *data)
   while ((work = (WorkPackage *)BLI_thread_queue_pop(g_gpuqueue))) {
     device->execute(work);
     delete work;
+    work_package_finished();
   }
 
   return nullptr;
@@ -104,32 +146,55 @@ void WorkScheduler::schedule(ExecutionGroup *group, int chunkNumber)
   CPUDevice device(0);
   device.execute(package);
   delete package;
-#elif COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+#elif COM_CURRENT_THREADING_MODEL == COM_TM_TASK
 #  ifdef COM_OPENCL_ENABLED
   if (group->isOpenCL() && g_openclActive) {
+    atomic_add_and_fetch_u(&g_numPendingPackages, 1);
     BLI_thread_queue_push(g_gpuqueue, package);
+    return;
   }
-  else {
+#  endif
+  if (g_cpupool != nullptr) {
+    atomic_add_and_fetch_u(&g_numPendingPackages, 1);
+    BLI_task_pool_push(g_cpupool, thread_execute_cpu, package, false, nullptr);
+  }
+  else if (g_cpuqueue != nullptr) {
+    atomic_add_and_fetch_u(&g_numPendingPackages, 1);
     BLI_thread_queue_push(g_cpuqueue, package);
   }
-#  else
-  BLI_thread_queue_push(g_cpuqueue, package);
-#  endif
+  else {
+    /* Single threaded, the package is executed right away so chunks are executed in the order
+     * they are scheduled in. */
+    CPUDevice device(0);
+    device.execute(package);
+    delete package;
+  }
 #endif
 }
 
 void WorkScheduler::start(CompositorContext &context)
 {
-#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
-  unsigned int index;
-  g_cpuqueue = BLI_thread_queue_init();
-  BLI_threadpool_init(&g_cputhreads, thread_execute_cpu, g_cpudevices.size());
-  for (index = 0; index < g_cpudevices.size(); index++) {
-    Device *device = g_cpudevices[index];
-    BLI_threadpool_insert(&g_cputhreads, device);
+#if COM_CURRENT_THREADING_MODEL == COM_TM_TASK
+  g_numPendingPackages = 0;
+  BLI_mutex_init(&g_pendingMutex);
+  BLI_condition_init(&g_pendingCondition);
+  g_cpupool = nullptr;
+  g_cpuqueue = nullptr;
+  if (g_num_cpu_threads >= BLI_task_scheduler_num_threads() && g_num_cpu_threads > 1) {
+    /* All threads can be used, idle threads of the task scheduler steal work from busy ones. */
+    g_cpupool = BLI_task_pool_create(nullptr, TASK_PRIORITY_HIGH);
+  }
+  else if (g_num_cpu_threads > 1) {
+    /* The scene limits the number of threads, use a thread per CPUDevice. */
+    g_cpuqueue = BLI_thread_queue_init();
+    BLI_threadpool_init(&g_cputhreads, thread_execute_cpu_device, g_cpudevices.size());
+    for (CPUDevice *device : g_cpudevices) {
+      BLI_threadpool_insert(&g_cputhreads, device);
+    }
   }
 #  ifdef COM_OPENCL_ENABLED
   if (context.getHasActiveOpenCLDevices()) {
+    unsigned int index;
     g_gpuqueue = BLI_thread_queue_init();
     BLI_threadpool_init(&g_gputhreads, thread_execute_gpu, g_gpudevices.size());
     for (index = 0; index < g_gpudevices.size(); index++) {
@@ -141,32 +206,42 @@ void WorkScheduler::start(CompositorContext &context)
   else {
     g_openclActive = false;
   }
+#  else
+  UNUSED_VARS(context);
 #  endif
+#else
+  UNUSED_VARS(context);
 #endif
 }
 void WorkScheduler::finish()
 {
-#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
-#  ifdef COM_OPENCL_ENABLED
-  if (g_openclActive) {
-    BLI_thread_queue_wait_finish(g_gpuqueue);
-    BLI_thread_queue_wait_finish(g_cpuqueue);
+#if COM_CURRENT_THREADING_MODEL == COM_TM_TASK
+  /* Let this thread help with the CPU work, then wait for the packages that are executed by
+   * other threads or that are still to be scheduled by them. */
+  if (g_cpupool != nullptr) {
+    BLI_task_pool_work_and_wait(g_cpupool);
   }
-  else {
-    BLI_thread_queue_wait_finish(g_cpuqueue);
+
+  BLI_mutex_lock(&g_pendingMutex);
+  while (atomic_add_and_fetch_u(&g_numPendingPackages, 0) != 0) {
+    BLI_condition_wait(&g_pendingCondition, &g_pendingMutex);
   }
-#  else
-  BLI_thread_queue_wait_finish(cpuqueue);
-#  endif
+  BLI_mutex_unlock(&g_pendingMutex);
 #endif
 }
 void WorkScheduler::stop()
 {
-#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
-  BLI_thread_queue_nowait(g_cpuqueue);
-  BLI_threadpool_end(&g_cputhreads);
-  BLI_thread_queue_free(g_cpuqueue);
-  g_cpuqueue = nullptr;
+#if COM_CURRENT_THREADING_MODEL == COM_TM_TASK
+  if (g_cpupool != nullptr) {
+    BLI_task_pool_free(g_cpupool);
+    g_cpupool = nullptr;
+  }
+  if (g_cpuqueue != nullptr) {
+    BLI_thread_queue_nowait(g_cpuqueue);
+    BLI_threadpool_end(&g_cputhreads);
+    BLI_thread_queue_free(g_cpuqueue);
+    g_cpuqueue = nullptr;
+  }
 #  ifdef COM_OPENCL_ENABLED
   if (g_openclActive) {
     BLI_thread_queue_nowait(g_gpuqueue);
@@ -175,12 +250,14 @@ void WorkScheduler::stop()
     g_gpuqueue = nullptr;
   }
 #  endif
+  BLI_condition_end(&g_pendingCondition);
+  BLI_mutex_end(&g_pendingMutex);
 #endif
 }
 
 bool WorkScheduler::hasGPUDevices()
 {
-#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+#if COM_CURRENT_THREADING_MODEL == COM_TM_TASK
 #  ifdef COM_OPENCL_ENABLED
   return !g_gpudevices.empty();
 #  else
@@ -191,7 +268,7 @@ bool WorkScheduler::hasGPUDevices()
 #endif
 }
 
-#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+#if COM_CURRENT_THREADING_MODEL == COM_TM_TASK
 static void CL_CALLBACK clContextError(const char *errinfo,
                                        const void * /*private_info*/,
                                        size_t /*cb*/,
@@ -203,32 +280,24 @@ static void CL_CALLBACK clContextError(const char *errinfo,
 
 void WorkScheduler::initialize(bool use_opencl, int num_cpu_threads)
 {
-#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
-  /* deinitialize if number of threads doesn't match */
-  if (g_cpudevices.size() != num_cpu_threads) {
-    Device *device;
-
+#if COM_CURRENT_THREADING_MODEL == COM_TM_TASK
+  /* CPUDevices are only needed when the number of threads is limited, otherwise the CPU work is
+   * executed by the threads of the task scheduler. */
+  if (!g_cpuInitialized) {
+    BLI_thread_local_create(g_thread_device);
+    g_cpuInitialized = true;
+  }
+  if (g_num_cpu_threads != num_cpu_threads) {
     while (!g_cpudevices.empty()) {
-      device = g_cpudevices.back();
+      delete g_cpudevices.back();
       g_cpudevices.pop_back();
-      device->deinitialize();
-      delete device;
     }
-    if (g_cpuInitialized) {
-      BLI_thread_local_delete(g_thread_device);
-    }
-    g_cpuInitialized = false;
-  }
-
-  /* initialize CPU threads */
-  if (!g_cpuInitialized) {
-    for (int index = 0; index < num_cpu_threads; index++) {
-      CPUDevice *device = new CPUDevice(index);
-      device->initialize();
-      g_cpudevices.push_back(device);
+    g_num_cpu_threads = num_cpu_threads;
+    if (num_cpu_threads > 1 && num_cpu_threads < BLI_task_scheduler_num_threads()) {
+      for (int index = 0; index < num_cpu_threads; index++) {
+        g_cpudevices.push_back(new CPUDevice(index));
+      }
     }
-    BLI_thread_local_create(g_thread_device);
-    g_cpuInitialized = true;
   }
 
 #  ifdef COM_OPENCL_ENABLED
@@ -325,16 +394,13 @@ void WorkScheduler::initialize(bool use_opencl, int num_cpu_threads)
 
 void WorkScheduler::deinitialize()
 {
-#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
-  /* deinitialize CPU threads */
+#if COM_CURRENT_THREADING_MODEL == COM_TM_TASK
+  while (!g_cpudevices.empty()) {
+    delete g_cpudevices.back();
+    g_cpudevices.pop_back();
+  }
+  g_num_cpu_threads = 0;
   if (g_cpuInitialized) {
-    Device *device;
-    while (!g_cpudevices.empty()) {
-      device = g_cpudevices.back();
-      g_cpudevices.pop_back();
-      device->deinitialize();
-      delete device;
-    }
     BLI_thread_local_delete(g_thread_device);
     g_cpuInitialized = false;
   }
@@ -364,8 +430,31 @@ void WorkScheduler::deinitialize()
 #endif
 }
 
+int WorkScheduler::get_num_cpu_threads()
+{
+#if COM_CURRENT_THREADING_MODEL == COM_TM_TASK
+  if (g_cpupool != nullptr) {
+    return BLI_task_scheduler_num_threads();
+  }
+  return g_num_cpu_threads > 1 ? g_num_cpu_threads : 1;
+#else
+  return 1;
+#endif
+}
+
 int WorkScheduler::current_thread_id()
 {
-  CPUDevice *device = (CPUDevice *)BLI_thread_local_get(g_thread_device);
-  return device->thread_id();
+#if COM_CURRENT_THREADING_MODEL == COM_TM_TASK
+  if (g_cpupool == nullptr && g_cpuInitialized) {
+    CPUDevice *device = (CPUDevice *)BLI_thread_local_get(g_thread_device);
+    if (device != nullptr) {
+      return device->thread_id();
+    }
+  }
+  /* Task pool threads, and the threads rendering rows of the full frame execution model which
+   * have no CPU device. */
+  return BLI_task_parallel_thread_id(nullptr);
+#else
+  return 0;
+#endif
 }
@@ -20,6 +20,7 @@
 
 #include "COM_ExecutionGroup.h"
 
+#include "BLI_task.h"
 #include "BLI_threads.h"
 
 #include "COM_Device.h"
@@ -31,17 +32,18 @@
  */
 class WorkScheduler {
 
-#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+#if COM_CURRENT_THREADING_MODEL == COM_TM_TASK
   /**
-   * \brief are we being stopped.
+   * \brief task of the cpu work
+   * executes a single WorkPackage on the thread that picked it up from the task pool
    */
-  static bool isStopping();
+  static void thread_execute_cpu(TaskPool *__restrict pool, void *taskdata);
 
   /**
-   * \brief main thread loop for cpudevices
+   * \brief main thread loop for cpudevices, when the number of threads is limited
    * inside this loop new work is queried and being executed
    */
-  static void *thread_execute_cpu(void *data);
+  static void *thread_execute_cpu_device(void *data);
 
   /**
    * \brief main thread loop for gpudevices
@@ -52,9 +54,10 @@ class WorkScheduler {
  public:
   /**
    * \brief schedule a chunk of a group to be calculated.
-   * An execution group schedules a chunk in the WorkScheduler
+   * An execution group schedules a chunk in the WorkScheduler when all its input chunks are
+   * executed. This can happen from any thread, also from the device executing an input chunk.
    * when ExecutionGroup.isOpenCL is set the work will be handled by a OpenCLDevice
-   * otherwise the work is scheduled for an CPUDevice
+   * otherwise the work is pushed to the task pool of the CPU, where idle threads steal it
    * \see ExecutionGroup.execute
    * \param group: the execution group
    * \param chunkNumber: the number of the chunk in the group to be executed
@@ -64,12 +67,11 @@ class WorkScheduler {
   /**
    * \brief initialize the WorkScheduler
    *
-   * during initialization the mutexes are initialized.
-   * there are two mutexes (for every device type one)
-   * After mutex initialization the system is queried in order to count the number of CPUDevices
-   * and GPUDevices to be created. For every hardware thread a CPUDevice and for every OpenCL GPU
-   * device a OpenCLDevice is created. these devices are stored in a separate list (cpudevices &
-   * gpudevices)
+   * When num_cpu_threads covers all threads of the task scheduler, the CPU work is executed by
+   * those threads and a CPUDevice is created per executed WorkPackage. A lower number of threads
+   * (a fixed thread count of the scene) creates a CPUDevice with its own thread per CPU thread.
+   * When num_cpu_threads is one all CPU work is executed in the calling thread. For every OpenCL
+   * GPU device a OpenCLDevice is created and stored in a list (gpudevices).
    *
    * This function can be called multiple times to lazily initialize OpenCL.
    */
@@ -83,8 +85,8 @@ class WorkScheduler {
 
   /**
    * \brief Start the execution
-   * this methods will start the WorkScheduler. Inside this method all threads are initialized.
-   * for every device a thread is created.
+   * this methods will start the WorkScheduler. Inside this method the task pool of the CPU work
+   * is created and for every OpenCL device a thread is created.
    * \see initialize Initialization and query of the number of devices
    */
   static void start(CompositorContext &context);
@@ -98,6 +100,8 @@ class WorkScheduler {
 
   /**
    * \brief wait for all work to be completed.
+   * This includes work that is scheduled while waiting, when chunks waiting on executed chunks
+   * become ready.
    */
   static void finish();
 
@@ -109,6 +113,14 @@ class WorkScheduler {
    */
   static bool hasGPUDevices();
 
+  /**
+   * \brief number of threads executing the CPU work
+   */
+  static int get_num_cpu_threads();
+
+  /**
+   * \brief index of the thread executing CPU work, smaller than BLENDER_MAX_THREADS
+   */
   static int current_thread_id();
 
 #ifdef WITH_CXX_GUARDEDALLOC
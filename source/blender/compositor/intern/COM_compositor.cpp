@@ -17,6 +17,7 @@
  */
 
 #include "BLI_threads.h"
+#include "BLI_timeit.hh"
 
 #include "BLT_translation.h"
 
@@ -25,6 +26,7 @@
 
 #include "COM_ExecutionSystem.h"
 #include "COM_MovieDistortionOperation.h"
+#include "COM_ResultCache.h"
 #include "COM_WorkScheduler.h"
 #include "COM_compositor.h"
 #include "clew.h"
@@ -50,6 +52,8 @@ void COM_execute(RenderData *rd,
 
   BLI_mutex_lock(&s_compositorMutex);
 
+  TRACE_SCOPE("compositor", "Compositing");
+
   if (editingtree->test_break(editingtree->tbh)) {
     // during editing multiple calls to this method can be triggered.
     // make sure one the last one will be doing the work.
@@ -108,11 +112,22 @@ void COM_execute(RenderData *rd,
   BLI_mutex_unlock(&s_compositorMutex);
 }
 
+void COM_clearCaches()
+{
+  /* The cache is only filled by executions, which initialize the mutex. */
+  if (is_compositorMutex_init) {
+    BLI_mutex_lock(&s_compositorMutex);
+    ResultCache::clear();
+    BLI_mutex_unlock(&s_compositorMutex);
+  }
+}
+
 void COM_deinitialize()
 {
   if (is_compositorMutex_init) {
     BLI_mutex_lock(&s_compositorMutex);
     WorkScheduler::deinitialize();
+    ResultCache::clear();
     is_compositorMutex_init = false;
     BLI_mutex_unlock(&s_compositorMutex);
     BLI_mutex_end(&s_compositorMutex);
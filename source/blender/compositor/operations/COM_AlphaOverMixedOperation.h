@@ -43,4 +43,10 @@ class AlphaOverMixedOperation : public MixBaseOperation {
   {
     this->m_x = x;
   }
+
+  bool hashParams(OperationHash &hash)
+  {
+    hash.add(this->m_x);
+    return MixBaseOperation::hashParams(hash);
+  }
 };
@@ -18,9 +18,15 @@
 
 #include "COM_AlphaOverPremultiplyOperation.h"
 
+#include "BLI_math.h"
+
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 AlphaOverPremultiplyOperation::AlphaOverPremultiplyOperation()
 {
-  /* pass */
+  this->setFullFrame(true);
 }
 
 void AlphaOverPremultiplyOperation::executePixelSampled(float output[4],
@@ -52,3 +58,33 @@ void AlphaOverPremultiplyOperation::executePixelSampled(float output[4],
     output[3] = (mul * inputColor1[3]) + value[0] * inputOverColor[3];
   }
 }
+
+void AlphaOverPremultiplyOperation::updateMemoryBufferRow(
+    float *output, const float *value, const float *color1, const float *color2, int length)
+{
+  for (int i = 0; i < length; i++) {
+    const float *over = color2;
+    if (over[3] < 0.0f) {
+      copy_v4_v4(output, color1);
+    }
+    else if (value[i] == 1.0f && over[3] >= 1.0f) {
+      copy_v4_v4(output, over);
+    }
+    else {
+      const float mul = 1.0f - value[i] * over[3];
+#ifdef __SSE2__
+      _mm_storeu_ps(output,
+                    _mm_add_ps(_mm_mul_ps(_mm_set1_ps(mul), _mm_loadu_ps(color1)),
+                               _mm_mul_ps(_mm_set1_ps(value[i]), _mm_loadu_ps(over))));
+#else
+      output[0] = (mul * color1[0]) + value[i] * over[0];
+      output[1] = (mul * color1[1]) + value[i] * over[1];
+      output[2] = (mul * color1[2]) + value[i] * over[2];
+      output[3] = (mul * color1[3]) + value[i] * over[3];
+#endif
+    }
+    output += 4;
+    color1 += 4;
+    color2 += 4;
+  }
+}
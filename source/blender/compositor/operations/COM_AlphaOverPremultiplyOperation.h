@@ -35,4 +35,8 @@ class AlphaOverPremultiplyOperation : public MixBaseOperation {
    * the inner loop of this program
    */
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+ protected:
+  void updateMemoryBufferRow(
+      float *output, const float *value, const float *color1, const float *color2, int length);
 };
@@ -137,6 +137,12 @@ class BokehImageOperation : public NodeOperation {
     this->m_data = data;
   }
 
+  bool hashParams(OperationHash &hash)
+  {
+    hash.add(*this->m_data);
+    return true;
+  }
+
   /**
    * \brief deleteDataOnFinish
    *
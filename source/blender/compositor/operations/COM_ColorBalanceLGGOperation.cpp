@@ -44,6 +44,7 @@ ColorBalanceLGGOperation::ColorBalanceLGGOperation()
   this->m_inputValueOperation = nullptr;
   this->m_inputColorOperation = nullptr;
   this->setResolutionInputSocketIndex(1);
+  this->setFullFrame(true);
 }
 
 void ColorBalanceLGGOperation::initExecution()
@@ -79,6 +80,32 @@ void ColorBalanceLGGOperation::executePixelSampled(float output[4],
   output[3] = inputColor[3];
 }
 
+void ColorBalanceLGGOperation::updateMemoryBuffer(MemoryBuffer *output,
+                                                  const rcti *area,
+                                                  MemoryBuffer **inputs)
+{
+  const int width = BLI_rcti_size_x(area);
+  std::vector<float> value_row(width);
+  std::vector<float> color_row(width * COM_NUM_CHANNELS_COLOR);
+  for (int y = area->ymin; y < area->ymax; y++) {
+    const float *value = inputs[0]->readRow(area->xmin, y, width, value_row.data());
+    const float *color = inputs[1]->readRow(area->xmin, y, width, color_row.data());
+    float *out = output->getElem(area->xmin, y);
+    for (int i = 0; i < width; i++) {
+      const float fac = min(1.0f, value[i]);
+      const float mfac = 1.0f - fac;
+      for (int c = 0; c < 3; c++) {
+        out[c] = mfac * color[c] +
+                 fac * colorbalance_lgg(
+                           color[c], this->m_lift[c], this->m_gamma_inv[c], this->m_gain[c]);
+      }
+      out[3] = color[3];
+      out += 4;
+      color += 4;
+    }
+  }
+}
+
 void ColorBalanceLGGOperation::deinitExecution()
 {
   this->m_inputValueOperation = nullptr;
@@ -47,6 +47,8 @@ class ColorBalanceLGGOperation : public NodeOperation {
    */
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
 
+  void updateMemoryBuffer(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
+
   /**
    * Initialize the execution
    */
@@ -57,6 +59,14 @@ class ColorBalanceLGGOperation : public NodeOperation {
    */
   void deinitExecution();
 
+  bool hashParams(OperationHash &hash)
+  {
+    hash.add(this->m_gain);
+    hash.add(this->m_lift);
+    hash.add(this->m_gamma_inv);
+    return true;
+  }
+
   void setGain(const float gain[3])
   {
     copy_v3_v3(this->m_gain, gain);
@@ -36,6 +36,7 @@ ColorCurveOperation::ColorCurveOperation()
   this->m_inputWhiteProgram = nullptr;
 
   this->setResolutionInputSocketIndex(1);
+  this->setFullFrame(true);
 }
 void ColorCurveOperation::initExecution()
 {
@@ -87,6 +88,47 @@ void ColorCurveOperation::executePixelSampled(float output[4],
   output[3] = image[3];
 }
 
+void ColorCurveOperation::updateMemoryBuffer(MemoryBuffer *output,
+                                             const rcti *area,
+                                             MemoryBuffer **inputs)
+{
+  CurveMapping *cumap = this->m_curveMapping;
+  const int width = BLI_rcti_size_x(area);
+  std::vector<float> fac_row(width);
+  std::vector<float> image_row(width * COM_NUM_CHANNELS_COLOR);
+  std::vector<float> black_row(width * COM_NUM_CHANNELS_COLOR);
+  std::vector<float> white_row(width * COM_NUM_CHANNELS_COLOR);
+  for (int y = area->ymin; y < area->ymax; y++) {
+    const float *fac = inputs[0]->readRow(area->xmin, y, width, fac_row.data());
+    const float *image = inputs[1]->readRow(area->xmin, y, width, image_row.data());
+    const float *black = inputs[2]->readRow(area->xmin, y, width, black_row.data());
+    const float *white = inputs[3]->readRow(area->xmin, y, width, white_row.data());
+    float *out = output->getElem(area->xmin, y);
+    for (int i = 0; i < width; i++) {
+      if (fac[i] <= 0.0f) {
+        copy_v3_v3(out, image);
+      }
+      else {
+        float bwmul[3];
+        BKE_curvemapping_set_black_white_ex(black, white, bwmul);
+        if (fac[i] >= 1.0f) {
+          BKE_curvemapping_evaluate_premulRGBF_ex(cumap, out, image, black, bwmul);
+        }
+        else {
+          float col[4];
+          BKE_curvemapping_evaluate_premulRGBF_ex(cumap, col, image, black, bwmul);
+          interp_v3_v3v3(out, image, col, fac[i]);
+        }
+      }
+      out[3] = image[3];
+      out += 4;
+      image += 4;
+      black += 4;
+      white += 4;
+    }
+  }
+}
+
 void ColorCurveOperation::deinitExecution()
 {
   CurveBaseOperation::deinitExecution();
@@ -108,6 +150,7 @@ ConstantLevelColorCurveOperation::ConstantLevelColorCurveOperation()
   this->m_inputImageProgram = nullptr;
 
   this->setResolutionInputSocketIndex(1);
+  this->setFullFrame(true);
 }
 void ConstantLevelColorCurveOperation::initExecution()
 {
@@ -145,6 +188,37 @@ void ConstantLevelColorCurveOperation::executePixelSampled(float output[4],
   output[3] = image[3];
 }
 
+void ConstantLevelColorCurveOperation::updateMemoryBuffer(MemoryBuffer *output,
+                                                          const rcti *area,
+                                                          MemoryBuffer **inputs)
+{
+  CurveMapping *cumap = this->m_curveMapping;
+  const int width = BLI_rcti_size_x(area);
+  std::vector<float> fac_row(width);
+  std::vector<float> image_row(width * COM_NUM_CHANNELS_COLOR);
+  for (int y = area->ymin; y < area->ymax; y++) {
+    const float *fac = inputs[0]->readRow(area->xmin, y, width, fac_row.data());
+    const float *image = inputs[1]->readRow(area->xmin, y, width, image_row.data());
+    float *out = output->getElem(area->xmin, y);
+    for (int i = 0; i < width; i++) {
+      if (fac[i] >= 1.0f) {
+        BKE_curvemapping_evaluate_premulRGBF(cumap, out, image);
+      }
+      else if (fac[i] <= 0.0f) {
+        copy_v3_v3(out, image);
+      }
+      else {
+        float col[4];
+        BKE_curvemapping_evaluate_premulRGBF(cumap, col, image);
+        interp_v3_v3v3(out, image, col, fac[i]);
+      }
+      out[3] = image[3];
+      out += 4;
+      image += 4;
+    }
+  }
+}
+
 void ConstantLevelColorCurveOperation::deinitExecution()
 {
   CurveBaseOperation::deinitExecution();
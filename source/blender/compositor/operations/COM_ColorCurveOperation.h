@@ -40,6 +40,8 @@ class ColorCurveOperation : public CurveBaseOperation {
    */
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
 
+  void updateMemoryBuffer(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
+
   /**
    * Initialize the execution
    */
@@ -69,6 +71,8 @@ class ConstantLevelColorCurveOperation : public CurveBaseOperation {
    */
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
 
+  void updateMemoryBuffer(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
+
   /**
    * Initialize the execution
    */
@@ -87,4 +91,11 @@ class ConstantLevelColorCurveOperation : public CurveBaseOperation {
   {
     copy_v3_v3(this->m_white, white);
   }
+
+  bool hashParams(OperationHash &hash)
+  {
+    hash.add(this->m_black);
+    hash.add(this->m_white);
+    return CurveBaseOperation::hashParams(hash);
+  }
 };
@@ -20,6 +20,10 @@
 
 #include "IMB_colormanagement.h"
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 ConvertBaseOperation::ConvertBaseOperation()
 {
   this->m_inputOperation = nullptr;
@@ -35,12 +39,26 @@ void ConvertBaseOperation::deinitExecution()
   this->m_inputOperation = nullptr;
 }
 
+void ConvertBaseOperation::updateMemoryBuffer(MemoryBuffer *output,
+                                              const rcti *area,
+                                              MemoryBuffer **inputs)
+{
+  MemoryBuffer *input = inputs[0];
+  const int width = BLI_rcti_size_x(area);
+  std::vector<float> row(width * input->get_num_channels());
+  for (int y = area->ymin; y < area->ymax; y++) {
+    updateMemoryBufferRow(
+        output->getElem(area->xmin, y), input->readRow(area->xmin, y, width, row.data()), width);
+  }
+}
+
 /* ******** Value to Color ******** */
 
 ConvertValueToColorOperation::ConvertValueToColorOperation() : ConvertBaseOperation()
 {
   this->addInputSocket(COM_DT_VALUE);
   this->addOutputSocket(COM_DT_COLOR);
+  this->setFullFrame(true);
 }
 
 void ConvertValueToColorOperation::executePixelSampled(float output[4],
@@ -54,12 +72,24 @@ void ConvertValueToColorOperation::executePixelSampled(float output[4],
   output[3] = 1.0f;
 }
 
+void ConvertValueToColorOperation::updateMemoryBufferRow(float *output,
+                                                         const float *input,
+                                                         int length)
+{
+  for (int i = 0; i < length; i++) {
+    output[0] = output[1] = output[2] = input[i];
+    output[3] = 1.0f;
+    output += 4;
+  }
+}
+
 /* ******** Color to Value ******** */
 
 ConvertColorToValueOperation::ConvertColorToValueOperation() : ConvertBaseOperation()
 {
   this->addInputSocket(COM_DT_COLOR);
   this->addOutputSocket(COM_DT_VALUE);
+  this->setFullFrame(true);
 }
 
 void ConvertColorToValueOperation::executePixelSampled(float output[4],
@@ -72,12 +102,23 @@ void ConvertColorToValueOperation::executePixelSampled(float output[4],
   output[0] = (inputColor[0] + inputColor[1] + inputColor[2]) / 3.0f;
 }
 
+void ConvertColorToValueOperation::updateMemoryBufferRow(float *output,
+                                                         const float *input,
+                                                         int length)
+{
+  for (int i = 0; i < length; i++) {
+    output[i] = (input[0] + input[1] + input[2]) / 3.0f;
+    input += 4;
+  }
+}
+
 /* ******** Color to BW ******** */
 
 ConvertColorToBWOperation::ConvertColorToBWOperation() : ConvertBaseOperation()
 {
   this->addInputSocket(COM_DT_COLOR);
   this->addOutputSocket(COM_DT_VALUE);
+  this->setFullFrame(true);
 }
 
 void ConvertColorToBWOperation::executePixelSampled(float output[4],
@@ -90,12 +131,23 @@ void ConvertColorToBWOperation::executePixelSampled(float output[4],
   output[0] = IMB_colormanagement_get_luminance(inputColor);
 }
 
+void ConvertColorToBWOperation::updateMemoryBufferRow(float *output,
+                                                      const float *input,
+                                                      int length)
+{
+  for (int i = 0; i < length; i++) {
+    output[i] = IMB_colormanagement_get_luminance(input);
+    input += 4;
+  }
+}
+
 /* ******** Color to Vector ******** */
 
 ConvertColorToVectorOperation::ConvertColorToVectorOperation() : ConvertBaseOperation()
 {
   this->addInputSocket(COM_DT_COLOR);
   this->addOutputSocket(COM_DT_VECTOR);
+  this->setFullFrame(true);
 }
 
 void ConvertColorToVectorOperation::executePixelSampled(float output[4],
@@ -108,12 +160,24 @@ void ConvertColorToVectorOperation::executePixelSampled(float output[4],
   copy_v3_v3(output, color);
 }
 
+void ConvertColorToVectorOperation::updateMemoryBufferRow(float *output,
+                                                          const float *input,
+                                                          int length)
+{
+  for (int i = 0; i < length; i++) {
+    copy_v3_v3(output, input);
+    output += 3;
+    input += 4;
+  }
+}
+
 /* ******** Value to Vector ******** */
 
 ConvertValueToVectorOperation::ConvertValueToVectorOperation() : ConvertBaseOperation()
 {
   this->addInputSocket(COM_DT_VALUE);
   this->addOutputSocket(COM_DT_VECTOR);
+  this->setFullFrame(true);
 }
 
 void ConvertValueToVectorOperation::executePixelSampled(float output[4],
@@ -126,12 +190,23 @@ void ConvertValueToVectorOperation::executePixelSampled(float output[4],
   output[0] = output[1] = output[2] = value;
 }
 
+void ConvertValueToVectorOperation::updateMemoryBufferRow(float *output,
+                                                          const float *input,
+                                                          int length)
+{
+  for (int i = 0; i < length; i++) {
+    output[0] = output[1] = output[2] = input[i];
+    output += 3;
+  }
+}
+
 /* ******** Vector to Color ******** */
 
 ConvertVectorToColorOperation::ConvertVectorToColorOperation() : ConvertBaseOperation()
 {
   this->addInputSocket(COM_DT_VECTOR);
   this->addOutputSocket(COM_DT_COLOR);
+  this->setFullFrame(true);
 }
 
 void ConvertVectorToColorOperation::executePixelSampled(float output[4],
@@ -143,12 +218,25 @@ void ConvertVectorToColorOperation::executePixelSampled(float output[4],
   output[3] = 1.0f;
 }
 
+void ConvertVectorToColorOperation::updateMemoryBufferRow(float *output,
+                                                          const float *input,
+                                                          int length)
+{
+  for (int i = 0; i < length; i++) {
+    copy_v3_v3(output, input);
+    output[3] = 1.0f;
+    output += 4;
+    input += 3;
+  }
+}
+
 /* ******** Vector to Value ******** */
 
 ConvertVectorToValueOperation::ConvertVectorToValueOperation() : ConvertBaseOperation()
 {
   this->addInputSocket(COM_DT_VECTOR);
   this->addOutputSocket(COM_DT_VALUE);
+  this->setFullFrame(true);
 }
 
 void ConvertVectorToValueOperation::executePixelSampled(float output[4],
@@ -161,6 +249,16 @@ void ConvertVectorToValueOperation::executePixelSampled(float output[4],
   output[0] = (input[0] + input[1] + input[2]) / 3.0f;
 }
 
+void ConvertVectorToValueOperation::updateMemoryBufferRow(float *output,
+                                                          const float *input,
+                                                          int length)
+{
+  for (int i = 0; i < length; i++) {
+    output[i] = (input[0] + input[1] + input[2]) / 3.0f;
+    input += 3;
+  }
+}
+
 /* ******** RGB to YCC ******** */
 
 ConvertRGBToYCCOperation::ConvertRGBToYCCOperation() : ConvertBaseOperation()
@@ -346,6 +444,7 @@ ConvertPremulToStraightOperation::ConvertPremulToStraightOperation() : ConvertBa
 {
   this->addInputSocket(COM_DT_COLOR);
   this->addOutputSocket(COM_DT_COLOR);
+  this->setFullFrame(true);
 }
 
 void ConvertPremulToStraightOperation::executePixelSampled(float output[4],
@@ -370,12 +469,39 @@ void ConvertPremulToStraightOperation::executePixelSampled(float output[4],
   output[3] = alpha;
 }
 
+void ConvertPremulToStraightOperation::updateMemoryBufferRow(float *output,
+                                                             const float *input,
+                                                             int length)
+{
+  for (int i = 0; i < length; i++) {
+    const float alpha = input[3];
+#ifdef __SSE2__
+    const __m128 color = fabsf(alpha) < 1e-5f ?
+                             _mm_setzero_ps() :
+                             _mm_mul_ps(_mm_loadu_ps(input), _mm_set1_ps(1.0f / alpha));
+    _mm_storeu_ps(output, color);
+#else
+    if (fabsf(alpha) < 1e-5f) {
+      zero_v3(output);
+    }
+    else {
+      mul_v3_v3fl(output, input, 1.0f / alpha);
+    }
+#endif
+    /* never touches the alpha */
+    output[3] = alpha;
+    output += 4;
+    input += 4;
+  }
+}
+
 /* ******** Straight to Premul ******** */
 
 ConvertStraightToPremulOperation::ConvertStraightToPremulOperation() : ConvertBaseOperation()
 {
   this->addInputSocket(COM_DT_COLOR);
   this->addOutputSocket(COM_DT_COLOR);
+  this->setFullFrame(true);
 }
 
 void ConvertStraightToPremulOperation::executePixelSampled(float output[4],
@@ -395,6 +521,24 @@ void ConvertStraightToPremulOperation::executePixelSampled(float output[4],
   output[3] = alpha;
 }
 
+void ConvertStraightToPremulOperation::updateMemoryBufferRow(float *output,
+                                                             const float *input,
+                                                             int length)
+{
+  for (int i = 0; i < length; i++) {
+    const float alpha = input[3];
+#ifdef __SSE2__
+    _mm_storeu_ps(output, _mm_mul_ps(_mm_loadu_ps(input), _mm_set1_ps(alpha)));
+#else
+    mul_v3_v3fl(output, input, alpha);
+#endif
+    /* never touches the alpha */
+    output[3] = alpha;
+    output += 4;
+    input += 4;
+  }
+}
+
 /* ******** Separate Channels ******** */
 
 SeparateChannelOperation::SeparateChannelOperation()
@@ -29,6 +29,21 @@ class ConvertBaseOperation : public NodeOperation {
 
   void initExecution();
   void deinitExecution();
+
+  void updateMemoryBuffer(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
+
+  bool hashParams(OperationHash & /*hash*/)
+  {
+    return true;
+  }
+
+ protected:
+  /**
+   * Convert a row of elements, implemented by the conversions which are full frame operations.
+   */
+  virtual void updateMemoryBufferRow(float * /*output*/, const float * /*input*/, int /*length*/)
+  {
+  }
 };
 
 class ConvertValueToColorOperation : public ConvertBaseOperation {
@@ -36,6 +51,9 @@ class ConvertValueToColorOperation : public ConvertBaseOperation {
   ConvertValueToColorOperation();
 
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+ protected:
+  void updateMemoryBufferRow(float *output, const float *input, int length);
 };
 
 class ConvertColorToValueOperation : public ConvertBaseOperation {
@@ -43,6 +61,9 @@ class ConvertColorToValueOperation : public ConvertBaseOperation {
   ConvertColorToValueOperation();
 
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+ protected:
+  void updateMemoryBufferRow(float *output, const float *input, int length);
 };
 
 class ConvertColorToBWOperation : public ConvertBaseOperation {
@@ -50,6 +71,9 @@ class ConvertColorToBWOperation : public ConvertBaseOperation {
   ConvertColorToBWOperation();
 
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+ protected:
+  void updateMemoryBufferRow(float *output, const float *input, int length);
 };
 
 class ConvertColorToVectorOperation : public ConvertBaseOperation {
@@ -57,6 +81,9 @@ class ConvertColorToVectorOperation : public ConvertBaseOperation {
   ConvertColorToVectorOperation();
 
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+ protected:
+  void updateMemoryBufferRow(float *output, const float *input, int length);
 };
 
 class ConvertValueToVectorOperation : public ConvertBaseOperation {
@@ -64,6 +91,9 @@ class ConvertValueToVectorOperation : public ConvertBaseOperation {
   ConvertValueToVectorOperation();
 
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+ protected:
+  void updateMemoryBufferRow(float *output, const float *input, int length);
 };
 
 class ConvertVectorToColorOperation : public ConvertBaseOperation {
@@ -71,6 +101,9 @@ class ConvertVectorToColorOperation : public ConvertBaseOperation {
   ConvertVectorToColorOperation();
 
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+ protected:
+  void updateMemoryBufferRow(float *output, const float *input, int length);
 };
 
 class ConvertVectorToValueOperation : public ConvertBaseOperation {
@@ -78,6 +111,9 @@ class ConvertVectorToValueOperation : public ConvertBaseOperation {
   ConvertVectorToValueOperation();
 
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+ protected:
+  void updateMemoryBufferRow(float *output, const float *input, int length);
 };
 
 class ConvertRGBToYCCOperation : public ConvertBaseOperation {
@@ -92,6 +128,12 @@ class ConvertRGBToYCCOperation : public ConvertBaseOperation {
 
   /** Set the YCC mode */
   void setMode(int mode);
+
+  bool hashParams(OperationHash &hash)
+  {
+    hash.add(this->m_mode);
+    return true;
+  }
 };
 
 class ConvertYCCToRGBOperation : public ConvertBaseOperation {
@@ -106,6 +148,12 @@ class ConvertYCCToRGBOperation : public ConvertBaseOperation {
 
   /** Set the YCC mode */
   void setMode(int mode);
+
+  bool hashParams(OperationHash &hash)
+  {
+    hash.add(this->m_mode);
+    return true;
+  }
 };
 
 class ConvertRGBToYUVOperation : public ConvertBaseOperation {
@@ -141,6 +189,9 @@ class ConvertPremulToStraightOperation : public ConvertBaseOperation {
   ConvertPremulToStraightOperation();
 
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+ protected:
+  void updateMemoryBufferRow(float *output, const float *input, int length);
 };
 
 class ConvertStraightToPremulOperation : public ConvertBaseOperation {
@@ -148,6 +199,9 @@ class ConvertStraightToPremulOperation : public ConvertBaseOperation {
   ConvertStraightToPremulOperation();
 
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+ protected:
+  void updateMemoryBufferRow(float *output, const float *input, int length);
 };
 
 class SeparateChannelOperation : public NodeOperation {
@@ -166,6 +220,12 @@ class SeparateChannelOperation : public NodeOperation {
   {
     this->m_channel = channel;
   }
+
+  bool hashParams(OperationHash &hash)
+  {
+    hash.add(this->m_channel);
+    return true;
+  }
 };
 
 class CombineChannelsOperation : public NodeOperation {
@@ -181,4 +241,9 @@ class CombineChannelsOperation : public NodeOperation {
 
   void initExecution();
   void deinitExecution();
+
+  bool hashParams(OperationHash & /*hash*/)
+  {
+    return true;
+  }
 };
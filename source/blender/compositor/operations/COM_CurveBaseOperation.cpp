@@ -53,3 +53,29 @@ void CurveBaseOperation::setCurveMapping(CurveMapping *mapping)
   }
   this->m_curveMapping = BKE_curvemapping_copy(mapping);
 }
+
+bool CurveBaseOperation::hashParams(OperationHash &hash)
+{
+  const CurveMapping *cumap = this->m_curveMapping;
+  if (cumap == nullptr) {
+    return false;
+  }
+  hash.add(cumap->flag);
+  hash.add(cumap->clipr);
+  hash.add(cumap->black);
+  hash.add(cumap->white);
+  hash.add(cumap->tone);
+  for (int a = 0; a < CM_TOT; a++) {
+    const CurveMap *cuma = &cumap->cm[a];
+    hash.add(cuma->totpoint);
+    hash.add(cuma->ext_in);
+    hash.add(cuma->ext_out);
+    for (int b = 0; b < cuma->totpoint; b++) {
+      /* Selection doesn't change the curve. */
+      hash.add(cuma->curve[b].x);
+      hash.add(cuma->curve[b].y);
+      hash.add((short)(cuma->curve[b].flag & ~CUMA_SELECT));
+    }
+  }
+  return true;
+}
@@ -39,4 +39,6 @@ class CurveBaseOperation : public NodeOperation {
   void deinitExecution();
 
   void setCurveMapping(CurveMapping *mapping);
+
+  bool hashParams(OperationHash &hash);
 };
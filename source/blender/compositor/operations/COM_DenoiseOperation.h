@@ -51,6 +51,11 @@ class DenoiseOperation : public SingleThreadedOperation {
   {
     this->m_settings = settings;
   }
+  bool hashParams(OperationHash &hash)
+  {
+    hash.add(*this->m_settings);
+    return true;
+  }
   bool determineDependingAreaOfInterest(rcti *input,
                                         ReadBufferOperation *readOperation,
                                         rcti *output);
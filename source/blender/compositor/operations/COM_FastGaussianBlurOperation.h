@@ -78,4 +78,11 @@ class FastGaussianBlurValueOperation : public NodeOperation {
   {
     this->m_overlay = overlay;
   }
+
+  bool hashParams(OperationHash &hash)
+  {
+    hash.add(this->m_sigma);
+    hash.add(this->m_overlay);
+    return true;
+  }
 };
@@ -44,6 +44,11 @@ class GammaCorrectOperation : public NodeOperation {
    * Deinitialize the execution
    */
   void deinitExecution();
+
+  bool hashParams(OperationHash & /*hash*/)
+  {
+    return true;
+  }
 };
 
 class GammaUncorrectOperation : public NodeOperation {
@@ -70,4 +75,9 @@ class GammaUncorrectOperation : public NodeOperation {
    * Deinitialize the execution
    */
   void deinitExecution();
+
+  bool hashParams(OperationHash & /*hash*/)
+  {
+    return true;
+  }
 };
@@ -62,6 +62,11 @@ class GlareBaseOperation : public SingleThreadedOperation {
   {
     this->m_settings = settings;
   }
+  bool hashParams(OperationHash &hash)
+  {
+    hash.add(*this->m_settings);
+    return true;
+  }
   bool determineDependingAreaOfInterest(rcti *input,
                                         ReadBufferOperation *readOperation,
                                         rcti *output);
@@ -55,6 +55,11 @@ class GlareThresholdOperation : public NodeOperation {
   {
     this->m_settings = settings;
   }
+  bool hashParams(OperationHash &hash)
+  {
+    hash.add(*this->m_settings);
+    return true;
+  }
 
   void determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2]);
 };
@@ -64,6 +64,12 @@ class MathBaseOperation : public NodeOperation {
    */
   void determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2]);
 
+  bool hashParams(OperationHash &hash)
+  {
+    hash.add(this->m_useClamp);
+    return true;
+  }
+
   void setUseClamp(bool value)
   {
     this->m_useClamp = value;
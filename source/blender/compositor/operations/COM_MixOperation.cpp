@@ -20,6 +20,10 @@
 
 #include "BLI_math.h"
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 /* ******** Mix Base Operation ******** */
 
 MixBaseOperation::MixBaseOperation()
@@ -95,11 +99,71 @@ void MixBaseOperation::deinitExecution()
   this->m_inputColor2Operation = nullptr;
 }
 
+void MixBaseOperation::updateMemoryBuffer(MemoryBuffer *output,
+                                          const rcti *area,
+                                          MemoryBuffer **inputs)
+{
+  const int width = BLI_rcti_size_x(area);
+  std::vector<float> value_row(width);
+  std::vector<float> color1_row(width * COM_NUM_CHANNELS_COLOR);
+  std::vector<float> color2_row(width * COM_NUM_CHANNELS_COLOR);
+  for (int y = area->ymin; y < area->ymax; y++) {
+    updateMemoryBufferRow(output->getElem(area->xmin, y),
+                          inputs[0]->readRow(area->xmin, y, width, value_row.data()),
+                          inputs[1]->readRow(area->xmin, y, width, color1_row.data()),
+                          inputs[2]->readRow(area->xmin, y, width, color2_row.data()),
+                          width);
+  }
+}
+
+/* Mix a row of pixels using a kernel which mixes the color channels of a single pixel, the alpha
+ * of the result is the alpha of the first color. With SSE2 kernels mix all channels of a pixel
+ * at once, using the same operations as the pixel execution so results are identical. */
+template<typename Kernel>
+static void mix_row(float *output,
+                    const float *value,
+                    const float *color1,
+                    const float *color2,
+                    int length,
+                    bool valueAlphaMultiply,
+                    bool useClamp)
+{
+  const Kernel kernel;
+#ifdef __SSE2__
+  const __m128 alpha_mask = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+  for (int i = 0; i < length; i++) {
+    const __m128 col1 = _mm_loadu_ps(color1);
+    const __m128 col2 = _mm_loadu_ps(color2);
+    const float fac = valueAlphaMultiply ? value[i] * color2[3] : value[i];
+    __m128 result = _bli_math_blend_sse(alpha_mask, col1, kernel(col1, col2, _mm_set1_ps(fac)));
+    if (useClamp) {
+      result = _mm_min_ps(_mm_max_ps(result, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+    }
+    _mm_storeu_ps(output, result);
+    output += 4;
+    color1 += 4;
+    color2 += 4;
+  }
+#else
+  for (int i = 0; i < length; i++) {
+    const float fac = valueAlphaMultiply ? value[i] * color2[3] : value[i];
+    kernel(output, color1, color2, fac);
+    output[3] = color1[3];
+    if (useClamp) {
+      clamp_v4(output, 0.0f, 1.0f);
+    }
+    output += 4;
+    color1 += 4;
+    color2 += 4;
+  }
+#endif
+}
+
 /* ******** Mix Add Operation ******** */
 
 MixAddOperation::MixAddOperation()
 {
-  /* pass */
+  this->setFullFrame(true);
 }
 
 void MixAddOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
@@ -124,11 +188,34 @@ void MixAddOperation::executePixelSampled(float output[4], float x, float y, Pix
   clampIfNeeded(output);
 }
 
+struct MixAddKernel {
+#ifdef __SSE2__
+  __m128 operator()(const __m128 col1, const __m128 col2, const __m128 fac) const
+  {
+    return _mm_add_ps(col1, _mm_mul_ps(fac, col2));
+  }
+#else
+  void operator()(float output[4], const float col1[4], const float col2[4], float fac) const
+  {
+    output[0] = col1[0] + fac * col2[0];
+    output[1] = col1[1] + fac * col2[1];
+    output[2] = col1[2] + fac * col2[2];
+  }
+#endif
+};
+
+void MixAddOperation::updateMemoryBufferRow(
+    float *output, const float *value, const float *color1, const float *color2, int length)
+{
+  mix_row<MixAddKernel>(
+      output, value, color1, color2, length, this->m_valueAlphaMultiply, this->m_useClamp);
+}
+
 /* ******** Mix Blend Operation ******** */
 
 MixBlendOperation::MixBlendOperation()
 {
-  /* pass */
+  this->setFullFrame(true);
 }
 
 void MixBlendOperation::executePixelSampled(float output[4],
@@ -158,6 +245,31 @@ void MixBlendOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+struct MixBlendKernel {
+#ifdef __SSE2__
+  __m128 operator()(const __m128 col1, const __m128 col2, const __m128 fac) const
+  {
+    const __m128 facm = _mm_sub_ps(_mm_set1_ps(1.0f), fac);
+    return _mm_add_ps(_mm_mul_ps(facm, col1), _mm_mul_ps(fac, col2));
+  }
+#else
+  void operator()(float output[4], const float col1[4], const float col2[4], float fac) const
+  {
+    const float facm = 1.0f - fac;
+    output[0] = facm * col1[0] + fac * col2[0];
+    output[1] = facm * col1[1] + fac * col2[1];
+    output[2] = facm * col1[2] + fac * col2[2];
+  }
+#endif
+};
+
+void MixBlendOperation::updateMemoryBufferRow(
+    float *output, const float *value, const float *color1, const float *color2, int length)
+{
+  mix_row<MixBlendKernel>(
+      output, value, color1, color2, length, this->m_valueAlphaMultiply, this->m_useClamp);
+}
+
 /* ******** Mix Burn Operation ******** */
 
 MixColorBurnOperation::MixColorBurnOperation()
@@ -290,7 +402,7 @@ void MixColorOperation::executePixelSampled(float output[4],
 
 MixDarkenOperation::MixDarkenOperation()
 {
-  /* pass */
+  this->setFullFrame(true);
 }
 
 void MixDarkenOperation::executePixelSampled(float output[4],
@@ -319,11 +431,36 @@ void MixDarkenOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+struct MixDarkenKernel {
+#ifdef __SSE2__
+  __m128 operator()(const __m128 col1, const __m128 col2, const __m128 fac) const
+  {
+    const __m128 facm = _mm_sub_ps(_mm_set1_ps(1.0f), fac);
+    return _mm_add_ps(_mm_mul_ps(_mm_min_ps(col1, col2), fac), _mm_mul_ps(col1, facm));
+  }
+#else
+  void operator()(float output[4], const float col1[4], const float col2[4], float fac) const
+  {
+    const float facm = 1.0f - fac;
+    output[0] = min_ff(col1[0], col2[0]) * fac + col1[0] * facm;
+    output[1] = min_ff(col1[1], col2[1]) * fac + col1[1] * facm;
+    output[2] = min_ff(col1[2], col2[2]) * fac + col1[2] * facm;
+  }
+#endif
+};
+
+void MixDarkenOperation::updateMemoryBufferRow(
+    float *output, const float *value, const float *color1, const float *color2, int length)
+{
+  mix_row<MixDarkenKernel>(
+      output, value, color1, color2, length, this->m_valueAlphaMultiply, this->m_useClamp);
+}
+
 /* ******** Mix Difference Operation ******** */
 
 MixDifferenceOperation::MixDifferenceOperation()
 {
-  /* pass */
+  this->setFullFrame(true);
 }
 
 void MixDifferenceOperation::executePixelSampled(float output[4],
@@ -352,6 +489,32 @@ void MixDifferenceOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+struct MixDifferenceKernel {
+#ifdef __SSE2__
+  __m128 operator()(const __m128 col1, const __m128 col2, const __m128 fac) const
+  {
+    const __m128 facm = _mm_sub_ps(_mm_set1_ps(1.0f), fac);
+    const __m128 difference = _mm_andnot_ps(_mm_set1_ps(-0.0f), _mm_sub_ps(col1, col2));
+    return _mm_add_ps(_mm_mul_ps(facm, col1), _mm_mul_ps(fac, difference));
+  }
+#else
+  void operator()(float output[4], const float col1[4], const float col2[4], float fac) const
+  {
+    const float facm = 1.0f - fac;
+    output[0] = facm * col1[0] + fac * fabsf(col1[0] - col2[0]);
+    output[1] = facm * col1[1] + fac * fabsf(col1[1] - col2[1]);
+    output[2] = facm * col1[2] + fac * fabsf(col1[2] - col2[2]);
+  }
+#endif
+};
+
+void MixDifferenceOperation::updateMemoryBufferRow(
+    float *output, const float *value, const float *color1, const float *color2, int length)
+{
+  mix_row<MixDifferenceKernel>(
+      output, value, color1, color2, length, this->m_valueAlphaMultiply, this->m_useClamp);
+}
+
 /* ******** Mix Difference Operation ******** */
 
 MixDivideOperation::MixDivideOperation()
@@ -577,7 +740,7 @@ void MixHueOperation::executePixelSampled(float output[4], float x, float y, Pix
 
 MixLightenOperation::MixLightenOperation()
 {
-  /* pass */
+  this->setFullFrame(true);
 }
 
 void MixLightenOperation::executePixelSampled(float output[4],
@@ -624,6 +787,29 @@ void MixLightenOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+struct MixLightenKernel {
+#ifdef __SSE2__
+  __m128 operator()(const __m128 col1, const __m128 col2, const __m128 fac) const
+  {
+    return _mm_max_ps(_mm_mul_ps(fac, col2), col1);
+  }
+#else
+  void operator()(float output[4], const float col1[4], const float col2[4], float fac) const
+  {
+    output[0] = max_ff(fac * col2[0], col1[0]);
+    output[1] = max_ff(fac * col2[1], col1[1]);
+    output[2] = max_ff(fac * col2[2], col1[2]);
+  }
+#endif
+};
+
+void MixLightenOperation::updateMemoryBufferRow(
+    float *output, const float *value, const float *color1, const float *color2, int length)
+{
+  mix_row<MixLightenKernel>(
+      output, value, color1, color2, length, this->m_valueAlphaMultiply, this->m_useClamp);
+}
+
 /* ******** Mix Linear Light Operation ******** */
 
 MixLinearLightOperation::MixLinearLightOperation()
@@ -676,7 +862,7 @@ void MixLinearLightOperation::executePixelSampled(float output[4],
 
 MixMultiplyOperation::MixMultiplyOperation()
 {
-  /* pass */
+  this->setFullFrame(true);
 }
 
 void MixMultiplyOperation::executePixelSampled(float output[4],
@@ -705,6 +891,31 @@ void MixMultiplyOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+struct MixMultiplyKernel {
+#ifdef __SSE2__
+  __m128 operator()(const __m128 col1, const __m128 col2, const __m128 fac) const
+  {
+    const __m128 facm = _mm_sub_ps(_mm_set1_ps(1.0f), fac);
+    return _mm_mul_ps(col1, _mm_add_ps(facm, _mm_mul_ps(fac, col2)));
+  }
+#else
+  void operator()(float output[4], const float col1[4], const float col2[4], float fac) const
+  {
+    const float facm = 1.0f - fac;
+    output[0] = col1[0] * (facm + fac * col2[0]);
+    output[1] = col1[1] * (facm + fac * col2[1]);
+    output[2] = col1[2] * (facm + fac * col2[2]);
+  }
+#endif
+};
+
+void MixMultiplyOperation::updateMemoryBufferRow(
+    float *output, const float *value, const float *color1, const float *color2, int length)
+{
+  mix_row<MixMultiplyKernel>(
+      output, value, color1, color2, length, this->m_valueAlphaMultiply, this->m_useClamp);
+}
+
 /* ******** Mix Ovelray Operation ******** */
 
 MixOverlayOperation::MixOverlayOperation()
@@ -801,7 +1012,7 @@ void MixSaturationOperation::executePixelSampled(float output[4],
 
 MixScreenOperation::MixScreenOperation()
 {
-  /* pass */
+  this->setFullFrame(true);
 }
 
 void MixScreenOperation::executePixelSampled(float output[4],
@@ -831,6 +1042,33 @@ void MixScreenOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+struct MixScreenKernel {
+#ifdef __SSE2__
+  __m128 operator()(const __m128 col1, const __m128 col2, const __m128 fac) const
+  {
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 facm = _mm_sub_ps(one, fac);
+    const __m128 mix = _mm_add_ps(facm, _mm_mul_ps(fac, _mm_sub_ps(one, col2)));
+    return _mm_sub_ps(one, _mm_mul_ps(mix, _mm_sub_ps(one, col1)));
+  }
+#else
+  void operator()(float output[4], const float col1[4], const float col2[4], float fac) const
+  {
+    const float facm = 1.0f - fac;
+    output[0] = 1.0f - (facm + fac * (1.0f - col2[0])) * (1.0f - col1[0]);
+    output[1] = 1.0f - (facm + fac * (1.0f - col2[1])) * (1.0f - col1[1]);
+    output[2] = 1.0f - (facm + fac * (1.0f - col2[2])) * (1.0f - col1[2]);
+  }
+#endif
+};
+
+void MixScreenOperation::updateMemoryBufferRow(
+    float *output, const float *value, const float *color1, const float *color2, int length)
+{
+  mix_row<MixScreenKernel>(
+      output, value, color1, color2, length, this->m_valueAlphaMultiply, this->m_useClamp);
+}
+
 /* ******** Mix Soft Light Operation ******** */
 
 MixSoftLightOperation::MixSoftLightOperation()
@@ -881,7 +1119,7 @@ void MixSoftLightOperation::executePixelSampled(float output[4],
 
 MixSubtractOperation::MixSubtractOperation()
 {
-  /* pass */
+  this->setFullFrame(true);
 }
 
 void MixSubtractOperation::executePixelSampled(float output[4],
@@ -909,6 +1147,29 @@ void MixSubtractOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+struct MixSubtractKernel {
+#ifdef __SSE2__
+  __m128 operator()(const __m128 col1, const __m128 col2, const __m128 fac) const
+  {
+    return _mm_sub_ps(col1, _mm_mul_ps(fac, col2));
+  }
+#else
+  void operator()(float output[4], const float col1[4], const float col2[4], float fac) const
+  {
+    output[0] = col1[0] - fac * col2[0];
+    output[1] = col1[1] - fac * col2[1];
+    output[2] = col1[2] - fac * col2[2];
+  }
+#endif
+};
+
+void MixSubtractOperation::updateMemoryBufferRow(
+    float *output, const float *value, const float *color1, const float *color2, int length)
+{
+  mix_row<MixSubtractKernel>(
+      output, value, color1, color2, length, this->m_valueAlphaMultiply, this->m_useClamp);
+}
+
 /* ******** Mix Value Operation ******** */
 
 MixValueOperation::MixValueOperation()
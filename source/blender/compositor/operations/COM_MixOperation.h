@@ -66,6 +66,8 @@ class MixBaseOperation : public NodeOperation {
 
   void determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2]);
 
+  void updateMemoryBuffer(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
+
   void setUseValueAlphaMultiply(const bool value)
   {
     this->m_valueAlphaMultiply = value;
@@ -78,18 +80,47 @@ class MixBaseOperation : public NodeOperation {
   {
     this->m_useClamp = value;
   }
+
+  bool hashParams(OperationHash &hash)
+  {
+    hash.add(this->m_valueAlphaMultiply);
+    hash.add(this->m_useClamp);
+    return true;
+  }
+
+ protected:
+  /**
+   * \brief mix a row of pixels in the full frame execution model
+   * \param value: the factor of each pixel
+   * \param color1, color2: the colors of each pixel, four elements per pixel
+   */
+  virtual void updateMemoryBufferRow(float * /*output*/,
+                                     const float * /*value*/,
+                                     const float * /*color1*/,
+                                     const float * /*color2*/,
+                                     int /*length*/)
+  {
+  }
 };
 
 class MixAddOperation : public MixBaseOperation {
  public:
   MixAddOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+ protected:
+  void updateMemoryBufferRow(
+      float *output, const float *value, const float *color1, const float *color2, int length);
 };
 
 class MixBlendOperation : public MixBaseOperation {
  public:
   MixBlendOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+ protected:
+  void updateMemoryBufferRow(
+      float *output, const float *value, const float *color1, const float *color2, int length);
 };
 
 class MixColorBurnOperation : public MixBaseOperation {
@@ -108,12 +139,20 @@ class MixDarkenOperation : public MixBaseOperation {
  public:
   MixDarkenOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+ protected:
+  void updateMemoryBufferRow(
+      float *output, const float *value, const float *color1, const float *color2, int length);
 };
 
 class MixDifferenceOperation : public MixBaseOperation {
  public:
   MixDifferenceOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+ protected:
+  void updateMemoryBufferRow(
+      float *output, const float *value, const float *color1, const float *color2, int length);
 };
 
 class MixDivideOperation : public MixBaseOperation {
@@ -144,6 +183,10 @@ class MixLightenOperation : public MixBaseOperation {
  public:
   MixLightenOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+ protected:
+  void updateMemoryBufferRow(
+      float *output, const float *value, const float *color1, const float *color2, int length);
 };
 
 class MixLinearLightOperation : public MixBaseOperation {
@@ -156,6 +199,10 @@ class MixMultiplyOperation : public MixBaseOperation {
  public:
   MixMultiplyOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+ protected:
+  void updateMemoryBufferRow(
+      float *output, const float *value, const float *color1, const float *color2, int length);
 };
 
 class MixOverlayOperation : public MixBaseOperation {
@@ -174,6 +221,10 @@ class MixScreenOperation : public MixBaseOperation {
  public:
   MixScreenOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+ protected:
+  void updateMemoryBufferRow(
+      float *output, const float *value, const float *color1, const float *color2, int length);
 };
 
 class MixSoftLightOperation : public MixBaseOperation {
@@ -186,6 +237,10 @@ class MixSubtractOperation : public MixBaseOperation {
  public:
   MixSubtractOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+ protected:
+  void updateMemoryBufferRow(
+      float *output, const float *value, const float *color1, const float *color2, int length);
 };
 
 class MixValueOperation : public MixBaseOperation {
@@ -45,6 +45,23 @@ ImBuf *MultilayerBaseOperation::getImBuf()
   return nullptr;
 }
 
+void MultilayerBaseOperation::copyImageArea(MemoryBuffer *output, const rcti *area)
+{
+  const int num_channels = output->get_num_channels();
+  if (this->m_imageFloatBuffer == nullptr) {
+    const float zero[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    output->fill(area, zero);
+    return;
+  }
+
+  const int width = BLI_rcti_size_x(area);
+  for (int y = area->ymin; y < area->ymax; y++) {
+    const float *input = &this->m_imageFloatBuffer[(y * this->getWidth() + area->xmin) *
+                                                   num_channels];
+    memcpy(output->getElem(area->xmin, y), input, sizeof(float) * width * num_channels);
+  }
+}
+
 void MultilayerColorOperation::executePixelSampled(float output[4],
                                                    float x,
                                                    float y,
@@ -82,6 +99,27 @@ void MultilayerColorOperation::executePixelSampled(float output[4],
   }
 }
 
+void MultilayerColorOperation::updateMemoryBuffer(MemoryBuffer *output,
+                                                  const rcti *area,
+                                                  MemoryBuffer ** /*inputs*/)
+{
+  if (this->m_imageFloatBuffer == nullptr || this->m_numberOfChannels == 4) {
+    copyImageArea(output, area);
+    return;
+  }
+
+  for (int y = area->ymin; y < area->ymax; y++) {
+    float *elem = output->getElem(area->xmin, y);
+    const float *input = &this->m_imageFloatBuffer[(y * this->getWidth() + area->xmin) * 3];
+    for (int x = area->xmin; x < area->xmax; x++) {
+      copy_v3_v3(elem, input);
+      elem[3] = 1.0f;
+      elem += 4;
+      input += 3;
+    }
+  }
+}
+
 void MultilayerValueOperation::executePixelSampled(float output[4],
                                                    float x,
                                                    float y,
@@ -104,6 +142,13 @@ void MultilayerValueOperation::executePixelSampled(float output[4],
   }
 }
 
+void MultilayerValueOperation::updateMemoryBuffer(MemoryBuffer *output,
+                                                  const rcti *area,
+                                                  MemoryBuffer ** /*inputs*/)
+{
+  copyImageArea(output, area);
+}
+
 void MultilayerVectorOperation::executePixelSampled(float output[4],
                                                     float x,
                                                     float y,
@@ -125,3 +170,10 @@ void MultilayerVectorOperation::executePixelSampled(float output[4],
     }
   }
 }
+
+void MultilayerVectorOperation::updateMemoryBuffer(MemoryBuffer *output,
+                                                   const rcti *area,
+                                                   MemoryBuffer ** /*inputs*/)
+{
+  copyImageArea(output, area);
+}
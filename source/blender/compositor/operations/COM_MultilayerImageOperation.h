@@ -29,6 +29,11 @@ class MultilayerBaseOperation : public BaseImageOperation {
  protected:
   ImBuf *getImBuf();
 
+  /**
+   * Copy an area of the image float buffer, which has as many channels as the output buffer.
+   */
+  void copyImageArea(MemoryBuffer *output, const rcti *area);
+
  public:
   /**
    * Constructor
@@ -45,8 +50,10 @@ class MultilayerColorOperation : public MultilayerBaseOperation {
   MultilayerColorOperation(int passindex, int view) : MultilayerBaseOperation(passindex, view)
   {
     this->addOutputSocket(COM_DT_COLOR);
+    this->setFullFrame(true);
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBuffer(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MultilayerValueOperation : public MultilayerBaseOperation {
@@ -54,8 +61,10 @@ class MultilayerValueOperation : public MultilayerBaseOperation {
   MultilayerValueOperation(int passindex, int view) : MultilayerBaseOperation(passindex, view)
   {
     this->addOutputSocket(COM_DT_VALUE);
+    this->setFullFrame(true);
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBuffer(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MultilayerVectorOperation : public MultilayerBaseOperation {
@@ -63,6 +72,8 @@ class MultilayerVectorOperation : public MultilayerBaseOperation {
   MultilayerVectorOperation(int passindex, int view) : MultilayerBaseOperation(passindex, view)
   {
     this->addOutputSocket(COM_DT_VECTOR);
+    this->setFullFrame(true);
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBuffer(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
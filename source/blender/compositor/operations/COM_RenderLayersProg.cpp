@@ -36,6 +36,20 @@ RenderLayersProg::RenderLayersProg(const char *passName, DataType type, int elem
   this->m_rd = nullptr;
 
   this->addOutputSocket(type);
+  this->setFullFrame(true);
+}
+
+float *RenderLayersProg::getPassBuffer(RenderResult *rr)
+{
+  ViewLayer *view_layer = (ViewLayer *)BLI_findlink(&this->getScene()->view_layers,
+                                                    getLayerId());
+  if (view_layer) {
+    RenderLayer *rl = RE_GetRenderLayer(rr, view_layer->name);
+    if (rl) {
+      return RE_RenderLayerGetPass(rl, this->m_passName.c_str(), this->m_viewName);
+    }
+  }
+  return nullptr;
 }
 
 void RenderLayersProg::initExecution()
@@ -49,15 +63,7 @@ void RenderLayersProg::initExecution()
   }
 
   if (rr) {
-    ViewLayer *view_layer = (ViewLayer *)BLI_findlink(&scene->view_layers, getLayerId());
-    if (view_layer) {
-
-      RenderLayer *rl = RE_GetRenderLayer(rr, view_layer->name);
-      if (rl) {
-        this->m_inputBuffer = RE_RenderLayerGetPass(
-            rl, this->m_passName.c_str(), this->m_viewName);
-      }
-    }
+    this->m_inputBuffer = getPassBuffer(rr);
   }
   if (re) {
     RE_ReleaseResult(re);
@@ -174,6 +180,47 @@ void RenderLayersProg::executePixelSampled(float output[4], float x, float y, Pi
   }
 }
 
+void RenderLayersProg::updateMemoryBuffer(MemoryBuffer *output,
+                                          const rcti *area,
+                                          MemoryBuffer ** /*inputs*/)
+{
+  if (this->m_inputBuffer == nullptr) {
+    const float zero[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    output->fill(area, zero);
+    return;
+  }
+
+  const int width = BLI_rcti_size_x(area);
+  for (int y = area->ymin; y < area->ymax; y++) {
+    const float *input = &this->m_inputBuffer[(y * this->getWidth() + area->xmin) *
+                                              this->m_elementsize];
+    memcpy(output->getElem(area->xmin, y), input, sizeof(float) * width * this->m_elementsize);
+  }
+}
+
+bool RenderLayersProg::hashParams(OperationHash &hash)
+{
+  /* The render result is identified by its session UUID, which is renewed when its passes are
+   * written, the pass by its buffer. Operations are only initialized when they are rendered, so
+   * the render result is acquired here. */
+  Scene *scene = this->getScene();
+  Render *re = (scene) ? RE_GetSceneRender(scene) : nullptr;
+  unsigned int session_uuid = 0;
+  const float *passBuffer = nullptr;
+  if (re) {
+    RenderResult *rr = RE_AcquireResultRead(re);
+    if (rr) {
+      session_uuid = rr->session_uuid;
+      passBuffer = getPassBuffer(rr);
+    }
+    RE_ReleaseResult(re);
+  }
+  hash.add(session_uuid);
+  hash.add(passBuffer);
+  hash.add(this->m_elementsize);
+  return true;
+}
+
 void RenderLayersProg::deinitExecution()
 {
   this->m_inputBuffer = nullptr;
@@ -225,6 +272,29 @@ void RenderLayersAOOperation::executePixelSampled(float output[4],
   output[3] = 1.0f;
 }
 
+void RenderLayersAOOperation::updateMemoryBuffer(MemoryBuffer *output,
+                                                 const rcti *area,
+                                                 MemoryBuffer ** /*inputs*/)
+{
+  const float *inputBuffer = this->getInputBuffer();
+  for (int y = area->ymin; y < area->ymax; y++) {
+    float *elem = output->getElem(area->xmin, y);
+    const float *input = inputBuffer ? &inputBuffer[(y * this->getWidth() + area->xmin) * 3] :
+                                       nullptr;
+    for (int x = area->xmin; x < area->xmax; x++) {
+      if (input) {
+        copy_v3_v3(elem, input);
+        input += 3;
+      }
+      else {
+        zero_v3(elem);
+      }
+      elem[3] = 1.0f;
+      elem += 4;
+    }
+  }
+}
+
 /* ******** Render Layers Alpha Operation ******** */
 void RenderLayersAlphaProg::executePixelSampled(float output[4],
                                                 float x,
@@ -243,6 +313,27 @@ void RenderLayersAlphaProg::executePixelSampled(float output[4],
   }
 }
 
+void RenderLayersAlphaProg::updateMemoryBuffer(MemoryBuffer *output,
+                                               const rcti *area,
+                                               MemoryBuffer ** /*inputs*/)
+{
+  const float *inputBuffer = this->getInputBuffer();
+  if (inputBuffer == nullptr) {
+    const float zero = 0.0f;
+    output->fill(area, &zero);
+    return;
+  }
+
+  const int width = BLI_rcti_size_x(area);
+  for (int y = area->ymin; y < area->ymax; y++) {
+    float *elem = output->getElem(area->xmin, y);
+    const float *input = &inputBuffer[(y * this->getWidth() + area->xmin) * 4];
+    for (int i = 0; i < width; i++) {
+      elem[i] = input[i * 4 + 3];
+    }
+  }
+}
+
 /* ******** Render Layers Depth Operation ******** */
 void RenderLayersDepthProg::executePixelSampled(float output[4],
                                                 float x,
@@ -262,3 +353,21 @@ void RenderLayersDepthProg::executePixelSampled(float output[4],
     output[0] = inputBuffer[offset];
   }
 }
+
+void RenderLayersDepthProg::updateMemoryBuffer(MemoryBuffer *output,
+                                               const rcti *area,
+                                               MemoryBuffer ** /*inputs*/)
+{
+  const float *inputBuffer = this->getInputBuffer();
+  if (inputBuffer == nullptr) {
+    const float far_depth = 10e10f;
+    output->fill(area, &far_depth);
+    return;
+  }
+
+  const int width = BLI_rcti_size_x(area);
+  for (int y = area->ymin; y < area->ymax; y++) {
+    const float *input = &inputBuffer[y * this->getWidth() + area->xmin];
+    memcpy(output->getElem(area->xmin, y), input, sizeof(float) * width);
+  }
+}
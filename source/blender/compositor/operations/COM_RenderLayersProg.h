@@ -78,6 +78,11 @@ class RenderLayersProg : public NodeOperation {
     return this->m_inputBuffer;
   }
 
+  /**
+   * get the float buffer of the pass in the render result, nullptr when it isn't rendered.
+   */
+  float *getPassBuffer(RenderResult *rr);
+
   void doInterpolation(float output[4], float x, float y, PixelSampler sampler);
 
  public:
@@ -121,6 +126,8 @@ class RenderLayersProg : public NodeOperation {
   void initExecution();
   void deinitExecution();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBuffer(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
+  bool hashParams(OperationHash &hash);
 };
 
 class RenderLayersAOOperation : public RenderLayersProg {
@@ -130,6 +137,7 @@ class RenderLayersAOOperation : public RenderLayersProg {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBuffer(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class RenderLayersAlphaProg : public RenderLayersProg {
@@ -139,6 +147,7 @@ class RenderLayersAlphaProg : public RenderLayersProg {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBuffer(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class RenderLayersDepthProg : public RenderLayersProg {
@@ -148,4 +157,5 @@ class RenderLayersDepthProg : public RenderLayersProg {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBuffer(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
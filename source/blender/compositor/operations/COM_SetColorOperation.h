@@ -75,8 +75,14 @@ class SetColorOperation : public NodeOperation {
    * the inner loop of this program
    */
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBuffer(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 
   void determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2]);
+  bool hashParams(OperationHash &hash)
+  {
+    hash.add(this->m_color);
+    return true;
+  }
   bool isSetOperation() const
   {
     return true;
@@ -74,8 +74,17 @@ class SetVectorOperation : public NodeOperation {
    * the inner loop of this program
    */
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void updateMemoryBuffer(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 
   void determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2]);
+  bool hashParams(OperationHash &hash)
+  {
+    hash.add(this->m_x);
+    hash.add(this->m_y);
+    hash.add(this->m_z);
+    hash.add(this->m_w);
+    return true;
+  }
   bool isSetOperation() const
   {
     return true;
@@ -76,6 +76,14 @@ class VariableSizeBokehBlurOperation : public NodeOperation, public QualityStepH
     this->m_do_size_scale = scale_size;
   }
 
+  bool hashParams(OperationHash &hash)
+  {
+    hash.add(this->m_maxBlur);
+    hash.add(this->m_threshold);
+    hash.add(this->m_do_size_scale);
+    return true;
+  }
+
   void executeOpenCL(OpenCLDevice *device,
                      MemoryBuffer *outputMemoryBuffer,
                      cl_mem clOutputBuffer,
@@ -121,5 +129,11 @@ class InverseSearchRadiusOperation : public NodeOperation {
   {
     this->m_maxBlur = maxRadius;
   }
+
+  bool hashParams(OperationHash &hash)
+  {
+    hash.add(this->m_maxBlur);
+    return true;
+  }
 };
 #endif
@@ -0,0 +1,142 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <cmath>
+#include <limits>
+
+#include "BLI_rect.h"
+
+#include "COM_MemoryBuffer.h"
+
+namespace blender::compositor::tests {
+
+/* Pack a row of values as half floats and read them back. */
+static void half_float_round_trip(const float *values, int num_values, float *r_values)
+{
+  BLI_assert(num_values % 4 == 0);
+  rcti rect;
+  BLI_rcti_init(&rect, 0, num_values / 4, 0, 1);
+  MemoryBuffer buffer(COM_DT_COLOR, &rect);
+  memcpy(buffer.getBuffer(), values, sizeof(float) * num_values);
+  buffer.pack(false, true);
+  EXPECT_TRUE(buffer.isPacked());
+  EXPECT_EQ(buffer.getMemorySize(), sizeof(uint16_t) * num_values);
+  const float *row = buffer.readRow(0, 0, num_values / 4, r_values);
+  EXPECT_EQ(row, r_values);
+}
+
+TEST(MemoryBufferTest, HalfFloatExact)
+{
+  /* Values with at most 11 significant bits are stored exactly, including denormals. */
+  const float values[] = {0.0f,
+                          -0.0f,
+                          1.0f,
+                          -2.5f,
+                          0.333251953125f,
+                          1000.5f,
+                          65504.0f,
+                          -65504.0f,
+                          6.103515625e-05f,
+                          5.9604644775390625e-08f,
+                          -3.0517578125e-05f,
+                          std::numeric_limits<float>::infinity()};
+  const int num_values = ARRAY_SIZE(values);
+  float result[ARRAY_SIZE(values)];
+  half_float_round_trip(values, num_values, result);
+  for (int i = 0; i < num_values; i++) {
+    EXPECT_EQ(result[i], values[i]) << "at " << i;
+    EXPECT_EQ(std::signbit(result[i]), std::signbit(values[i])) << "at " << i;
+  }
+}
+
+TEST(MemoryBufferTest, HalfFloatRounding)
+{
+  const float values[] = {
+      /* Halfway between 1 and the next half float rounds to the even mantissa. */
+      1.0f + 1.0f / 2048.0f,
+      1.0f + 3.0f / 2048.0f,
+      /* Nearest. */
+      1.0f + 1.4f / 1024.0f,
+      -1.0f - 0.6f / 1024.0f,
+      /* Too large values are clamped to the largest half float, not made infinite. */
+      70000.0f,
+      -1.0e10f,
+      /* Halfway between zero and the smallest denormal rounds to zero. */
+      2.98023223876953125e-08f,
+      1.0e-10f,
+  };
+  const float expected[] = {
+      1.0f,
+      1.0f + 2.0f / 1024.0f,
+      1.0f + 1.0f / 1024.0f,
+      -1.0f - 1.0f / 1024.0f,
+      65504.0f,
+      -65504.0f,
+      0.0f,
+      0.0f,
+  };
+  const int num_values = ARRAY_SIZE(values);
+  float result[ARRAY_SIZE(values)];
+  half_float_round_trip(values, num_values, result);
+  for (int i = 0; i < num_values; i++) {
+    EXPECT_EQ(result[i], expected[i]) << "at " << i;
+  }
+}
+
+TEST(MemoryBufferTest, HalfFloatNaN)
+{
+  const float values[] = {std::numeric_limits<float>::quiet_NaN(),
+                          -std::numeric_limits<float>::infinity(),
+                          0.5f,
+                          0.25f};
+  float result[4];
+  half_float_round_trip(values, 4, result);
+  EXPECT_TRUE(std::isnan(result[0]));
+  EXPECT_EQ(result[1], -std::numeric_limits<float>::infinity());
+  EXPECT_EQ(result[2], 0.5f);
+  EXPECT_EQ(result[3], 0.25f);
+}
+
+TEST(MemoryBufferTest, ValueBufferStaysFloat)
+{
+  rcti rect;
+  BLI_rcti_init(&rect, 0, 4, 0, 2);
+  MemoryBuffer buffer(COM_DT_VALUE, &rect);
+  for (int i = 0; i < 8; i++) {
+    buffer.getBuffer()[i] = 100000.0f + i;
+  }
+  buffer.pack(false, true);
+  EXPECT_FALSE(buffer.isPacked());
+  EXPECT_EQ(*buffer.getElem(3, 1), 100007.0f);
+}
+
+TEST(MemoryBufferTest, SingleElement)
+{
+  rcti rect;
+  BLI_rcti_init(&rect, 0, 5, 0, 3);
+  const float color[4] = {0.25f, 0.5f, 100000.0f, 1.0f};
+
+  MemoryBuffer disabled(COM_DT_COLOR, &rect);
+  disabled.fill(&rect, color);
+  disabled.pack(false, false);
+  EXPECT_FALSE(disabled.isPacked());
+
+  MemoryBuffer buffer(COM_DT_COLOR, &rect);
+  buffer.fill(&rect, color);
+  buffer.pack(true, true);
+  EXPECT_TRUE(buffer.isPacked());
+  EXPECT_EQ(buffer.getMemorySize(), sizeof(color));
+
+  /* Elements outside of the buffer are zero. */
+  float row[7 * 4];
+  buffer.readRow(-1, 2, 7, row);
+  for (int x = 0; x < 7; x++) {
+    for (int channel = 0; channel < 4; channel++) {
+      const bool is_inside = x >= 1 && x < 6;
+      EXPECT_EQ(row[x * 4 + channel], is_inside ? color[channel] : 0.0f) << "at " << x;
+    }
+  }
+}
+
+}  // namespace blender::compositor::tests
@@ -0,0 +1,136 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_rect.h"
+
+#include "DNA_node_types.h"
+
+#include "COM_BufferOperation.h"
+#include "COM_ConvertOperation.h"
+#include "COM_MemoryBuffer.h"
+#include "COM_SetValueOperation.h"
+
+namespace blender::compositor::tests {
+
+static int test_break_never(void * /*tbh*/)
+{
+  return 0;
+}
+
+/* Operation without full frame support, rendered by the pixel fallback of the full frame
+ * execution model. */
+class AddOneOperation : public NodeOperation {
+ private:
+  SocketReader *m_inputOperation = nullptr;
+
+ public:
+  AddOneOperation()
+  {
+    this->addInputSocket(COM_DT_VALUE);
+    this->addOutputSocket(COM_DT_VALUE);
+  }
+
+  void initExecution() override
+  {
+    this->m_inputOperation = this->getInputSocketReader(0);
+  }
+
+  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler) override
+  {
+    this->m_inputOperation->readSampled(output, x, y, sampler);
+    output[0] += 1.0f;
+  }
+};
+
+class FullFrameRenderTest : public testing::Test {
+ protected:
+  bNodeTree ntree_ = {};
+  rcti rect_;
+
+  void SetUp() override
+  {
+    ntree_.test_break = test_break_never;
+    BLI_rcti_init(&rect_, 0, 37, 0, 23);
+  }
+
+  /* Value buffer with a different value for every element. */
+  MemoryBuffer *value_buffer_create()
+  {
+    MemoryBuffer *buffer = new MemoryBuffer(COM_DT_VALUE, &rect_);
+    for (int y = rect_.ymin; y < rect_.ymax; y++) {
+      for (int x = rect_.xmin; x < rect_.xmax; x++) {
+        *buffer->getElem(x, y) = x * 0.25f - y * 0.5f;
+      }
+    }
+    return buffer;
+  }
+
+  /* Render the operation with the full frame execution model, and compare the result with the
+   * pixels of the tiled execution model, which reads the input through a buffer operation. */
+  void expect_render_matches_pixels(NodeOperation *operation,
+                                    MemoryBuffer *input,
+                                    DataType datatype)
+  {
+    BufferOperation input_operation(input, COM_DT_VALUE);
+    operation->getInputSocket(0)->setLink(input_operation.getOutputSocket());
+    operation->setbNodeTree(&ntree_);
+    MemoryBuffer output(datatype, &rect_);
+    MemoryBuffer *inputs[] = {input};
+    operation->render(&output, &rect_, inputs);
+
+    operation->initExecution();
+    const int num_channels = output.get_num_channels();
+    for (int y = rect_.ymin; y < rect_.ymax; y++) {
+      for (int x = rect_.xmin; x < rect_.xmax; x++) {
+        float expected[4];
+        operation->readSampled(expected, x, y, COM_PS_NEAREST);
+        const float *elem = output.getElem(x, y);
+        for (int channel = 0; channel < num_channels; channel++) {
+          EXPECT_EQ(elem[channel], expected[channel]) << "at " << x << ", " << y;
+        }
+      }
+    }
+    operation->deinitExecution();
+    operation->getInputSocket(0)->setLink(nullptr);
+  }
+};
+
+TEST_F(FullFrameRenderTest, ConvertValueToColor)
+{
+  MemoryBuffer *input = value_buffer_create();
+  ConvertValueToColorOperation operation;
+  EXPECT_TRUE(operation.isFullFrameOperation());
+  expect_render_matches_pixels(&operation, input, COM_DT_COLOR);
+  delete input;
+}
+
+TEST_F(FullFrameRenderTest, PixelFallback)
+{
+  MemoryBuffer *input = value_buffer_create();
+  AddOneOperation operation;
+  EXPECT_FALSE(operation.isFullFrameOperation());
+  expect_render_matches_pixels(&operation, input, COM_DT_VALUE);
+  delete input;
+}
+
+TEST_F(FullFrameRenderTest, SetValuePartialArea)
+{
+  MemoryBuffer output(COM_DT_VALUE, &rect_);
+  output.clear();
+  SetValueOperation operation;
+  operation.setbNodeTree(&ntree_);
+  operation.setValue(2.5f);
+  rcti area;
+  BLI_rcti_init(&area, 3, 20, 5, 11);
+  operation.render(&output, &area, nullptr);
+
+  for (int y = rect_.ymin; y < rect_.ymax; y++) {
+    for (int x = rect_.xmin; x < rect_.xmax; x++) {
+      const bool is_inside = x >= area.xmin && x < area.xmax && y >= area.ymin && y < area.ymax;
+      EXPECT_EQ(*output.getElem(x, y), is_inside ? 2.5f : 0.0f) << "at " << x << ", " << y;
+    }
+  }
+}
+
+}  // namespace blender::compositor::tests
@@ -0,0 +1,137 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_rect.h"
+
+#include "COM_MemoryBuffer.h"
+#include "COM_ResultCache.h"
+
+namespace blender::compositor::tests {
+
+class ResultCacheTest : public testing::Test {
+ protected:
+  rcti rect_;
+  size_t buffer_size_;
+
+  void SetUp() override
+  {
+    BLI_rcti_init(&rect_, 0, 16, 0, 8);
+    MemoryBuffer buffer(COM_DT_COLOR, &rect_);
+    buffer_size_ = buffer.getMemorySize();
+  }
+
+  void TearDown() override
+  {
+    ResultCache::clear();
+  }
+
+  MemoryBuffer *buffer_create()
+  {
+    return new MemoryBuffer(COM_DT_COLOR, &rect_);
+  }
+
+  /* Store a new buffer, the buffer is freed when the cache doesn't take it. */
+  bool store(uint64_t hash)
+  {
+    MemoryBuffer *buffer = buffer_create();
+    if (ResultCache::store(hash, buffer, &rect_)) {
+      return true;
+    }
+    delete buffer;
+    return false;
+  }
+
+  bool is_cached(uint64_t hash)
+  {
+    return ResultCache::lookup(hash, &rect_) != nullptr;
+  }
+};
+
+TEST_F(ResultCacheTest, Disabled)
+{
+  EXPECT_FALSE(ResultCache::beginExecution(0));
+  EXPECT_FALSE(store(1));
+  ResultCache::endExecution();
+}
+
+TEST_F(ResultCacheTest, LookupArea)
+{
+  ASSERT_TRUE(ResultCache::beginExecution(buffer_size_));
+  rcti area;
+  BLI_rcti_init(&area, 2, 10, 0, 4);
+  MemoryBuffer *buffer = buffer_create();
+  ASSERT_TRUE(ResultCache::store(1, buffer, &area));
+  ResultCache::endExecution();
+
+  ASSERT_TRUE(ResultCache::beginExecution(buffer_size_));
+  EXPECT_EQ(ResultCache::lookup(2, &area), nullptr);
+  /* Only the rendered area of the buffer can be used. */
+  EXPECT_EQ(ResultCache::lookup(1, &rect_), nullptr);
+  rcti inside;
+  BLI_rcti_init(&inside, 3, 8, 1, 4);
+  EXPECT_EQ(ResultCache::lookup(1, &inside), buffer);
+  ResultCache::endExecution();
+}
+
+TEST_F(ResultCacheTest, LeastRecentlyUsedFreedFirst)
+{
+  const size_t limit = buffer_size_ * 2;
+  ASSERT_TRUE(ResultCache::beginExecution(limit));
+  EXPECT_TRUE(store(1));
+  EXPECT_TRUE(store(2));
+  ResultCache::endExecution();
+
+  /* Use the oldest result, so the second one is the least recently used. */
+  ASSERT_TRUE(ResultCache::beginExecution(limit));
+  EXPECT_TRUE(is_cached(1));
+  ResultCache::endExecution();
+
+  ASSERT_TRUE(ResultCache::beginExecution(limit));
+  EXPECT_TRUE(store(3));
+  ResultCache::endExecution();
+
+  ASSERT_TRUE(ResultCache::beginExecution(limit));
+  EXPECT_TRUE(is_cached(1));
+  EXPECT_FALSE(is_cached(2));
+  EXPECT_TRUE(is_cached(3));
+  ResultCache::endExecution();
+}
+
+TEST_F(ResultCacheTest, UsedResultsKept)
+{
+  const size_t limit = buffer_size_ * 2;
+  ASSERT_TRUE(ResultCache::beginExecution(limit));
+  EXPECT_TRUE(store(1));
+  EXPECT_TRUE(store(2));
+  /* Both results are used by this execution, nothing can be freed. */
+  EXPECT_FALSE(store(3));
+  ResultCache::endExecution();
+
+  ASSERT_TRUE(ResultCache::beginExecution(limit));
+  EXPECT_TRUE(is_cached(1));
+  EXPECT_TRUE(is_cached(2));
+  EXPECT_FALSE(is_cached(3));
+  ResultCache::endExecution();
+}
+
+TEST_F(ResultCacheTest, LowerLimitFreesResults)
+{
+  ASSERT_TRUE(ResultCache::beginExecution(buffer_size_ * 2));
+  EXPECT_TRUE(store(1));
+  EXPECT_TRUE(store(2));
+  ResultCache::endExecution();
+
+  ASSERT_TRUE(ResultCache::beginExecution(buffer_size_));
+  EXPECT_FALSE(is_cached(1));
+  EXPECT_TRUE(is_cached(2));
+  ResultCache::endExecution();
+
+  ASSERT_TRUE(ResultCache::beginExecution(buffer_size_ - 1));
+  EXPECT_FALSE(is_cached(2));
+  /* Results larger than the limit are never stored. */
+  EXPECT_FALSE(store(3));
+  ResultCache::endExecution();
+}
+
+}  // namespace blender::compositor::tests
@@ -72,12 +72,22 @@ void DEG_graph_build_from_ids(struct Depsgraph *graph, struct ID **ids, const in
 /* Tag relations from the given graph for update. */
 void DEG_graph_tag_relations_update(struct Depsgraph *graph);
 
+/* Tag relations of the given ID for update in the given graph. Only relations of this ID and the
+ * IDs directly related to it are rebuilt, unless it is not possible for the ID, in which case the
+ * whole graph is rebuilt. */
+void DEG_graph_id_tag_relations_update(struct Depsgraph *graph, struct ID *id);
+
 /* Create or update relations in the specified graph. */
 void DEG_graph_relations_update(struct Depsgraph *graph);
 
 /* Tag all relations in the database for update.*/
 void DEG_relations_tag_update(struct Main *bmain);
 
+/* Tag relations of the given ID for update in all graphs, see
+ * #DEG_graph_id_tag_relations_update. Use when the change only affects relations of this ID, for
+ * example when a modifier or a constraint was added to an object. */
+void DEG_id_relations_tag_update(struct Main *bmain, struct ID *id);
+
 /* Add Dependencies  ----------------------------- */
 
 /* Handle for components to define their dependencies from callbacks.
@@ -31,7 +31,9 @@
 extern "C" {
 #endif
 
+struct DepsgraphOperationCost;
 struct Depsgraph;
+struct ID;
 struct Scene;
 struct ViewLayer;
 
@@ -52,6 +54,32 @@ void DEG_stats_simple(const struct Depsgraph *graph,
                       size_t *r_operations,
                       size_t *r_relations);
 
+/* Memory of geometry arrays of evaluated datablocks, which is shared with the original datablocks
+ * or copied for evaluation. */
+void DEG_stats_copy_on_write_memory(const struct Depsgraph *graph,
+                                    size_t *r_shared,
+                                    size_t *r_copied);
+
+/* ************************************************ */
+/* Evaluation Cost Profile */
+
+/* Average evaluation time of operations is gathered when time debugging, priority scheduling or
+ * the scene's SCE_DEPSGRAPH_COST_PROFILE flag is enabled. All times are in seconds. */
+
+/* Predicted evaluation time of all operations of the given ID. */
+double DEG_cost_profile_id_time(const struct Depsgraph *graph, const struct ID *id);
+/* Predicted evaluation time of all operations in the graph. */
+double DEG_cost_profile_total_time(const struct Depsgraph *graph);
+
+bool DEG_cost_profile_write_json(const struct Depsgraph *graph, const char *filepath);
+/* Costs stored in the scene are not affected, but are not used by this graph anymore. */
+void DEG_cost_profile_clear(struct Depsgraph *graph);
+
+/* Merge the costs stored in the scene and the profiles of all its dependency graphs, to be stored
+ * in the file. Returns an array allocated with MEM_mallocN, or NULL when there are no costs. */
+struct DepsgraphOperationCost *DEG_cost_profile_export(const struct Scene *scene,
+                                                       int *r_costs_num);
+
 /* ************************************************ */
 /* Diagram-Based Graph Debugging */
 
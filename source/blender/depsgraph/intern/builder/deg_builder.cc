@@ -201,6 +201,68 @@ void deg_graph_build_flush_visibility(Depsgraph *graph)
   BLI_stack_free(stack);
 }
 
+/* Same as above, but only flushes visibility of the given ID nodes. Visibility of the other nodes
+ * is kept from the previous build, so the flush stops at components which are visible already.
+ * The ID nodes which got new visible components are added to r_changed_id_nodes. */
+void deg_graph_build_flush_visibility(Depsgraph * /*graph*/,
+                                      Span<IDNode *> id_nodes,
+                                      Set<IDNode *> &r_changed_id_nodes)
+{
+  Vector<OperationNode *> stack;
+  for (IDNode *id_node : id_nodes) {
+    for (ComponentNode *comp_node : id_node->components.values()) {
+      comp_node->affects_directly_visible |= id_node->is_directly_visible;
+      stack.extend(comp_node->operations);
+    }
+  }
+  while (!stack.is_empty()) {
+    OperationNode *op_node = stack.pop_last();
+    if (!op_node->owner->affects_directly_visible) {
+      continue;
+    }
+    for (Relation *rel : op_node->inlinks) {
+      if (rel->from->type != NodeType::OPERATION) {
+        continue;
+      }
+      ComponentNode *comp_from = static_cast<OperationNode *>(rel->from)->owner;
+      if (comp_from->affects_directly_visible) {
+        continue;
+      }
+      comp_from->affects_directly_visible = true;
+      r_changed_id_nodes.add(comp_from->owner);
+      stack.extend(comp_from->operations);
+    }
+  }
+}
+
+void deg_graph_build_finalize_id_tag(Main *bmain, Depsgraph *graph, IDNode *id_node)
+{
+  ID *id_orig = id_node->id_orig;
+  int flag = 0;
+  /* Tag rebuild if special evaluation flags changed. */
+  if (id_node->eval_flags != id_node->previous_eval_flags) {
+    flag |= ID_RECALC_TRANSFORM | ID_RECALC_GEOMETRY;
+  }
+  /* Tag rebuild if the custom data mask changed. */
+  if (id_node->customdata_masks != id_node->previous_customdata_masks) {
+    flag |= ID_RECALC_GEOMETRY;
+  }
+  if (!deg_copy_on_write_is_expanded(id_node->id_cow)) {
+    flag |= ID_RECALC_COPY_ON_WRITE;
+    /* This means ID is being added to the dependency graph first
+     * time, which is similar to "ob-visible-change" */
+    if (GS(id_orig->name) == ID_OB) {
+      flag |= ID_RECALC_TRANSFORM | ID_RECALC_GEOMETRY;
+    }
+  }
+  /* Restore recalc flags from original ID, which could possibly contain recalc flags set by
+   * an operator and then were carried on by the undo system. */
+  flag |= id_orig->recalc;
+  if (flag != 0) {
+    graph_id_tag_update(bmain, graph, id_node->id_orig, flag, DEG_UPDATE_SOURCE_RELATIONS);
+  }
+}
+
 }  // namespace
 
 void deg_graph_build_finalize(Main *bmain, Depsgraph *graph)
@@ -212,32 +274,35 @@ void deg_graph_build_finalize(Main *bmain, Depsgraph *graph)
   /* Re-tag IDs for update if it was tagged before the relations
    * update tag. */
   for (IDNode *id_node : graph->id_nodes) {
-    ID *id_orig = id_node->id_orig;
     id_node->finalize_build(graph);
-    int flag = 0;
-    /* Tag rebuild if special evaluation flags changed. */
-    if (id_node->eval_flags != id_node->previous_eval_flags) {
-      flag |= ID_RECALC_TRANSFORM | ID_RECALC_GEOMETRY;
-    }
-    /* Tag rebuild if the custom data mask changed. */
-    if (id_node->customdata_masks != id_node->previous_customdata_masks) {
-      flag |= ID_RECALC_GEOMETRY;
-    }
-    if (!deg_copy_on_write_is_expanded(id_node->id_cow)) {
-      flag |= ID_RECALC_COPY_ON_WRITE;
-      /* This means ID is being added to the dependency graph first
-       * time, which is similar to "ob-visible-change" */
-      if (GS(id_orig->name) == ID_OB) {
-        flag |= ID_RECALC_TRANSFORM | ID_RECALC_GEOMETRY;
-      }
-    }
-    /* Restore recalc flags from original ID, which could possibly contain recalc flags set by
-     * an operator and then were carried on by the undo system. */
-    flag |= id_orig->recalc;
-    if (flag != 0) {
-      graph_id_tag_update(bmain, graph, id_node->id_orig, flag, DEG_UPDATE_SOURCE_RELATIONS);
+    deg_graph_build_finalize_id_tag(bmain, graph, id_node);
+  }
+}
+
+void deg_graph_build_finalize(Main *bmain, Depsgraph *graph, Span<IDNode *> id_nodes)
+{
+  /* Operations of the new components are only known after the components are finalized. */
+  for (IDNode *id_node : id_nodes) {
+    id_node->finalize_build(graph);
+  }
+  Set<IDNode *> visibility_changed_id_nodes;
+  deg_graph_build_flush_visibility(graph, id_nodes, visibility_changed_id_nodes);
+  Vector<OperationNode *> operations;
+  for (IDNode *id_node : id_nodes) {
+    for (ComponentNode *comp_node : id_node->components.values()) {
+      operations.extend(comp_node->operations);
     }
   }
+  deg_graph_remove_unused_noops(graph, operations);
+
+  for (IDNode *id_node : id_nodes) {
+    visibility_changed_id_nodes.remove(id_node);
+    id_node->visible_components_mask = id_node->get_visible_components_mask();
+    deg_graph_build_finalize_id_tag(bmain, graph, id_node);
+  }
+  for (IDNode *id_node : visibility_changed_id_nodes) {
+    id_node->visible_components_mask = id_node->get_visible_components_mask();
+  }
 }
 
 }  // namespace blender::deg
@@ -23,6 +23,8 @@
 
 #pragma once
 
+#include "BLI_span.hh"
+
 struct Base;
 struct ID;
 struct Main;
@@ -33,6 +35,7 @@ namespace blender {
 namespace deg {
 
 struct Depsgraph;
+struct IDNode;
 class DepsgraphBuilderCache;
 
 class DepsgraphBuilder {
@@ -58,6 +61,9 @@ class DepsgraphBuilder {
 bool deg_check_id_in_depsgraph(const Depsgraph *graph, ID *id_orig);
 bool deg_check_base_in_depsgraph(const Depsgraph *graph, Base *base);
 void deg_graph_build_finalize(Main *bmain, Depsgraph *graph);
+/* Finalize an incremental build, which only changed nodes of the given IDs and relations between
+ * their operations. */
+void deg_graph_build_finalize(Main *bmain, Depsgraph *graph, Span<IDNode *> id_nodes);
 
 }  // namespace deg
 }  // namespace blender
@@ -60,7 +60,8 @@ struct CyclesSolverState {
   CyclesSolverState(Depsgraph *graph)
       : graph(graph),
         traversal_stack(BLI_stack_new(sizeof(StackEntry), "DEG detect cycles stack")),
-        num_cycles(0)
+        num_cycles(0),
+        skip_cyclic_relations(false)
   {
     /* pass */
   }
@@ -74,6 +75,9 @@ struct CyclesSolverState {
   Depsgraph *graph;
   BLI_Stack *traversal_stack;
   int num_cycles;
+  /* Relations which were already marked as cyclic are not followed. Used when only part of the
+   * graph is checked, so cycles which are solved already are not reported again. */
+  bool skip_cyclic_relations;
 };
 
 inline void set_node_visited_state(Node *node, eCyclicCheckVisitedState state)
@@ -179,6 +183,9 @@ void solve_cycles(CyclesSolverState *state)
     const int num_visited = get_node_num_visited_children(node);
     for (int i = num_visited; i < node->outlinks.size(); i++) {
       Relation *rel = node->outlinks[i];
+      if (state->skip_cyclic_relations && (rel->flag & RELATION_FLAG_CYCLIC)) {
+        continue;
+      }
       if (rel->to->type == NodeType::OPERATION) {
         OperationNode *to = (OperationNode *)rel->to;
         eCyclicCheckVisitedState to_state = get_node_visited_state(to);
@@ -234,4 +241,32 @@ void deg_graph_detect_cycles(Depsgraph *graph)
   }
 }
 
+void deg_graph_detect_cycles(Depsgraph *graph, Span<OperationNode *> operations)
+{
+  CyclesSolverState state(graph);
+  state.skip_cyclic_relations = true;
+  /* Any new cycle passes through one of the given operations, so it is enough to only traverse
+   * the part of the graph which is reachable from them. Clear the state of that part only. */
+  Set<OperationNode *> reachable_nodes;
+  Vector<OperationNode *> stack(operations);
+  while (!stack.is_empty()) {
+    OperationNode *node = stack.pop_last();
+    if (!reachable_nodes.add(node)) {
+      continue;
+    }
+    node->custom_flags = 0;
+    for (Relation *rel : node->outlinks) {
+      if (rel->to->type == NodeType::OPERATION && (rel->flag & RELATION_FLAG_CYCLIC) == 0) {
+        stack.append(static_cast<OperationNode *>(rel->to));
+      }
+    }
+  }
+  for (OperationNode *node : operations) {
+    if (get_node_visited_state(node) == NODE_NOT_VISITED) {
+      schedule_node_to_stack(&state, node);
+      solve_cycles(&state);
+    }
+  }
+}
+
 }  // namespace blender::deg
@@ -23,13 +23,20 @@
 
 #pragma once
 
+#include "BLI_span.hh"
+
 namespace blender {
 namespace deg {
 
 struct Depsgraph;
+struct OperationNode;
 
 /* Detect and solve dependency cycles. */
 void deg_graph_detect_cycles(Depsgraph *graph);
 
+/* Detect and solve dependency cycles which pass through any of the given operations. Relations
+ * which were marked as cyclic already are not followed. */
+void deg_graph_detect_cycles(Depsgraph *graph, Span<OperationNode *> operations);
+
 }  // namespace deg
 }  // namespace blender
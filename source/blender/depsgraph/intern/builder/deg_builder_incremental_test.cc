@@ -0,0 +1,85 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "deg_builder_incremental_test_utils.hh"
+
+namespace blender::deg::tests {
+
+TEST_F(DepsgraphIncrementalBuildTest, AddConstraint)
+{
+  scene_create(50);
+  add_constraint(objects[25], objects[3]);
+  expect_incremental_update_matches_full_build(objects[25]);
+}
+
+TEST_F(DepsgraphIncrementalBuildTest, AddConstraintToParent)
+{
+  scene_create(50);
+  /* Children of the object have relations to it, which are to be rebuilt as well. */
+  add_constraint(objects[21], objects[40]);
+  expect_incremental_update_matches_full_build(objects[21]);
+}
+
+TEST_F(DepsgraphIncrementalBuildTest, AddModifier)
+{
+  scene_create(50);
+  add_array_modifier(objects[12], objects[33]);
+  expect_incremental_update_matches_full_build(objects[12]);
+}
+
+TEST_F(DepsgraphIncrementalBuildTest, AddConstraintCycle)
+{
+  scene_create(50);
+  /* Parent follows its own child. */
+  add_constraint(objects[30], objects[32]);
+  expect_incremental_update_matches_full_build(objects[30]);
+}
+
+TEST_F(DepsgraphIncrementalBuildTest, FallbackToFullBuild)
+{
+  scene_create(50);
+  /* Colliders are cached by the graph, so the whole graph is rebuilt. */
+  BLI_addtail(&objects[5]->modifiers, BKE_modifier_new(eModifierType_Collision));
+  expect_incremental_update_matches_full_build(objects[5], false);
+}
+
+TEST_F(DepsgraphIncrementalBuildTest, ThreadedBuildMatchesSerialBuild)
+{
+  scene_create(50);
+  add_constraint(objects[25], objects[3]);
+  add_constraint(objects[30], objects[32]);
+  add_array_modifier(objects[12], objects[33]);
+  BLI_addtail(&objects[5]->modifiers, BKE_modifier_new(eModifierType_Collision));
+  DEG_graph_tag_relations_update(depsgraph);
+  DEG_graph_relations_update(depsgraph);
+
+  /* Relations of all IDs are built from a single thread, by traversing the view layer. */
+  const int debug_flags = G.debug;
+  G.debug |= G_DEBUG_DEPSGRAPH_NO_THREADS;
+  ::Depsgraph *serial_depsgraph = depsgraph_create();
+  G.debug = debug_flags;
+  expect_graphs_match(depsgraph, serial_depsgraph);
+  DEG_graph_free(serial_depsgraph);
+}
+
+}  // namespace blender::deg::tests
@@ -0,0 +1,195 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#pragma once
+
+#include "testing/testing.h"
+
+#include "tests/blendfile_loading_base_test.h"
+
+#include <set>
+
+#include "BLI_listbase.h"
+#include "BLI_string.h"
+
+#include "BKE_collection.h"
+#include "BKE_constraint.h"
+#include "BKE_global.h"
+#include "BKE_lib_id.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+#include "BKE_modifier.h"
+#include "BKE_object.h"
+#include "BKE_scene.h"
+
+#include "DNA_constraint_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+
+#include "intern/builder/pipeline_view_layer.h"
+#include "intern/depsgraph.h"
+#include "intern/depsgraph_relation.h"
+#include "intern/node/deg_node_component.h"
+#include "intern/node/deg_node_id.h"
+#include "intern/node/deg_node_operation.h"
+
+namespace blender::deg::tests {
+
+inline std::string node_identifier(const Node *node)
+{
+  if (node->type != NodeType::OPERATION) {
+    return node->identifier();
+  }
+  const OperationNode *op_node = static_cast<const OperationNode *>(node);
+  return string(nodeTypeAsString(op_node->owner->type)) + " " + op_node->full_identifier() +
+         "[" + to_string(op_node->name_tag) + "]";
+}
+
+/* All relations of the graph in a form which does not depend on the build order. */
+inline std::set<std::string> graph_relations(::Depsgraph *depsgraph)
+{
+  Depsgraph *graph = reinterpret_cast<Depsgraph *>(depsgraph);
+  std::set<std::string> relations;
+  for (OperationNode *op_node : graph->operations) {
+    for (Relation *rel : op_node->inlinks) {
+      relations.insert(node_identifier(rel->from) + " -> " + node_identifier(op_node) + " : " +
+                       rel->name);
+    }
+  }
+  return relations;
+}
+
+class DepsgraphIncrementalBuildTest : public BlendfileLoadingBaseTest {
+ protected:
+  Main *bmain = nullptr;
+  Scene *scene = nullptr;
+  Vector<Object *> objects;
+
+  void TearDown() override
+  {
+    if (depsgraph != nullptr) {
+      DEG_graph_free(depsgraph);
+      depsgraph = nullptr;
+    }
+    if (bmain != nullptr) {
+      BKE_main_free(bmain);
+      bmain = nullptr;
+    }
+    objects.clear();
+    BlendfileLoadingBaseTest::TearDown();
+  }
+
+  /* Scene with chains of ten parented objects, all sharing the same mesh. */
+  void scene_create(const int objects_num)
+  {
+    bmain = BKE_main_new();
+    scene = BKE_scene_add(bmain, "Scene");
+    Mesh *mesh = BKE_mesh_add(bmain, "Mesh");
+    Collection *collection = BKE_collection_add(bmain, nullptr, "Objects");
+    for (int i = 0; i < objects_num; i++) {
+      char name[MAX_ID_NAME - 2];
+      BLI_snprintf(name, sizeof(name), "Object%d", i);
+      Object *object = BKE_object_add_only_object(bmain, OB_MESH, name);
+      object->data = mesh;
+      id_us_plus(&mesh->id);
+      if (i % 10 != 0) {
+        object->parent = objects[i - 1];
+      }
+      BKE_collection_object_add(bmain, collection, object);
+      objects.append(object);
+    }
+    BKE_collection_child_add(bmain, scene->master_collection, collection);
+    depsgraph = depsgraph_create();
+    DEG_evaluate_on_refresh(depsgraph);
+  }
+
+  ::Depsgraph *depsgraph_create()
+  {
+    ::Depsgraph *graph = DEG_graph_new(
+        bmain, scene, static_cast<ViewLayer *>(scene->view_layers.first), DAG_EVAL_VIEWPORT);
+    DEG_graph_build_from_view_layer(graph);
+    return graph;
+  }
+
+  void add_constraint(Object *object, Object *target)
+  {
+    bConstraint *constraint = BKE_constraint_add_for_object(
+        object, "Copy Location", CONSTRAINT_TYPE_LOCLIKE);
+    static_cast<bLocateLikeConstraint *>(constraint->data)->tar = target;
+  }
+
+  void add_array_modifier(Object *object, Object *offset_object)
+  {
+    ArrayModifierData *amd = reinterpret_cast<ArrayModifierData *>(
+        BKE_modifier_new(eModifierType_Array));
+    amd->offset_type |= MOD_ARR_OFF_OBJ;
+    amd->offset_ob = offset_object;
+    BLI_addtail(&object->modifiers, amd);
+  }
+
+  /* Update relations of the given object and compare them with a graph built from scratch. */
+  void expect_incremental_update_matches_full_build(Object *object, bool is_incremental = true)
+  {
+    Depsgraph *graph = reinterpret_cast<Depsgraph *>(depsgraph);
+    /* Nodes of the objects which are not related to the changed one are kept. */
+    const IDNode *unrelated_id_node = graph->find_id_node(&objects.last()->id);
+    DEG_id_relations_tag_update(bmain, &object->id);
+    /* The graph is left untouched when the incremental update is not possible, and is then built
+     * from scratch by the regular relations update. */
+    ViewLayerBuilderPipeline builder(depsgraph);
+    EXPECT_EQ(builder.build_incremental(graph->relations_update_ids), is_incremental);
+    DEG_graph_relations_update(depsgraph);
+    EXPECT_FALSE(graph->need_update);
+    if (is_incremental) {
+      EXPECT_EQ(graph->find_id_node(&objects.last()->id), unrelated_id_node);
+    }
+
+    ::Depsgraph *full_depsgraph = depsgraph_create();
+    expect_graphs_match(depsgraph, full_depsgraph);
+    DEG_graph_free(full_depsgraph);
+  }
+
+  void expect_graphs_match(::Depsgraph *depsgraph, ::Depsgraph *expected_depsgraph)
+  {
+    Depsgraph *graph = reinterpret_cast<Depsgraph *>(depsgraph);
+    Depsgraph *expected_graph = reinterpret_cast<Depsgraph *>(expected_depsgraph);
+    EXPECT_EQ(graph->id_nodes.size(), expected_graph->id_nodes.size());
+    EXPECT_EQ(graph->operations.size(), expected_graph->operations.size());
+
+    const std::set<std::string> relations = graph_relations(depsgraph);
+    const std::set<std::string> expected_relations = graph_relations(expected_depsgraph);
+    for (const std::string &relation : expected_relations) {
+      EXPECT_TRUE(relations.count(relation)) << "Missing relation " << relation;
+    }
+    for (const std::string &relation : relations) {
+      EXPECT_TRUE(expected_relations.count(relation)) << "Extra relation " << relation;
+    }
+  }
+};
+
+}  // namespace blender::deg::tests
@@ -25,9 +25,11 @@
 
 #include "DNA_ID.h"
 
+#include "intern/depsgraph.h"
+
 namespace blender::deg {
 
-BuilderMap::BuilderMap()
+BuilderMap::BuilderMap() : built_graph_(nullptr)
 {
 }
 
@@ -42,20 +44,47 @@ bool BuilderMap::checkIsBuilt(ID *id, int tag) const
 
 void BuilderMap::tagBuild(ID *id, int tag)
 {
-  id_tags_.lookup_or_add(id, 0) |= tag;
+  id_tags_.lookup_or_add_cb(id, [&]() { return getBuiltGraphIDTag(id); }) |= tag;
 }
 
 bool BuilderMap::checkIsBuiltAndTag(ID *id, int tag)
 {
-  int &id_tag = id_tags_.lookup_or_add(id, 0);
+  int &id_tag = id_tags_.lookup_or_add_cb(id, [&]() { return getBuiltGraphIDTag(id); });
   const bool result = (id_tag & tag) == tag;
   id_tag |= tag;
   return result;
 }
 
+void BuilderMap::setBuiltGraph(const Depsgraph *graph)
+{
+  built_graph_ = graph;
+}
+
+void BuilderMap::untagBuild(ID *id)
+{
+  id_tags_.add_overwrite(id, 0);
+}
+
+void BuilderMap::clear()
+{
+  id_tags_.clear();
+}
+
 int BuilderMap::getIDTag(ID *id) const
 {
-  return id_tags_.lookup_default(id, 0);
+  const int *id_tag = id_tags_.lookup_ptr(id);
+  if (id_tag != nullptr) {
+    return *id_tag;
+  }
+  return getBuiltGraphIDTag(id);
+}
+
+int BuilderMap::getBuiltGraphIDTag(ID *id) const
+{
+  if (built_graph_ != nullptr && built_graph_->find_id_node(id) != nullptr) {
+    return TAG_COMPLETE;
+  }
+  return 0;
 }
 
 }  // namespace blender::deg
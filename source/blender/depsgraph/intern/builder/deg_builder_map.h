@@ -30,6 +30,8 @@ struct ID;
 namespace blender {
 namespace deg {
 
+struct Depsgraph;
+
 class BuilderMap {
  public:
   enum {
@@ -60,6 +62,16 @@ class BuilderMap {
    * handled otherwise and return false. */
   bool checkIsBuiltAndTag(ID *id, int tag = TAG_COMPLETE);
 
+  /* Consider all IDs which have nodes in the given graph as handled, unless they are tagged
+   * otherwise. Used by builders which only build a part of the graph. */
+  void setBuiltGraph(const Depsgraph *graph);
+
+  /* Tag given ID as not handled, so it is built even if it has a node in the built graph. */
+  void untagBuild(ID *id);
+
+  /* Forget about all tagged IDs. */
+  void clear();
+
   template<typename T> bool checkIsBuilt(T *datablock, int tag = TAG_COMPLETE) const
   {
     return checkIsBuilt(&datablock->id, tag);
@@ -75,8 +87,10 @@ class BuilderMap {
 
  protected:
   int getIDTag(ID *id) const;
+  int getBuiltGraphIDTag(ID *id) const;
 
   Map<ID *, int> id_tags_;
+  const Depsgraph *built_graph_;
 };
 
 }  // namespace deg
@@ -307,48 +307,60 @@ ID *DepsgraphNodeBuilder::ensure_cow_id(ID *id_orig)
 
 /* **** Build functions for entity nodes **** */
 
+void DepsgraphNodeBuilder::save_id_info(IDNode *id_node)
+{
+  /* It is possible that the ID does not need to have CoW version in which case id_cow is the
+   * same as id_orig. Additionally, such ID might have been removed, which makes the check
+   * for whether id_cow is expanded to access freed memory. In order to deal with this we
+   * check whether CoW is needed based on a scalar value which does not lead to access of
+   * possibly deleted memory.
+   * Additionally, this saves some space in the map by skipping mapping for datablocks which
+   * do not need CoW, */
+  if (!deg_copy_on_write_is_needed(id_node->id_type)) {
+    id_node->id_cow = nullptr;
+    return;
+  }
+
+  IDInfo *id_info = (IDInfo *)MEM_mallocN(sizeof(IDInfo), "depsgraph id info");
+  if (deg_copy_on_write_is_expanded(id_node->id_cow) && id_node->id_orig != id_node->id_cow) {
+    id_info->id_cow = id_node->id_cow;
+    /* Ownership is taken by the ID info. */
+    id_node->id_cow = nullptr;
+  }
+  else {
+    /* Copy which was never expanded is not re-used, it is freed together with the node. */
+    id_info->id_cow = nullptr;
+  }
+  id_info->previously_visible_components_mask = id_node->visible_components_mask;
+  id_info->previous_eval_flags = id_node->eval_flags;
+  id_info->previous_customdata_masks = id_node->customdata_masks;
+  id_info_hash_.add_new(id_node->id_orig, id_info);
+}
+
+void DepsgraphNodeBuilder::save_entry_tag(OperationNode *op_node)
+{
+  ComponentNode *comp_node = op_node->owner;
+  IDNode *id_node = comp_node->owner;
+
+  SavedEntryTag entry_tag;
+  entry_tag.id_orig = id_node->id_orig;
+  entry_tag.component_type = comp_node->type;
+  entry_tag.opcode = op_node->opcode;
+  entry_tag.name = op_node->name;
+  entry_tag.name_tag = op_node->name_tag;
+  saved_entry_tags_.append(entry_tag);
+}
+
 void DepsgraphNodeBuilder::begin_build()
 {
   /* Store existing copy-on-write versions of datablock, so we can re-use
    * them for new ID nodes. */
   for (IDNode *id_node : graph_->id_nodes) {
-    /* It is possible that the ID does not need to have CoW version in which case id_cow is the
-     * same as id_orig. Additionally, such ID might have been removed, which makes the check
-     * for whether id_cow is expanded to access freed memory. In order to deal with this we
-     * check whether CoW is needed based on a scalar value which does not lead to access of
-     * possibly deleted memory.
-     * Additionally, this saves some space in the map by skipping mapping for datablocks which
-     * do not need CoW, */
-    if (!deg_copy_on_write_is_needed(id_node->id_type)) {
-      id_node->id_cow = nullptr;
-      continue;
-    }
-
-    IDInfo *id_info = (IDInfo *)MEM_mallocN(sizeof(IDInfo), "depsgraph id info");
-    if (deg_copy_on_write_is_expanded(id_node->id_cow) && id_node->id_orig != id_node->id_cow) {
-      id_info->id_cow = id_node->id_cow;
-    }
-    else {
-      id_info->id_cow = nullptr;
-    }
-    id_info->previously_visible_components_mask = id_node->visible_components_mask;
-    id_info->previous_eval_flags = id_node->eval_flags;
-    id_info->previous_customdata_masks = id_node->customdata_masks;
-    id_info_hash_.add_new(id_node->id_orig, id_info);
-    id_node->id_cow = nullptr;
+    save_id_info(id_node);
   }
 
   for (OperationNode *op_node : graph_->entry_tags) {
-    ComponentNode *comp_node = op_node->owner;
-    IDNode *id_node = comp_node->owner;
-
-    SavedEntryTag entry_tag;
-    entry_tag.id_orig = id_node->id_orig;
-    entry_tag.component_type = comp_node->type;
-    entry_tag.opcode = op_node->opcode;
-    entry_tag.name = op_node->name;
-    entry_tag.name_tag = op_node->name_tag;
-    saved_entry_tags_.append(entry_tag);
+    save_entry_tag(op_node);
   }
 
   /* Make sure graph has no nodes left from previous state. */
@@ -357,6 +369,43 @@ void DepsgraphNodeBuilder::begin_build()
   graph_->entry_tags.clear();
 }
 
+void DepsgraphNodeBuilder::begin_build_incremental(Span<Object *> objects)
+{
+  Set<IDNode *> id_nodes_to_remove;
+  for (Object *object : objects) {
+    IDNode *id_node = find_id_node(&object->id);
+    BLI_assert(id_node != nullptr);
+    IncrementalObject incremental_object;
+    incremental_object.object = object;
+    incremental_object.linked_state = id_node->linked_state;
+    incremental_object.is_directly_visible = id_node->is_directly_visible;
+    incremental_object.has_base = id_node->has_base;
+    incremental_objects_.append(incremental_object);
+    /* Copy-on-write datablock is re-used by the new ID node. */
+    save_id_info(id_node);
+    id_nodes_to_remove.add(id_node);
+  }
+
+  for (OperationNode *op_node : graph_->entry_tags) {
+    if (id_nodes_to_remove.contains(op_node->owner->owner)) {
+      save_entry_tag(op_node);
+    }
+  }
+
+  /* Nodes of all other IDs are kept. Consider their current state as the previous one, so that
+   * only changes caused by this build are detected when finalizing it. */
+  for (IDNode *id_node : graph_->id_nodes) {
+    if (id_nodes_to_remove.contains(id_node)) {
+      continue;
+    }
+    built_map_.tagBuild(id_node->id_orig);
+    id_node->previous_eval_flags = id_node->eval_flags;
+    id_node->previous_customdata_masks = id_node->customdata_masks;
+  }
+
+  graph_->remove_id_nodes(id_nodes_to_remove);
+}
+
 void DepsgraphNodeBuilder::end_build()
 {
   for (const SavedEntryTag &entry_tag : saved_entry_tags_) {
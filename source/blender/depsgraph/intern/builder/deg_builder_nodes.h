@@ -99,6 +99,10 @@ class DepsgraphNodeBuilder : public DepsgraphBuilder {
   }
 
   virtual void begin_build();
+  /* Begin incremental build: nodes of the given objects are removed from the graph, so they are
+   * built again by build_view_layer_incremental(). Nodes of all other IDs are kept as-is and are
+   * considered built. */
+  virtual void begin_build_incremental(Span<Object *> objects);
   virtual void end_build();
 
   IDNode *add_id_node(ID *id);
@@ -162,6 +166,7 @@ class DepsgraphNodeBuilder : public DepsgraphBuilder {
   virtual void build_view_layer(Scene *scene,
                                 ViewLayer *view_layer,
                                 eDepsNode_LinkedState_Type linked_state);
+  virtual void build_view_layer_incremental(Scene *scene, ViewLayer *view_layer);
   virtual void build_collection(LayerCollection *from_layer_collection, Collection *collection);
   virtual void build_object(int base_index,
                             Object *object,
@@ -259,6 +264,19 @@ class DepsgraphNodeBuilder : public DepsgraphBuilder {
   };
   Vector<SavedEntryTag> saved_entry_tags_;
 
+  /* Objects which are built again by an incremental build, with the state which was accumulated
+   * for them by the previous build of the graph. */
+  struct IncrementalObject {
+    Object *object;
+    eDepsNode_LinkedState_Type linked_state;
+    bool is_directly_visible;
+    bool has_base;
+  };
+  Vector<IncrementalObject> incremental_objects_;
+
+  void save_id_info(IDNode *id_node);
+  void save_entry_tag(OperationNode *op_node);
+
   struct BuilderWalkUserData {
     DepsgraphNodeBuilder *builder;
     /* Denotes whether object the walk is invoked from is visible. */
@@ -174,4 +174,34 @@ void DepsgraphNodeBuilder::build_view_layer(Scene *scene,
   }
 }
 
+void DepsgraphNodeBuilder::build_view_layer_incremental(Scene *scene, ViewLayer *view_layer)
+{
+  /* Same context as the full build of the view layer. */
+  view_layer_index_ = 0;
+  scene_ = scene;
+  view_layer_ = view_layer;
+  for (const IncrementalObject &incremental_object : incremental_objects_) {
+    Object *object = incremental_object.object;
+    /* Base index matches the one assigned by build_view_layer(). */
+    int base_index = -1;
+    if (incremental_object.has_base) {
+      int index = 0;
+      LISTBASE_FOREACH (Base *, base, &view_layer->object_bases) {
+        if (!need_pull_base_into_graph(base)) {
+          continue;
+        }
+        if (base->object == object) {
+          base_index = index;
+          break;
+        }
+        index++;
+      }
+    }
+    build_object(base_index,
+                 object,
+                 incremental_object.linked_state,
+                 incremental_object.is_directly_visible);
+  }
+}
+
 }  // namespace blender::deg
@@ -31,6 +31,8 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 #include "BLI_blenlib.h"
 #include "BLI_utildefines.h"
 
@@ -237,6 +239,20 @@ bool object_have_geometry_component(const Object *object)
   return ELEM(object->type, OB_MESH, OB_CURVE, OB_FONT, OB_SURF, OB_MBALL, OB_LATTICE, OB_GPENCIL);
 }
 
+/* Masks of an ID node are extended while building relations of other IDs, which might happen from
+ * multiple threads. */
+void customdata_mask_atomic_or(uint64_t *mask, const uint64_t bits)
+{
+  uint64_t old_mask = *mask;
+  while ((old_mask | bits) != old_mask) {
+    const uint64_t prev_mask = atomic_cas_uint64(mask, old_mask, old_mask | bits);
+    if (prev_mask == old_mask) {
+      break;
+    }
+    old_mask = prev_mask;
+  }
+}
+
 }  // namespace
 
 /* **** General purpose functions ****  */
@@ -244,7 +260,11 @@ bool object_have_geometry_component(const Object *object)
 DepsgraphRelationBuilder::DepsgraphRelationBuilder(Main *bmain,
                                                    Depsgraph *graph,
                                                    DepsgraphBuilderCache *cache)
-    : DepsgraphBuilder(bmain, graph, cache), scene_(nullptr), rna_node_query_(graph, this)
+    : DepsgraphBuilder(bmain, graph, cache),
+      scene_(nullptr),
+      extra_relation_flags_(0),
+      deferred_relations_(nullptr),
+      rna_node_query_(graph, this)
 {
 }
 
@@ -328,11 +348,27 @@ void DepsgraphRelationBuilder::add_customdata_mask(Object *object,
       BLI_assert(!"ID should always be valid");
     }
     else {
-      id_node->customdata_masks |= customdata_masks;
+      customdata_mask_atomic_or(&id_node->customdata_masks.vert_mask, customdata_masks.vert_mask);
+      customdata_mask_atomic_or(&id_node->customdata_masks.edge_mask, customdata_masks.edge_mask);
+      customdata_mask_atomic_or(&id_node->customdata_masks.face_mask, customdata_masks.face_mask);
+      customdata_mask_atomic_or(&id_node->customdata_masks.loop_mask, customdata_masks.loop_mask);
+      customdata_mask_atomic_or(&id_node->customdata_masks.poly_mask, customdata_masks.poly_mask);
     }
   }
 }
 
+Relation *DepsgraphRelationBuilder::add_new_relation(Node *node_from,
+                                                     Node *node_to,
+                                                     const char *description,
+                                                     int flags)
+{
+  if (deferred_relations_ != nullptr) {
+    return graph_->create_deferred_relation(
+        node_from, node_to, description, flags, *deferred_relations_);
+  }
+  return graph_->add_new_relation(node_from, node_to, description, flags);
+}
+
 void DepsgraphRelationBuilder::add_special_eval_flag(ID *id, uint32_t flag)
 {
   IDNode *id_node = graph_->find_id_node(id);
@@ -340,7 +376,7 @@ void DepsgraphRelationBuilder::add_special_eval_flag(ID *id, uint32_t flag)
     BLI_assert(!"ID should always be valid");
   }
   else {
-    id_node->eval_flags |= flag;
+    atomic_fetch_and_or_uint32(&id_node->eval_flags, flag);
   }
 }
 
@@ -350,7 +386,7 @@ Relation *DepsgraphRelationBuilder::add_time_relation(TimeSourceNode *timesrc,
                                                       int flags)
 {
   if (timesrc && node_to) {
-    return graph_->add_new_relation(timesrc, node_to, description, flags);
+    return add_new_relation(timesrc, node_to, description, flags | extra_relation_flags_);
   }
 
   DEG_DEBUG_PRINTF((::Depsgraph *)graph_,
@@ -371,7 +407,7 @@ Relation *DepsgraphRelationBuilder::add_operation_relation(OperationNode *node_f
                                                            int flags)
 {
   if (node_from && node_to) {
-    return graph_->add_new_relation(node_from, node_to, description, flags);
+    return add_new_relation(node_from, node_to, description, flags | extra_relation_flags_);
   }
 
   DEG_DEBUG_PRINTF((::Depsgraph *)graph_,
@@ -478,6 +514,76 @@ void DepsgraphRelationBuilder::begin_build()
 {
 }
 
+void DepsgraphRelationBuilder::begin_build_incremental(const Set<ID *> &ids)
+{
+  for (IDNode *id_node : graph_->id_nodes) {
+    if (!ids.contains(id_node->id_orig)) {
+      built_map_.tagBuild(id_node->id_orig);
+    }
+  }
+  extra_relation_flags_ = RELATION_CHECK_BEFORE_ADD;
+}
+
+bool DepsgraphRelationBuilder::can_build_id_relations(ID_Type id_type)
+{
+  switch (id_type) {
+    case ID_AC:
+    case ID_AR:
+    case ID_CA:
+    case ID_GR:
+    case ID_OB:
+    case ID_KE:
+    case ID_LA:
+    case ID_LP:
+    case ID_NT:
+    case ID_MA:
+    case ID_TE:
+    case ID_IM:
+    case ID_WO:
+    case ID_MSK:
+    case ID_LS:
+    case ID_MC:
+    case ID_ME:
+    case ID_CU:
+    case ID_MB:
+    case ID_LT:
+    case ID_HA:
+    case ID_PT:
+    case ID_VO:
+    case ID_GD:
+    case ID_PA:
+    case ID_SPK:
+    case ID_SO:
+    case ID_CF:
+    case ID_SCE:
+    case ID_SIM:
+      return true;
+    default:
+      return false;
+  }
+}
+
+void DepsgraphRelationBuilder::build_id_separately(Scene *scene, ID *id)
+{
+  scene_ = scene;
+  built_map_.clear();
+  built_map_.setBuiltGraph(graph_);
+  built_map_.untagBuild(id);
+  build_id(id);
+}
+
+void DepsgraphRelationBuilder::set_deferred_relations(Vector<Relation *> *r_relations)
+{
+  deferred_relations_ = r_relations;
+}
+
+void DepsgraphRelationBuilder::tag_ids_built(Span<ID *> ids)
+{
+  for (ID *id : ids) {
+    built_map_.tagBuild(id);
+  }
+}
+
 void DepsgraphRelationBuilder::build_id(ID *id)
 {
   if (id == nullptr) {
@@ -539,8 +645,12 @@ void DepsgraphRelationBuilder::build_id(ID *id)
     case ID_HA:
     case ID_PT:
     case ID_VO:
+    case ID_GD:
       build_object_data_geometry_datablock(id);
       break;
+    case ID_PA:
+      build_particle_settings((ParticleSettings *)id);
+      break;
     case ID_SPK:
       build_speaker((Speaker *)id);
       break;
@@ -1326,8 +1436,7 @@ void DepsgraphRelationBuilder::build_animdata_curves_targets(ID *id,
       add_relation(adt_key, pose_init_key, "Animation -> Prop", RELATION_CHECK_BEFORE_ADD);
       continue;
     }
-    graph_->add_new_relation(
-        operation_from, operation_to, "Animation -> Prop", RELATION_CHECK_BEFORE_ADD);
+    add_new_relation(operation_from, operation_to, "Animation -> Prop", RELATION_CHECK_BEFORE_ADD);
     /* It is possible that animation is writing to a nested ID data-block,
      * need to make sure animation is evaluated after target ID is copied. */
     const IDNode *id_node_from = operation_from->owner->owner;
@@ -2791,6 +2900,10 @@ void DepsgraphRelationBuilder::build_copy_on_write_relations(IDNode *id_node)
       /* Component explicitly requests to not add relation. */
       continue;
     }
+    if (comp_node->operations_map == nullptr) {
+      /* Component was kept as-is by an incremental build, its relations are up to date. */
+      continue;
+    }
     int rel_flag = (RELATION_FLAG_NO_FLUSH | RELATION_FLAG_GODMODE);
     if ((ELEM(id_type, ID_ME, ID_HA, ID_PT, ID_VO) && comp_node->type == NodeType::GEOMETRY) ||
         (id_type == ID_CF && comp_node->type == NodeType::CACHE)) {
@@ -2820,7 +2933,7 @@ void DepsgraphRelationBuilder::build_copy_on_write_relations(IDNode *id_node)
      * copy of ID. */
     OperationNode *op_entry = comp_node->get_entry_operation();
     if (op_entry != nullptr) {
-      Relation *rel = graph_->add_new_relation(op_cow, op_entry, "CoW Dependency");
+      Relation *rel = add_new_relation(op_cow, op_entry, "CoW Dependency", extra_relation_flags_);
       rel->flag |= rel_flag;
     }
     /* All dangling operations should also be executed after copy-on-write. */
@@ -2829,7 +2942,7 @@ void DepsgraphRelationBuilder::build_copy_on_write_relations(IDNode *id_node)
         continue;
       }
       if (op_node->inlinks.is_empty()) {
-        Relation *rel = graph_->add_new_relation(op_cow, op_node, "CoW Dependency");
+        Relation *rel = add_new_relation(op_cow, op_node, "CoW Dependency", extra_relation_flags_);
         rel->flag |= rel_flag;
       }
       else {
@@ -2845,7 +2958,8 @@ void DepsgraphRelationBuilder::build_copy_on_write_relations(IDNode *id_node)
           }
         }
         if (!has_same_comp_dependency) {
-          Relation *rel = graph_->add_new_relation(op_cow, op_node, "CoW Dependency");
+          Relation *rel = add_new_relation(
+              op_cow, op_node, "CoW Dependency", extra_relation_flags_);
           rel->flag |= rel_flag;
         }
       }
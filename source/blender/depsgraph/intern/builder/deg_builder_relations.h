@@ -164,6 +164,24 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
   DepsgraphRelationBuilder(Main *bmain, Depsgraph *graph, DepsgraphBuilderCache *cache);
 
   void begin_build();
+  /* Begin incremental build: relations are only built for the given IDs and for the IDs which are
+   * new in the graph, all other IDs are considered built. Relations are added with the
+   * RELATION_CHECK_BEFORE_ADD flag, so the ones kept from the previous build are not
+   * duplicated. */
+  void begin_build_incremental(const Set<ID *> &ids);
+
+  /* Relations of IDs of this type are fully built by build_id(). */
+  static bool can_build_id_relations(ID_Type id_type);
+  /* Build relations of the given ID only: all other IDs which have nodes in the graph are
+   * considered built, so the builder does not go into the IDs the given one depends on. Used to
+   * build relations of different IDs from multiple threads. */
+  void build_id_separately(Scene *scene, ID *id);
+  /* Instead of adding relations to the graph, append them to the given vector. See
+   * Depsgraph::create_deferred_relation(). Passing nullptr adds relations to the graph again. */
+  void set_deferred_relations(Vector<Relation *> *r_relations);
+  /* Tag IDs as built, so the builder does not go into them. Used for IDs which relations were
+   * built separately. */
+  void tag_ids_built(Span<ID *> ids);
 
   template<typename KeyFrom, typename KeyTo>
   Relation *add_relation(const KeyFrom &key_from,
@@ -209,6 +227,7 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
   virtual void build_view_layer(Scene *scene,
                                 ViewLayer *view_layer,
                                 eDepsNode_LinkedState_Type linked_state);
+  virtual void build_view_layer_incremental(Scene *scene, Span<ID *> ids);
   virtual void build_collection(LayerCollection *from_layer_collection,
                                 Object *object,
                                 Collection *collection);
@@ -337,6 +356,7 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
                                    OperationNode *node_to,
                                    const char *description,
                                    int flags = 0);
+  Relation *add_new_relation(Node *node_from, Node *node_to, const char *description, int flags);
 
   template<typename KeyType>
   DepsNodeHandle create_node_handle(const KeyType &key, const char *default_name = "");
@@ -370,6 +390,10 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
 
   /* State which demotes currently built entities. */
   Scene *scene_;
+  /* Flags added to every relation, used by incremental build. */
+  int extra_relation_flags_;
+  /* Relations are appended here instead of being added to the graph, when not nullptr. */
+  Vector<Relation *> *deferred_relations_;
 
   BuilderMap built_map_;
   RNANodeQuery rna_node_query_;
@@ -153,4 +153,15 @@ void DepsgraphRelationBuilder::build_view_layer(Scene *scene,
   }
 }
 
+void DepsgraphRelationBuilder::build_view_layer_incremental(Scene *scene, Span<ID *> ids)
+{
+  /* Same context as the full build of the view layer. */
+  scene_ = scene;
+  /* IDs which are new in the graph are not tagged as built, so they are handled while
+   * traversing the given ones. */
+  for (ID *id : ids) {
+    build_id(id);
+  }
+}
+
 }  // namespace blender::deg
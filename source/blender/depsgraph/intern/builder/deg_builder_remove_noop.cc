@@ -46,16 +46,9 @@ static inline bool is_unused_noop(OperationNode *op_node)
   return op_node->is_noop() && op_node->outlinks.is_empty();
 }
 
-void deg_graph_remove_unused_noops(Depsgraph *graph)
+static void remove_unused_noops(Depsgraph *graph, deque<OperationNode *> &queue)
 {
   int num_removed_relations = 0;
-  deque<OperationNode *> queue;
-
-  for (OperationNode *node : graph->operations) {
-    if (is_unused_noop(node)) {
-      queue.push_back(node);
-    }
-  }
 
   while (!queue.empty()) {
     OperationNode *to_remove = queue.front();
@@ -84,4 +77,30 @@ void deg_graph_remove_unused_noops(Depsgraph *graph)
       (::Depsgraph *)graph, BUILD, "Removed %d relations to no-op nodes\n", num_removed_relations);
 }
 
+void deg_graph_remove_unused_noops(Depsgraph *graph)
+{
+  deque<OperationNode *> queue;
+
+  for (OperationNode *node : graph->operations) {
+    if (is_unused_noop(node)) {
+      queue.push_back(node);
+    }
+  }
+
+  remove_unused_noops(graph, queue);
+}
+
+void deg_graph_remove_unused_noops(Depsgraph *graph, Span<OperationNode *> operations)
+{
+  deque<OperationNode *> queue;
+
+  for (OperationNode *node : operations) {
+    if (is_unused_noop(node)) {
+      queue.push_back(node);
+    }
+  }
+
+  remove_unused_noops(graph, queue);
+}
+
 }  // namespace blender::deg
@@ -23,13 +23,20 @@
 
 #pragma once
 
+#include "BLI_span.hh"
+
 namespace blender {
 namespace deg {
 
 struct Depsgraph;
+struct OperationNode;
 
 /* Remove all no-op nodes that have zero outgoing relations. */
 void deg_graph_remove_unused_noops(Depsgraph *graph);
 
+/* Same as above, but only starts from the given operations. No-op nodes which become unused after
+ * removing relations to them are removed as well. */
+void deg_graph_remove_unused_noops(Depsgraph *graph, Span<OperationNode *> operations);
+
 }  // namespace deg
 }  // namespace blender
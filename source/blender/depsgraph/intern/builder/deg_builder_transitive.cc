@@ -55,56 +55,85 @@ enum {
   OP_REACHABLE = 2,
 };
 
-static void deg_graph_tag_paths_recursive(Node *node)
+static void deg_graph_tag_paths_recursive(Node *node, Vector<Node *> &r_tagged_nodes)
 {
   if (node->custom_flags & OP_VISITED) {
     return;
   }
   node->custom_flags |= OP_VISITED;
+  r_tagged_nodes.append(node);
   for (Relation *rel : node->inlinks) {
-    deg_graph_tag_paths_recursive(rel->from);
+    deg_graph_tag_paths_recursive(rel->from, r_tagged_nodes);
     /* Do this only in inlinks loop, so the target node does not get
      * flagged. */
     rel->from->custom_flags |= OP_REACHABLE;
   }
 }
 
+/* Remove relations to the target which are redundant. Expects flags of all nodes to be cleared,
+ * nodes which got flagged are appended to r_tagged_nodes. */
+static int deg_graph_reduce_target(OperationNode *target, Vector<Node *> &r_tagged_nodes)
+{
+  Vector<Relation *> relations_to_remove;
+  /* Mark nodes from which we can reach the target
+   * start with children, so the target node and direct children are not
+   * flagged. */
+  target->custom_flags |= OP_VISITED;
+  r_tagged_nodes.append(target);
+  for (Relation *rel : target->inlinks) {
+    deg_graph_tag_paths_recursive(rel->from, r_tagged_nodes);
+  }
+  /* Remove redundant paths to the target. */
+  for (Relation *rel : target->inlinks) {
+    if (rel->from->type == NodeType::TIMESOURCE) {
+      /* HACK: time source nodes don't get "custom_flags" flag
+       * set/cleared. */
+      /* TODO: there will be other types in future, so iterators above
+       * need modifying. */
+      continue;
+    }
+    if (rel->from->custom_flags & OP_REACHABLE) {
+      relations_to_remove.append(rel);
+    }
+  }
+  for (Relation *rel : relations_to_remove) {
+    rel->unlink();
+    delete rel;
+  }
+  return relations_to_remove.size();
+}
+
 void deg_graph_transitive_reduction(Depsgraph *graph)
 {
   int num_removed_relations = 0;
-  Vector<Relation *> relations_to_remove;
+  Vector<Node *> tagged_nodes;
 
   for (OperationNode *target : graph->operations) {
     /* Clear tags. */
     for (OperationNode *node : graph->operations) {
       node->custom_flags = 0;
     }
-    /* Mark nodes from which we can reach the target
-     * start with children, so the target node and direct children are not
-     * flagged. */
-    target->custom_flags |= OP_VISITED;
-    for (Relation *rel : target->inlinks) {
-      deg_graph_tag_paths_recursive(rel->from);
-    }
-    /* Remove redundant paths to the target. */
-    for (Relation *rel : target->inlinks) {
-      if (rel->from->type == NodeType::TIMESOURCE) {
-        /* HACK: time source nodes don't get "custom_flags" flag
-         * set/cleared. */
-        /* TODO: there will be other types in future, so iterators above
-         * need modifying. */
-        continue;
-      }
-      if (rel->from->custom_flags & OP_REACHABLE) {
-        relations_to_remove.append(rel);
-      }
-    }
-    for (Relation *rel : relations_to_remove) {
-      rel->unlink();
-      delete rel;
+    num_removed_relations += deg_graph_reduce_target(target, tagged_nodes);
+    tagged_nodes.clear();
+  }
+  DEG_DEBUG_PRINTF((::Depsgraph *)graph, BUILD, "Removed %d relations\n", num_removed_relations);
+}
+
+void deg_graph_transitive_reduction(Depsgraph *graph, Span<OperationNode *> targets)
+{
+  int num_removed_relations = 0;
+  Vector<Node *> tagged_nodes;
+
+  for (OperationNode *node : graph->operations) {
+    node->custom_flags = 0;
+  }
+  for (OperationNode *target : targets) {
+    num_removed_relations += deg_graph_reduce_target(target, tagged_nodes);
+    /* Only clear tags of the nodes which were visited for this target. */
+    for (Node *node : tagged_nodes) {
+      node->custom_flags = 0;
     }
-    num_removed_relations += relations_to_remove.size();
-    relations_to_remove.clear();
+    tagged_nodes.clear();
   }
   DEG_DEBUG_PRINTF((::Depsgraph *)graph, BUILD, "Removed %d relations\n", num_removed_relations);
 }
@@ -23,13 +23,19 @@
 
 #pragma once
 
+#include "BLI_span.hh"
+
 namespace blender {
 namespace deg {
 
 struct Depsgraph;
+struct OperationNode;
 
 /* Performs a transitive reduction to remove redundant relations. */
 void deg_graph_transitive_reduction(Depsgraph *graph);
 
+/* Same as above, but only removes redundant relations to the given operations. */
+void deg_graph_transitive_reduction(Depsgraph *graph, Span<OperationNode *> targets);
+
 }  // namespace deg
 }  // namespace blender
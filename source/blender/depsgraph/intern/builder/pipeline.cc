@@ -21,6 +21,8 @@
 
 #include "PIL_time.h"
 
+#include "BLI_task.h"
+
 #include "BKE_global.h"
 
 #include "DNA_scene_types.h"
@@ -30,8 +32,50 @@
 #include "deg_builder_relations.h"
 #include "deg_builder_transitive.h"
 
+#include "intern/depsgraph.h"
+#include "intern/node/deg_node_id.h"
+
 namespace blender::deg {
 
+namespace {
+
+struct ParallelRelationsData {
+  Span<IDNode *> id_nodes;
+  const function<void(DepsgraphRelationBuilder &builder, IDNode *id_node)> *build_func;
+  const function<unique_ptr<DepsgraphRelationBuilder>()> *construct_func;
+  /* Relations of every ID node, added to the graph once all of them are built. */
+  Vector<Vector<Relation *>> *relations;
+};
+
+struct ParallelRelationsTLS {
+  /* Created on first use, so threads which do not get any work do not allocate a builder. */
+  DepsgraphRelationBuilder *builder;
+};
+
+void build_relations_parallel_func(void *__restrict data_v,
+                                   const int i,
+                                   const TaskParallelTLS *__restrict tls)
+{
+  ParallelRelationsData *data = (ParallelRelationsData *)data_v;
+  ParallelRelationsTLS *relations_tls = (ParallelRelationsTLS *)tls->userdata_chunk;
+  if (relations_tls->builder == nullptr) {
+    relations_tls->builder = (*data->construct_func)().release();
+  }
+  DepsgraphRelationBuilder &builder = *relations_tls->builder;
+  builder.set_deferred_relations(&(*data->relations)[i]);
+  (*data->build_func)(builder, data->id_nodes[i]);
+  builder.set_deferred_relations(nullptr);
+}
+
+void build_relations_parallel_free(const void *__restrict /*userdata*/, void *__restrict chunk_v)
+{
+  ParallelRelationsTLS *relations_tls = (ParallelRelationsTLS *)chunk_v;
+  delete relations_tls->builder;
+  relations_tls->builder = nullptr;
+}
+
+}  // namespace
+
 AbstractBuilderPipeline::AbstractBuilderPipeline(::Depsgraph *graph)
     : deg_graph_(reinterpret_cast<Depsgraph *>(graph)),
       bmain_(deg_graph_->bmain),
@@ -83,10 +127,44 @@ void AbstractBuilderPipeline::build_step_relations()
   unique_ptr<DepsgraphRelationBuilder> relation_builder = construct_relation_builder();
   relation_builder->begin_build();
   build_relations(*relation_builder);
-  relation_builder->build_copy_on_write_relations();
+  /* Copy-on-write relations of an ID only connect its own operations. */
+  build_relations_parallel(deg_graph_->id_nodes,
+                           [](DepsgraphRelationBuilder &builder, IDNode *id_node) {
+                             builder.build_copy_on_write_relations(id_node);
+                           });
   relation_builder->build_driver_relations();
 }
 
+void AbstractBuilderPipeline::build_relations_parallel(
+    Span<IDNode *> id_nodes,
+    const function<void(DepsgraphRelationBuilder &builder, IDNode *id_node)> &build_func)
+{
+  const function<unique_ptr<DepsgraphRelationBuilder>()> construct_func = [this]() {
+    return construct_relation_builder();
+  };
+  Vector<Vector<Relation *>> relations(id_nodes.size());
+  ParallelRelationsData data;
+  data.id_nodes = id_nodes;
+  data.build_func = &build_func;
+  data.construct_func = &construct_func;
+  data.relations = &relations;
+  ParallelRelationsTLS relations_tls;
+  relations_tls.builder = nullptr;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (G.debug & G_DEBUG_DEPSGRAPH_NO_THREADS) == 0;
+  settings.min_iter_per_thread = 8;
+  settings.userdata_chunk = &relations_tls;
+  settings.userdata_chunk_size = sizeof(relations_tls);
+  settings.func_free = build_relations_parallel_free;
+  BLI_task_parallel_range(0, id_nodes.size(), &data, build_relations_parallel_func, &settings);
+
+  for (Span<Relation *> id_relations : relations) {
+    deg_graph_->add_deferred_relations(id_relations);
+  }
+}
+
 void AbstractBuilderPipeline::build_step_finalize()
 {
   /* Detect and solve cycles. */
@@ -98,10 +176,22 @@ void AbstractBuilderPipeline::build_step_finalize()
   if (G.debug_value == 799) {
     deg_graph_transitive_reduction(deg_graph_);
   }
+  build_step_finalize_state();
+}
+
+/* Finalization which is common for the full and incremental builds, after cycles are solved.
+ * The incremental build passes the ID nodes it changed, the rest of the graph is kept as-is. */
+void AbstractBuilderPipeline::build_step_finalize_state(const Vector<IDNode *> *changed_id_nodes)
+{
   /* Store pointers to commonly used valuated datablocks. */
   deg_graph_->scene_cow = (Scene *)deg_graph_->get_cow_id(&deg_graph_->scene->id);
   /* Flush visibility layer and re-schedule nodes for update. */
-  deg_graph_build_finalize(bmain_, deg_graph_);
+  if (changed_id_nodes != nullptr) {
+    deg_graph_build_finalize(bmain_, deg_graph_, *changed_id_nodes);
+  }
+  else {
+    deg_graph_build_finalize(bmain_, deg_graph_);
+  }
   DEG_graph_on_visible_update(bmain_, reinterpret_cast<::Depsgraph *>(deg_graph_), false);
 #if 0
   if (!DEG_debug_consistency_check(deg_graph_)) {
@@ -111,6 +201,7 @@ void AbstractBuilderPipeline::build_step_finalize()
 #endif
   /* Relations are up to date. */
   deg_graph_->need_update = false;
+  deg_graph_->relations_update_ids.clear();
 }
 
 unique_ptr<DepsgraphNodeBuilder> AbstractBuilderPipeline::construct_node_builder()
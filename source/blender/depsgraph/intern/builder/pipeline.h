@@ -36,6 +36,7 @@ namespace blender {
 namespace deg {
 
 struct Depsgraph;
+struct IDNode;
 class DepsgraphNodeBuilder;
 class DepsgraphRelationBuilder;
 
@@ -68,6 +69,14 @@ class AbstractBuilderPipeline {
   void build_step_nodes();
   void build_step_relations();
   void build_step_finalize();
+  void build_step_finalize_state(const Vector<IDNode *> *changed_id_nodes = nullptr);
+
+  /* Build relations of the given ID nodes from multiple threads, every thread uses its own
+   * relation builder. Relations are added to the graph in the order of the ID nodes, so the
+   * result does not depend on the scheduling. */
+  void build_relations_parallel(
+      Span<IDNode *> id_nodes,
+      const function<void(DepsgraphRelationBuilder &builder, IDNode *id_node)> &build_func);
 
   virtual void build_nodes(DepsgraphNodeBuilder &node_builder) = 0;
   virtual void build_relations(DepsgraphRelationBuilder &relation_builder) = 0;
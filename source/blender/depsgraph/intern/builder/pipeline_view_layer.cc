@@ -19,9 +19,27 @@
 
 #include "pipeline_view_layer.h"
 
+#include "PIL_time.h"
+
+#include "BLI_listbase.h"
+#include "BLI_utildefines.h"
+
+#include "BKE_global.h"
+
+#include "DNA_modifier_types.h"
+#include "DNA_object_force_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "intern/builder/deg_builder_cycle.h"
 #include "intern/builder/deg_builder_nodes.h"
 #include "intern/builder/deg_builder_relations.h"
+#include "intern/builder/deg_builder_transitive.h"
 #include "intern/depsgraph.h"
+#include "intern/depsgraph_relation.h"
+#include "intern/node/deg_node_component.h"
+#include "intern/node/deg_node_id.h"
+#include "intern/node/deg_node_operation.h"
 
 namespace blender::deg {
 
@@ -37,7 +55,209 @@ void ViewLayerBuilderPipeline::build_nodes(DepsgraphNodeBuilder &node_builder)
 
 void ViewLayerBuilderPipeline::build_relations(DepsgraphRelationBuilder &relation_builder)
 {
+  /* Relations of an ID do not depend on where the ID is used from, so they are built for every ID
+   * separately from multiple threads. The scene is built together with the view layer afterwards,
+   * which only adds the relations of the scene itself then.
+   *
+   * Objects of set scenes are built in the context of their own scene, and relations of IDs of
+   * unsupported types are only built when the ID is reached from another one. Such graphs are
+   * built by traversing the view layer, same as when threading is disabled for debugging. */
+  Vector<IDNode *> id_nodes;
+  if (scene_->set == nullptr && (G.debug & G_DEBUG_DEPSGRAPH_NO_THREADS) == 0) {
+    for (IDNode *id_node : deg_graph_->id_nodes) {
+      if (!DepsgraphRelationBuilder::can_build_id_relations(id_node->id_type)) {
+        id_nodes.clear();
+        break;
+      }
+      if (id_node->id_type != ID_SCE) {
+        id_nodes.append(id_node);
+      }
+    }
+  }
+  if (!id_nodes.is_empty()) {
+    Scene *scene = scene_;
+    build_relations_parallel(id_nodes,
+                             [scene](DepsgraphRelationBuilder &builder, IDNode *id_node) {
+                               builder.build_id_separately(scene, id_node->id_orig);
+                             });
+    Vector<ID *> ids;
+    for (IDNode *id_node : id_nodes) {
+      ids.append(id_node->id_orig);
+    }
+    relation_builder.tag_ids_built(ids);
+  }
   relation_builder.build_view_layer(scene_, view_layer_, DEG_ID_LINKED_DIRECTLY);
 }
 
+namespace {
+
+bool object_supports_incremental_build(const Object *object)
+{
+  if (object->proxy != nullptr || object->proxy_from != nullptr) {
+    return false;
+  }
+  /* Colliders, effectors and rigid bodies are cached in the physics relations of the graph, which
+   * are only updated by the full build. */
+  if (object->pd != nullptr && object->pd->forcefield != PFIELD_NULL) {
+    return false;
+  }
+  if (object->rigidbody_object != nullptr || object->rigidbody_constraint != nullptr) {
+    return false;
+  }
+  LISTBASE_FOREACH (const ModifierData *, md, &object->modifiers) {
+    if (ELEM(md->type, eModifierType_Collision, eModifierType_Fluid, eModifierType_DynamicPaint)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template<typename Func> void foreach_operation(IDNode *id_node, const Func &func)
+{
+  for (ComponentNode *comp_node : id_node->components.values()) {
+    if (comp_node->operations_map != nullptr) {
+      for (OperationNode *op_node : comp_node->operations_map->values()) {
+        func(op_node);
+      }
+    }
+    else {
+      for (OperationNode *op_node : comp_node->operations) {
+        func(op_node);
+      }
+    }
+  }
+}
+
+/* ID node which has operations added by the current build. */
+bool id_node_is_rebuilt(const IDNode *id_node)
+{
+  for (const ComponentNode *comp_node : id_node->components.values()) {
+    if (comp_node->operations_map != nullptr) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+bool ViewLayerBuilderPipeline::build_incremental(const Set<ID *> &ids)
+{
+  double start_time = 0.0;
+  if (G.debug & (G_DEBUG_DEPSGRAPH_BUILD | G_DEBUG_DEPSGRAPH_TIME)) {
+    start_time = PIL_check_seconds_timer();
+  }
+
+  Vector<Object *> objects;
+  for (ID *id : ids) {
+    IDNode *id_node = deg_graph_->find_id_node(id);
+    if (id_node == nullptr || id_node->id_type != ID_OB ||
+        id_node->linked_state == DEG_ID_LINKED_VIA_SET) {
+      return false;
+    }
+    Object *object = reinterpret_cast<Object *>(id);
+    if (!object_supports_incremental_build(object)) {
+      return false;
+    }
+    objects.append(object);
+  }
+  /* Rebuilding a big part of the graph is not faster than building it from scratch. */
+  if (objects.size() * 4 > deg_graph_->id_nodes.size()) {
+    return false;
+  }
+
+  /* Relations to and from the operations of the objects are removed together with them, so all
+   * the IDs on the other side of those relations need to have their relations built again. */
+  Set<ID *> relation_ids = ids;
+  for (Object *object : objects) {
+    IDNode *id_node = deg_graph_->find_id_node(&object->id);
+    bool is_supported = true;
+    auto add_relation_id = [&](Node *node) {
+      if (node->type != NodeType::OPERATION) {
+        return;
+      }
+      const IDNode *other_id_node = static_cast<OperationNode *>(node)->owner->owner;
+      if (!DepsgraphRelationBuilder::can_build_id_relations(other_id_node->id_type)) {
+        is_supported = false;
+      }
+      relation_ids.add(other_id_node->id_orig);
+    };
+    foreach_operation(id_node, [&](OperationNode *op_node) {
+      for (Relation *rel : op_node->inlinks) {
+        add_relation_id(rel->from);
+      }
+      for (Relation *rel : op_node->outlinks) {
+        add_relation_id(rel->to);
+      }
+    });
+    if (!is_supported) {
+      return false;
+    }
+  }
+
+  build_step_sanity_check();
+
+  /* Nodes. */
+  unique_ptr<DepsgraphNodeBuilder> node_builder = construct_node_builder();
+  node_builder->begin_build_incremental(objects);
+  node_builder->build_view_layer_incremental(scene_, view_layer_);
+  node_builder->end_build();
+
+  /* IDs which got new operations: the objects themselves, IDs which were not in the graph yet,
+   * and kept IDs which got operations added by the objects. */
+  Vector<IDNode *> rebuilt_id_nodes;
+  for (IDNode *id_node : deg_graph_->id_nodes) {
+    if (id_node_is_rebuilt(id_node)) {
+      rebuilt_id_nodes.append(id_node);
+      relation_ids.add(id_node->id_orig);
+    }
+  }
+  /* Keep order of the full build. */
+  Vector<ID *> relation_ids_ordered;
+  for (IDNode *id_node : deg_graph_->id_nodes) {
+    if (relation_ids.contains(id_node->id_orig)) {
+      relation_ids_ordered.append(id_node->id_orig);
+    }
+  }
+
+  /* Relations. */
+  unique_ptr<DepsgraphRelationBuilder> relation_builder = construct_relation_builder();
+  relation_builder->begin_build_incremental(relation_ids);
+  relation_builder->build_view_layer_incremental(scene_, relation_ids_ordered);
+  for (IDNode *id_node : rebuilt_id_nodes) {
+    relation_builder->build_copy_on_write_relations(id_node);
+  }
+  for (ID *id : relation_ids_ordered) {
+    relation_builder->build_driver_relations(deg_graph_->find_id_node(id));
+  }
+
+  /* New cycles can only pass through the new operations. */
+  Vector<OperationNode *> rebuilt_operations;
+  for (IDNode *id_node : rebuilt_id_nodes) {
+    foreach_operation(id_node,
+                      [&](OperationNode *op_node) { rebuilt_operations.append(op_node); });
+  }
+  deg_graph_detect_cycles(deg_graph_, rebuilt_operations);
+  if (G.debug_value == 799) {
+    Vector<OperationNode *> target_operations;
+    for (ID *id : relation_ids_ordered) {
+      foreach_operation(deg_graph_->find_id_node(id),
+                        [&](OperationNode *op_node) { target_operations.append(op_node); });
+    }
+    deg_graph_transitive_reduction(deg_graph_, target_operations);
+  }
+  Vector<IDNode *> changed_id_nodes;
+  for (ID *id : relation_ids_ordered) {
+    changed_id_nodes.append(deg_graph_->find_id_node(id));
+  }
+  build_step_finalize_state(&changed_id_nodes);
+
+  if (G.debug & (G_DEBUG_DEPSGRAPH_BUILD | G_DEBUG_DEPSGRAPH_TIME)) {
+    printf("Depsgraph relations of %d IDs updated in %f seconds.\n",
+           int(relation_ids.size()),
+           PIL_check_seconds_timer() - start_time);
+  }
+  return true;
+}
+
 }  // namespace blender::deg
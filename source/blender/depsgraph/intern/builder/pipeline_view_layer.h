@@ -25,6 +25,10 @@
 
 #include "pipeline.h"
 
+#include "intern/depsgraph_type.h"
+
+struct ID;
+
 namespace blender {
 namespace deg {
 
@@ -32,6 +36,11 @@ class ViewLayerBuilderPipeline : public AbstractBuilderPipeline {
  public:
   ViewLayerBuilderPipeline(::Depsgraph *graph);
 
+  /* Rebuild nodes and relations of the given objects and relations of IDs directly related to
+   * them, keeping the rest of the graph as-is. Returns false if this is not possible for the
+   * given IDs, the graph is not modified in this case and is to be built from scratch. */
+  bool build_incremental(const Set<ID *> &ids);
+
  protected:
   virtual void build_nodes(DepsgraphNodeBuilder &node_builder) override;
   virtual void build_relations(DepsgraphRelationBuilder &relation_builder) override;
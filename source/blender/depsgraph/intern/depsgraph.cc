@@ -32,6 +32,7 @@
 
 #include "BLI_console.h"
 #include "BLI_hash.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_global.h"
@@ -73,6 +74,7 @@ Depsgraph::Depsgraph(Main *bmain, Scene *scene, ViewLayer *view_layer, eEvaluati
       is_render_pipeline_depsgraph(false)
 {
   BLI_spin_init(&lock);
+  BLI_mutex_init(&physics_relations_lock);
   memset(id_type_updated, 0, sizeof(id_type_updated));
   memset(id_type_exist, 0, sizeof(id_type_exist));
   memset(physics_relations, 0, sizeof(physics_relations));
@@ -85,6 +87,7 @@ Depsgraph::~Depsgraph()
   clear_id_nodes();
   delete time_source;
   BLI_spin_end(&lock);
+  BLI_mutex_end(&physics_relations_lock);
 }
 
 /* Node Management ---------------------------- */
@@ -152,6 +155,16 @@ static void clear_id_nodes_conditional(Depsgraph::IDDepsNodes *id_nodes, const F
   }
 }
 
+static void free_id_node_func(void *__restrict data_v,
+                              const int i,
+                              const TaskParallelTLS *__restrict /*tls*/)
+{
+  Depsgraph *graph = (Depsgraph *)data_v;
+  /* Expanded copy-on-write datablocks are freed already. Nodes only free their incoming
+   * relations, so nodes of different IDs can be freed from different threads. */
+  delete graph->id_nodes[i];
+}
+
 void Depsgraph::clear_id_nodes()
 {
   /* Free memory used by ID nodes. */
@@ -159,9 +172,14 @@ void Depsgraph::clear_id_nodes()
   /* Stupid workaround to ensure we free IDs in a proper order. */
   clear_id_nodes_conditional(&id_nodes, [](ID_Type id_type) { return id_type == ID_SCE; });
   clear_id_nodes_conditional(&id_nodes, [](ID_Type id_type) { return id_type != ID_PA; });
-
-  for (IDNode *id_node : id_nodes) {
-    delete id_node;
+  clear_id_nodes_conditional(&id_nodes, [](ID_Type /*id_type*/) { return true; });
+
+  {
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.use_threading = (G.debug & G_DEBUG_DEPSGRAPH_NO_THREADS) == 0;
+    settings.min_iter_per_thread = 256;
+    BLI_task_parallel_range(0, id_nodes.size(), this, free_id_node_func, &settings);
   }
   /* Clear containers. */
   id_hash.clear();
@@ -170,6 +188,49 @@ void Depsgraph::clear_id_nodes()
   clear_physics_relations(this);
 }
 
+template<typename T, typename FilterFunc>
+static void vector_remove_if(Vector<T> &vector, const FilterFunc &filter)
+{
+  T *new_end = std::remove_if(vector.begin(), vector.end(), filter);
+  vector.resize(new_end - vector.begin());
+}
+
+void Depsgraph::remove_id_nodes(const Set<IDNode *> &id_nodes_to_remove)
+{
+  if (id_nodes_to_remove.is_empty()) {
+    return;
+  }
+  /* Free relations from both sides, so the nodes which stay in the graph do not point to the
+   * freed ones. */
+  for (IDNode *id_node : id_nodes_to_remove) {
+    for (ComponentNode *comp_node : id_node->components.values()) {
+      for (OperationNode *op_node : comp_node->operations) {
+        while (!op_node->inlinks.is_empty()) {
+          Relation *rel = op_node->inlinks[0];
+          rel->unlink();
+          delete rel;
+        }
+        while (!op_node->outlinks.is_empty()) {
+          Relation *rel = op_node->outlinks[0];
+          rel->unlink();
+          delete rel;
+        }
+        entry_tags.remove(op_node);
+      }
+    }
+  }
+  /* Keep order of the remaining nodes, it is used for the evaluation order. */
+  vector_remove_if(operations, [&](OperationNode *op_node) {
+    return id_nodes_to_remove.contains(op_node->owner->owner);
+  });
+  vector_remove_if(id_nodes,
+                   [&](IDNode *id_node) { return id_nodes_to_remove.contains(id_node); });
+  for (IDNode *id_node : id_nodes_to_remove) {
+    id_hash.remove(id_node->id_orig);
+    delete id_node;
+  }
+}
+
 /* Add new relation between two nodes */
 Relation *Depsgraph::add_new_relation(Node *from, Node *to, const char *description, int flags)
 {
@@ -197,6 +258,34 @@ Relation *Depsgraph::add_new_relation(Node *from, Node *to, const char *descript
   return rel;
 }
 
+Relation *Depsgraph::create_deferred_relation(Node *from,
+                                              Node *to,
+                                              const char *description,
+                                              int flags,
+                                              Vector<Relation *> &r_relations)
+{
+  Relation *rel = new Relation(from, to, description, false);
+  rel->flag |= flags;
+  r_relations.append(rel);
+  return rel;
+}
+
+void Depsgraph::add_deferred_relations(Span<Relation *> relations)
+{
+  for (Relation *rel : relations) {
+    /* Same as add_new_relation(), flags of the new relation are merged into the existing one. */
+    if (rel->flag & RELATION_CHECK_BEFORE_ADD) {
+      Relation *rel_existing = check_nodes_connected(rel->from, rel->to, rel->name);
+      if (rel_existing != nullptr) {
+        rel_existing->flag |= rel->flag;
+        delete rel;
+        continue;
+      }
+    }
+    rel->link();
+  }
+}
+
 Relation *Depsgraph::check_nodes_connected(const Node *from,
                                            const Node *to,
                                            const char *description)
@@ -44,6 +44,7 @@
 
 #include "intern/debug/deg_debug.h"
 #include "intern/depsgraph_type.h"
+#include "intern/eval/deg_eval_cost_profile.h"
 
 struct ID;
 struct Scene;
@@ -73,10 +74,24 @@ struct Depsgraph {
   IDNode *find_id_node(const ID *id) const;
   IDNode *add_id_node(ID *id, ID *id_cow_hint = nullptr);
   void clear_id_nodes();
+  /* Remove nodes of the given IDs together with their operations and all relations to and from
+   * those operations. Copy-on-write datablocks of the nodes are freed unless the caller took
+   * their ownership by setting id_cow to nullptr. */
+  void remove_id_nodes(const Set<IDNode *> &id_nodes_to_remove);
 
   /* Add new relationship between two nodes. */
   Relation *add_new_relation(Node *from, Node *to, const char *description, int flags = 0);
 
+  /* Create new relationship between two nodes without registering it in the nodes: it is
+   * appended to r_relations instead, and added to the graph by add_deferred_relations(). This
+   * way relations can be created from multiple threads, and added in a deterministic order. */
+  Relation *create_deferred_relation(Node *from,
+                                     Node *to,
+                                     const char *description,
+                                     int flags,
+                                     Vector<Relation *> &r_relations);
+  void add_deferred_relations(Span<Relation *> relations);
+
   /* Check whether two nodes are connected by relation with given
    * description. Description might be nullptr to check ANY relation between
    * given nodes. */
@@ -110,6 +125,11 @@ struct Depsgraph {
   /* Indicates whether relations needs to be updated. */
   bool need_update;
 
+  /* IDs which had their relations tagged for update individually. When the set is not empty
+   * and need_update is set, relations are updated incrementally for these IDs only. An empty set
+   * means the whole graph is to be rebuilt. */
+  Set<ID *> relations_update_ids;
+
   /* Indicates which ID types were updated. */
   char id_type_updated[MAX_LIBARRAY];
 
@@ -155,6 +175,9 @@ struct Depsgraph {
 
   DepsgraphDebug debug;
 
+  /* Average evaluation time of operations, kept when relations are rebuilt. */
+  CostProfile cost_profile;
+
   bool is_evaluating;
 
   /* Is set to truth for dependency graph which are used for post-processing (compositor and
@@ -166,6 +189,9 @@ struct Depsgraph {
   /* Cached list of colliders/effectors for collections and the scene
    * created along with relations, for fast lookup during evaluation. */
   Map<const ID *, ListBase *> *physics_relations[DEG_PHYSICS_RELATIONS_NUM];
+  /* Protects creation of the cached physics relations, relations of different IDs might be built
+   * from multiple threads. */
+  ThreadMutex physics_relations_lock;
 
   MEM_CXX_CLASS_ALLOC_FUNCS("Depsgraph");
 };
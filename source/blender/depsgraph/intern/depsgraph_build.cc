@@ -246,6 +246,7 @@ void DEG_graph_tag_relations_update(Depsgraph *graph)
   DEG_DEBUG_PRINTF(graph, TAG, "%s: Tagging relations for update.\n", __func__);
   deg::Depsgraph *deg_graph = reinterpret_cast<deg::Depsgraph *>(graph);
   deg_graph->need_update = true;
+  deg_graph->relations_update_ids.clear();
   /* NOTE: When relations are updated, it's quite possible that
    * we've got new bases in the scene. This means, we need to
    * re-create flat array of bases in view layer.
@@ -258,6 +259,30 @@ void DEG_graph_tag_relations_update(Depsgraph *graph)
   }
 }
 
+/* Tag relations of a single ID for update. */
+void DEG_graph_id_tag_relations_update(Depsgraph *graph, ID *id)
+{
+  deg::Depsgraph *deg_graph = reinterpret_cast<deg::Depsgraph *>(graph);
+  if (deg_graph->need_update && deg_graph->relations_update_ids.is_empty()) {
+    /* Full rebuild of relations is pending already. */
+    return;
+  }
+  if (deg_graph->is_render_pipeline_depsgraph) {
+    /* Only view layer graphs support incremental update. */
+    DEG_graph_tag_relations_update(graph);
+    return;
+  }
+  deg::IDNode *id_node = deg_graph->find_id_node(id);
+  if (id_node == nullptr) {
+    /* Nothing in this graph depends on the ID. */
+    return;
+  }
+  DEG_DEBUG_PRINTF(graph, TAG, "%s: Tagging relations of %s for update.\n", __func__, id->name);
+  deg_graph->need_update = true;
+  deg_graph->relations_update_ids.add(id);
+  id_node->tag_update(deg_graph, deg::DEG_UPDATE_SOURCE_RELATIONS);
+}
+
 /* Create or update relations in the specified graph. */
 void DEG_graph_relations_update(Depsgraph *graph)
 {
@@ -266,6 +291,12 @@ void DEG_graph_relations_update(Depsgraph *graph)
     /* Graph is up to date, nothing to do. */
     return;
   }
+  if (!deg_graph->relations_update_ids.is_empty()) {
+    deg::ViewLayerBuilderPipeline builder(graph);
+    if (builder.build_incremental(deg_graph->relations_update_ids)) {
+      return;
+    }
+  }
   DEG_graph_build_from_view_layer(graph);
 }
 
@@ -277,3 +308,12 @@ void DEG_relations_tag_update(Main *bmain)
     DEG_graph_tag_relations_update(reinterpret_cast<Depsgraph *>(depsgraph));
   }
 }
+
+/* Tag relations of a single ID for update in all graphs. */
+void DEG_id_relations_tag_update(Main *bmain, ID *id)
+{
+  DEG_GLOBAL_DEBUG_PRINTF(TAG, "%s: Tagging relations of %s for update.\n", __func__, id->name);
+  for (deg::Depsgraph *depsgraph : deg::get_all_registered_graphs(bmain)) {
+    DEG_graph_id_tag_relations_update(reinterpret_cast<Depsgraph *>(depsgraph), id);
+  }
+}
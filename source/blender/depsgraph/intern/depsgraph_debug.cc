@@ -23,8 +23,17 @@
  * Implementation of tools for debugging the depsgraph
  */
 
+#include "MEM_guardedalloc.h"
+
+#include "BLI_fileops.h"
+#include "BLI_ghash.h"
 #include "BLI_utildefines.h"
 
+#include "BKE_customdata.h"
+
+#include "DNA_hair_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_pointcloud_types.h"
 #include "DNA_scene_types.h"
 
 #include "DNA_object_types.h"
@@ -38,6 +47,7 @@
 #include "intern/depsgraph.h"
 #include "intern/depsgraph_relation.h"
 #include "intern/depsgraph_type.h"
+#include "intern/eval/deg_eval_copy_on_write.h"
 #include "intern/node/deg_node_component.h"
 #include "intern/node/deg_node_id.h"
 #include "intern/node/deg_node_time.h"
@@ -245,6 +255,119 @@ void DEG_stats_simple(const Depsgraph *graph,
   }
 }
 
+/**
+ * Obtain memory used by geometry arrays of the evaluated copies of datablocks.
+ * \param[out] r_shared: Memory of arrays which are shared with the original datablocks
+ * \param[out] r_copied: Memory of arrays which are owned by the evaluated copies
+ */
+void DEG_stats_copy_on_write_memory(const Depsgraph *graph, size_t *r_shared, size_t *r_copied)
+{
+  const deg::Depsgraph *deg_graph = reinterpret_cast<const deg::Depsgraph *>(graph);
+  *r_shared = 0;
+  *r_copied = 0;
+  for (deg::IDNode *id_node : deg_graph->id_nodes) {
+    const ID *id_cow = id_node->id_cow;
+    if (!deg::deg_copy_on_write_is_expanded(id_cow)) {
+      continue;
+    }
+    switch (GS(id_cow->name)) {
+      case ID_ME: {
+        const Mesh *mesh = reinterpret_cast<const Mesh *>(id_cow);
+        CustomData_memory_usage_add(&mesh->vdata, mesh->totvert, r_shared, r_copied);
+        CustomData_memory_usage_add(&mesh->edata, mesh->totedge, r_shared, r_copied);
+        CustomData_memory_usage_add(&mesh->fdata, mesh->totface, r_shared, r_copied);
+        CustomData_memory_usage_add(&mesh->ldata, mesh->totloop, r_shared, r_copied);
+        CustomData_memory_usage_add(&mesh->pdata, mesh->totpoly, r_shared, r_copied);
+        break;
+      }
+      case ID_HA: {
+        const Hair *hair = reinterpret_cast<const Hair *>(id_cow);
+        CustomData_memory_usage_add(&hair->pdata, hair->totpoint, r_shared, r_copied);
+        CustomData_memory_usage_add(&hair->cdata, hair->totcurve, r_shared, r_copied);
+        break;
+      }
+      case ID_PT: {
+        const PointCloud *pointcloud = reinterpret_cast<const PointCloud *>(id_cow);
+        CustomData_memory_usage_add(&pointcloud->pdata, pointcloud->totpoint, r_shared, r_copied);
+        break;
+      }
+      default:
+        break;
+    }
+  }
+}
+
+double DEG_cost_profile_id_time(const Depsgraph *graph, const ID *id)
+{
+  const deg::Depsgraph *deg_graph = reinterpret_cast<const deg::Depsgraph *>(graph);
+  deg::IDNode *id_node = deg_graph->find_id_node(DEG_get_original_id(const_cast<ID *>(id)));
+  if (id_node == nullptr) {
+    return 0.0;
+  }
+  return deg_graph->cost_profile.id_time(id_node);
+}
+
+double DEG_cost_profile_total_time(const Depsgraph *graph)
+{
+  const deg::Depsgraph *deg_graph = reinterpret_cast<const deg::Depsgraph *>(graph);
+  return deg_graph->cost_profile.total_time(deg_graph);
+}
+
+bool DEG_cost_profile_write_json(const Depsgraph *graph, const char *filepath)
+{
+  const deg::Depsgraph *deg_graph = reinterpret_cast<const deg::Depsgraph *>(graph);
+  FILE *file = BLI_fopen(filepath, "w");
+  if (file == nullptr) {
+    return false;
+  }
+  deg_graph->cost_profile.write_json(deg_graph, file);
+  return fclose(file) == 0;
+}
+
+void DEG_cost_profile_clear(Depsgraph *graph)
+{
+  deg::Depsgraph *deg_graph = reinterpret_cast<deg::Depsgraph *>(graph);
+  deg_graph->cost_profile.clear();
+  /* Don't bring back costs stored in the scene. */
+  deg_graph->cost_profile.is_imported = true;
+}
+
+DepsgraphOperationCost *DEG_cost_profile_export(const Scene *scene, int *r_costs_num)
+{
+  blender::Map<uint64_t, deg::OperationCost> costs;
+  if (scene->depsgraph_hash != nullptr) {
+    GHashIterator gh_iter;
+    GHASH_ITER (gh_iter, scene->depsgraph_hash) {
+      const deg::Depsgraph *deg_graph = reinterpret_cast<const deg::Depsgraph *>(
+          BLI_ghashIterator_getValue(&gh_iter));
+      deg_graph->cost_profile.export_to(costs);
+    }
+  }
+  /* Profiles of the dependency graphs include the stored costs once they were imported. */
+  for (int i = 0; i < scene->depsgraph_costs_num; i++) {
+    const DepsgraphOperationCost &stored_cost = scene->depsgraph_costs[i];
+    deg::OperationCost cost;
+    cost.average_time = stored_cost.average_time;
+    cost.samples_num = stored_cost.samples_num;
+    costs.add(stored_cost.key, cost);
+  }
+
+  *r_costs_num = (int)costs.size();
+  if (costs.is_empty()) {
+    return nullptr;
+  }
+  DepsgraphOperationCost *result = (DepsgraphOperationCost *)MEM_malloc_arrayN(
+      costs.size(), sizeof(DepsgraphOperationCost), __func__);
+  int index = 0;
+  for (blender::Map<uint64_t, deg::OperationCost>::Item item : costs.items()) {
+    result[index].key = item.key;
+    result[index].average_time = (float)item.value.average_time;
+    result[index].samples_num = item.value.samples_num;
+    index++;
+  }
+  return result;
+}
+
 static deg::string depsgraph_name_for_logging(struct Depsgraph *depsgraph)
 {
   const char *name = DEG_debug_name_get(depsgraph);
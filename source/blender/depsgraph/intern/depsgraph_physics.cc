@@ -178,6 +178,8 @@ namespace blender::deg {
 
 ListBase *build_effector_relations(Depsgraph *graph, Collection *collection)
 {
+  /* Relations of different IDs might be built from multiple threads. */
+  BLI_mutex_lock(&graph->physics_relations_lock);
   Map<const ID *, ListBase *> *hash = graph->physics_relations[DEG_PHYSICS_EFFECTOR];
   if (hash == nullptr) {
     graph->physics_relations[DEG_PHYSICS_EFFECTOR] = new Map<const ID *, ListBase *>();
@@ -188,10 +190,12 @@ ListBase *build_effector_relations(Depsgraph *graph, Collection *collection)
    * view layer.
    */
   ID *collection_id = object_id_safe(collection);
-  return hash->lookup_or_add_cb(collection_id, [&]() {
+  ListBase *relations = hash->lookup_or_add_cb(collection_id, [&]() {
     ::Depsgraph *depsgraph = reinterpret_cast<::Depsgraph *>(graph);
     return BKE_effector_relations_create(depsgraph, graph->view_layer, collection);
   });
+  BLI_mutex_unlock(&graph->physics_relations_lock);
+  return relations;
 }
 
 ListBase *build_collision_relations(Depsgraph *graph,
@@ -199,6 +203,8 @@ ListBase *build_collision_relations(Depsgraph *graph,
                                     unsigned int modifier_type)
 {
   const ePhysicsRelationType type = modifier_to_relation_type(modifier_type);
+  /* Relations of different IDs might be built from multiple threads. */
+  BLI_mutex_lock(&graph->physics_relations_lock);
   Map<const ID *, ListBase *> *hash = graph->physics_relations[type];
   if (hash == nullptr) {
     graph->physics_relations[type] = new Map<const ID *, ListBase *>();
@@ -209,10 +215,12 @@ ListBase *build_collision_relations(Depsgraph *graph,
    * view layer.
    */
   ID *collection_id = object_id_safe(collection);
-  return hash->lookup_or_add_cb(collection_id, [&]() {
+  ListBase *relations = hash->lookup_or_add_cb(collection_id, [&]() {
     ::Depsgraph *depsgraph = reinterpret_cast<::Depsgraph *>(graph);
     return BKE_collision_relations_create(depsgraph, collection, modifier_type);
   });
+  BLI_mutex_unlock(&graph->physics_relations_lock);
+  return relations;
 }
 
 void clear_physics_relations(Depsgraph *graph)
@@ -30,8 +30,21 @@
 
 namespace blender::deg {
 
-Relation::Relation(Node *from, Node *to, const char *description)
+Relation::Relation(Node *from, Node *to, const char *description, bool do_link)
     : from(from), to(to), name(description), flag(0)
+{
+  if (do_link) {
+    link();
+  }
+}
+
+Relation::~Relation()
+{
+  /* Sanity check. */
+  BLI_assert(from != nullptr && to != nullptr);
+}
+
+void Relation::link()
 {
   /* Hook it up to the nodes which use it.
    *
@@ -50,12 +63,6 @@ Relation::Relation(Node *from, Node *to, const char *description)
   to->inlinks.append(this);
 }
 
-Relation::~Relation()
-{
-  /* Sanity check. */
-  BLI_assert(from != nullptr && to != nullptr);
-}
-
 void Relation::unlink()
 {
   /* Sanity check. */
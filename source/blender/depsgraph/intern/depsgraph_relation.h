@@ -49,9 +49,11 @@ enum RelationFlag {
 
 /* B depends on A (A -> B) */
 struct Relation {
-  Relation(Node *from, Node *to, const char *description);
+  /* Relation is registered in the nodes it connects, unless do_link is false. See link(). */
+  Relation(Node *from, Node *to, const char *description, bool do_link = true);
   ~Relation();
 
+  void link();
   void unlink();
 
   /* the nodes in the relationship (since this is shared between the nodes) */
@@ -27,16 +27,22 @@
 
 #include "PIL_time.h"
 
+#include <algorithm>
+
 #include "BLI_compiler_attrs.h"
 #include "BLI_gsqueue.h"
 #include "BLI_task.h"
+#include "BLI_threads.h"
+#include "BLI_timeit.hh"
 #include "BLI_utildefines.h"
+#include "BLI_vector.hh"
 
 #include "BKE_global.h"
 
 #include "DNA_node_types.h"
 #include "DNA_object_types.h"
 #include "DNA_scene_types.h"
+#include "DNA_userdef_types.h"
 
 #include "DEG_depsgraph.h"
 #include "DEG_depsgraph_query.h"
@@ -46,6 +52,7 @@
 #include "intern/depsgraph.h"
 #include "intern/depsgraph_relation.h"
 #include "intern/eval/deg_eval_copy_on_write.h"
+#include "intern/eval/deg_eval_cost_profile.h"
 #include "intern/eval/deg_eval_flush.h"
 #include "intern/eval/deg_eval_stats.h"
 #include "intern/node/deg_node.h"
@@ -59,8 +66,10 @@ namespace blender::deg {
 namespace {
 
 struct DepsgraphEvalState;
+struct PriorityScheduleContext;
 
 void deg_task_run_func(TaskPool *pool, void *taskdata);
+void deg_task_run_priority_func(TaskPool *pool, void *taskdata);
 
 template<typename ScheduleFunction, typename... ScheduleFunctionArgs>
 void schedule_children(DepsgraphEvalState *state,
@@ -90,19 +99,108 @@ enum class EvaluationStage {
   SINGLE_THREADED_WORKAROUND,
 };
 
+/* Operations which are ready for evaluation, ordered by their critical path time. */
+struct ReadyQueue {
+  SpinLock lock;
+  Vector<OperationNode *> heap;
+
+  static bool compare(const OperationNode *a, const OperationNode *b)
+  {
+    return a->critical_path_time < b->critical_path_time;
+  }
+
+  void push(OperationNode *node)
+  {
+    BLI_spin_lock(&lock);
+    heap.append(node);
+    std::push_heap(heap.begin(), heap.end(), compare);
+    BLI_spin_unlock(&lock);
+  }
+
+  OperationNode *pop()
+  {
+    BLI_spin_lock(&lock);
+    BLI_assert(!heap.is_empty());
+    std::pop_heap(heap.begin(), heap.end(), compare);
+    OperationNode *node = heap.pop_last();
+    BLI_spin_unlock(&lock);
+    return node;
+  }
+};
+
 struct DepsgraphEvalState {
   Depsgraph *graph;
   bool do_stats;
   EvaluationStage stage;
   bool need_single_thread_pass;
+  /* Evaluate operations with the longest critical path first, see #schedule_node_to_priority. */
+  bool use_priority_scheduling;
+  ReadyQueue ready_queue;
 };
 
+/* Priority scheduling.
+ *
+ * Every ready operation is added to the #ReadyQueue, and a task is pushed to the pool for it.
+ * Tasks don't evaluate a specific operation, but the one with the highest priority at the time
+ * they run, so long chains of dependencies (like rigs) start as early as possible instead of
+ * waiting behind many short independent operations.
+ *
+ * Operations which are known to be cheap from the timing of previous evaluations don't get a task
+ * of their own. Instead they are evaluated by the task which made them ready, which avoids the
+ * task overhead for them. */
+
+/* Operations expected to take less time than this (in seconds) are evaluated in batches. */
+const double PRIORITY_CHEAP_OPERATION_TIME = 5e-6;
+/* Cost estimate of operations which were not timed yet. */
+const double PRIORITY_DEFAULT_OPERATION_TIME = 2e-5;
+/* Maximum number of cheap operations evaluated by a single task, so that cheap operations with
+ * many children still get spread over threads. */
+const int PRIORITY_BATCH_SIZE = 32;
+
+struct PriorityScheduleContext {
+  DepsgraphEvalState *state;
+  TaskPool *pool;
+  /* Cheap operations to be evaluated by the current task, null outside of tasks. */
+  Vector<OperationNode *, PRIORITY_BATCH_SIZE> *batch;
+  int batch_size;
+};
+
+double operation_cost_estimate(const OperationNode *node)
+{
+  if (node->is_noop()) {
+    return 0.0;
+  }
+  if (node->stats.average_time > 0.0) {
+    return node->stats.average_time;
+  }
+  return PRIORITY_DEFAULT_OPERATION_TIME;
+}
+
+void schedule_node_to_priority(OperationNode *node,
+                               const int UNUSED(thread_id),
+                               PriorityScheduleContext *context)
+{
+  if (context->batch != nullptr && context->batch_size < PRIORITY_BATCH_SIZE &&
+      operation_cost_estimate(node) < PRIORITY_CHEAP_OPERATION_TIME) {
+    context->batch->append(node);
+    context->batch_size++;
+    return;
+  }
+  context->state->ready_queue.push(node);
+  BLI_task_pool_push(context->pool, deg_task_run_priority_func, nullptr, false, nullptr);
+}
+
 void evaluate_node(const DepsgraphEvalState *state, OperationNode *operation_node)
 {
   ::Depsgraph *depsgraph = reinterpret_cast<::Depsgraph *>(state->graph);
 
   /* Sanity checks. */
   BLI_assert(!operation_node->is_noop() && "NOOP nodes should not actually be scheduled");
+  /* Only build the identifier when it is needed. */
+  const bool do_trace = BLI_trace_is_enabled();
+  if (do_trace) {
+    BLI_trace_begin("depsgraph", operation_node->full_identifier().c_str());
+  }
   /* Perform operation. */
   if (state->do_stats) {
     const double start_time = PIL_check_seconds_timer();
@@ -112,6 +210,9 @@ void evaluate_node(const DepsgraphEvalState *state, OperationNode *operation_nod
   else {
     operation_node->evaluate(depsgraph);
   }
+  if (do_trace) {
+    BLI_trace_end();
+  }
 }
 
 void deg_task_run_func(TaskPool *pool, void *taskdata)
@@ -127,6 +228,26 @@ void deg_task_run_func(TaskPool *pool, void *taskdata)
   schedule_children(state, operation_node, schedule_node_to_pool, pool);
 }
 
+void deg_task_run_priority_func(TaskPool *pool, void *UNUSED(taskdata))
+{
+  void *userdata_v = BLI_task_pool_user_data(pool);
+  DepsgraphEvalState *state = (DepsgraphEvalState *)userdata_v;
+
+  /* There is one task per operation in the queue, so it is never empty here. */
+  OperationNode *operation_node = state->ready_queue.pop();
+
+  Vector<OperationNode *, PRIORITY_BATCH_SIZE> batch;
+  PriorityScheduleContext context = {state, pool, &batch, 0};
+  while (true) {
+    evaluate_node(state, operation_node);
+    schedule_children(state, operation_node, schedule_node_to_priority, &context);
+    if (batch.is_empty()) {
+      break;
+    }
+    operation_node = batch.pop_last();
+  }
+}
+
 bool check_operation_node_visible(OperationNode *op_node)
 {
   const ComponentNode *comp_node = op_node->owner;
@@ -177,10 +298,66 @@ void calculate_pending_parents(Depsgraph *graph)
   }
 }
 
+bool need_evaluate_operation(OperationNode *node)
+{
+  return check_operation_node_visible(node) && (node->flag & DEPSOP_FLAG_NEEDS_UPDATE) != 0;
+}
+
+/* Calculate the critical path time of all operations which are to be evaluated, by going over
+ * them from the last ones to be evaluated to the first ones. */
+void calculate_critical_path_times(Depsgraph *graph)
+{
+  Vector<OperationNode *> stack;
+  /* Count the children which still need their critical path, in the custom flags. */
+  for (OperationNode *node : graph->operations) {
+    if (!need_evaluate_operation(node)) {
+      continue;
+    }
+    node->critical_path_time = 0.0;
+    node->custom_flags = 0;
+    /* Nodes are re-created when relations are rebuilt, start from the persistent profile. */
+    if (node->stats.average_time == 0.0) {
+      const OperationCost *cost = graph->cost_profile.lookup(node);
+      if (cost != nullptr) {
+        node->stats.average_time = cost->average_time;
+      }
+    }
+    for (Relation *rel : node->outlinks) {
+      if (rel->to->type == NodeType::OPERATION && (rel->flag & RELATION_FLAG_CYCLIC) == 0 &&
+          need_evaluate_operation((OperationNode *)rel->to)) {
+        node->custom_flags++;
+      }
+    }
+    if (node->custom_flags == 0) {
+      stack.append(node);
+    }
+  }
+  while (!stack.is_empty()) {
+    OperationNode *node = stack.pop_last();
+    node->critical_path_time += operation_cost_estimate(node);
+    for (Relation *rel : node->inlinks) {
+      if (rel->from->type != NodeType::OPERATION || (rel->flag & RELATION_FLAG_CYCLIC) != 0) {
+        continue;
+      }
+      OperationNode *parent = (OperationNode *)rel->from;
+      if (!need_evaluate_operation(parent)) {
+        continue;
+      }
+      parent->critical_path_time = std::max(parent->critical_path_time, node->critical_path_time);
+      if (--parent->custom_flags == 0) {
+        stack.append(parent);
+      }
+    }
+  }
+}
+
 void initialize_execution(DepsgraphEvalState *state, Depsgraph *graph)
 {
   const bool do_stats = state->do_stats;
   calculate_pending_parents(graph);
+  if (state->use_priority_scheduling) {
+    calculate_critical_path_times(graph);
+  }
   /* Clear tags and other things which needs to be clear. */
   for (OperationNode *node : graph->operations) {
     if (do_stats) {
@@ -356,6 +533,20 @@ static TaskPool *deg_evaluate_task_pool_create(DepsgraphEvalState *state)
   return BLI_task_pool_create_suspended(state, TASK_PRIORITY_HIGH);
 }
 
+static void evaluate_graph_threaded(DepsgraphEvalState *state)
+{
+  TaskPool *task_pool = deg_evaluate_task_pool_create(state);
+  if (state->use_priority_scheduling) {
+    PriorityScheduleContext context = {state, task_pool, nullptr, 0};
+    schedule_graph(state, schedule_node_to_priority, &context);
+  }
+  else {
+    schedule_graph(state, schedule_node_to_pool, task_pool);
+  }
+  BLI_task_pool_work_and_wait(task_pool);
+  BLI_task_pool_free(task_pool);
+}
+
 /**
  * Evaluate all nodes tagged for updating,
  * \warning This is usually done as part of main loop, but may also be
@@ -370,6 +561,8 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
     return;
   }
 
+  TRACE_SCOPE("depsgraph", "Depsgraph evaluation");
+
   graph->debug.begin_graph_evaluation();
 
   graph->is_evaluating = true;
@@ -377,25 +570,27 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
   /* Set up evaluation state. */
   DepsgraphEvalState state;
   state.graph = graph;
-  state.do_stats = graph->debug.do_time_debug();
+  state.use_priority_scheduling = U.experimental.use_depsgraph_priority_scheduling;
+  /* Priority scheduling relies on timing of previous evaluations. */
+  state.do_stats = graph->debug.do_time_debug() || state.use_priority_scheduling ||
+                   (graph->scene->flag & SCE_DEPSGRAPH_COST_PROFILE) != 0;
+  if (state.do_stats && !graph->cost_profile.is_imported) {
+    graph->cost_profile.import(graph->scene->depsgraph_costs, graph->scene->depsgraph_costs_num);
+    graph->cost_profile.is_imported = true;
+  }
   state.need_single_thread_pass = false;
+  BLI_spin_init(&state.ready_queue.lock);
   /* Prepare all nodes for evaluation. */
   initialize_execution(&state, graph);
 
   /* Do actual evaluation now. */
   /* First, process all Copy-On-Write nodes. */
   state.stage = EvaluationStage::COPY_ON_WRITE;
-  TaskPool *task_pool = deg_evaluate_task_pool_create(&state);
-  schedule_graph(&state, schedule_node_to_pool, task_pool);
-  BLI_task_pool_work_and_wait(task_pool);
-  BLI_task_pool_free(task_pool);
+  evaluate_graph_threaded(&state);
 
   /* After that, process all other nodes. */
   state.stage = EvaluationStage::THREADED_EVALUATION;
-  task_pool = deg_evaluate_task_pool_create(&state);
-  schedule_graph(&state, schedule_node_to_pool, task_pool);
-  BLI_task_pool_work_and_wait(task_pool);
-  BLI_task_pool_free(task_pool);
+  evaluate_graph_threaded(&state);
 
   if (state.need_single_thread_pass) {
     state.stage = EvaluationStage::SINGLE_THREADED_WORKAROUND;
@@ -408,6 +603,7 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
   if (state.do_stats) {
     deg_eval_stats_aggregate(graph);
   }
+  BLI_spin_end(&state.ready_queue.lock);
   /* Clear any uncleared tags - just in case. */
   deg_graph_clear_tags(graph);
   graph->is_evaluating = false;
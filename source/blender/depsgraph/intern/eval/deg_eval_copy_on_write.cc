@@ -41,11 +41,15 @@
 #include "BLI_utildefines.h"
 
 #include "BKE_curve.h"
+#include "BKE_customdata.h"
 #include "BKE_global.h"
 #include "BKE_gpencil.h"
+#include "BKE_hair.h"
 #include "BKE_idprop.h"
 #include "BKE_layer.h"
 #include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_pointcloud.h"
 #include "BKE_scene.h"
 
 #include "DEG_depsgraph.h"
@@ -56,10 +60,12 @@
 #include "DNA_ID.h"
 #include "DNA_anim_types.h"
 #include "DNA_armature_types.h"
+#include "DNA_hair_types.h"
 #include "DNA_mesh_types.h"
 #include "DNA_modifier_types.h"
 #include "DNA_object_types.h"
 #include "DNA_particle_types.h"
+#include "DNA_pointcloud_types.h"
 #include "DNA_rigidbody_types.h"
 #include "DNA_scene_types.h"
 #include "DNA_sequence_types.h"
@@ -282,9 +288,47 @@ struct ValidateData {
   bool is_valid;
 };
 
+/* Make referenced geometry layers of the copy-on-write datablock keep the original data
+ * alive, so the evaluated geometry stays valid when the original one is freed or reallocated. */
+void id_cow_share_geometry(const ID *id_orig, ID *id_cow)
+{
+  switch (GS(id_orig->name)) {
+    case ID_ME: {
+      const Mesh *mesh_orig = reinterpret_cast<const Mesh *>(id_orig);
+      Mesh *mesh_cow = reinterpret_cast<Mesh *>(id_cow);
+      CustomData_share_referenced_layers(&mesh_orig->vdata, &mesh_cow->vdata, mesh_cow->totvert);
+      CustomData_share_referenced_layers(&mesh_orig->edata, &mesh_cow->edata, mesh_cow->totedge);
+      CustomData_share_referenced_layers(&mesh_orig->fdata, &mesh_cow->fdata, mesh_cow->totface);
+      CustomData_share_referenced_layers(&mesh_orig->ldata, &mesh_cow->ldata, mesh_cow->totloop);
+      CustomData_share_referenced_layers(&mesh_orig->pdata, &mesh_cow->pdata, mesh_cow->totpoly);
+      BKE_mesh_update_customdata_pointers(mesh_cow, false);
+      break;
+    }
+    case ID_HA: {
+      const Hair *hair_orig = reinterpret_cast<const Hair *>(id_orig);
+      Hair *hair_cow = reinterpret_cast<Hair *>(id_cow);
+      CustomData_share_referenced_layers(&hair_orig->pdata, &hair_cow->pdata, hair_cow->totpoint);
+      CustomData_share_referenced_layers(&hair_orig->cdata, &hair_cow->cdata, hair_cow->totcurve);
+      BKE_hair_update_customdata_pointers(hair_cow);
+      break;
+    }
+    case ID_PT: {
+      const PointCloud *pointcloud_orig = reinterpret_cast<const PointCloud *>(id_orig);
+      PointCloud *pointcloud_cow = reinterpret_cast<PointCloud *>(id_cow);
+      CustomData_share_referenced_layers(
+          &pointcloud_orig->pdata, &pointcloud_cow->pdata, pointcloud_cow->totpoint);
+      BKE_pointcloud_update_customdata_pointers(pointcloud_cow);
+      break;
+    }
+    default:
+      BLI_assert(!"Geometry of the datablock can not be shared");
+      break;
+  }
+}
+
 /* Similar to generic BKE_id_copy() but does not require main and assumes pointer
- * is already allocated. */
-bool id_copy_inplace_no_main(const ID *id, ID *newid)
+ * is already allocated. Extra LIB_ID_COPY_ flags can be passed. */
+bool id_copy_inplace_no_main(const ID *id, ID *newid, const int flag = 0)
 {
   const ID *id_for_copy = id;
 
@@ -301,10 +345,8 @@ bool id_copy_inplace_no_main(const ID *id, ID *newid)
   id_for_copy = nested_id_hack_get_discarded_pointers(&id_hack_storage, id);
 #endif
 
-  bool result = (BKE_id_copy_ex(nullptr,
-                                (ID *)id_for_copy,
-                                &newid,
-                                LIB_ID_COPY_LOCALIZE | LIB_ID_CREATE_NO_ALLOCATE) != nullptr);
+  const int copy_flag = LIB_ID_COPY_LOCALIZE | LIB_ID_CREATE_NO_ALLOCATE | flag;
+  bool result = (BKE_id_copy_ex(nullptr, (ID *)id_for_copy, &newid, copy_flag) != nullptr);
 
 #ifdef NESTED_ID_NASTY_WORKAROUND
   if (result) {
@@ -863,8 +905,6 @@ ID *deg_expand_copy_on_write_datablock(const Depsgraph *depsgraph,
   }
   // BLI_assert(check_datablock_expanded(id_cow) == false);
   /* Copy data from original ID to a copied version. */
-  /* TODO(sergey): Avoid doing full ID copy somehow, make Mesh to reference
-   * original geometry arrays for until those are modified. */
   /* TODO(sergey): We do some trickery with temp bmain and extra ID pointer
    * just to be able to use existing API. Ideally we need to replace this with
    * in-place copy from existing datablock to a prepared memory.
@@ -887,9 +927,23 @@ ID *deg_expand_copy_on_write_datablock(const Depsgraph *depsgraph,
       }
       break;
     }
-    case ID_ME: {
-      /* TODO(sergey): Ideally we want to handle meshes in a special
-       * manner here to avoid initial copy of all the geometry arrays. */
+    case ID_ME:
+    case ID_HA:
+    case ID_PT: {
+      /* Geometry arrays are shared with the original datablock instead of being copied, so
+       * geometry which is not modified by the evaluation is not stored twice. Evaluation never
+       * writes to those arrays in place: the referenced layers are duplicated before the first
+       * write (see CustomData_duplicate_referenced_layer()), and the shared data is kept alive
+       * when the original frees it before the next update.
+       *
+       * Render pipeline graphs are evaluated while the original geometry can be edited, they
+       * keep copying it. */
+      if (depsgraph->mode == DAG_EVAL_VIEWPORT) {
+        done = id_copy_inplace_no_main(id_orig, id_cow, LIB_ID_COPY_CD_REFERENCE);
+        if (done) {
+          id_cow_share_geometry(id_orig, id_cow);
+        }
+      }
       break;
     }
     default:
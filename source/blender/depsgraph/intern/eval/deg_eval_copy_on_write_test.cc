@@ -0,0 +1,169 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "testing/testing.h"
+
+#include "tests/blendfile_loading_base_test.h"
+
+#include "BKE_collection.h"
+#include "BKE_customdata.h"
+#include "BKE_lib_id.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+#include "BKE_object.h"
+#include "BKE_scene.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+#include "DEG_depsgraph_debug.h"
+#include "DEG_depsgraph_query.h"
+
+namespace blender::deg::tests {
+
+class DepsgraphCopyOnWriteTest : public BlendfileLoadingBaseTest {
+ protected:
+  Main *bmain = nullptr;
+  Mesh *mesh = nullptr;
+
+  void TearDown() override
+  {
+    if (depsgraph != nullptr) {
+      DEG_graph_free(depsgraph);
+      depsgraph = nullptr;
+    }
+    if (bmain != nullptr) {
+      BKE_main_free(bmain);
+      bmain = nullptr;
+    }
+    BlendfileLoadingBaseTest::TearDown();
+  }
+
+  /* Scene with a single object, using a mesh with the given number of vertices. */
+  void scene_create(const int verts_num)
+  {
+    bmain = BKE_main_new();
+    Scene *scene = BKE_scene_add(bmain, "Scene");
+    mesh = BKE_mesh_add(bmain, "Mesh");
+    mesh->totvert = verts_num;
+    CustomData_add_layer(&mesh->vdata, CD_MVERT, CD_CALLOC, nullptr, verts_num);
+    BKE_mesh_update_customdata_pointers(mesh, false);
+    Object *object = BKE_object_add_only_object(bmain, OB_MESH, "Object");
+    object->data = mesh;
+    id_us_plus(&mesh->id);
+    BKE_collection_object_add(bmain, scene->master_collection, object);
+
+    depsgraph = DEG_graph_new(
+        bmain, scene, static_cast<ViewLayer *>(scene->view_layers.first), DAG_EVAL_VIEWPORT);
+    DEG_graph_build_from_view_layer(depsgraph);
+    DEG_evaluate_on_refresh(depsgraph);
+  }
+};
+
+TEST_F(DepsgraphCopyOnWriteTest, MeshSharesGeometry)
+{
+  scene_create(100);
+  const Mesh *mesh_cow = reinterpret_cast<Mesh *>(DEG_get_evaluated_id(depsgraph, &mesh->id));
+  EXPECT_NE(mesh_cow, mesh);
+  EXPECT_EQ(mesh_cow->mvert, mesh->mvert);
+
+  size_t shared, copied;
+  DEG_stats_copy_on_write_memory(depsgraph, &shared, &copied);
+  EXPECT_EQ(shared, sizeof(MVert) * 100);
+  EXPECT_EQ(copied, 0);
+}
+
+TEST_F(DepsgraphCopyOnWriteTest, MeshCopiesGeometryOnWrite)
+{
+  scene_create(100);
+  Mesh *mesh_cow = reinterpret_cast<Mesh *>(DEG_get_evaluated_id(depsgraph, &mesh->id));
+  /* Vertex normals are written to the vertex array. */
+  BKE_mesh_calc_normals(mesh_cow);
+  EXPECT_NE(mesh_cow->mvert, mesh->mvert);
+  EXPECT_EQ(mesh_cow->mvert, CustomData_get_layer(&mesh_cow->vdata, CD_MVERT));
+
+  size_t shared, copied;
+  DEG_stats_copy_on_write_memory(depsgraph, &shared, &copied);
+  EXPECT_EQ(shared, 0);
+  EXPECT_EQ(copied, sizeof(MVert) * 100);
+}
+
+TEST_F(DepsgraphCopyOnWriteTest, MeshUpdateKeepsSharing)
+{
+  scene_create(100);
+  /* Geometry of the original mesh is replaced, which is followed by a tag. */
+  CustomData_free(&mesh->vdata, mesh->totvert);
+  mesh->totvert = 10;
+  CustomData_add_layer(&mesh->vdata, CD_MVERT, CD_CALLOC, nullptr, 10);
+  BKE_mesh_update_customdata_pointers(mesh, false);
+  DEG_id_tag_update_ex(bmain, &mesh->id, ID_RECALC_GEOMETRY);
+  DEG_evaluate_on_refresh(depsgraph);
+
+  const Mesh *mesh_cow = reinterpret_cast<Mesh *>(DEG_get_evaluated_id(depsgraph, &mesh->id));
+  EXPECT_EQ(mesh_cow->totvert, 10);
+  EXPECT_EQ(mesh_cow->mvert, mesh->mvert);
+}
+
+TEST_F(DepsgraphCopyOnWriteTest, MeshKeepsGeometryOfFreedOriginal)
+{
+  scene_create(100);
+  mesh->mvert[5].co[0] = 1.0f;
+  const Mesh *mesh_cow = reinterpret_cast<Mesh *>(DEG_get_evaluated_id(depsgraph, &mesh->id));
+  const MVert *mvert_cow = mesh_cow->mvert;
+
+  /* The original geometry is freed before the graph is updated. */
+  CustomData_free(&mesh->vdata, mesh->totvert);
+  mesh->totvert = 10;
+  CustomData_add_layer(&mesh->vdata, CD_MVERT, CD_CALLOC, nullptr, 10);
+  BKE_mesh_update_customdata_pointers(mesh, false);
+  EXPECT_EQ(mesh_cow->mvert, mvert_cow);
+  EXPECT_EQ(mesh_cow->mvert[5].co[0], 1.0f);
+
+  /* The old array is freed together with the evaluated mesh. */
+  DEG_id_tag_update_ex(bmain, &mesh->id, ID_RECALC_GEOMETRY);
+  DEG_evaluate_on_refresh(depsgraph);
+  EXPECT_EQ(mesh_cow->totvert, 10);
+  EXPECT_EQ(mesh_cow->mvert, mesh->mvert);
+}
+
+TEST_F(DepsgraphCopyOnWriteTest, MeshKeepsGeometryOfReallocatedOriginal)
+{
+  scene_create(100);
+  mesh->mvert[5].co[0] = 1.0f;
+  const Mesh *mesh_cow = reinterpret_cast<Mesh *>(DEG_get_evaluated_id(depsgraph, &mesh->id));
+  const MVert *mvert_cow = mesh_cow->mvert;
+
+  CustomData_realloc(&mesh->vdata, 200);
+  mesh->totvert = 200;
+  BKE_mesh_update_customdata_pointers(mesh, false);
+  EXPECT_NE(mesh->mvert, mvert_cow);
+  EXPECT_EQ(mesh->mvert[5].co[0], 1.0f);
+  EXPECT_EQ(mesh_cow->mvert, mvert_cow);
+  EXPECT_EQ(mesh_cow->mvert[5].co[0], 1.0f);
+}
+
+}  // namespace blender::deg::tests
@@ -0,0 +1,179 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "intern/eval/deg_eval_cost_profile.h"
+
+#include "BLI_hash_mm2a.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_scene_types.h"
+
+#include "intern/depsgraph.h"
+#include "intern/node/deg_node_component.h"
+#include "intern/node/deg_node_id.h"
+#include "intern/node/deg_node_operation.h"
+
+namespace blender::deg {
+
+uint64_t cost_profile_key(OperationNode *node)
+{
+  if (node->cost_profile_key != 0) {
+    return node->cost_profile_key;
+  }
+  /* Name tag is not a part of the identifier, but is needed to tell apart operations. */
+  const string identifier = node->full_identifier() + "#" + std::to_string(node->name_tag);
+  const unsigned char *data = (const unsigned char *)identifier.c_str();
+  const uint64_t key = ((uint64_t)BLI_hash_mm2(data, identifier.size(), 0) << 32) |
+                       BLI_hash_mm2(data, identifier.size(), 1);
+  /* Zero is used to indicate that the key is not calculated yet. */
+  node->cost_profile_key = (key != 0) ? key : 1;
+  return node->cost_profile_key;
+}
+
+void CostProfile::update(OperationNode *node)
+{
+  OperationCost &cost = costs_.lookup_or_add_default(cost_profile_key(node));
+  cost.average_time = node->stats.average_time;
+  cost.samples_num++;
+}
+
+const OperationCost *CostProfile::lookup(OperationNode *node) const
+{
+  return costs_.lookup_ptr(cost_profile_key(node));
+}
+
+double CostProfile::id_time(IDNode *id_node) const
+{
+  double time = 0.0;
+  for (ComponentNode *comp_node : id_node->components.values()) {
+    for (OperationNode *op_node : comp_node->operations) {
+      const OperationCost *cost = lookup(op_node);
+      if (cost != nullptr) {
+        time += cost->average_time;
+      }
+    }
+  }
+  return time;
+}
+
+double CostProfile::total_time(const Depsgraph *graph) const
+{
+  double time = 0.0;
+  for (IDNode *id_node : graph->id_nodes) {
+    time += id_time(id_node);
+  }
+  return time;
+}
+
+void CostProfile::import(const DepsgraphOperationCost *costs, int costs_num)
+{
+  for (int i = 0; i < costs_num; i++) {
+    OperationCost cost;
+    cost.average_time = costs[i].average_time;
+    cost.samples_num = costs[i].samples_num;
+    costs_.add(costs[i].key, cost);
+  }
+}
+
+void CostProfile::export_to(Map<uint64_t, OperationCost> &costs) const
+{
+  for (Map<uint64_t, OperationCost>::Item item : costs_.items()) {
+    costs.add_or_modify(
+        item.key,
+        [&](OperationCost *cost) { new (cost) OperationCost(item.value); },
+        [&](OperationCost *cost) {
+          if (item.value.samples_num > cost->samples_num) {
+            *cost = item.value;
+          }
+        });
+  }
+}
+
+static void write_json_string(FILE *file, const char *str)
+{
+  fputc('"', file);
+  for (const char *c = str; *c; c++) {
+    if (ELEM(*c, '"', '\\')) {
+      fputc('\\', file);
+      fputc(*c, file);
+    }
+    else if ((unsigned char)*c < 0x20) {
+      fprintf(file, "\\u%04x", (unsigned char)*c);
+    }
+    else {
+      fputc(*c, file);
+    }
+  }
+  fputc('"', file);
+}
+
+void CostProfile::write_json(const Depsgraph *graph, FILE *file) const
+{
+  /* All times are written in milliseconds. */
+  fprintf(file, "{\n  \"total_time\": %f,\n", total_time(graph) * 1000.0);
+  fprintf(file, "  \"stored_operations_num\": %d,\n", (int)costs_.size());
+
+  fputs("  \"ids\": [", file);
+  bool is_first = true;
+  for (IDNode *id_node : graph->id_nodes) {
+    const double time = id_time(id_node);
+    if (time == 0.0) {
+      continue;
+    }
+    fputs(is_first ? "\n    {\"name\": " : ",\n    {\"name\": ", file);
+    write_json_string(file, id_node->name.c_str());
+    fprintf(file, ", \"time\": %f}", time * 1000.0);
+    is_first = false;
+  }
+  fputs("\n  ],\n", file);
+
+  fputs("  \"operations\": [", file);
+  is_first = true;
+  for (OperationNode *op_node : graph->operations) {
+    const OperationCost *cost = lookup(op_node);
+    if (cost == nullptr) {
+      continue;
+    }
+    fputs(is_first ? "\n    {\"name\": " : ",\n    {\"name\": ", file);
+    write_json_string(file, op_node->full_identifier().c_str());
+    fprintf(file,
+            ", \"key\": \"%016llx\", \"average_time\": %f, \"samples\": %d}",
+            (unsigned long long)cost_profile_key(op_node),
+            cost->average_time * 1000.0,
+            cost->samples_num);
+    is_first = false;
+  }
+  fputs("\n  ]\n}\n", file);
+}
+
+void CostProfile::clear()
+{
+  costs_.clear();
+}
+
+bool CostProfile::is_empty() const
+{
+  return costs_.is_empty();
+}
+
+}  // namespace blender::deg
@@ -0,0 +1,85 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ *
+ * Persistent per-operation evaluation cost profile.
+ *
+ * Unlike the node statistics, the profile is owned by the dependency graph itself, so it survives
+ * relations rebuild, and it can be stored in the scene to survive save and reload.
+ */
+
+#pragma once
+
+#include "BLI_map.hh"
+
+#include <stdio.h>
+
+struct DepsgraphOperationCost;
+
+namespace blender {
+namespace deg {
+
+struct Depsgraph;
+struct IDNode;
+struct OperationNode;
+
+struct OperationCost {
+  /* Exponential moving average of the evaluation time, in seconds. */
+  double average_time = 0.0;
+  /* Number of evaluations which contributed to the average. */
+  int samples_num = 0;
+};
+
+class CostProfile {
+ public:
+  /* Store average timing of the operation after it was evaluated. */
+  void update(OperationNode *node);
+
+  /* Cost of the operation, nullptr if it was never evaluated. */
+  const OperationCost *lookup(OperationNode *node) const;
+
+  /* Predicted evaluation time of all operations of the ID or the whole graph. */
+  double id_time(IDNode *id_node) const;
+  double total_time(const Depsgraph *graph) const;
+
+  /* Copy stored costs which are not in the profile yet. */
+  void import(const DepsgraphOperationCost *costs, int costs_num);
+  /* Merge the profile into the given map, keeping the entry with the most samples. */
+  void export_to(Map<uint64_t, OperationCost> &costs) const;
+
+  void write_json(const Depsgraph *graph, FILE *file) const;
+
+  void clear();
+  bool is_empty() const;
+
+  /* Costs from the scene were imported, only done once per dependency graph. */
+  bool is_imported = false;
+
+ protected:
+  Map<uint64_t, OperationCost> costs_;
+};
+
+/* Key of the operation in the profile, stable across sessions.
+ * Computed from the operation identifier and cached in the operation node. */
+uint64_t cost_profile_key(OperationNode *node);
+
+}  // namespace deg
+}  // namespace blender
@@ -0,0 +1,73 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "intern/eval/deg_eval_cost_profile.h"
+
+#include "DNA_scene_types.h"
+
+#include "testing/testing.h"
+
+namespace blender::deg::tests {
+
+TEST(deg_eval_cost_profile, ImportKeepsExisting)
+{
+  const DepsgraphOperationCost stored[2] = {{1, 0.5f, 3}, {2, 0.25f, 1}};
+  CostProfile profile;
+  EXPECT_TRUE(profile.is_empty());
+  profile.import(stored, 2);
+  EXPECT_FALSE(profile.is_empty());
+
+  /* Costs which are already in the profile are newer than the stored ones. */
+  const DepsgraphOperationCost newer[1] = {{1, 2.0f, 10}};
+  profile.import(newer, 1);
+
+  Map<uint64_t, OperationCost> costs;
+  profile.export_to(costs);
+  EXPECT_EQ(costs.size(), 2);
+  EXPECT_EQ(costs.lookup(1).average_time, 0.5);
+  EXPECT_EQ(costs.lookup(1).samples_num, 3);
+  EXPECT_EQ(costs.lookup(2).average_time, 0.25);
+
+  profile.clear();
+  EXPECT_TRUE(profile.is_empty());
+}
+
+TEST(deg_eval_cost_profile, ExportMergesBySamples)
+{
+  const DepsgraphOperationCost costs_a[2] = {{1, 1.0f, 5}, {2, 1.0f, 1}};
+  const DepsgraphOperationCost costs_b[2] = {{1, 2.0f, 2}, {2, 2.0f, 4}};
+  CostProfile profile_a;
+  CostProfile profile_b;
+  profile_a.import(costs_a, 2);
+  profile_b.import(costs_b, 2);
+
+  Map<uint64_t, OperationCost> costs;
+  profile_a.export_to(costs);
+  profile_b.export_to(costs);
+  EXPECT_EQ(costs.size(), 2);
+  EXPECT_EQ(costs.lookup(1).average_time, 1.0);
+  EXPECT_EQ(costs.lookup(2).average_time, 2.0);
+  EXPECT_EQ(costs.lookup(2).samples_num, 4);
+}
+
+}  // namespace blender::deg::tests
@@ -51,6 +51,11 @@ void deg_eval_stats_aggregate(Depsgraph *graph)
     IDNode *id_node = comp_node->owner;
     id_node->stats.current_time += op_node->stats.current_time;
     comp_node->stats.current_time += op_node->stats.current_time;
+    /* Only operations which were evaluated have a meaningful time. */
+    if (op_node->scheduled && !op_node->is_noop()) {
+      op_node->stats.accumulate_current();
+      graph->cost_profile.update(op_node);
+    }
   }
 }
 
@@ -161,8 +161,12 @@ struct Node {
     /* Reset counters needed for the current graph evaluation, does not
      * touch averaging accumulators. */
     void reset_current();
+    /* Blend time of the current graph evaluation into the average. */
+    void accumulate_current();
     /* Time spend on this node during current graph evaluation. */
     double current_time;
+    /* Exponential moving average of the evaluation time, zero when never timed. */
+    double average_time;
   };
   /* Relationships between nodes
    * The reason why all depsgraph nodes are descended from this type (apart
@@ -172,6 +172,15 @@ OperationNode *ComponentNode::add_operation(const DepsEvalOperationCb &op,
                                             const char *name,
                                             int name_tag)
 {
+  /* Component of an ID which is kept by an incremental build, re-open it for new operations. */
+  if (operations_map == nullptr) {
+    operations_map = new Map<ComponentNode::OperationIDKey, OperationNode *>();
+    for (OperationNode *op_node : operations) {
+      OperationIDKey key(op_node->opcode, op_node->name.c_str(), op_node->name_tag);
+      operations_map->add_new(key, op_node);
+    }
+    operations.clear();
+  }
   OperationNode *op_node = find_operation(opcode, name, name_tag);
   if (!op_node) {
     DepsNodeFactory *factory = type_get_factory(NodeType::OPERATION);
@@ -251,14 +260,9 @@ OperationNode *ComponentNode::get_entry_operation()
     return entry_operation;
   }
   if (operations_map != nullptr && operations_map->size() == 1) {
-    OperationNode *op_node = nullptr;
-    /* TODO(sergey): This is somewhat slow. */
-    for (OperationNode *tmp : operations_map->values()) {
-      op_node = tmp;
-    }
-    /* Cache for the subsequent usage. */
-    entry_operation = op_node;
-    return op_node;
+    /* The single operation is not cached in the component: relations of different IDs are built
+     * from multiple threads, which all might query the same component. */
+    return *operations_map->values().begin();
   }
   if (operations.size() == 1) {
     return operations[0];
@@ -272,14 +276,8 @@ OperationNode *ComponentNode::get_exit_operation()
     return exit_operation;
   }
   if (operations_map != nullptr && operations_map->size() == 1) {
-    OperationNode *op_node = nullptr;
-    /* TODO(sergey): This is somewhat slow. */
-    for (OperationNode *tmp : operations_map->values()) {
-      op_node = tmp;
-    }
-    /* Cache for the subsequent usage. */
-    exit_operation = op_node;
-    return op_node;
+    /* Not cached, see get_entry_operation(). */
+    return *operations_map->values().begin();
   }
   if (operations.size() == 1) {
     return operations[0];
@@ -289,6 +287,10 @@ OperationNode *ComponentNode::get_exit_operation()
 
 void ComponentNode::finalize_build(Depsgraph * /*graph*/)
 {
+  if (operations_map == nullptr) {
+    /* Component was kept as-is by an incremental build. */
+    return;
+  }
   operations.reserve(operations_map->size());
   for (OperationNode *op_node : operations_map->values()) {
     operations.append(op_node);
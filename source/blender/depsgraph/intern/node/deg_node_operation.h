@@ -266,6 +266,13 @@ struct OperationNode : public Node {
   uint32_t num_links_pending;
   bool scheduled;
 
+  /* Estimated time of the longest chain of operations which starts at this one, among the
+   * operations tagged for update. Used to prioritize operations when evaluating. */
+  double critical_path_time;
+
+  /* Key of this operation in the evaluation cost profile, zero until it is first needed. */
+  uint64_t cost_profile_key;
+
   /* Identifier for the operation being performed. */
   OperationCode opcode;
   int name_tag;
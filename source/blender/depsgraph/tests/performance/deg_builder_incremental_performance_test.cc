@@ -0,0 +1,84 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+
+#include "intern/builder/deg_builder_incremental_test_utils.hh"
+
+#include "PIL_time.h"
+
+#include "BKE_global.h"
+
+DEFINE_int32(deg_rebuild_objects,
+             1000,
+             "Number of objects in the scene used to compare full and incremental rebuild time.");
+
+namespace blender::deg::tests {
+
+TEST_F(DepsgraphIncrementalBuildTest, RelationsUpdate)
+{
+  const int objects_num = FLAGS_deg_rebuild_objects;
+  scene_create(objects_num);
+  Object *object = objects[objects_num / 2];
+
+  add_constraint(object, objects[1]);
+  double start_time = PIL_check_seconds_timer();
+  DEG_id_relations_tag_update(bmain, &object->id);
+  DEG_graph_relations_update(depsgraph);
+  const double incremental_time = PIL_check_seconds_timer() - start_time;
+
+  /* Same relations built from scratch. */
+  start_time = PIL_check_seconds_timer();
+  DEG_graph_tag_relations_update(depsgraph);
+  DEG_graph_relations_update(depsgraph);
+  const double full_time = PIL_check_seconds_timer() - start_time;
+
+  printf("Relations update with %d objects: full %.3f ms, incremental %.3f ms (%.1fx)\n",
+         objects_num,
+         full_time * 1000.0,
+         incremental_time * 1000.0,
+         full_time / incremental_time);
+}
+
+/* Build from scratch with relations of IDs built from multiple threads and from a single one.
+ * Run with `--deg_rebuild_objects=50000` to measure big scenes. */
+TEST_F(DepsgraphIncrementalBuildTest, FullBuildThreads)
+{
+  const int objects_num = FLAGS_deg_rebuild_objects;
+  scene_create(objects_num);
+
+  double start_time = PIL_check_seconds_timer();
+  DEG_graph_tag_relations_update(depsgraph);
+  DEG_graph_relations_update(depsgraph);
+  const double threaded_time = PIL_check_seconds_timer() - start_time;
+
+  const int debug_flags = G.debug;
+  G.debug |= G_DEBUG_DEPSGRAPH_NO_THREADS;
+  start_time = PIL_check_seconds_timer();
+  DEG_graph_tag_relations_update(depsgraph);
+  DEG_graph_relations_update(depsgraph);
+  const double serial_time = PIL_check_seconds_timer() - start_time;
+  G.debug = debug_flags;
+
+  printf("Relations build with %d objects: single thread %.3f ms, threaded %.3f ms (%.1fx)\n",
+         objects_num,
+         serial_time * 1000.0,
+         threaded_time * 1000.0,
+         serial_time / threaded_time);
+}
+
+}  // namespace blender::deg::tests
@@ -81,6 +81,36 @@ static bool memfile_undosys_poll(bContext *C)
   return true;
 }
 
+/**
+ * Compress the memfile steps older than #UserDef.undo_compress_steps in the background,
+ * these are unlikely to be restored soon and would otherwise use a lot of memory.
+ */
+static void memfile_undosys_compress_cold_steps(MemFileUndoStep *us_new,
+                                               MemFileUndoStep *us_prev)
+{
+  /* The new step is not in the stack yet. */
+  MemFileUndoStep *us_next = us_new;
+  int steps_newer = 1;
+  for (UndoStep *us_iter = &us_prev->step; us_iter != NULL;
+       us_iter = BKE_undosys_step_same_type_prev(us_iter)) {
+    MemFileUndoStep *us = (MemFileUndoStep *)us_iter;
+    if (us->data == NULL) {
+      continue;
+    }
+    /* Apply the results of compression that finished, without waiting for the running one,
+     * keeping the memory usage up to date so the undo memory limit accounts for it. */
+    BLO_memfile_compress_update(&us->data->memfile);
+    us->step.data_size = us->data->memfile.size;
+
+    if (U.undo_compress_steps != 0 && steps_newer >= U.undo_compress_steps &&
+        !us->data->memfile.is_compressed) {
+      BLO_memfile_compress_begin(&us->data->memfile, &us_next->data->memfile);
+    }
+    us_next = us;
+    steps_newer++;
+  }
+}
+
 static bool memfile_undosys_step_encode(struct bContext *UNUSED(C),
                                         struct Main *bmain,
                                         UndoStep *us_p)
@@ -105,6 +135,10 @@ static bool memfile_undosys_step_encode(struct bContext *UNUSED(C),
   us->step.use_old_bmain_data = !bmain->use_memfile_full_barrier;
   bmain->use_memfile_full_barrier = false;
 
+  if (us_prev != NULL) {
+    memfile_undosys_compress_cold_steps(us, us_prev);
+  }
+
   return true;
 }
 
@@ -149,6 +183,15 @@ static void memfile_undosys_step_decode(struct bContext *C,
 {
   BLI_assert(undo_direction != 0);
 
+  MemFileUndoStep *us = (MemFileUndoStep *)us_p;
+
+  /* Cold undo steps may be compressed, see #BLO_memfile_compress_begin. Decompress before
+   * anything is freed, so the current state is kept when the step can't be restored. */
+  if (!BLO_memfile_decompress(&us->data->memfile)) {
+    WM_report(RPT_ERROR, "Undo step could not be decompressed, it can't be restored");
+    return;
+  }
+
   bool use_old_bmain_data = true;
 
   if (USER_EXPERIMENTAL_TEST(&U, use_undo_legacy)) {
@@ -190,7 +233,6 @@ static void memfile_undosys_step_decode(struct bContext *C,
 
   ED_editors_exit(bmain, false);
 
-  MemFileUndoStep *us = (MemFileUndoStep *)us_p;
   BKE_memfile_undo_decode(us->data, undo_direction, use_old_bmain_data, C);
 
   for (UndoStep *us_iter = us_p->next; us_iter; us_iter = us_iter->next) {
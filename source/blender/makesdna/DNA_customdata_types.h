@@ -240,6 +240,10 @@ enum {
   CD_FLAG_EXTERNAL = (1 << 3),
   /* Indicates external data is read into memory */
   CD_FLAG_IN_MEMORY = (1 << 4),
+  /* Indicates the referenced layer keeps the data of its owner alive (runtime only) */
+  CD_FLAG_SHARED = (1 << 5),
+  /* Indicates the data of the layer is or was used by shared layers (runtime only) */
+  CD_FLAG_SHARED_SOURCE = (1 << 6),
 };
 
 /* Limits */
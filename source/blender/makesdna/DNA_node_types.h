@@ -411,6 +411,10 @@ typedef struct bNodeLink {
 #define NTREE_CHUNKSIZE_512 512
 #define NTREE_CHUNKSIZE_1024 1024
 
+/* tree->execution_mode */
+#define NTREE_EXECUTION_MODE_TILED 0
+#define NTREE_EXECUTION_MODE_FULL_FRAME 1
+
 /* the basis for a Node tree, all links and nodes reside internal here */
 /* only re-usable node trees are in the library though,
  * materials and textures allocate own tree struct */
@@ -448,7 +452,9 @@ typedef struct bNodeTree {
   short is_updating;
   /** Generic temporary flag for recursion check (DFS/BFS). */
   short done;
-  char _pad2[4];
+  /** Execution model of the compositor engine. */
+  short execution_mode;
+  char _pad2[2];
 
   /** Specific node type this tree is used for. */
   int nodetype DNA_DEPRECATED;
@@ -518,6 +524,8 @@ typedef struct bNodeTree {
 
 /* tree is localized copy, free when deleting node groups */
 /* #define NTREE_IS_LOCALIZED           (1 << 5) */
+#define NTREE_COM_HALF_FLOAT_BUFFER (1 << 6) /* store full frame buffers as half floats */
+#define NTREE_COM_CONSTANT_BUFFER (1 << 7)   /* store constant full frame buffers as one element */
 
 /* ntree->update */
 typedef enum eNodeTreeUpdate {
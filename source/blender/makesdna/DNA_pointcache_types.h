@@ -128,6 +128,8 @@ typedef struct PointCache {
   struct PTCacheEdit *edit;
   /** Free callback. */
   void (*free_edit)(struct PTCacheEdit *edit);
+  /** Memory mapped #PTCACHE_DISK_SINGLE_FILE archive (runtime only). */
+  struct PTCacheArchive *archive;
 } PointCache;
 
 /* pointcache->flag */
@@ -153,6 +155,8 @@ typedef struct PointCache {
 #define PTCACHE_IGNORE_CLEAR (1 << 13)
 
 #define PTCACHE_FLAG_INFO_DIRTY (1 << 14)
+/** Store all frames of the disk cache in a single file, with data stored per channel. */
+#define PTCACHE_DISK_SINGLE_FILE (1 << 15)
 
 /* PTCACHE_OUTDATED + PTCACHE_FRAMES_SKIPPED */
 #define PTCACHE_REDO_NEEDED 258
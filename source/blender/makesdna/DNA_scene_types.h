@@ -1679,6 +1679,15 @@ enum {
   SCE_ORIENT_SCALE = 3,
 };
 
+/* Average evaluation time of a dependency graph operation, see #Scene.depsgraph_costs. */
+typedef struct DepsgraphOperationCost {
+  /** Hash of the operation identifier. */
+  uint64_t key;
+  /** In seconds. */
+  float average_time;
+  int samples_num;
+} DepsgraphOperationCost;
+
 typedef struct Scene {
   ID id;
   /** Animation data (must be immediately after id for utilities to use it). */
@@ -1740,7 +1749,10 @@ typedef struct Scene {
 
   /* none of the dependency graph  vars is mean to be saved */
   struct GHash *depsgraph_hash;
-  char _pad7[4];
+
+  /** Evaluation cost profile of the dependency graphs, stored with #SCE_DEPSGRAPH_COST_PROFILE. */
+  struct DepsgraphOperationCost *depsgraph_costs;
+  int depsgraph_costs_num;
 
   /* User-Defined KeyingSets */
   /**
@@ -2126,6 +2138,7 @@ typedef enum eVGroupSelect {
 #define SCE_FRAME_DROP (1 << 3)
 #define SCE_KEYS_NO_SELONLY (1 << 4)
 #define SCE_READFILE_LIBLINK_NEED_SETSCENE_CHECK (1 << 5)
+#define SCE_DEPSGRAPH_COST_PROFILE (1 << 6)
 
 /* return flag BKE_scene_base_iter_next functions */
 /* #define F_ERROR          -1 */ /* UNUSED */
@@ -18,6 +18,7 @@
  * \ingroup RNA
  */
 
+#include <float.h>
 #include <stdlib.h>
 
 #include "BLI_path_util.h"
@@ -42,6 +43,7 @@
 
 #  include "BLI_iterator.h"
 #  include "BLI_math.h"
+#  include "BLI_string.h"
 
 #  include "RNA_access.h"
 
@@ -269,6 +271,44 @@ static void rna_Depsgraph_debug_stats(Depsgraph *depsgraph, char *result)
                outer);
 }
 
+static void rna_Depsgraph_debug_stats_copy_on_write(Depsgraph *depsgraph, char *result)
+{
+  size_t shared, copied;
+  DEG_stats_copy_on_write_memory(depsgraph, &shared, &copied);
+  char shared_str[15], copied_str[15];
+  BLI_str_format_byte_unit(shared_str, (long long)shared, false);
+  BLI_str_format_byte_unit(copied_str, (long long)copied, false);
+  BLI_snprintf(result,
+               STATS_MAX_SIZE,
+               "Evaluated geometry: %s shared with original data, %s copied",
+               shared_str,
+               copied_str);
+}
+
+static float rna_Depsgraph_cost_profile_id_time(Depsgraph *depsgraph, ID *id)
+{
+  return (float)DEG_cost_profile_id_time(depsgraph, id);
+}
+
+static float rna_Depsgraph_cost_profile_total_time(Depsgraph *depsgraph)
+{
+  return (float)DEG_cost_profile_total_time(depsgraph);
+}
+
+static void rna_Depsgraph_cost_profile_write_json(Depsgraph *depsgraph,
+                                                  ReportList *reports,
+                                                  const char *filepath)
+{
+  if (!DEG_cost_profile_write_json(depsgraph, filepath)) {
+    BKE_reportf(reports, RPT_ERROR, "Could not write cost profile to '%s'", filepath);
+  }
+}
+
+static void rna_Depsgraph_cost_profile_clear(Depsgraph *depsgraph)
+{
+  DEG_cost_profile_clear(depsgraph);
+}
+
 static void rna_Depsgraph_update(Depsgraph *depsgraph, Main *bmain, ReportList *reports)
 {
   if (DEG_is_evaluating(depsgraph)) {
@@ -676,6 +716,44 @@ static void rna_def_depsgraph(BlenderRNA *brna)
   RNA_def_parameter_flags(parm, PROP_THICK_WRAP, 0); /* needed for string return value */
   RNA_def_function_output(func, parm);
 
+  func = RNA_def_function(
+      srna, "debug_stats_copy_on_write", "rna_Depsgraph_debug_stats_copy_on_write");
+  RNA_def_function_ui_description(func,
+                                  "Report the memory of evaluated geometry which is shared with "
+                                  "the original data, and which is copied for evaluation");
+  /* weak!, no way to return dynamic string type */
+  parm = RNA_def_string(func, "result", NULL, STATS_MAX_SIZE, "result", "");
+  RNA_def_parameter_flags(parm, PROP_THICK_WRAP, 0); /* needed for string return value */
+  RNA_def_function_output(func, parm);
+
+  /* Evaluation cost profile. */
+
+  func = RNA_def_function(srna, "cost_profile_id_time", "rna_Depsgraph_cost_profile_id_time");
+  RNA_def_function_ui_description(
+      func, "Average evaluation time of all operations of the data-block, in seconds");
+  parm = RNA_def_pointer(func, "id", "ID", "", "Original or evaluated data-block");
+  RNA_def_parameter_flags(parm, 0, PARM_REQUIRED);
+  parm = RNA_def_float(func, "time", 0.0f, 0.0f, FLT_MAX, "Time", "", 0.0f, FLT_MAX);
+  RNA_def_function_return(func, parm);
+
+  func = RNA_def_function(
+      srna, "cost_profile_total_time", "rna_Depsgraph_cost_profile_total_time");
+  RNA_def_function_ui_description(
+      func, "Average evaluation time of all operations in the dependency graph, in seconds");
+  parm = RNA_def_float(func, "time", 0.0f, 0.0f, FLT_MAX, "Time", "", 0.0f, FLT_MAX);
+  RNA_def_function_return(func, parm);
+
+  func = RNA_def_function(
+      srna, "cost_profile_write_json", "rna_Depsgraph_cost_profile_write_json");
+  RNA_def_function_ui_description(func, "Write the evaluation cost profile to a JSON file");
+  RNA_def_function_flag(func, FUNC_USE_REPORTS);
+  parm = RNA_def_string_file_path(
+      func, "filepath", NULL, FILE_MAX, "File Path", "Output path for the JSON file");
+  RNA_def_parameter_flags(parm, 0, PARM_REQUIRED);
+
+  func = RNA_def_function(srna, "cost_profile_clear", "rna_Depsgraph_cost_profile_clear");
+  RNA_def_function_ui_description(func, "Forget the evaluation cost profile gathered so far");
+
   /* Updates. */
 
   func = RNA_def_function(srna, "update", "rna_Depsgraph_update");
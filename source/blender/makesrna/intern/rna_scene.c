@@ -7575,6 +7575,14 @@ void RNA_def_scene(BlenderRNA *brna)
   RNA_def_property_ui_text(prop, "Sync Mode", "How to sync playback");
   RNA_def_property_update(prop, NC_SCENE, NULL);
 
+  prop = RNA_def_property(srna, "use_depsgraph_cost_profile", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "flag", SCE_DEPSGRAPH_COST_PROFILE);
+  RNA_def_property_ui_text(prop,
+                           "Evaluation Cost Profile",
+                           "Measure the average evaluation time of the dependency graph "
+                           "operations, and store it in the file");
+  RNA_def_property_update(prop, NC_SCENE, NULL);
+
   /* Nodes (Compositing) */
   prop = RNA_def_property(srna, "node_tree", PROP_POINTER, PROP_NONE);
   RNA_def_property_pointer_sdna(prop, NULL, "nodetree");
@@ -830,6 +830,22 @@ static void rna_Sequence_audio_update(Main *UNUSED(bmain), Scene *scene, Pointer
   DEG_id_tag_update(&scene->id, ID_RECALC_SEQUENCER_STRIPS);
 }
 
+static int rna_Sequence_cache_hits_get(PointerRNA *ptr)
+{
+  Scene *scene = (Scene *)ptr->owner_id;
+  int hits, misses;
+  BKE_sequencer_cache_strip_stats_get(scene, (Sequence *)ptr->data, &hits, &misses);
+  return hits;
+}
+
+static int rna_Sequence_cache_misses_get(PointerRNA *ptr)
+{
+  Scene *scene = (Scene *)ptr->owner_id;
+  int hits, misses;
+  BKE_sequencer_cache_strip_stats_get(scene, (Sequence *)ptr->data, &hits, &misses);
+  return misses;
+}
+
 static int rna_Sequence_input_count_get(PointerRNA *ptr)
 {
   Sequence *seq = (Sequence *)(ptr->data);
@@ -1093,6 +1109,12 @@ static int rna_SequenceEditor_overlay_frame_get(PointerRNA *ptr)
   }
 }
 
+static float rna_SequenceEditor_prefetch_frame_rate_get(PointerRNA *ptr)
+{
+  Scene *scene = (Scene *)ptr->owner_id;
+  return BKE_sequencer_prefetch_throughput_get(scene);
+}
+
 static void rna_SequenceEditor_overlay_frame_set(PointerRNA *ptr, int value)
 {
   Scene *scene = (Scene *)ptr->owner_id;
@@ -1941,6 +1963,22 @@ static void rna_def_sequence(BlenderRNA *brna)
   RNA_def_property_boolean_sdna(prop, NULL, "cache_flag", SEQ_CACHE_OVERRIDE);
   RNA_def_property_ui_text(prop, "Override Cache Settings", "Override global cache settings");
 
+  prop = RNA_def_property(srna, "cache_hits", PROP_INT, PROP_NONE);
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_int_funcs(prop, "rna_Sequence_cache_hits_get", NULL, NULL);
+  RNA_def_property_ui_text(prop,
+                           "Cache Hits",
+                           "Number of images of this strip found in the cache, final images count "
+                           "for the topmost strip of the frame");
+
+  prop = RNA_def_property(srna, "cache_misses", PROP_INT, PROP_NONE);
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_int_funcs(prop, "rna_Sequence_cache_misses_get", NULL, NULL);
+  RNA_def_property_ui_text(prop,
+                           "Cache Misses",
+                           "Number of images of this strip not found in the cache, which had to "
+                           "be rendered");
+
   RNA_api_sequence_strip(srna);
 }
 
@@ -2086,6 +2124,13 @@ static void rna_def_editor(BlenderRNA *brna)
       "Render frames ahead of current frame in the background for faster playback");
   RNA_def_property_update(prop, NC_SCENE | ND_SEQUENCER, NULL);
 
+  prop = RNA_def_property(srna, "prefetch_frame_rate", PROP_FLOAT, PROP_NONE);
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_float_funcs(prop, "rna_SequenceEditor_prefetch_frame_rate_get", NULL, NULL);
+  RNA_def_property_ui_text(prop,
+                           "Prefetch Frame Rate",
+                           "Frames rendered per second by prefetching since it was started");
+
   prop = RNA_def_property(srna, "recycle_max_cost", PROP_FLOAT, PROP_NONE);
   RNA_def_property_range(prop, 0.0f, SEQ_CACHE_COST_MAX);
   RNA_def_property_ui_range(prop, 0.0f, SEQ_CACHE_COST_MAX, 0.1f, 1);
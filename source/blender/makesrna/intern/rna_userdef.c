@@ -30,6 +30,7 @@
 
 #include "BLI_math_base.h"
 #include "BLI_math_rotation.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
 #include "BLT_translation.h"
@@ -4951,6 +4952,14 @@ static void rna_def_userdef_edit(BlenderRNA *brna)
   RNA_def_property_ui_text(
       prop, "Undo Memory Size", "Maximum memory usage in megabytes (0 means unlimited)");
 
+  prop = RNA_def_property(srna, "undo_compress_steps", PROP_INT, PROP_NONE);
+  RNA_def_property_int_sdna(prop, NULL, "undo_compress_steps");
+  RNA_def_property_range(prop, 0, 256);
+  RNA_def_property_ui_text(prop,
+                           "Compress Undo Steps",
+                           "Compress global undo steps older than this number of steps in the "
+                           "background to reduce memory usage (0 disables compression)");
+
   prop = RNA_def_property(srna, "use_global_undo", PROP_BOOLEAN, PROP_NONE);
   RNA_def_property_boolean_sdna(prop, NULL, "uiflag", USER_GLOBALUNDO);
   RNA_def_property_ui_text(
@@ -5305,6 +5314,11 @@ static void rna_def_userdef_system(BlenderRNA *brna)
        0,
        "None",
        "Requires fast storage, but uses minimum CPU resources"},
+      {USER_SEQ_DISK_CACHE_COMPRESSION_FAST,
+       "FAST",
+       0,
+       "Fast",
+       "Compresses less than Low, but is much faster to write and read back"},
       {USER_SEQ_DISK_CACHE_COMPRESSION_LOW,
        "LOW",
        0,
@@ -5360,6 +5374,14 @@ static void rna_def_userdef_system(BlenderRNA *brna)
   RNA_def_property_ui_text(prop, "Memory Cache Limit", "Memory cache limit (in megabytes)");
   RNA_def_property_update(prop, 0, "rna_Userdef_memcache_update");
 
+  prop = RNA_def_property(srna, "compositor_cache_limit", PROP_INT, PROP_NONE);
+  RNA_def_property_int_sdna(prop, NULL, "compositor_cache_limit");
+  RNA_def_property_range(prop, 0, max_memory_in_megabytes_int());
+  RNA_def_property_ui_text(prop,
+                           "Compositor Cache Limit",
+                           "Memory used to keep compositor results between executions, only used "
+                           "by the full frame execution model (in megabytes, 0 disables caching)");
+
   /* Sequencer disk cache */
 
   prop = RNA_def_property(srna, "use_sequencer_disk_cache", PROP_BOOLEAN, PROP_NONE);
@@ -5385,6 +5407,15 @@ static void rna_def_userdef_system(BlenderRNA *brna)
       "Disk Cache Compression Level",
       "Smaller compression will result in larger files, but less decoding overhead");
 
+  prop = RNA_def_property(srna, "sequencer_prefetch_threads", PROP_INT, PROP_NONE);
+  RNA_def_property_int_sdna(prop, NULL, "sequencer_prefetch_threads");
+  RNA_def_property_range(prop, 1, BLENDER_MAX_THREADS);
+  RNA_def_property_ui_range(prop, 1, 64, 1, -1);
+  RNA_def_property_ui_text(prop,
+                           "Prefetch Threads",
+                           "Number of frames rendered in parallel when prefetching, only used "
+                           "when intermediate images are not cached");
+
   prop = RNA_def_property(srna, "scrollback", PROP_INT, PROP_UNSIGNED);
   RNA_def_property_int_sdna(prop, NULL, "scrollback");
   RNA_def_property_range(prop, 32, 32768);
@@ -6154,6 +6185,14 @@ static void rna_def_userdef_experimental(BlenderRNA *brna)
       "Undo Legacy",
       "Use legacy undo (slower than the new default one, but may be more stable in some cases)");
 
+  prop = RNA_def_property(srna, "use_depsgraph_priority_scheduling", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "use_depsgraph_priority_scheduling", 1);
+  RNA_def_property_ui_text(prop,
+                           "Depsgraph Priority Scheduling",
+                           "Evaluate the longest chains of dependencies first, estimated from the "
+                           "timing of previous evaluations, and evaluate very cheap operations "
+                           "in batches");
+
   prop = RNA_def_property(srna, "use_new_geometry_nodes", PROP_BOOLEAN, PROP_NONE);
   RNA_def_property_boolean_sdna(prop, NULL, "use_new_geometry_nodes", 1);
   RNA_def_property_ui_text(
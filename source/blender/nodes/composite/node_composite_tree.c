@@ -299,6 +299,15 @@ void ntreeCompositRegisterPass(bNodeTree *ntree,
   }
 }
 
+/* Free results of the compositor which are kept between executions, called when the trees they
+ * were computed from are freed. */
+void ntreeCompositClearResultCache(void)
+{
+#ifdef WITH_COMPOSITOR
+  COM_clearCaches();
+#endif
+}
+
 /* called from render pipeline, to tag render input and output */
 /* need to do all scenes, to prevent errors when you re-render 1 scene */
 void ntreeCompositTagRender(Scene *scene)
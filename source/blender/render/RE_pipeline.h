@@ -155,6 +155,9 @@ typedef struct RenderResult {
   char *error;
 
   struct StampData *stamp_data;
+
+  /* unique in the session, renewed when passes are written, so users can tell results apart */
+  unsigned int session_uuid;
 } RenderResult;
 
 typedef struct RenderStats {
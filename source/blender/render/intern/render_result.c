@@ -28,6 +28,8 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 #include "BLI_ghash.h"
 #include "BLI_hash_md5.h"
 #include "BLI_listbase.h"
@@ -305,6 +307,7 @@ RenderResult *render_result_new(Render *re,
   }
 
   rr = MEM_callocN(sizeof(RenderResult), "new render result");
+  render_result_session_uuid_renew(rr);
   rr->rectx = rectx;
   rr->recty = recty;
   rr->renrect.xmin = 0;
@@ -777,9 +780,19 @@ RenderResult *render_result_new_from_exr(
     }
   }
 
+  render_result_session_uuid_renew(rr);
+
   return rr;
 }
 
+/* Results of the same render can be told apart by the session_uuid, it changes with the contents
+ * of the passes. */
+void render_result_session_uuid_renew(RenderResult *rr)
+{
+  static uint global_session_uuid = 0;
+  rr->session_uuid = atomic_add_and_fetch_uint32(&global_session_uuid, 1);
+}
+
 void render_result_view_new(RenderResult *rr, const char *viewname)
 {
   RenderView *rv = MEM_callocN(sizeof(RenderView), "new render view");
@@ -883,6 +896,8 @@ void render_result_merge(RenderResult *rr, RenderResult *rrpart)
       }
     }
   }
+
+  render_result_session_uuid_renew(rr);
 }
 
 /* Called from the UI and render pipeline, to save multilayer and multiview
@@ -1373,6 +1388,7 @@ int render_result_exr_file_read_path(RenderResult *rr,
 
   IMB_exr_read_channels(exrhandle);
   IMB_exr_close(exrhandle);
+  render_result_session_uuid_renew(rr);
 
   return 1;
 }
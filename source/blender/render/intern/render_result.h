@@ -62,6 +62,8 @@ struct RenderResult *render_result_new_from_exr(
 void render_result_view_new(struct RenderResult *rr, const char *viewname);
 void render_result_views_new(struct RenderResult *rr, const struct RenderData *rd);
 
+void render_result_session_uuid_renew(struct RenderResult *rr);
+
 /* Merge */
 
 void render_result_merge(struct RenderResult *rr, struct RenderResult *rrpart);
@@ -266,6 +266,10 @@ void BKE_sequencer_cache_iterate(struct Scene *scene,
                                                     int timeline_frame,
                                                     int cache_type,
                                                     float cost));
+void BKE_sequencer_cache_strip_stats_get(struct Scene *scene,
+                                         struct Sequence *seq,
+                                         int *r_hits,
+                                         int *r_misses);
 
 /* **********************************************************************
  * prefetch.c
@@ -277,6 +281,7 @@ void BKE_sequencer_cache_iterate(struct Scene *scene,
 void BKE_sequencer_prefetch_stop_all(void);
 void BKE_sequencer_prefetch_stop(struct Scene *scene);
 bool BKE_sequencer_prefetch_need_redraw(struct Main *bmain, struct Scene *scene);
+float BKE_sequencer_prefetch_throughput_get(struct Scene *scene);
 
 /* **********************************************************************
  * sequencer.c
@@ -0,0 +1,330 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup sequencer
+ */
+
+#include <string.h>
+
+#include "zlib.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_task.h"
+#include "BLI_utildefines.h"
+
+#ifdef WITH_LZO
+#  ifdef WITH_SYSTEM_LZO
+#    include <lzo/lzo1x.h>
+#  else
+#    include "minilzo.h"
+#  endif
+#  define LZO_OUT_LEN(size) ((size) + (size) / 16 + 64 + 3)
+#endif
+
+#include "disk_cache_codec.h"
+
+typedef struct ChunkCodecData {
+  int codec;
+  int level;
+  int element_size;
+  size_t size_raw;
+  size_t chunk_bound;
+
+  /* Raw data. */
+  uchar *data;
+
+  /* Encoded chunks, `chunk_bound` bytes apart when encoding. */
+  uchar *encoded;
+  uint32_t *chunk_sizes;
+  size_t *chunk_offsets;
+
+  bool is_valid;
+} ChunkCodecData;
+
+bool seq_disk_cache_codec_is_supported(int codec)
+{
+  switch (codec) {
+    case SEQ_DISK_CACHE_CODEC_NONE:
+    case SEQ_DISK_CACHE_CODEC_ZLIB:
+      return true;
+    case SEQ_DISK_CACHE_CODEC_LZO:
+#ifdef WITH_LZO
+      return true;
+#else
+      return false;
+#endif
+  }
+
+  return false;
+}
+
+int seq_disk_cache_chunks_num(size_t size_raw)
+{
+  return (int)((size_raw + SEQ_DISK_CACHE_CHUNK_SIZE - 1) / SEQ_DISK_CACHE_CHUNK_SIZE);
+}
+
+static size_t seq_disk_cache_chunk_size_raw(size_t size_raw, int chunk)
+{
+  const size_t offset = (size_t)chunk * SEQ_DISK_CACHE_CHUNK_SIZE;
+  return MIN2(size_raw - offset, SEQ_DISK_CACHE_CHUNK_SIZE);
+}
+
+static size_t seq_disk_cache_chunk_bound(int codec)
+{
+  switch (codec) {
+    case SEQ_DISK_CACHE_CODEC_LZO:
+#ifdef WITH_LZO
+      return LZO_OUT_LEN(SEQ_DISK_CACHE_CHUNK_SIZE);
+#else
+      break;
+#endif
+    case SEQ_DISK_CACHE_CODEC_ZLIB:
+      return compressBound(SEQ_DISK_CACHE_CHUNK_SIZE);
+  }
+
+  return SEQ_DISK_CACHE_CHUNK_SIZE;
+}
+
+/* Store every byte of the elements in its own plane, so exponents and high mantissa bytes of
+ * floats are next to each other. */
+static void seq_disk_cache_shuffle(const uchar *src, uchar *dst, size_t size, int element_size)
+{
+  const size_t elements_num = size / element_size;
+
+  for (int byte = 0; byte < element_size; byte++) {
+    uchar *plane = dst + byte * elements_num;
+    for (size_t i = 0; i < elements_num; i++) {
+      plane[i] = src[i * element_size + byte];
+    }
+  }
+
+  memcpy(dst + elements_num * element_size,
+         src + elements_num * element_size,
+         size - elements_num * element_size);
+}
+
+static void seq_disk_cache_unshuffle(const uchar *src, uchar *dst, size_t size, int element_size)
+{
+  const size_t elements_num = size / element_size;
+
+  for (int byte = 0; byte < element_size; byte++) {
+    const uchar *plane = src + byte * elements_num;
+    for (size_t i = 0; i < elements_num; i++) {
+      dst[i * element_size + byte] = plane[i];
+    }
+  }
+
+  memcpy(dst + elements_num * element_size,
+         src + elements_num * element_size,
+         size - elements_num * element_size);
+}
+
+static void seq_disk_cache_encode_chunk(void *__restrict userdata,
+                                        const int chunk,
+                                        const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ChunkCodecData *data = (ChunkCodecData *)userdata;
+  const size_t size = seq_disk_cache_chunk_size_raw(data->size_raw, chunk);
+  const uchar *src = data->data + (size_t)chunk * SEQ_DISK_CACHE_CHUNK_SIZE;
+  uchar *dst = data->encoded + (size_t)chunk * data->chunk_bound;
+  uchar *shuffled = NULL;
+  size_t size_encoded = 0;
+
+  if (data->element_size > 1) {
+    shuffled = MEM_mallocN(size, __func__);
+    seq_disk_cache_shuffle(src, shuffled, size, data->element_size);
+  }
+  const uchar *chunk_src = shuffled ? shuffled : src;
+
+  switch (data->codec) {
+    case SEQ_DISK_CACHE_CODEC_LZO: {
+#ifdef WITH_LZO
+      void *wrkmem = MEM_mallocN(LZO1X_1_MEM_COMPRESS, __func__);
+      lzo_uint out_len = (lzo_uint)data->chunk_bound;
+      if (lzo1x_1_compress(chunk_src, (lzo_uint)size, dst, &out_len, wrkmem) == LZO_E_OK) {
+        size_encoded = out_len;
+      }
+      MEM_freeN(wrkmem);
+#endif
+      break;
+    }
+    case SEQ_DISK_CACHE_CODEC_ZLIB: {
+      uLongf out_len = (uLongf)data->chunk_bound;
+      if (compress2(dst, &out_len, chunk_src, (uLong)size, data->level) == Z_OK) {
+        size_encoded = out_len;
+      }
+      break;
+    }
+  }
+
+  /* Chunks which don't compress are stored as they are, they are recognized by their size. */
+  if (size_encoded == 0 || size_encoded >= size) {
+    memcpy(dst, src, size);
+    size_encoded = size;
+  }
+
+  data->chunk_sizes[chunk] = (uint32_t)size_encoded;
+  MEM_SAFE_FREE(shuffled);
+}
+
+void *seq_disk_cache_encode(const void *data,
+                            size_t size_raw,
+                            int codec,
+                            int level,
+                            int element_size,
+                            uint32_t *r_chunk_sizes,
+                            size_t *r_size_encoded)
+{
+  const int chunks_num = seq_disk_cache_chunks_num(size_raw);
+
+  if (codec == SEQ_DISK_CACHE_CODEC_NONE || !seq_disk_cache_codec_is_supported(codec)) {
+    for (int chunk = 0; chunk < chunks_num; chunk++) {
+      r_chunk_sizes[chunk] = (uint32_t)seq_disk_cache_chunk_size_raw(size_raw, chunk);
+    }
+    *r_size_encoded = size_raw;
+    return NULL;
+  }
+
+  ChunkCodecData codec_data = {
+      .codec = codec,
+      .level = level,
+      .element_size = element_size,
+      .size_raw = size_raw,
+      .chunk_bound = seq_disk_cache_chunk_bound(codec),
+      .data = (uchar *)data,
+      .chunk_sizes = r_chunk_sizes,
+  };
+  codec_data.encoded = MEM_mallocN(codec_data.chunk_bound * chunks_num, __func__);
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(0, chunks_num, &codec_data, seq_disk_cache_encode_chunk, &settings);
+
+  /* Move chunks next to each other, in place. */
+  size_t size_encoded = 0;
+  for (int chunk = 0; chunk < chunks_num; chunk++) {
+    memmove(codec_data.encoded + size_encoded,
+            codec_data.encoded + (size_t)chunk * codec_data.chunk_bound,
+            r_chunk_sizes[chunk]);
+    size_encoded += r_chunk_sizes[chunk];
+  }
+
+  *r_size_encoded = size_encoded;
+  return codec_data.encoded;
+}
+
+static void seq_disk_cache_decode_chunk(void *__restrict userdata,
+                                        const int chunk,
+                                        const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ChunkCodecData *data = (ChunkCodecData *)userdata;
+  const size_t size = seq_disk_cache_chunk_size_raw(data->size_raw, chunk);
+  const size_t size_encoded = data->chunk_sizes[chunk];
+  const uchar *src = data->encoded + data->chunk_offsets[chunk];
+  uchar *dst = data->data + (size_t)chunk * SEQ_DISK_CACHE_CHUNK_SIZE;
+
+  if (size_encoded == size) {
+    memcpy(dst, src, size);
+    return;
+  }
+
+  uchar *shuffled = NULL;
+  if (data->element_size > 1) {
+    shuffled = MEM_mallocN(size, __func__);
+  }
+  uchar *chunk_dst = shuffled ? shuffled : dst;
+  bool is_valid = false;
+
+  switch (data->codec) {
+    case SEQ_DISK_CACHE_CODEC_LZO: {
+#ifdef WITH_LZO
+      lzo_uint out_len = (lzo_uint)size;
+      is_valid = lzo1x_decompress_safe(src, (lzo_uint)size_encoded, chunk_dst, &out_len, NULL) ==
+                     LZO_E_OK &&
+                 out_len == size;
+#endif
+      break;
+    }
+    case SEQ_DISK_CACHE_CODEC_ZLIB: {
+      uLongf out_len = (uLongf)size;
+      is_valid = uncompress(chunk_dst, &out_len, src, (uLong)size_encoded) == Z_OK &&
+                 out_len == size;
+      break;
+    }
+  }
+
+  if (is_valid && shuffled) {
+    seq_disk_cache_unshuffle(shuffled, dst, size, data->element_size);
+  }
+  if (!is_valid) {
+    data->is_valid = false;
+  }
+  MEM_SAFE_FREE(shuffled);
+}
+
+bool seq_disk_cache_decode(const void *encoded,
+                           size_t size_encoded,
+                           const uint32_t *chunk_sizes,
+                           int codec,
+                           int element_size,
+                           void *r_data,
+                           size_t size_raw)
+{
+  const int chunks_num = seq_disk_cache_chunks_num(size_raw);
+  size_t *chunk_offsets = MEM_mallocN(sizeof(*chunk_offsets) * chunks_num, __func__);
+  size_t offset = 0;
+
+  for (int chunk = 0; chunk < chunks_num; chunk++) {
+    chunk_offsets[chunk] = offset;
+    offset += chunk_sizes[chunk];
+
+    if (chunk_sizes[chunk] > seq_disk_cache_chunk_size_raw(size_raw, chunk) &&
+        chunk_sizes[chunk] > seq_disk_cache_chunk_bound(codec)) {
+      offset = SIZE_MAX;
+      break;
+    }
+  }
+
+  if (offset != size_encoded) {
+    MEM_freeN(chunk_offsets);
+    return false;
+  }
+
+  ChunkCodecData codec_data = {
+      .codec = codec,
+      .element_size = element_size,
+      .size_raw = size_raw,
+      .data = (uchar *)r_data,
+      .encoded = (uchar *)encoded,
+      .chunk_sizes = (uint32_t *)chunk_sizes,
+      .chunk_offsets = chunk_offsets,
+      .is_valid = true,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(0, chunks_num, &codec_data, seq_disk_cache_decode_chunk, &settings);
+
+  MEM_freeN(chunk_offsets);
+  return codec_data.is_valid;
+}
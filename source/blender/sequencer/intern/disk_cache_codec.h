@@ -0,0 +1,87 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup sequencer
+ *
+ * Encoding of images stored in the disk cache, see image_cache.c.
+ *
+ * Image data is split into chunks of #SEQ_DISK_CACHE_CHUNK_SIZE bytes, which are encoded and
+ * decoded independently and in parallel. The encoded size of every chunk is stored in an index,
+ * chunks which don't compress are stored as they are.
+ */
+
+#include "BLI_sys_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SEQ_DISK_CACHE_CHUNK_SIZE (256 * 1024)
+
+typedef enum eSeqDiskCacheCodec {
+  SEQ_DISK_CACHE_CODEC_NONE = 0,
+  /** Fast LZ77 compression, only available when built with LZO. */
+  SEQ_DISK_CACHE_CODEC_LZO = 1,
+  SEQ_DISK_CACHE_CODEC_ZLIB = 2,
+} eSeqDiskCacheCodec;
+
+/* **********************************************************************
+ * disk_cache_codec.c
+ * **********************************************************************
+ */
+
+bool seq_disk_cache_codec_is_supported(int codec);
+int seq_disk_cache_chunks_num(size_t size_raw);
+
+/**
+ * Encode `size_raw` bytes of `data`. Elements of `element_size` bytes (floats) are split into
+ * byte planes before compressing, which makes them compress much better.
+ *
+ * \param r_chunk_sizes: Encoded size of every chunk, #seq_disk_cache_chunks_num items.
+ * \return Encoded chunks, `r_size_encoded` bytes, free with #MEM_freeN.
+ * NULL for #SEQ_DISK_CACHE_CODEC_NONE, `data` is stored as is then.
+ */
+void *seq_disk_cache_encode(const void *data,
+                            size_t size_raw,
+                            int codec,
+                            int level,
+                            int element_size,
+                            uint32_t *r_chunk_sizes,
+                            size_t *r_size_encoded);
+
+/**
+ * Decode chunks written by #seq_disk_cache_encode into `r_data`. `encoded` can point into a
+ * memory mapped file, it is only read.
+ *
+ * \return false when the encoded data is invalid.
+ */
+bool seq_disk_cache_decode(const void *encoded,
+                           size_t size_encoded,
+                           const uint32_t *chunk_sizes,
+                           int codec,
+                           int element_size,
+                           void *r_data,
+                           size_t size_raw);
+
+#ifdef __cplusplus
+}
+#endif
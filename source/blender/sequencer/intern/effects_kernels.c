@@ -0,0 +1,658 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup sequencer
+ */
+
+#include <string.h>
+
+#include "BLI_math_base.h"
+#include "BLI_math_color_blend.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_sequence_types.h"
+
+#include "effects_kernels.h"
+
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
+/* Kernels run on render threads, this is only changed by tests and benchmarks while no kernels
+ * are running. */
+static bool use_simd_kernels = true;
+
+bool seq_effect_kernels_simd_supported(void)
+{
+  /* A CPU running code compiled for SSE2 supports it, so there is nothing to detect at runtime. */
+#ifdef __SSE2__
+  return true;
+#else
+  return false;
+#endif
+}
+
+void seq_effect_kernels_use_simd(bool use_simd)
+{
+  use_simd_kernels = use_simd;
+}
+
+BLI_INLINE bool use_simd(void)
+{
+  return use_simd_kernels;
+}
+
+/* Byte kernels use integer factors in [0, 256], like the scalar code they replace. The SIMD
+ * versions rely on this range to fit intermediate values in 16 bits. */
+BLI_INLINE int byte_fac(float fac)
+{
+  return (int)(256.0f * fac);
+}
+
+BLI_INLINE bool byte_fac_in_range(int fac)
+{
+  return fac >= 0 && fac <= 256;
+}
+
+/* -------------------------------------------------------------------- */
+/** \name Scalar Kernels
+ * \{ */
+
+static void alphaover_float_scalar(
+    const float *rt1, const float *rt2, float *rt, int width, float fac)
+{
+  for (int x = 0; x < width; x++, rt1 += 4, rt2 += 4, rt += 4) {
+    /* rt = rt1 over rt2  (alpha from rt1) */
+    const float mfac = 1.0f - (fac * rt1[3]);
+
+    if (fac <= 0.0f) {
+      memcpy(rt, rt2, sizeof(float[4]));
+    }
+    else if (mfac <= 0.0f) {
+      memcpy(rt, rt1, sizeof(float[4]));
+    }
+    else {
+      rt[0] = fac * rt1[0] + mfac * rt2[0];
+      rt[1] = fac * rt1[1] + mfac * rt2[1];
+      rt[2] = fac * rt1[2] + mfac * rt2[2];
+      rt[3] = fac * rt1[3] + mfac * rt2[3];
+    }
+  }
+}
+
+static void cross_byte_scalar(const uchar *rt1, const uchar *rt2, uchar *rt, int width, int fac2)
+{
+  const int fac1 = 256 - fac2;
+  for (int x = 0; x < width; x++, rt1 += 4, rt2 += 4, rt += 4) {
+    rt[0] = (fac1 * rt1[0] + fac2 * rt2[0]) >> 8;
+    rt[1] = (fac1 * rt1[1] + fac2 * rt2[1]) >> 8;
+    rt[2] = (fac1 * rt1[2] + fac2 * rt2[2]) >> 8;
+    rt[3] = (fac1 * rt1[3] + fac2 * rt2[3]) >> 8;
+  }
+}
+
+static void cross_float_scalar(const float *rt1, const float *rt2, float *rt, int width, float fac)
+{
+  const float mfac = 1.0f - fac;
+  for (int x = 0; x < width; x++, rt1 += 4, rt2 += 4, rt += 4) {
+    rt[0] = mfac * rt1[0] + fac * rt2[0];
+    rt[1] = mfac * rt1[1] + fac * rt2[1];
+    rt[2] = mfac * rt1[2] + fac * rt2[2];
+    rt[3] = mfac * rt1[3] + fac * rt2[3];
+  }
+}
+
+static void add_byte_scalar(const uchar *cp1, const uchar *cp2, uchar *rt, int width, int fac)
+{
+  for (int x = 0; x < width; x++, cp1 += 4, cp2 += 4, rt += 4) {
+    const int m = fac * (int)cp2[3];
+    rt[0] = min_ii(cp1[0] + ((m * cp2[0]) >> 16), 255);
+    rt[1] = min_ii(cp1[1] + ((m * cp2[1]) >> 16), 255);
+    rt[2] = min_ii(cp1[2] + ((m * cp2[2]) >> 16), 255);
+    rt[3] = cp1[3];
+  }
+}
+
+static void add_float_scalar(const float *rt1, const float *rt2, float *rt, int width, float fac)
+{
+  for (int x = 0; x < width; x++, rt1 += 4, rt2 += 4, rt += 4) {
+    const float m = (1.0f - (rt1[3] * (1.0f - fac))) * rt2[3];
+    rt[0] = rt1[0] + m * rt2[0];
+    rt[1] = rt1[1] + m * rt2[1];
+    rt[2] = rt1[2] + m * rt2[2];
+    rt[3] = rt1[3];
+  }
+}
+
+static void sub_byte_scalar(const uchar *cp1, const uchar *cp2, uchar *rt, int width, int fac)
+{
+  for (int x = 0; x < width; x++, cp1 += 4, cp2 += 4, rt += 4) {
+    const int m = fac * (int)cp2[3];
+    rt[0] = max_ii(cp1[0] - ((m * cp2[0]) >> 16), 0);
+    rt[1] = max_ii(cp1[1] - ((m * cp2[1]) >> 16), 0);
+    rt[2] = max_ii(cp1[2] - ((m * cp2[2]) >> 16), 0);
+    rt[3] = cp1[3];
+  }
+}
+
+static void sub_float_scalar(const float *rt1, const float *rt2, float *rt, int width, float fac)
+{
+  const float fac_inv = 1.0f - fac;
+  for (int x = 0; x < width; x++, rt1 += 4, rt2 += 4, rt += 4) {
+    const float m = (1.0f - (rt1[3] * fac_inv)) * rt2[3];
+    rt[0] = max_ff(rt1[0] - m * rt2[0], 0.0f);
+    rt[1] = max_ff(rt1[1] - m * rt2[1], 0.0f);
+    rt[2] = max_ff(rt1[2] - m * rt2[2], 0.0f);
+    rt[3] = rt1[3];
+  }
+}
+
+static void mul_byte_scalar(const uchar *rt1, const uchar *rt2, uchar *rt, int width, int fac)
+{
+  /* formula:
+   * fac * (a * b) + (1 - fac) * a  =>  fac * a * (b - 1) + a
+   */
+  for (int x = 0; x < width; x++, rt1 += 4, rt2 += 4, rt += 4) {
+    rt[0] = rt1[0] + ((fac * rt1[0] * (rt2[0] - 255)) >> 16);
+    rt[1] = rt1[1] + ((fac * rt1[1] * (rt2[1] - 255)) >> 16);
+    rt[2] = rt1[2] + ((fac * rt1[2] * (rt2[2] - 255)) >> 16);
+    rt[3] = rt1[3] + ((fac * rt1[3] * (rt2[3] - 255)) >> 16);
+  }
+}
+
+static void mul_float_scalar(const float *rt1, const float *rt2, float *rt, int width, float fac)
+{
+  for (int x = 0; x < width; x++, rt1 += 4, rt2 += 4, rt += 4) {
+    rt[0] = rt1[0] + fac * rt1[0] * (rt2[0] - 1.0f);
+    rt[1] = rt1[1] + fac * rt1[1] * (rt2[1] - 1.0f);
+    rt[2] = rt1[2] + fac * rt1[2] * (rt2[2] - 1.0f);
+    rt[3] = rt1[3] + fac * rt1[3] * (rt2[3] - 1.0f);
+  }
+}
+
+typedef void (*BlendFunctionFloat)(float dst[4], const float src1[4], const float src2[4]);
+
+static BlendFunctionFloat blend_function_float_get(int blend_mode)
+{
+  switch (blend_mode) {
+    case SEQ_TYPE_ADD:
+      return blend_color_add_float;
+    case SEQ_TYPE_SUB:
+      return blend_color_sub_float;
+    case SEQ_TYPE_MUL:
+      return blend_color_mul_float;
+    case SEQ_TYPE_DARKEN:
+      return blend_color_darken_float;
+    case SEQ_TYPE_LIGHTEN:
+      return blend_color_lighten_float;
+    case SEQ_TYPE_SCREEN:
+      return blend_color_screen_float;
+    case SEQ_TYPE_DIFFERENCE:
+      return blend_color_difference_float;
+    default:
+      return NULL;
+  }
+}
+
+static void blend_float_scalar(BlendFunctionFloat blend_function,
+                               const float *rt1,
+                               const float *rt2,
+                               float *rt,
+                               int width,
+                               float fac)
+{
+  for (int x = 0; x < width; x++, rt1 += 4, rt2 += 4, rt += 4) {
+    const float src1[4] = {rt1[0], rt1[1], rt1[2], rt1[3] * fac};
+    blend_function(rt, src1, rt2);
+    rt[3] = rt1[3];
+  }
+}
+
+/** \} */
+
+#ifdef __SSE2__
+
+/* -------------------------------------------------------------------- */
+/** \name SSE2 Kernels
+ *
+ * Float kernels process a pixel per register, byte kernels four pixels. Operations are done in
+ * the same order as in the scalar kernels, so results are identical.
+ * \{ */
+
+#  define SHUFFLE_ALPHA(v) _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3))
+
+/* Take the RGB channels from rgb and alpha from alpha. */
+BLI_INLINE __m128 replace_alpha_ps(__m128 rgb, __m128 alpha)
+{
+  const __m128 alpha_mask = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+  return _mm_or_ps(_mm_and_ps(alpha_mask, alpha), _mm_andnot_ps(alpha_mask, rgb));
+}
+
+BLI_INLINE __m128 select_ps(__m128 mask, __m128 a, __m128 b)
+{
+  return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static void alphaover_float_sse2(
+    const float *rt1, const float *rt2, float *rt, int width, float fac)
+{
+  if (fac <= 0.0f) {
+    memcpy(rt, rt2, sizeof(float[4]) * width);
+    return;
+  }
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 fac_v = _mm_set1_ps(fac);
+  for (int x = 0; x < width; x++, rt1 += 4, rt2 += 4, rt += 4) {
+    const __m128 a = _mm_loadu_ps(rt1);
+    const __m128 b = _mm_loadu_ps(rt2);
+    const __m128 mfac = _mm_sub_ps(one, _mm_mul_ps(fac_v, SHUFFLE_ALPHA(a)));
+    const __m128 result = _mm_add_ps(_mm_mul_ps(fac_v, a), _mm_mul_ps(mfac, b));
+    _mm_storeu_ps(rt, select_ps(_mm_cmple_ps(mfac, zero), a, result));
+  }
+}
+
+static void cross_float_sse2(const float *rt1, const float *rt2, float *rt, int width, float fac)
+{
+  const __m128 fac_v = _mm_set1_ps(fac);
+  const __m128 mfac_v = _mm_set1_ps(1.0f - fac);
+  for (int x = 0; x < width; x++, rt1 += 4, rt2 += 4, rt += 4) {
+    const __m128 a = _mm_loadu_ps(rt1);
+    const __m128 b = _mm_loadu_ps(rt2);
+    _mm_storeu_ps(rt, _mm_add_ps(_mm_mul_ps(mfac_v, a), _mm_mul_ps(fac_v, b)));
+  }
+}
+
+static void add_float_sse2(const float *rt1, const float *rt2, float *rt, int width, float fac)
+{
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 fac_inv = _mm_set1_ps(1.0f - fac);
+  for (int x = 0; x < width; x++, rt1 += 4, rt2 += 4, rt += 4) {
+    const __m128 a = _mm_loadu_ps(rt1);
+    const __m128 b = _mm_loadu_ps(rt2);
+    const __m128 m = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(SHUFFLE_ALPHA(a), fac_inv)),
+                                SHUFFLE_ALPHA(b));
+    _mm_storeu_ps(rt, replace_alpha_ps(_mm_add_ps(a, _mm_mul_ps(m, b)), a));
+  }
+}
+
+static void sub_float_sse2(const float *rt1, const float *rt2, float *rt, int width, float fac)
+{
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 fac_inv = _mm_set1_ps(1.0f - fac);
+  for (int x = 0; x < width; x++, rt1 += 4, rt2 += 4, rt += 4) {
+    const __m128 a = _mm_loadu_ps(rt1);
+    const __m128 b = _mm_loadu_ps(rt2);
+    const __m128 m = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(SHUFFLE_ALPHA(a), fac_inv)),
+                                SHUFFLE_ALPHA(b));
+    _mm_storeu_ps(rt, replace_alpha_ps(_mm_max_ps(_mm_sub_ps(a, _mm_mul_ps(m, b)), zero), a));
+  }
+}
+
+static void mul_float_sse2(const float *rt1, const float *rt2, float *rt, int width, float fac)
+{
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 fac_v = _mm_set1_ps(fac);
+  for (int x = 0; x < width; x++, rt1 += 4, rt2 += 4, rt += 4) {
+    const __m128 a = _mm_loadu_ps(rt1);
+    const __m128 b = _mm_loadu_ps(rt2);
+    _mm_storeu_ps(rt, _mm_add_ps(a, _mm_mul_ps(_mm_mul_ps(fac_v, a), _mm_sub_ps(b, one))));
+  }
+}
+
+static void blend_float_sse2(
+    int blend_mode, const float *rt1, const float *rt2, float *rt, int width, float fac)
+{
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 fac_v = _mm_set1_ps(fac);
+  const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+
+  for (int x = 0; x < width; x++, rt1 += 4, rt2 += 4, rt += 4) {
+    const __m128 a = _mm_loadu_ps(rt1);
+    const __m128 b = _mm_loadu_ps(rt2);
+    /* Alpha of the first input scaled by the factor, and alpha of the second input. */
+    const __m128 a_alpha = _mm_mul_ps(SHUFFLE_ALPHA(a), fac_v);
+    const __m128 t = SHUFFLE_ALPHA(b);
+    const __m128 mt = _mm_sub_ps(one, t);
+    __m128 result;
+
+    switch (blend_mode) {
+      case SEQ_TYPE_ADD:
+        result = _mm_add_ps(a, _mm_mul_ps(b, a_alpha));
+        break;
+      case SEQ_TYPE_SUB:
+        result = _mm_max_ps(_mm_sub_ps(a, _mm_mul_ps(b, a_alpha)), zero);
+        break;
+      case SEQ_TYPE_MUL:
+        result = _mm_add_ps(_mm_mul_ps(mt, a), _mm_mul_ps(_mm_mul_ps(a, b), a_alpha));
+        break;
+      case SEQ_TYPE_DARKEN:
+      case SEQ_TYPE_LIGHTEN: {
+        /* Avoid dividing by zero, those pixels are not used. */
+        const __m128 divisor = select_ps(_mm_cmpneq_ps(t, zero), t, one);
+        const __m128 mapped = _mm_mul_ps(b, _mm_div_ps(a_alpha, divisor));
+        const __m128 pick = (blend_mode == SEQ_TYPE_DARKEN) ?
+                                select_ps(_mm_cmplt_ps(a, mapped), a, mapped) :
+                                select_ps(_mm_cmpgt_ps(a, mapped), a, mapped);
+        result = _mm_add_ps(_mm_mul_ps(mt, a), _mm_mul_ps(t, pick));
+        break;
+      }
+      case SEQ_TYPE_SCREEN: {
+        const __m128 screen = _mm_sub_ps(
+            one, _mm_mul_ps(_mm_sub_ps(one, a), _mm_sub_ps(one, b)));
+        const __m128 temp = select_ps(_mm_cmpgt_ps(screen, zero), screen, zero);
+        result = _mm_add_ps(_mm_mul_ps(temp, t), _mm_mul_ps(a, mt));
+        break;
+      }
+      case SEQ_TYPE_DIFFERENCE:
+      default:
+        result = _mm_add_ps(_mm_mul_ps(_mm_and_ps(_mm_sub_ps(a, b), abs_mask), t),
+                            _mm_mul_ps(a, mt));
+        break;
+    }
+
+    /* No-op when the second input is transparent, alpha always comes from the first input. */
+    result = select_ps(_mm_cmpneq_ps(t, zero), result, a);
+    _mm_storeu_ps(rt, replace_alpha_ps(result, a));
+  }
+}
+
+#  undef SHUFFLE_ALPHA
+
+/* Broadcast the alpha of each of the two pixels in 16 bit lanes over the pixel. */
+BLI_INLINE __m128i alpha_epi16(__m128i v)
+{
+  return _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(3, 3, 3, 3)),
+                             _MM_SHUFFLE(3, 3, 3, 3));
+}
+
+/* Take the RGB bytes from rgb and the alpha bytes from alpha. */
+BLI_INLINE __m128i replace_alpha_epi8(__m128i rgb, __m128i alpha)
+{
+  const __m128i alpha_mask = _mm_set1_epi32((int)0xff000000);
+  return _mm_or_si128(_mm_and_si128(alpha_mask, alpha), _mm_andnot_si128(alpha_mask, rgb));
+}
+
+/* Four pixels per iteration, returns the number of pixels done. */
+static int cross_byte_sse2(const uchar *rt1, const uchar *rt2, uchar *rt, int width, int fac2)
+{
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i fac1_v = _mm_set1_epi16((short)(256 - fac2));
+  const __m128i fac2_v = _mm_set1_epi16((short)fac2);
+  int x;
+  for (x = 0; x + 4 <= width; x += 4, rt1 += 16, rt2 += 16, rt += 16) {
+    const __m128i a = _mm_loadu_si128((const __m128i *)rt1);
+    const __m128i b = _mm_loadu_si128((const __m128i *)rt2);
+    /* The factors add up to 256, so the sums fit in 16 bits. */
+    const __m128i lo = _mm_srli_epi16(
+        _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(a, zero), fac1_v),
+                      _mm_mullo_epi16(_mm_unpacklo_epi8(b, zero), fac2_v)),
+        8);
+    const __m128i hi = _mm_srli_epi16(
+        _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(a, zero), fac1_v),
+                      _mm_mullo_epi16(_mm_unpackhi_epi8(b, zero), fac2_v)),
+        8);
+    _mm_storeu_si128((__m128i *)rt, _mm_packus_epi16(lo, hi));
+  }
+  return x;
+}
+
+/* (fac * alpha * color) >> 16 of the second input, as added or subtracted by add and sub. */
+BLI_INLINE __m128i add_sub_term_epi8(__m128i b, __m128i fac_v)
+{
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i b_lo = _mm_unpacklo_epi8(b, zero);
+  const __m128i b_hi = _mm_unpackhi_epi8(b, zero);
+  const __m128i m_lo = _mm_mullo_epi16(alpha_epi16(b_lo), fac_v);
+  const __m128i m_hi = _mm_mullo_epi16(alpha_epi16(b_hi), fac_v);
+  return _mm_packus_epi16(_mm_mulhi_epu16(m_lo, b_lo), _mm_mulhi_epu16(m_hi, b_hi));
+}
+
+static int add_byte_sse2(const uchar *cp1, const uchar *cp2, uchar *rt, int width, int fac)
+{
+  const __m128i fac_v = _mm_set1_epi16((short)fac);
+  int x;
+  for (x = 0; x + 4 <= width; x += 4, cp1 += 16, cp2 += 16, rt += 16) {
+    const __m128i a = _mm_loadu_si128((const __m128i *)cp1);
+    const __m128i b = _mm_loadu_si128((const __m128i *)cp2);
+    const __m128i result = _mm_adds_epu8(a, add_sub_term_epi8(b, fac_v));
+    _mm_storeu_si128((__m128i *)rt, replace_alpha_epi8(result, a));
+  }
+  return x;
+}
+
+static int sub_byte_sse2(const uchar *cp1, const uchar *cp2, uchar *rt, int width, int fac)
+{
+  const __m128i fac_v = _mm_set1_epi16((short)fac);
+  int x;
+  for (x = 0; x + 4 <= width; x += 4, cp1 += 16, cp2 += 16, rt += 16) {
+    const __m128i a = _mm_loadu_si128((const __m128i *)cp1);
+    const __m128i b = _mm_loadu_si128((const __m128i *)cp2);
+    const __m128i result = _mm_subs_epu8(a, add_sub_term_epi8(b, fac_v));
+    _mm_storeu_si128((__m128i *)rt, replace_alpha_epi8(result, a));
+  }
+  return x;
+}
+
+/* a + ((fac * a * (b - 255)) >> 16), computed as a - ceil(fac * a * (255 - b) / 65536) since
+ * the shift of the negative product rounds down. */
+BLI_INLINE __m128i mul_epi16(__m128i a, __m128i b, __m128i fac_v)
+{
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i one = _mm_set1_epi16(1);
+  const __m128i p = _mm_mullo_epi16(a, _mm_sub_epi16(_mm_set1_epi16(255), b));
+  const __m128i high = _mm_mulhi_epu16(p, fac_v);
+  const __m128i low = _mm_mullo_epi16(p, fac_v);
+  const __m128i round_up = _mm_andnot_si128(_mm_cmpeq_epi16(low, zero), one);
+  return _mm_sub_epi16(a, _mm_add_epi16(high, round_up));
+}
+
+static int mul_byte_sse2(const uchar *rt1, const uchar *rt2, uchar *rt, int width, int fac)
+{
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i fac_v = _mm_set1_epi16((short)fac);
+  int x;
+  for (x = 0; x + 4 <= width; x += 4, rt1 += 16, rt2 += 16, rt += 16) {
+    const __m128i a = _mm_loadu_si128((const __m128i *)rt1);
+    const __m128i b = _mm_loadu_si128((const __m128i *)rt2);
+    const __m128i lo = mul_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero), fac_v);
+    const __m128i hi = mul_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero), fac_v);
+    _mm_storeu_si128((__m128i *)rt, _mm_packus_epi16(lo, hi));
+  }
+  return x;
+}
+
+/** \} */
+
+#endif /* __SSE2__ */
+
+/* -------------------------------------------------------------------- */
+/** \name Dispatch
+ * \{ */
+
+void seq_kernel_alphaover_float(
+    const float *rect1, const float *rect2, float *out, int width, float fac)
+{
+#ifdef __SSE2__
+  if (use_simd()) {
+    alphaover_float_sse2(rect1, rect2, out, width, fac);
+    return;
+  }
+#endif
+  alphaover_float_scalar(rect1, rect2, out, width, fac);
+}
+
+void seq_kernel_cross_byte(
+    const uchar *rect1, const uchar *rect2, uchar *out, int width, float fac)
+{
+  const int fac2 = byte_fac(fac);
+  int done = 0;
+#ifdef __SSE2__
+  if (use_simd() && byte_fac_in_range(fac2)) {
+    done = cross_byte_sse2(rect1, rect2, out, width, fac2);
+  }
+#endif
+  cross_byte_scalar(rect1 + done * 4, rect2 + done * 4, out + done * 4, width - done, fac2);
+}
+
+void seq_kernel_cross_float(
+    const float *rect1, const float *rect2, float *out, int width, float fac)
+{
+#ifdef __SSE2__
+  if (use_simd()) {
+    cross_float_sse2(rect1, rect2, out, width, fac);
+    return;
+  }
+#endif
+  cross_float_scalar(rect1, rect2, out, width, fac);
+}
+
+void seq_kernel_add_byte(const uchar *rect1, const uchar *rect2, uchar *out, int width, float fac)
+{
+  const int fac_i = byte_fac(fac);
+  int done = 0;
+#ifdef __SSE2__
+  if (use_simd() && byte_fac_in_range(fac_i)) {
+    done = add_byte_sse2(rect1, rect2, out, width, fac_i);
+  }
+#endif
+  add_byte_scalar(rect1 + done * 4, rect2 + done * 4, out + done * 4, width - done, fac_i);
+}
+
+void seq_kernel_add_float(
+    const float *rect1, const float *rect2, float *out, int width, float fac)
+{
+#ifdef __SSE2__
+  if (use_simd()) {
+    add_float_sse2(rect1, rect2, out, width, fac);
+    return;
+  }
+#endif
+  add_float_scalar(rect1, rect2, out, width, fac);
+}
+
+void seq_kernel_sub_byte(const uchar *rect1, const uchar *rect2, uchar *out, int width, float fac)
+{
+  const int fac_i = byte_fac(fac);
+  int done = 0;
+#ifdef __SSE2__
+  if (use_simd() && byte_fac_in_range(fac_i)) {
+    done = sub_byte_sse2(rect1, rect2, out, width, fac_i);
+  }
+#endif
+  sub_byte_scalar(rect1 + done * 4, rect2 + done * 4, out + done * 4, width - done, fac_i);
+}
+
+void seq_kernel_sub_float(
+    const float *rect1, const float *rect2, float *out, int width, float fac)
+{
+#ifdef __SSE2__
+  if (use_simd()) {
+    sub_float_sse2(rect1, rect2, out, width, fac);
+    return;
+  }
+#endif
+  sub_float_scalar(rect1, rect2, out, width, fac);
+}
+
+void seq_kernel_mul_byte(const uchar *rect1, const uchar *rect2, uchar *out, int width, float fac)
+{
+  const int fac_i = byte_fac(fac);
+  int done = 0;
+#ifdef __SSE2__
+  if (use_simd() && byte_fac_in_range(fac_i)) {
+    done = mul_byte_sse2(rect1, rect2, out, width, fac_i);
+  }
+#endif
+  mul_byte_scalar(rect1 + done * 4, rect2 + done * 4, out + done * 4, width - done, fac_i);
+}
+
+void seq_kernel_mul_float(
+    const float *rect1, const float *rect2, float *out, int width, float fac)
+{
+#ifdef __SSE2__
+  if (use_simd()) {
+    mul_float_sse2(rect1, rect2, out, width, fac);
+    return;
+  }
+#endif
+  mul_float_scalar(rect1, rect2, out, width, fac);
+}
+
+bool seq_kernel_blend_float(
+    int blend_mode, const float *rect1, const float *rect2, float *out, int width, float fac)
+{
+  BlendFunctionFloat blend_function = blend_function_float_get(blend_mode);
+  if (blend_function == NULL) {
+    return false;
+  }
+#ifdef __SSE2__
+  if (use_simd()) {
+    blend_float_sse2(blend_mode, rect1, rect2, out, width, fac);
+    return true;
+  }
+#endif
+  blend_float_scalar(blend_function, rect1, rect2, out, width, fac);
+  return true;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Rows
+ * \{ */
+
+void seq_kernel_rows_byte(SeqKernelByteFn kernel,
+                          const uchar *rect1,
+                          const uchar *rect2,
+                          uchar *out,
+                          int width,
+                          int height,
+                          float fac0,
+                          float fac1)
+{
+  for (int y = 0; y < height; y++) {
+    kernel(rect1, rect2, out, width, (y & 1) ? fac1 : fac0);
+    rect1 += width * 4;
+    rect2 += width * 4;
+    out += width * 4;
+  }
+}
+
+void seq_kernel_rows_float(SeqKernelFloatFn kernel,
+                           const float *rect1,
+                           const float *rect2,
+                           float *out,
+                           int width,
+                           int height,
+                           float fac0,
+                           float fac1)
+{
+  for (int y = 0; y < height; y++) {
+    kernel(rect1, rect2, out, width, (y & 1) ? fac1 : fac0);
+    rect1 += width * 4;
+    rect2 += width * 4;
+    out += width * 4;
+  }
+}
+
+/** \} */
@@ -0,0 +1,106 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup sequencer
+ *
+ * Row kernels of the blend effects, see effects.c.
+ *
+ * Every kernel blends a row of `width` RGBA pixels of `rect1` and `rect2` into `out`, with a
+ * single factor for the whole row. The SIMD versions give the same results as the scalar ones,
+ * they are used when the CPU supports them.
+ */
+
+#include "BLI_sys_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* **********************************************************************
+ * effects_kernels.c
+ * **********************************************************************
+ */
+
+/** Whether SIMD kernels are compiled in, a CPU running the build supports them. */
+bool seq_effect_kernels_simd_supported(void);
+/**
+ * Force the scalar kernels, for comparing both in tests and benchmarks. Ignored when not
+ * supported. Not thread safe, kernels may not be running.
+ */
+void seq_effect_kernels_use_simd(bool use_simd);
+
+typedef void (*SeqKernelByteFn)(
+    const uchar *rect1, const uchar *rect2, uchar *out, int width, float fac);
+typedef void (*SeqKernelFloatFn)(
+    const float *rect1, const float *rect2, float *out, int width, float fac);
+
+void seq_kernel_alphaover_float(
+    const float *rect1, const float *rect2, float *out, int width, float fac);
+void seq_kernel_cross_byte(
+    const uchar *rect1, const uchar *rect2, uchar *out, int width, float fac);
+void seq_kernel_cross_float(
+    const float *rect1, const float *rect2, float *out, int width, float fac);
+void seq_kernel_add_byte(const uchar *rect1, const uchar *rect2, uchar *out, int width, float fac);
+void seq_kernel_add_float(
+    const float *rect1, const float *rect2, float *out, int width, float fac);
+void seq_kernel_sub_byte(const uchar *rect1, const uchar *rect2, uchar *out, int width, float fac);
+void seq_kernel_sub_float(
+    const float *rect1, const float *rect2, float *out, int width, float fac);
+void seq_kernel_mul_byte(const uchar *rect1, const uchar *rect2, uchar *out, int width, float fac);
+void seq_kernel_mul_float(
+    const float *rect1, const float *rect2, float *out, int width, float fac);
+
+/**
+ * Blend mode of the blend effects, `fac` scales the alpha of `rect1`.
+ * \return false when there is no kernel for the blend mode.
+ */
+bool seq_kernel_blend_float(int blend_mode,
+                            const float *rect1,
+                            const float *rect2,
+                            float *out,
+                            int width,
+                            float fac);
+
+/**
+ * Apply a row kernel to `height` consecutive rows of `width` pixels. Even rows use `fac0` and odd
+ * rows `fac1`, for the fields of interlaced video.
+ */
+void seq_kernel_rows_byte(SeqKernelByteFn kernel,
+                          const uchar *rect1,
+                          const uchar *rect2,
+                          uchar *out,
+                          int width,
+                          int height,
+                          float fac0,
+                          float fac1);
+void seq_kernel_rows_float(SeqKernelFloatFn kernel,
+                           const float *rect1,
+                           const float *rect2,
+                           float *out,
+                           int width,
+                           int height,
+                           float fac0,
+                           float fac1);
+
+#ifdef __cplusplus
+}
+#endif
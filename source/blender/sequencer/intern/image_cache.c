@@ -20,10 +20,17 @@
  * \ingroup bke
  */
 
+#include <fcntl.h> /* for open flags (O_BINARY, O_RDONLY). */
 #include <memory.h>
 #include <stddef.h>
 #include <time.h>
 
+#ifndef WIN32
+#  include <unistd.h> /* for close */
+#else
+#  include <io.h> /* for open close */
+#endif
+
 #include "MEM_guardedalloc.h"
 
 #include "DNA_scene_types.h"
@@ -41,7 +48,9 @@
 #include "BLI_ghash.h"
 #include "BLI_listbase.h"
 #include "BLI_mempool.h"
+#include "BLI_mmap.h"
 #include "BLI_path_util.h"
+#include "BLI_session_uuid.h"
 #include "BLI_threads.h"
 
 #include "BKE_global.h"
@@ -50,6 +59,7 @@
 
 #include "SEQ_sequencer.h"
 
+#include "disk_cache_codec.h"
 #include "image_cache.h"
 #include "prefetch.h"
 #include "strip_time.h"
@@ -76,6 +86,11 @@
  * Once again, this is to reduce number of iterations, but also more controllable than removing
  * entries one by one in reverse order to their creation.
  *
+ * Recycling uses a GreedyDual-Size policy: the frame with the lowest score is freed, the score
+ * being its render cost per megabyte of memory, weighted by distance from the playhead, plus the
+ * cache clock at the time the frame was last used. The clock advances to the score of every
+ * recycled frame, so frames which are not used age, however expensive they are.
+ *
  * User can exclude caching of some images. Such entries will have is_temp_cache set.
  *
  *
@@ -86,7 +101,9 @@
  * For each cached non-temp image, image data and supplementary info are written to HDD.
  * Multiple(DCACHE_IMAGES_PER_FILE) images share the same file.
  * Each of these files contains header DiskCacheHeader followed by image data.
- * Zlib compression with user definable level can be used to compress image data(per image)
+ * Image data starts with an index of chunk sizes, followed by the chunks. Chunks are compressed
+ * independently with the codec chosen in user preferences, see disk_cache_codec.c.
+ * Files are read through memory mapping, chunks are decoded directly into the image buffer.
  * Images are written in order in which they are rendered.
  * Overwriting of individual entry is not possible.
  * Stored images are deleted by invalidation, or when size of all files exceeds maximum
@@ -99,11 +116,12 @@
 /* <cache type>-<resolution X>x<resolution Y>-<rendersize>%(<view_id>)-<frame no>.dcf */
 #define DCACHE_FNAME_FORMAT "%d-%dx%d-%d%%(%d)-%d.dcf"
 #define DCACHE_IMAGES_PER_FILE 100
-#define DCACHE_CURRENT_VERSION 1
+#define DCACHE_CURRENT_VERSION 2
 #define COLORSPACE_NAME_MAX 64 /* XXX: defined in imb intern */
 
 typedef struct DiskCacheHeaderEntry {
   unsigned char encoding;
+  unsigned char codec; /* eSeqDiskCacheCodec */
   uint64_t frameno;
   uint64_t size_compressed;
   uint64_t size_raw;
@@ -146,13 +164,24 @@ typedef struct SeqCache {
   struct SeqCacheKey *last_key;
   size_t memory_used;
   SeqDiskCache *disk_cache;
+  /* Score of the last recycled frame, see #seq_cache_recycle_score. */
+  float recycle_clock;
+  /* SeqCacheStripStats by session UUID of the strip. */
+  struct GHash *strip_stats;
 } SeqCache;
 
 typedef struct SeqCacheItem {
   struct SeqCache *cache_owner;
   struct ImBuf *ibuf;
+  /* #SeqCache.recycle_clock when the item was put or last used. */
+  float recycle_clock;
 } SeqCacheItem;
 
+typedef struct SeqCacheStripStats {
+  int hits;
+  int misses;
+} SeqCacheStripStats;
+
 typedef struct SeqCacheKey {
   struct SeqCache *cache_owner;
   void *userkey;
@@ -180,18 +209,28 @@ static char *seq_disk_cache_base_dir(void)
   return U.sequencer_disk_cache_dir;
 }
 
-static int seq_disk_cache_compression_level(void)
+static int seq_disk_cache_codec_get(int *r_level)
 {
+  *r_level = 0;
+
   switch (U.sequencer_disk_cache_compression) {
     case USER_SEQ_DISK_CACHE_COMPRESSION_NONE:
-      return 0;
+      return SEQ_DISK_CACHE_CODEC_NONE;
+    case USER_SEQ_DISK_CACHE_COMPRESSION_FAST:
+      if (seq_disk_cache_codec_is_supported(SEQ_DISK_CACHE_CODEC_LZO)) {
+        return SEQ_DISK_CACHE_CODEC_LZO;
+      }
+      *r_level = 1;
+      return SEQ_DISK_CACHE_CODEC_ZLIB;
     case USER_SEQ_DISK_CACHE_COMPRESSION_LOW:
-      return 1;
+      *r_level = 1;
+      return SEQ_DISK_CACHE_CODEC_ZLIB;
     case USER_SEQ_DISK_CACHE_COMPRESSION_HIGH:
-      return 9;
+      *r_level = 9;
+      return SEQ_DISK_CACHE_CODEC_ZLIB;
   }
 
-  return U.sequencer_disk_cache_compression;
+  return SEQ_DISK_CACHE_CODEC_NONE;
 }
 
 static size_t seq_disk_cache_size_limit(void)
@@ -483,36 +522,78 @@ static void seq_disk_cache_invalidate(Scene *scene,
   BLI_mutex_unlock(&disk_cache->read_write_mutex);
 }
 
-static size_t deflate_imbuf_to_file(ImBuf *ibuf,
-                                    FILE *file,
-                                    int level,
-                                    DiskCacheHeaderEntry *header_entry)
+/* Floats are encoded in byte planes, which compress better. */
+static int seq_disk_cache_element_size(ImBuf *ibuf)
 {
-  if (ibuf->rect) {
-    return BLI_gzip_mem_to_file_at_pos(
-        ibuf->rect, header_entry->size_raw, file, header_entry->offset, level);
-  }
+  return ibuf->rect ? 1 : sizeof(float);
+}
 
-  return BLI_gzip_mem_to_file_at_pos(
-      ibuf->rect_float, header_entry->size_raw, file, header_entry->offset, level);
+static size_t seq_disk_cache_write_imbuf(ImBuf *ibuf,
+                                         FILE *file,
+                                         int level,
+                                         DiskCacheHeaderEntry *header_entry)
+{
+  const void *data = ibuf->rect ? (void *)ibuf->rect : (void *)ibuf->rect_float;
+  const int chunks_num = seq_disk_cache_chunks_num(header_entry->size_raw);
+  uint32_t *chunk_sizes = MEM_mallocN(sizeof(*chunk_sizes) * chunks_num, __func__);
+  size_t size_encoded;
+  size_t bytes_written = 0;
+
+  void *encoded = seq_disk_cache_encode(data,
+                                        header_entry->size_raw,
+                                        header_entry->codec,
+                                        level,
+                                        seq_disk_cache_element_size(ibuf),
+                                        chunk_sizes,
+                                        &size_encoded);
+
+  if (fseek(file, header_entry->offset, SEEK_SET) == 0 &&
+      fwrite(chunk_sizes, sizeof(*chunk_sizes), chunks_num, file) == (size_t)chunks_num &&
+      fwrite(encoded ? encoded : data, 1, size_encoded, file) == size_encoded) {
+    bytes_written = sizeof(*chunk_sizes) * chunks_num + size_encoded;
+  }
+
+  MEM_freeN(chunk_sizes);
+  MEM_SAFE_FREE(encoded);
+  return bytes_written;
 }
 
-static size_t inflate_file_to_imbuf(ImBuf *ibuf, FILE *file, DiskCacheHeaderEntry *header_entry)
+static bool seq_disk_cache_read_imbuf(ImBuf *ibuf,
+                                      BLI_mmap_file *mmap_file,
+                                      DiskCacheHeaderEntry *header_entry)
 {
-  if (ibuf->rect) {
-    return BLI_ungzip_file_to_mem_at_pos(
-        ibuf->rect, header_entry->size_raw, file, header_entry->offset);
+  const int chunks_num = seq_disk_cache_chunks_num(header_entry->size_raw);
+  const size_t index_size = sizeof(uint32_t) * chunks_num;
+
+  if (header_entry->size_compressed < index_size ||
+      header_entry->offset + header_entry->size_compressed > BLI_mmap_get_length(mmap_file)) {
+    return false;
   }
 
-  return BLI_ungzip_file_to_mem_at_pos(
-      ibuf->rect_float, header_entry->size_raw, file, header_entry->offset);
+  /* Image data is decoded straight from the mapped file. */
+  const uchar *entry_data = (const uchar *)BLI_mmap_get_pointer(mmap_file) + header_entry->offset;
+  uint32_t *chunk_sizes = MEM_mallocN(index_size, __func__);
+  memcpy(chunk_sizes, entry_data, index_size);
+
+  if ((ENDIAN_ORDER == B_ENDIAN) && header_entry->encoding == 0) {
+    BLI_endian_switch_uint32_array(chunk_sizes, chunks_num);
+  }
+
+  void *data = ibuf->rect ? (void *)ibuf->rect : (void *)ibuf->rect_float;
+  bool is_valid = seq_disk_cache_decode(entry_data + index_size,
+                                        header_entry->size_compressed - index_size,
+                                        chunk_sizes,
+                                        header_entry->codec,
+                                        seq_disk_cache_element_size(ibuf),
+                                        data,
+                                        header_entry->size_raw);
+
+  MEM_freeN(chunk_sizes);
+  return is_valid && !BLI_mmap_any_io_error(mmap_file);
 }
 
-static void seq_disk_cache_read_header(FILE *file, DiskCacheHeader *header)
+static void seq_disk_cache_header_endian_switch(DiskCacheHeader *header)
 {
-  fseek(file, 0, 0);
-  fread(header, sizeof(*header), 1, file);
-
   for (int i = 0; i < DCACHE_IMAGES_PER_FILE; i++) {
     if ((ENDIAN_ORDER == B_ENDIAN) && header->entry[i].encoding == 0) {
       BLI_endian_switch_uint64(&header->entry[i].frameno);
@@ -523,13 +604,23 @@ static void seq_disk_cache_read_header(FILE *file, DiskCacheHeader *header)
   }
 }
 
+static void seq_disk_cache_read_header(FILE *file, DiskCacheHeader *header)
+{
+  fseek(file, 0, 0);
+  fread(header, sizeof(*header), 1, file);
+  seq_disk_cache_header_endian_switch(header);
+}
+
 static size_t seq_disk_cache_write_header(FILE *file, DiskCacheHeader *header)
 {
   fseek(file, 0, 0);
   return fwrite(header, sizeof(*header), 1, file);
 }
 
-static int seq_disk_cache_add_header_entry(SeqCacheKey *key, ImBuf *ibuf, DiskCacheHeader *header)
+static int seq_disk_cache_add_header_entry(SeqCacheKey *key,
+                                           ImBuf *ibuf,
+                                           int codec,
+                                           DiskCacheHeader *header)
 {
   int i;
   uint64_t offset = sizeof(*header);
@@ -561,6 +652,7 @@ static int seq_disk_cache_add_header_entry(SeqCacheKey *key, ImBuf *ibuf, DiskCa
     header->entry[i].encoding = 0;
   }
 
+  header->entry[i].codec = codec;
   header->entry[i].offset = offset;
   header->entry[i].frameno = key->frame_index;
 
@@ -610,9 +702,11 @@ static bool seq_disk_cache_write_file(SeqDiskCache *disk_cache, SeqCacheKey *key
   DiskCacheHeader header;
   memset(&header, 0, sizeof(header));
   seq_disk_cache_read_header(file, &header);
-  int entry_index = seq_disk_cache_add_header_entry(key, ibuf, &header);
-  size_t bytes_written = deflate_imbuf_to_file(
-      ibuf, file, seq_disk_cache_compression_level(), &header.entry[entry_index]);
+  int level;
+  int codec = seq_disk_cache_codec_get(&level);
+  int entry_index = seq_disk_cache_add_header_entry(key, ibuf, codec, &header);
+  size_t bytes_written = seq_disk_cache_write_imbuf(
+      ibuf, file, level, &header.entry[entry_index]);
 
   if (bytes_written != 0) {
     /* Last step is writing header, as image data can be overwritten,
@@ -637,51 +731,59 @@ static ImBuf *seq_disk_cache_read_file(SeqDiskCache *disk_cache, SeqCacheKey *ke
   seq_disk_cache_get_file_path(disk_cache, key, path, sizeof(path));
   BLI_make_existing_file(path);
 
-  FILE *file = BLI_fopen(path, "rb");
-  if (!file) {
+  const int file = BLI_open(path, O_BINARY | O_RDONLY, 0);
+  if (file == -1) {
     return NULL;
   }
 
-  seq_disk_cache_read_header(file, &header);
-  int entry_index = seq_disk_cache_get_header_entry(key, &header);
+  BLI_mmap_file *mmap_file = BLI_mmap_open(file);
+  if (mmap_file == NULL) {
+    close(file);
+    return NULL;
+  }
+
+  int entry_index = -1;
+  if (BLI_mmap_read(mmap_file, &header, 0, sizeof(header))) {
+    seq_disk_cache_header_endian_switch(&header);
+    entry_index = seq_disk_cache_get_header_entry(key, &header);
+  }
 
   /* Item not found. */
   if (entry_index < 0) {
-    fclose(file);
+    BLI_mmap_free(mmap_file);
+    close(file);
     return NULL;
   }
 
   ImBuf *ibuf;
   uint64_t size_char = (uint64_t)key->context.rectx * key->context.recty * 4;
   uint64_t size_float = (uint64_t)key->context.rectx * key->context.recty * 16;
-  size_t expected_size;
 
   if (header.entry[entry_index].size_raw == size_char) {
-    expected_size = size_char;
     ibuf = IMB_allocImBuf(key->context.rectx, key->context.recty, 32, IB_rect);
     IMB_colormanagement_assign_rect_colorspace(ibuf, header.entry[entry_index].colorspace_name);
   }
   else if (header.entry[entry_index].size_raw == size_float) {
-    expected_size = size_float;
     ibuf = IMB_allocImBuf(key->context.rectx, key->context.recty, 32, IB_rectfloat);
     IMB_colormanagement_assign_float_colorspace(ibuf, header.entry[entry_index].colorspace_name);
   }
   else {
-    fclose(file);
+    BLI_mmap_free(mmap_file);
+    close(file);
     return NULL;
   }
 
-  size_t bytes_read = inflate_file_to_imbuf(ibuf, file, &header.entry[entry_index]);
+  bool is_valid = seq_disk_cache_read_imbuf(ibuf, mmap_file, &header.entry[entry_index]);
+  BLI_mmap_free(mmap_file);
+  close(file);
 
   /* Sanity check. */
-  if (bytes_read != expected_size) {
-    fclose(file);
+  if (!is_valid) {
     IMB_freeImBuf(ibuf);
     return NULL;
   }
   BLI_file_touch(path);
   seq_disk_cache_update_file(disk_cache, path);
-  fclose(file);
 
   return ibuf;
 }
@@ -809,6 +911,7 @@ static void seq_cache_put(SeqCache *cache, SeqCacheKey *key, ImBuf *ibuf)
   item = BLI_mempool_alloc(cache->items_pool);
   item->cache_owner = cache;
   item->ibuf = ibuf;
+  item->recycle_clock = cache->recycle_clock;
 
   if (BLI_ghash_reinsert(cache->hash, key, item, seq_cache_keyfree, seq_cache_valfree)) {
     IMB_refImBuf(ibuf);
@@ -823,6 +926,7 @@ static ImBuf *seq_cache_get(SeqCache *cache, SeqCacheKey *key)
 
   if (item && item->ibuf) {
     IMB_refImBuf(item->ibuf);
+    item->recycle_clock = cache->recycle_clock;
 
     return item->ibuf;
   }
@@ -830,6 +934,50 @@ static ImBuf *seq_cache_get(SeqCache *cache, SeqCacheKey *key)
   return NULL;
 }
 
+/* Image types that are kept in the cache after the frame is rendered. */
+static int seq_cache_store_flag_get(const Scene *scene, const Sequence *seq)
+{
+  int flag;
+
+  if (seq->cache_flag & SEQ_CACHE_OVERRIDE) {
+    flag = seq->cache_flag;
+    /* Final_out is invalid in context of sequence override. */
+    flag -= seq->cache_flag & SEQ_CACHE_STORE_FINAL_OUT;
+    /* If global setting is enabled however, use it. */
+    flag |= scene->ed->cache_flag & SEQ_CACHE_STORE_FINAL_OUT;
+  }
+  else {
+    flag = scene->ed->cache_flag;
+  }
+
+  return flag;
+}
+
+/* Caller must hold the cache lock. Only lookups of images which are stored are counted. */
+static void seq_cache_strip_stats_add(
+    Scene *scene, SeqCache *cache, Sequence *seq, int type, bool is_hit)
+{
+  if ((seq_cache_store_flag_get(scene, seq) & type) == 0) {
+    return;
+  }
+
+  SeqCacheStripStats *stats = BLI_ghash_lookup(cache->strip_stats, &seq->runtime.session_uuid);
+
+  if (stats == NULL) {
+    SessionUUID *session_uuid = MEM_mallocN(sizeof(*session_uuid), "SeqCacheStripStats key");
+    *session_uuid = seq->runtime.session_uuid;
+    stats = MEM_callocN(sizeof(*stats), "SeqCacheStripStats");
+    BLI_ghash_insert(cache->strip_stats, session_uuid, stats);
+  }
+
+  if (is_hit) {
+    stats->hits++;
+  }
+  else {
+    stats->misses++;
+  }
+}
+
 static void seq_cache_relink_keys(SeqCacheKey *link_next, SeqCacheKey *link_prev)
 {
   if (link_next) {
@@ -840,11 +988,51 @@ static void seq_cache_relink_keys(SeqCacheKey *link_next, SeqCacheKey *link_prev
   }
 }
 
-/* Choose a key out of 2 candidates(leftmost and rightmost items)
- * to recycle based on currently used strategy */
-static SeqCacheKey *seq_cache_choose_key(Scene *scene, SeqCacheKey *lkey, SeqCacheKey *rkey)
+/**
+ * Frames with the lowest score are recycled first, these are cheap to render again for the memory
+ * they use, far from the playhead, or not used for a long time.
+ *
+ * \param recycle_clock: #SeqCache.recycle_clock when the frame was last used.
+ * \param distance: Seconds from the playhead to the frame, negative behind the playhead.
+ */
+float seq_cache_recycle_score(float cost, size_t size, float recycle_clock, float distance)
 {
-  SeqCacheKey *finalkey = NULL;
+  /* Frames behind the playhead are less likely to be played soon. */
+  if (distance < 0.0f) {
+    distance *= -2.0f;
+  }
+
+  const float size_mb = max_ff((float)size / (1024.0f * 1024.0f), 1e-3f);
+  return recycle_clock + cost / (size_mb * (1.0f + distance));
+}
+
+/* Score of the frame of `base` and its linked items, see #seq_cache_recycle_score. */
+static float seq_cache_frame_recycle_score(Scene *scene, SeqCache *cache, SeqCacheKey *base)
+{
+  float cost = 0.0f;
+  float clock = 0.0f;
+  size_t size = 0;
+
+  for (SeqCacheKey *key = base; key; key = key->link_prev) {
+    SeqCacheItem *item = BLI_ghash_lookup(cache->hash, key);
+    if (item == NULL || item->ibuf == NULL) {
+      continue;
+    }
+    /* Cost of the final frame includes its sources. */
+    cost = max_ff(cost, key->cost);
+    clock = max_ff(clock, item->recycle_clock);
+    size += IMB_get_size_in_memory(item->ibuf);
+  }
+
+  const float distance = (base->timeline_frame - scene->r.cfra) / max_ff((float)FPS, 1.0f);
+  return seq_cache_recycle_score(cost, size, clock, distance);
+}
+
+static bool seq_cache_is_recycle_allowed(Scene *scene, SeqCacheKey *key)
+{
+  if (key->cost > scene->ed->recycle_max_cost) {
+    return false;
+  }
 
   /* Ideally, cache would not need to check the state of prefetching task
    * that is tricky to do however, because prefetch would need to know,
@@ -861,47 +1049,12 @@ static SeqCacheKey *seq_cache_choose_key(Scene *scene, SeqCacheKey *lkey, SeqCac
     int pfjob_start, pfjob_end;
     BKE_sequencer_prefetch_get_time_range(scene, &pfjob_start, &pfjob_end);
 
-    if (lkey) {
-      if (lkey->timeline_frame < pfjob_start || lkey->timeline_frame > pfjob_end) {
-        return lkey;
-      }
-    }
-
-    if (rkey) {
-      if (rkey->timeline_frame < pfjob_start || rkey->timeline_frame > pfjob_end) {
-        return rkey;
-      }
+    if (key->timeline_frame >= pfjob_start && key->timeline_frame <= pfjob_end) {
+      return false;
     }
-
-    return NULL;
   }
 
-  if (rkey && lkey) {
-    if (lkey->timeline_frame > rkey->timeline_frame) {
-      SeqCacheKey *swapkey = lkey;
-      lkey = rkey;
-      rkey = swapkey;
-    }
-
-    int l_diff = scene->r.cfra - lkey->timeline_frame;
-    int r_diff = rkey->timeline_frame - scene->r.cfra;
-
-    if (l_diff > r_diff) {
-      finalkey = lkey;
-    }
-    else {
-      finalkey = rkey;
-    }
-  }
-  else {
-    if (lkey) {
-      finalkey = lkey;
-    }
-    else {
-      finalkey = rkey;
-    }
-  }
-  return finalkey;
+  return true;
 }
 
 static void seq_cache_recycle_linked(Scene *scene, SeqCacheKey *base)
@@ -927,20 +1080,14 @@ static void seq_cache_recycle_linked(Scene *scene, SeqCacheKey *base)
   }
 }
 
-static SeqCacheKey *seq_cache_get_item_for_removal(Scene *scene)
+static SeqCacheKey *seq_cache_get_item_for_removal(Scene *scene, float *r_score)
 {
   SeqCache *cache = seq_cache_get_from_scene(scene);
   SeqCacheKey *finalkey = NULL;
-  /* Leftmost key. */
-  SeqCacheKey *lkey = NULL;
-  /* Rightmost key. */
-  SeqCacheKey *rkey = NULL;
   SeqCacheKey *key = NULL;
 
   GHashIterator gh_iter;
   BLI_ghashIterator_init(&gh_iter, cache->hash);
-  int total_count = 0;
-  int cheap_count = 0;
 
   while (!BLI_ghashIterator_done(&gh_iter)) {
     key = BLI_ghashIterator_getKey(&gh_iter);
@@ -952,6 +1099,7 @@ static SeqCacheKey *seq_cache_get_item_for_removal(Scene *scene)
       seq_cache_recycle_linked(scene, key);
       /* Can not continue iterating after linked remove. */
       BLI_ghashIterator_init(&gh_iter, cache->hash);
+      finalkey = NULL;
       continue;
     }
 
@@ -959,31 +1107,17 @@ static SeqCacheKey *seq_cache_get_item_for_removal(Scene *scene)
       continue;
     }
 
-    total_count++;
+    if (!seq_cache_is_recycle_allowed(scene, key)) {
+      continue;
+    }
 
-    if (key->cost <= scene->ed->recycle_max_cost) {
-      cheap_count++;
-      if (lkey) {
-        if (key->timeline_frame < lkey->timeline_frame) {
-          lkey = key;
-        }
-      }
-      else {
-        lkey = key;
-      }
-      if (rkey) {
-        if (key->timeline_frame > rkey->timeline_frame) {
-          rkey = key;
-        }
-      }
-      else {
-        rkey = key;
-      }
+    const float score = seq_cache_frame_recycle_score(scene, cache, key);
+    if (finalkey == NULL || score < *r_score) {
+      finalkey = key;
+      *r_score = score;
     }
   }
 
-  finalkey = seq_cache_choose_key(scene, lkey, rkey);
-
   return finalkey;
 }
 
@@ -1001,10 +1135,12 @@ bool BKE_sequencer_cache_recycle_item(Scene *scene)
   seq_cache_lock(scene);
 
   while (cache->memory_used > memory_total) {
-    SeqCacheKey *finalkey = seq_cache_get_item_for_removal(scene);
+    float score;
+    SeqCacheKey *finalkey = seq_cache_get_item_for_removal(scene, &score);
 
     if (finalkey) {
       seq_cache_recycle_linked(scene, finalkey);
+      cache->recycle_clock = max_ff(cache->recycle_clock, score);
     }
     else {
       seq_cache_unlock(scene);
@@ -1069,6 +1205,8 @@ static void seq_cache_create(Main *bmain, Scene *scene)
     cache->keys_pool = BLI_mempool_create(sizeof(SeqCacheKey), 0, 64, BLI_MEMPOOL_NOP);
     cache->items_pool = BLI_mempool_create(sizeof(SeqCacheItem), 0, 64, BLI_MEMPOOL_NOP);
     cache->hash = BLI_ghash_new(seq_cache_hashhash, seq_cache_hashcmp, "SeqCache hash");
+    cache->strip_stats = BLI_ghash_new(
+        BLI_session_uuid_ghash_hash, BLI_session_uuid_ghash_compare, "SeqCache strip stats");
     cache->last_key = NULL;
     cache->bmain = bmain;
     BLI_mutex_init(&cache->iterator_mutex);
@@ -1119,6 +1257,7 @@ void BKE_sequencer_cache_destruct(Scene *scene)
   }
 
   BLI_ghash_free(cache->hash, seq_cache_keyfree, seq_cache_valfree);
+  BLI_ghash_free(cache->strip_stats, MEM_freeN, MEM_freeN);
   BLI_mempool_destroy(cache->keys_pool);
   BLI_mempool_destroy(cache->items_pool);
   BLI_mutex_end(&cache->iterator_mutex);
@@ -1158,7 +1297,9 @@ void BKE_sequencer_cache_cleanup(Scene *scene)
     BLI_ghashIterator_step(&gh_iter);
     BLI_ghash_remove(cache->hash, key, seq_cache_keyfree, seq_cache_valfree);
   }
+  BLI_ghash_clear(cache->strip_stats, MEM_freeN, MEM_freeN);
   cache->last_key = NULL;
+  cache->recycle_clock = 0.0f;
   seq_cache_unlock(scene);
 }
 
@@ -1222,6 +1363,11 @@ void BKE_sequencer_cache_cleanup_sequence(Scene *scene,
       BLI_ghash_remove(cache->hash, key, seq_cache_keyfree, seq_cache_valfree);
     }
   }
+
+  /* Images of the strip changed, or it is removed. */
+  if (invalidate_source) {
+    BLI_ghash_remove(cache->strip_stats, &seq->runtime.session_uuid, MEM_freeN, MEM_freeN);
+  }
   cache->last_key = NULL;
   seq_cache_unlock(scene);
 }
@@ -1266,6 +1412,10 @@ struct ImBuf *BKE_sequencer_cache_get(const SeqRenderData *context,
     key.type = type;
 
     ibuf = seq_cache_get(cache, &key);
+
+    if (ibuf) {
+      seq_cache_strip_stats_add(scene, cache, seq, type, true);
+    }
   }
   seq_cache_unlock(scene);
 
@@ -1292,9 +1442,84 @@ struct ImBuf *BKE_sequencer_cache_get(const SeqRenderData *context,
     }
   }
 
+  seq_cache_lock(scene);
+  seq_cache_strip_stats_add(scene, cache, seq, type, ibuf != NULL);
+  seq_cache_unlock(scene);
+
   return ibuf;
 }
 
+/* Hits and misses of stored images of the strip since its images were last invalidated, in memory
+ * or on disk. Final frames are counted for the topmost strip of the frame. */
+void BKE_sequencer_cache_strip_stats_get(Scene *scene, Sequence *seq, int *r_hits, int *r_misses)
+{
+  SeqCache *cache = seq_cache_get_from_scene(scene);
+  *r_hits = 0;
+  *r_misses = 0;
+
+  if (!cache) {
+    return;
+  }
+
+  seq_cache_lock(scene);
+  SeqCacheStripStats *stats = BLI_ghash_lookup(cache->strip_stats, &seq->runtime.session_uuid);
+  if (stats) {
+    *r_hits = stats->hits;
+    *r_misses = stats->misses;
+  }
+  seq_cache_unlock(scene);
+}
+
+/* Lookup which doesn't count as use of the item. */
+static bool seq_cache_has_item(const SeqRenderData *context,
+                               Sequence *seq,
+                               float timeline_frame,
+                               int type)
+{
+  Scene *scene = context->scene;
+  SeqCache *cache = seq_cache_get_from_scene(scene);
+
+  if (!cache) {
+    return false;
+  }
+
+  SeqCacheKey key;
+  key.seq = seq;
+  key.context = *context;
+  key.frame_index = seq_cache_timeline_frame_to_frame_index(seq, timeline_frame, type);
+  key.type = type;
+
+  seq_cache_lock(scene);
+  bool has_item = BLI_ghash_haskey(cache->hash, &key);
+  seq_cache_unlock(scene);
+
+  return has_item;
+}
+
+/**
+ * Whether images of given type are kept in the cache after the frame is rendered. Images that are
+ * not kept are only used while rendering the frame, so they don't have to exist as a whole.
+ */
+bool BKE_sequencer_cache_is_type_stored(const SeqRenderData *context, Sequence *seq, int type)
+{
+  if (context->skip_cache || context->is_proxy_render || !seq) {
+    return false;
+  }
+
+  Scene *scene = context->scene;
+
+  if (context->is_prefetch_render) {
+    context = BKE_sequencer_prefetch_get_original_context(context);
+    scene = context->scene;
+    seq = BKE_sequencer_prefetch_get_original_sequence(seq, scene);
+    if (!seq) {
+      return false;
+    }
+  }
+
+  return (seq_cache_store_flag_get(scene, seq) & type) != 0;
+}
+
 bool BKE_sequencer_cache_put_if_possible(const SeqRenderData *context,
                                          Sequence *seq,
                                          float timeline_frame,
@@ -1347,9 +1572,7 @@ void BKE_sequencer_cache_put(const SeqRenderData *context,
   }
 
   /* Prevent reinserting, it breaks cache key linking. */
-  ImBuf *test = BKE_sequencer_cache_get(context, seq, timeline_frame, type, true);
-  if (test) {
-    IMB_freeImBuf(test);
+  if (seq_cache_has_item(context, seq, timeline_frame, type)) {
     return;
   }
 
@@ -1360,18 +1583,7 @@ void BKE_sequencer_cache_put(const SeqRenderData *context,
   seq_cache_lock(scene);
 
   SeqCache *cache = seq_cache_get_from_scene(scene);
-  int flag;
-
-  if (seq->cache_flag & SEQ_CACHE_OVERRIDE) {
-    flag = seq->cache_flag;
-    /* Final_out is invalid in context of sequence override. */
-    flag -= seq->cache_flag & SEQ_CACHE_STORE_FINAL_OUT;
-    /* If global setting is enabled however, use it. */
-    flag |= scene->ed->cache_flag & SEQ_CACHE_STORE_FINAL_OUT;
-  }
-  else {
-    flag = scene->ed->cache_flag;
-  }
+  const int flag = seq_cache_store_flag_get(scene, seq);
 
   if (cost > SEQ_CACHE_COST_MAX) {
     cost = SEQ_CACHE_COST_MAX;
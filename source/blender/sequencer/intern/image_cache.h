@@ -33,10 +33,6 @@ struct Scene;
 struct Sequence;
 struct SeqRenderData;
 
-#ifdef __cplusplus
-}
-#endif
-
 struct ImBuf *BKE_sequencer_cache_get(const struct SeqRenderData *context,
                                       struct Sequence *seq,
                                       float timeline_frame,
@@ -56,6 +52,9 @@ bool BKE_sequencer_cache_put_if_possible(const struct SeqRenderData *context,
                                          struct ImBuf *nval,
                                          float cost,
                                          bool skip_disk_cache);
+bool BKE_sequencer_cache_is_type_stored(const struct SeqRenderData *context,
+                                        struct Sequence *seq,
+                                        int type);
 bool BKE_sequencer_cache_recycle_item(struct Scene *scene);
 void BKE_sequencer_cache_free_temp_cache(struct Scene *scene, short id, int timeline_frame);
 void BKE_sequencer_cache_destruct(struct Scene *scene);
@@ -66,6 +65,7 @@ void BKE_sequencer_cache_cleanup_sequence(struct Scene *scene,
                                           int invalidate_types,
                                           bool force_seq_changed_range);
 bool BKE_sequencer_cache_is_full(struct Scene *scene);
+float seq_cache_recycle_score(float cost, size_t size, float recycle_clock, float distance);
 
 #ifdef __cplusplus
 }
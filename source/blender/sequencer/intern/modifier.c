@@ -48,6 +48,7 @@
 
 #include "BLO_read_write.h"
 
+#include "modifier.h"
 #include "render.h"
 
 static SequenceModifierTypeInfo *modifiersTypes[NUM_SEQUENCE_MODIFIER_TYPES];
@@ -209,6 +210,23 @@ static void modifier_apply_threaded(ImBuf *ibuf,
       ibuf->y, sizeof(ModifierThread), &init_data, modifier_init_handle, modifier_do_thread);
 }
 
+static ImBuf *modifier_stack_mask_get(const SeqRenderData *context,
+                                      Sequence *seq,
+                                      SequenceModifierData *smd,
+                                      int timeline_frame,
+                                      bool make_float)
+{
+  int frame_offset;
+  if (smd->mask_time == SEQUENCE_MASK_TIME_RELATIVE) {
+    frame_offset = seq->start;
+  }
+  else /*if (smd->mask_time == SEQUENCE_MASK_TIME_ABSOLUTE)*/ {
+    frame_offset = smd->mask_id ? ((Mask *)smd->mask_id)->sfra : 0;
+  }
+
+  return modifier_mask_get(smd, context, timeline_frame, frame_offset, make_float);
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -551,6 +569,30 @@ static void colorBalance_apply(SequenceModifierData *smd, ImBuf *ibuf, ImBuf *ma
   modifier_color_balance_apply(&cbmd->color_balance, ibuf, cbmd->color_multiply, false, mask);
 }
 
+typedef struct ColorBalanceTileData {
+  StripColorBalance *cb;
+  float mul;
+} ColorBalanceTileData;
+
+/* Same as #color_balance_do_thread without conversion to float, for lines of the image. */
+static void colorBalance_apply_threaded(int width,
+                                        int height,
+                                        unsigned char *rect,
+                                        float *rect_float,
+                                        unsigned char *mask_rect,
+                                        const float *mask_rect_float,
+                                        void *data_v)
+{
+  ColorBalanceTileData *data = (ColorBalanceTileData *)data_v;
+
+  if (rect_float) {
+    color_balance_float_float(data->cb, rect_float, mask_rect_float, width, height, data->mul);
+  }
+  else {
+    color_balance_byte_byte(data->cb, rect, mask_rect, width, height, data->mul);
+  }
+}
+
 static SequenceModifierTypeInfo seqModifier_ColorBalance = {
     CTX_N_(BLT_I18NCONTEXT_ID_SEQUENCE, "Color Balance"), /* name */
     "ColorBalanceModifierData",                           /* struct_name */
@@ -748,10 +790,9 @@ static void curves_apply_threaded(int width,
   }
 }
 
-static void curves_apply(struct SequenceModifierData *smd, ImBuf *ibuf, ImBuf *mask)
+/* The curve mapping is prepared for #curves_apply_threaded until #curves_apply_end. */
+static void curves_apply_begin(CurvesModifierData *cmd)
 {
-  CurvesModifierData *cmd = (CurvesModifierData *)smd;
-
   const float black[3] = {0.0f, 0.0f, 0.0f};
   const float white[3] = {1.0f, 1.0f, 1.0f};
 
@@ -759,10 +800,22 @@ static void curves_apply(struct SequenceModifierData *smd, ImBuf *ibuf, ImBuf *m
 
   BKE_curvemapping_premultiply(&cmd->curve_mapping, 0);
   BKE_curvemapping_set_black_white(&cmd->curve_mapping, black, white);
+}
+
+static void curves_apply_end(CurvesModifierData *cmd)
+{
+  BKE_curvemapping_premultiply(&cmd->curve_mapping, 1);
+}
+
+static void curves_apply(struct SequenceModifierData *smd, ImBuf *ibuf, ImBuf *mask)
+{
+  CurvesModifierData *cmd = (CurvesModifierData *)smd;
+
+  curves_apply_begin(cmd);
 
   modifier_apply_threaded(ibuf, mask, curves_apply_threaded, &cmd->curve_mapping);
 
-  BKE_curvemapping_premultiply(&cmd->curve_mapping, 1);
+  curves_apply_end(cmd);
 }
 
 static SequenceModifierTypeInfo seqModifier_Curves = {
@@ -1297,6 +1350,177 @@ static SequenceModifierTypeInfo seqModifier_Tonemap = {
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Tiled Modifier Stack
+ *
+ * Applies the modifiers of a strip to lines of the image, for the tiled compositing of the
+ * strip stack. Only modifiers that change each pixel independently of the others are supported.
+ * \{ */
+
+typedef struct ModifierTileStep {
+  modifier_apply_threaded_cb apply_callback;
+  void *user_data;
+  ImBuf *mask;
+
+  union {
+    ColorBalanceTileData color_balance;
+    WhiteBalanceThreadData white_balance;
+    BrightContrastThreadData bright_contrast;
+  } data;
+} ModifierTileStep;
+
+struct SeqModifierTiles {
+  Sequence *seq;
+  ModifierTileStep *steps;
+  int steps_len;
+};
+
+static bool modifier_is_applied(const SequenceModifierData *smd)
+{
+  return BKE_sequence_modifier_type_info_get(smd->type) != NULL &&
+         (smd->flag & SEQUENCE_MODIFIER_MUTE) == 0;
+}
+
+bool seq_modifier_stack_supports_tiles(Sequence *seq)
+{
+  if (seq->modifiers.first && (seq->flag & SEQ_USE_LINEAR_MODIFIERS)) {
+    return false;
+  }
+
+  LISTBASE_FOREACH (SequenceModifierData *, smd, &seq->modifiers) {
+    /* Tone-mapping uses the average luminance of the whole image. */
+    if (modifier_is_applied(smd) && smd->type == seqModifierType_Tonemap) {
+      return false;
+    }
+  }
+  return true;
+}
+
+SeqModifierTiles *seq_modifier_stack_tiles_begin(const SeqRenderData *context,
+                                                 Sequence *seq,
+                                                 int timeline_frame,
+                                                 bool make_float)
+{
+  BLI_assert(seq_modifier_stack_supports_tiles(seq));
+
+  SeqModifierTiles *tiles = MEM_callocN(sizeof(*tiles), __func__);
+  tiles->seq = seq;
+  tiles->steps = MEM_calloc_arrayN(
+      BLI_listbase_count(&seq->modifiers), sizeof(*tiles->steps), __func__);
+
+  LISTBASE_FOREACH (SequenceModifierData *, smd, &seq->modifiers) {
+    if (!modifier_is_applied(smd)) {
+      continue;
+    }
+
+    ModifierTileStep *step = &tiles->steps[tiles->steps_len++];
+
+    switch (smd->type) {
+      case seqModifierType_ColorBalance: {
+        ColorBalanceModifierData *cbmd = (ColorBalanceModifierData *)smd;
+        step->data.color_balance.cb = &cbmd->color_balance;
+        step->data.color_balance.mul = cbmd->color_multiply;
+        step->apply_callback = colorBalance_apply_threaded;
+        step->user_data = &step->data.color_balance;
+        break;
+      }
+      case seqModifierType_WhiteBalance: {
+        WhiteBalanceModifierData *wbmd = (WhiteBalanceModifierData *)smd;
+        copy_v3_v3(step->data.white_balance.white, wbmd->white_value);
+        step->apply_callback = whiteBalance_apply_threaded;
+        step->user_data = &step->data.white_balance;
+        break;
+      }
+      case seqModifierType_Curves: {
+        CurvesModifierData *cmd = (CurvesModifierData *)smd;
+        curves_apply_begin(cmd);
+        step->apply_callback = curves_apply_threaded;
+        step->user_data = &cmd->curve_mapping;
+        break;
+      }
+      case seqModifierType_HueCorrect: {
+        HueCorrectModifierData *hcmd = (HueCorrectModifierData *)smd;
+        BKE_curvemapping_init(&hcmd->curve_mapping);
+        step->apply_callback = hue_correct_apply_threaded;
+        step->user_data = &hcmd->curve_mapping;
+        break;
+      }
+      case seqModifierType_BrightContrast: {
+        BrightContrastModifierData *bcmd = (BrightContrastModifierData *)smd;
+        step->data.bright_contrast.bright = bcmd->bright;
+        step->data.bright_contrast.contrast = bcmd->contrast;
+        step->apply_callback = brightcontrast_apply_threaded;
+        step->user_data = &step->data.bright_contrast;
+        break;
+      }
+      case seqModifierType_Mask:
+        step->apply_callback = maskmodifier_apply_threaded;
+        break;
+      default:
+        BLI_assert(!"Modifier type doesn't support tiles");
+        break;
+    }
+
+    step->mask = modifier_stack_mask_get(context, seq, smd, timeline_frame, make_float);
+  }
+
+  return tiles;
+}
+
+void seq_modifier_stack_tiles_apply(const SeqModifierTiles *tiles, ImBuf *ibuf, int start_line)
+{
+  const size_t offset = (size_t)4 * start_line * ibuf->x;
+
+  for (int i = 0; i < tiles->steps_len; i++) {
+    const ModifierTileStep *step = &tiles->steps[i];
+    unsigned char *mask_rect = NULL;
+    float *mask_rect_float = NULL;
+
+    if (step->apply_callback == NULL) {
+      continue;
+    }
+    if (step->mask) {
+      if (step->mask->rect) {
+        mask_rect = (unsigned char *)step->mask->rect + offset;
+      }
+      if (step->mask->rect_float) {
+        mask_rect_float = step->mask->rect_float + offset;
+      }
+    }
+
+    step->apply_callback(ibuf->x,
+                         ibuf->y,
+                         (unsigned char *)ibuf->rect,
+                         ibuf->rect_float,
+                         mask_rect,
+                         mask_rect_float,
+                         step->user_data);
+  }
+}
+
+void seq_modifier_stack_tiles_end(SeqModifierTiles *tiles)
+{
+  int i = 0;
+
+  LISTBASE_FOREACH (SequenceModifierData *, smd, &tiles->seq->modifiers) {
+    if (!modifier_is_applied(smd)) {
+      continue;
+    }
+    if (smd->type == seqModifierType_Curves) {
+      curves_apply_end((CurvesModifierData *)smd);
+    }
+    if (tiles->steps[i].mask) {
+      IMB_freeImBuf(tiles->steps[i].mask);
+    }
+    i++;
+  }
+
+  MEM_freeN(tiles->steps);
+  MEM_freeN(tiles);
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Public Modifier Functions
  * \{ */
@@ -1433,16 +1657,8 @@ ImBuf *BKE_sequence_modifier_apply_stack(const SeqRenderData *context,
     }
 
     if (smti->apply) {
-      int frame_offset;
-      if (smd->mask_time == SEQUENCE_MASK_TIME_RELATIVE) {
-        frame_offset = seq->start;
-      }
-      else /*if (smd->mask_time == SEQUENCE_MASK_TIME_ABSOLUTE)*/ {
-        frame_offset = smd->mask_id ? ((Mask *)smd->mask_id)->sfra : 0;
-      }
-
-      ImBuf *mask = modifier_mask_get(
-          smd, context, timeline_frame, frame_offset, ibuf->rect_float != NULL);
+      ImBuf *mask = modifier_stack_mask_get(
+          context, seq, smd, timeline_frame, ibuf->rect_float != NULL);
 
       if (processed_ibuf == ibuf) {
         processed_ibuf = IMB_dupImBuf(ibuf);
@@ -0,0 +1,53 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2004 Blender Foundation.
+ * All rights reserved.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup sequencer
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct ImBuf;
+struct SeqRenderData;
+struct Sequence;
+
+typedef struct SeqModifierTiles SeqModifierTiles;
+
+bool seq_modifier_stack_supports_tiles(struct Sequence *seq);
+/**
+ * Prepare the modifiers of \a seq to be applied to lines of its image, masks are rendered here.
+ * Modifier data must not change until #seq_modifier_stack_tiles_end.
+ */
+SeqModifierTiles *seq_modifier_stack_tiles_begin(const struct SeqRenderData *context,
+                                                 struct Sequence *seq,
+                                                 int timeline_frame,
+                                                 bool make_float);
+/** \a ibuf holds the lines of the image starting at \a start_line. */
+void seq_modifier_stack_tiles_apply(const SeqModifierTiles *tiles,
+                                    struct ImBuf *ibuf,
+                                    int start_line);
+void seq_modifier_stack_tiles_end(SeqModifierTiles *tiles);
+
+#ifdef __cplusplus
+}
+#endif
@@ -31,11 +31,16 @@
 #include "DNA_scene_types.h"
 #include "DNA_screen_types.h"
 #include "DNA_sequence_types.h"
+#include "DNA_userdef_types.h"
 #include "DNA_windowmanager_types.h"
 
 #include "BLI_listbase.h"
+#include "BLI_math_base.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 
+#include "PIL_time.h"
+
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
 
@@ -59,6 +64,20 @@
 #include "prefetch.h"
 #include "render.h"
 
+/* Renders a frame in parallel with other workers, with its own depsgraph and evaluated scene.
+ * Workers don't use the cache, rendered frames are stored by the prefetch thread. */
+typedef struct PrefetchWorker {
+  struct Main *bmain_eval;
+  struct Scene *scene_eval;
+  struct Depsgraph *depsgraph;
+  struct SeqRenderData context;
+
+  /* frame of the current batch */
+  float timeline_frame;
+  struct ImBuf *ibuf;
+  float cost;
+} PrefetchWorker;
+
 typedef struct PrefetchJob {
   struct PrefetchJob *next, *prev;
 
@@ -79,10 +98,20 @@ typedef struct PrefetchJob {
   struct ListBase *seqbasep;
   struct ListBase *seqbasep_cpy;
 
+  /* workers, only used when rendering more than one frame at a time */
+  PrefetchWorker *workers;
+  int num_workers;
+  /* workers are (re)built by the prefetch thread, not when prefetching is started */
+  bool workers_need_update;
+
   /* prefetch area */
   float cfra;
   int num_frames_prefetched;
 
+  /* throughput since prefetching was started */
+  int num_frames_rendered;
+  double render_time;
+
   /* control */
   bool running;
   bool waiting;
@@ -234,6 +263,85 @@ static void seq_prefetch_init_depsgraph(PrefetchJob *pfjob)
   pfjob->scene_eval->ed->cache_flag = 0;
 }
 
+/* Workers render without the cache, so images of strips can only be cached when rendering frames
+ * one at a time. */
+static bool seq_prefetch_cache_flag_stores_strips(int cache_flag)
+{
+  return (cache_flag & (SEQ_CACHE_STORE_RAW | SEQ_CACHE_STORE_PREPROCESSED |
+                        SEQ_CACHE_STORE_COMPOSITE)) != 0;
+}
+
+static int seq_prefetch_workers_num(Scene *scene)
+{
+  if (seq_prefetch_cache_flag_stores_strips(scene->ed->cache_flag)) {
+    return 0;
+  }
+
+  const int num_workers = min_ii(U.sequencer_prefetch_threads, BLI_system_thread_count());
+  return (num_workers > 1) ? num_workers : 0;
+}
+
+static void seq_prefetch_free_workers(PrefetchJob *pfjob)
+{
+  for (int i = 0; i < pfjob->num_workers; i++) {
+    PrefetchWorker *worker = &pfjob->workers[i];
+    DEG_graph_free(worker->depsgraph);
+    BKE_main_free(worker->bmain_eval);
+  }
+  MEM_SAFE_FREE(pfjob->workers);
+  pfjob->num_workers = 0;
+}
+
+/* Called from the prefetch thread, building a depsgraph for every worker takes a while. */
+static void seq_prefetch_init_workers(PrefetchJob *pfjob)
+{
+  Scene *scene = pfjob->scene;
+  ViewLayer *view_layer = BKE_view_layer_default_render(scene);
+  const SeqRenderData *context = &pfjob->context;
+
+  pfjob->num_workers = seq_prefetch_workers_num(scene);
+  if (pfjob->num_workers == 0) {
+    return;
+  }
+
+  pfjob->workers = MEM_callocN(sizeof(PrefetchWorker) * pfjob->num_workers, "PrefetchWorker");
+
+  for (int i = 0; i < pfjob->num_workers; i++) {
+    PrefetchWorker *worker = &pfjob->workers[i];
+    worker->bmain_eval = BKE_main_new();
+    worker->depsgraph = DEG_graph_new(worker->bmain_eval, scene, view_layer, DAG_EVAL_RENDER);
+    DEG_debug_name_set(worker->depsgraph, "SEQUENCER PREFETCH WORKER");
+
+    DEG_graph_build_for_render_pipeline(worker->depsgraph);
+    DEG_evaluate_on_framechange(worker->depsgraph, seq_prefetch_cfra(pfjob));
+
+    worker->scene_eval = DEG_get_evaluated_scene(worker->depsgraph);
+    worker->scene_eval->ed->cache_flag = 0;
+
+    SEQ_render_new_render_data(worker->bmain_eval,
+                               worker->depsgraph,
+                               worker->scene_eval,
+                               context->rectx,
+                               context->recty,
+                               context->preview_render_size,
+                               false,
+                               &worker->context);
+    worker->context.skip_cache = true;
+    worker->context.task_id = SEQ_TASK_PREFETCH_RENDER;
+  }
+}
+
+static void seq_prefetch_update_workers(PrefetchJob *pfjob)
+{
+  if (!pfjob->workers_need_update) {
+    return;
+  }
+
+  seq_prefetch_free_workers(pfjob);
+  seq_prefetch_init_workers(pfjob);
+  pfjob->workers_need_update = false;
+}
+
 static void seq_prefetch_update_area(PrefetchJob *pfjob)
 {
   int cfra = pfjob->scene->r.cfra;
@@ -314,6 +422,9 @@ static void seq_prefetch_update_context(const SeqRenderData *context)
    * This is to allow "temp cache" work correctly for both threads.
    */
   pfjob->context.task_id = SEQ_TASK_PREFETCH_RENDER;
+
+  /* Workers use the scene and the render size of the context. */
+  pfjob->workers_need_update = true;
 }
 
 static void seq_prefetch_update_scene(Scene *scene)
@@ -352,6 +463,7 @@ void BKE_sequencer_prefetch_free(Scene *scene)
   BLI_mutex_end(&pfjob->prefetch_suspend_mutex);
   BLI_condition_end(&pfjob->prefetch_suspend_cond);
   seq_prefetch_free_depsgraph(pfjob);
+  seq_prefetch_free_workers(pfjob);
   BKE_main_free(pfjob->bmain_eval);
   MEM_freeN(pfjob);
   scene->ed->prefetch_job = NULL;
@@ -417,6 +529,147 @@ static bool seq_prefetch_do_skip_frame(Scene *scene)
   return false;
 }
 
+/* Strips which can't be rendered by workers: text strips use the global font, scene strips
+ * are handled by #seq_prefetch_do_skip_frame and strips overriding the cache settings may store
+ * their images. */
+static bool seq_prefetch_seqbase_is_thread_safe(ListBase *seqbase, float timeline_frame)
+{
+  LISTBASE_FOREACH (Sequence *, seq, seqbase) {
+    if ((seq->flag & SEQ_MUTE) || timeline_frame < seq->startdisp ||
+        timeline_frame >= seq->enddisp) {
+      continue;
+    }
+
+    if ((seq->cache_flag & SEQ_CACHE_OVERRIDE) &&
+        seq_prefetch_cache_flag_stores_strips(seq->cache_flag)) {
+      return false;
+    }
+
+    switch (seq->type) {
+      case SEQ_TYPE_TEXT:
+      case SEQ_TYPE_SCENE:
+      case SEQ_TYPE_MOVIECLIP:
+        return false;
+      case SEQ_TYPE_META:
+        if (!seq_prefetch_seqbase_is_thread_safe(&seq->seqbase, timeline_frame)) {
+          return false;
+        }
+        break;
+    }
+  }
+
+  return true;
+}
+
+/* Whether the final image of the frame is in the cache already, it isn't rendered again. */
+static bool seq_prefetch_frame_is_cached(PrefetchJob *pfjob, float timeline_frame)
+{
+  Sequence *seq_arr[MAXSEQ + 1];
+  int count = seq_get_shown_sequences(pfjob->scene->ed->seqbasep, timeline_frame, 0, seq_arr);
+
+  if (count == 0) {
+    return false;
+  }
+
+  ImBuf *ibuf = BKE_sequencer_cache_get(
+      &pfjob->context, seq_arr[count - 1], timeline_frame, SEQ_CACHE_STORE_FINAL_OUT, false);
+  if (ibuf == NULL) {
+    return false;
+  }
+
+  IMB_freeImBuf(ibuf);
+  return true;
+}
+
+/* Number of frames from the current prefetch frame which can be rendered by workers. Cached
+ * frames are part of the batch, but don't take a worker. The other frames are assigned to the
+ * first \a r_num_workers_used workers. */
+static int seq_prefetch_batch_frames_num(PrefetchJob *pfjob, int *r_num_workers_used)
+{
+  Scene *scene = pfjob->scene;
+  int num_frames = 0;
+  int num_workers_used = 0;
+
+  while (num_workers_used < pfjob->num_workers) {
+    float timeline_frame = seq_prefetch_cfra(pfjob) + num_frames;
+
+    if (timeline_frame > scene->r.efra ||
+        !seq_prefetch_seqbase_is_thread_safe(scene->ed->seqbasep, timeline_frame)) {
+      break;
+    }
+    if (!seq_prefetch_frame_is_cached(pfjob, timeline_frame)) {
+      pfjob->workers[num_workers_used++].timeline_frame = timeline_frame;
+    }
+    num_frames++;
+  }
+
+  *r_num_workers_used = num_workers_used;
+  return num_frames;
+}
+
+static void seq_prefetch_worker_render_task(TaskPool *__restrict pool, void *taskdata)
+{
+  PrefetchJob *pfjob = BLI_task_pool_user_data(pool);
+  PrefetchWorker *worker = (PrefetchWorker *)taskdata;
+  Scene *scene_eval = worker->scene_eval;
+
+  if (pfjob->stop) {
+    return;
+  }
+
+  const double start = PIL_check_seconds_timer();
+
+  DEG_evaluate_on_framechange(worker->depsgraph, worker->timeline_frame);
+  AnimData *adt = BKE_animdata_from_id(&scene_eval->id);
+  AnimationEvalContext anim_eval_context = BKE_animsys_eval_context_construct(
+      worker->depsgraph, worker->timeline_frame);
+  BKE_animsys_evaluate_animdata(&scene_eval->id, adt, &anim_eval_context, ADT_RECALC_ALL, false);
+
+  worker->ibuf = seq_render_give_ibuf_seqbase(
+      &worker->context, worker->timeline_frame, 0, scene_eval->ed->seqbasep);
+  worker->cost = (float)((PIL_check_seconds_timer() - start) * scene_eval->r.frs_sec);
+}
+
+/* Render the frames assigned to workers in parallel, then store them in the cache in order, the
+ * same as if they were rendered one by one. */
+static void seq_prefetch_render_batch(PrefetchJob *pfjob, int num_workers_used)
+{
+  TaskPool *task_pool = BLI_task_pool_create(pfjob, TASK_PRIORITY_LOW);
+
+  for (int i = 0; i < num_workers_used; i++) {
+    PrefetchWorker *worker = &pfjob->workers[i];
+    worker->ibuf = NULL;
+    BLI_task_pool_push(task_pool, seq_prefetch_worker_render_task, worker, false, NULL);
+  }
+
+  BLI_task_pool_work_and_wait(task_pool);
+  BLI_task_pool_free(task_pool);
+
+  for (int i = 0; i < num_workers_used; i++) {
+    PrefetchWorker *worker = &pfjob->workers[i];
+
+    /* Frames rendered before stopping may be outdated. */
+    if (worker->ibuf != NULL && !pfjob->stop) {
+      seq_render_cache_put_final_out(
+          &pfjob->context, worker->timeline_frame, worker->ibuf, worker->cost);
+    }
+    IMB_freeImBuf(worker->ibuf);
+    worker->ibuf = NULL;
+  }
+}
+
+/* Frames rendered per second since prefetching was started, 0 when nothing was rendered yet. */
+float BKE_sequencer_prefetch_throughput_get(Scene *scene)
+{
+  PrefetchJob *pfjob = seq_prefetch_job_get(scene);
+
+  if (!pfjob || pfjob->render_time <= 0.0) {
+    return 0.0f;
+  }
+
+  return (float)(pfjob->num_frames_rendered / pfjob->render_time);
+}
+
 static bool seq_prefetch_need_suspend(PrefetchJob *pfjob)
 {
   return seq_prefetch_is_cache_full(pfjob->scene) || seq_prefetch_is_scrubbing(pfjob->bmain) ||
@@ -440,32 +693,50 @@ static void *seq_prefetch_frames(void *job)
 {
   PrefetchJob *pfjob = (PrefetchJob *)job;
 
+  seq_prefetch_update_workers(pfjob);
+
   while (seq_prefetch_cfra(pfjob) <= pfjob->scene->r.efra) {
-    pfjob->scene_eval->ed->prefetch_job = NULL;
-
-    seq_prefetch_update_depsgraph(pfjob);
-    AnimData *adt = BKE_animdata_from_id(&pfjob->context_cpy.scene->id);
-    AnimationEvalContext anim_eval_context = seq_prefetch_anim_eval_context(pfjob);
-    BKE_animsys_evaluate_animdata(
-        &pfjob->context_cpy.scene->id, adt, &anim_eval_context, ADT_RECALC_ALL, false);
-
-    /* This is quite hacky solution:
-     * We need cross-reference original scene with copy for cache.
-     * However depsgraph must not have this data, because it will try to kill this job.
-     * Scene copy don't reference original scene. Perhaps, this could be done by depsgraph.
-     * Set to NULL before return!
-     */
-    pfjob->scene_eval->ed->prefetch_job = pfjob;
+    const double start = PIL_check_seconds_timer();
+    int num_workers_used;
+    int num_frames = seq_prefetch_batch_frames_num(pfjob, &num_workers_used);
+    int num_frames_rendered = 1;
+
+    if (num_frames > 1) {
+      seq_prefetch_render_batch(pfjob, num_workers_used);
+      num_frames_rendered = num_workers_used;
+      /* Last frame of the batch is counted below. */
+      pfjob->num_frames_prefetched += num_frames - 1;
+    }
+    else {
+      pfjob->scene_eval->ed->prefetch_job = NULL;
+
+      seq_prefetch_update_depsgraph(pfjob);
+      AnimData *adt = BKE_animdata_from_id(&pfjob->context_cpy.scene->id);
+      AnimationEvalContext anim_eval_context = seq_prefetch_anim_eval_context(pfjob);
+      BKE_animsys_evaluate_animdata(
+          &pfjob->context_cpy.scene->id, adt, &anim_eval_context, ADT_RECALC_ALL, false);
+
+      /* This is quite hacky solution:
+       * We need cross-reference original scene with copy for cache.
+       * However depsgraph must not have this data, because it will try to kill this job.
+       * Scene copy don't reference original scene. Perhaps, this could be done by depsgraph.
+       * Set to NULL before return!
+       */
+      pfjob->scene_eval->ed->prefetch_job = pfjob;
+
+      if (seq_prefetch_do_skip_frame(pfjob->scene)) {
+        pfjob->num_frames_prefetched++;
+        continue;
+      }
 
-    if (seq_prefetch_do_skip_frame(pfjob->scene)) {
-      pfjob->num_frames_prefetched++;
-      continue;
+      ImBuf *ibuf = SEQ_render_give_ibuf(&pfjob->context_cpy, seq_prefetch_cfra(pfjob), 0);
+      BKE_sequencer_cache_free_temp_cache(
+          pfjob->scene, pfjob->context.task_id, seq_prefetch_cfra(pfjob));
+      IMB_freeImBuf(ibuf);
     }
 
-    ImBuf *ibuf = SEQ_render_give_ibuf(&pfjob->context_cpy, seq_prefetch_cfra(pfjob), 0);
-    BKE_sequencer_cache_free_temp_cache(
-        pfjob->scene, pfjob->context.task_id, seq_prefetch_cfra(pfjob));
-    IMB_freeImBuf(ibuf);
+    pfjob->num_frames_rendered += num_frames_rendered;
+    pfjob->render_time += PIL_check_seconds_timer() - start;
 
     /* Suspend thread if there is nothing to be prefetched. */
     seq_prefetch_do_suspend(pfjob);
@@ -514,6 +785,8 @@ static PrefetchJob *seq_prefetch_start(const SeqRenderData *context, float cfra)
 
   pfjob->cfra = cfra;
   pfjob->num_frames_prefetched = 1;
+  pfjob->num_frames_rendered = 0;
+  pfjob->render_time = 0.0;
 
   pfjob->waiting = false;
   pfjob->stop = false;
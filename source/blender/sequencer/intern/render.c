@@ -24,8 +24,6 @@
  * \ingroup bke
  */
 
-#include <time.h>
-
 #include "MEM_guardedalloc.h"
 
 #include "DNA_anim_types.h"
@@ -37,6 +35,7 @@
 #include "BLI_linklist.h"
 #include "BLI_listbase.h"
 #include "BLI_path_util.h"
+#include "BLI_task.h"
 
 #include "BKE_anim_data.h"
 #include "BKE_animsys.h"
@@ -59,6 +58,8 @@
 #include "IMB_imbuf_types.h"
 #include "IMB_metadata.h"
 
+#include "PIL_time.h"
+
 #include "RNA_access.h"
 
 #include "RE_engine.h"
@@ -68,6 +69,7 @@
 
 #include "effects.h"
 #include "image_cache.h"
+#include "modifier.h"
 #include "multiview.h"
 #include "prefetch.h"
 #include "proxy.h"
@@ -397,17 +399,17 @@ int seq_get_shown_sequences(ListBase *seqbasep,
   return cnt;
 }
 
-/* Estimate time spent by the program rendering the strip */
-static clock_t seq_estimate_render_cost_begin(void)
+/* Estimate time spent rendering the strip. Wall clock time is used, processor time would add up
+ * time of all threads, including other frames rendered at the same time. */
+static double seq_estimate_render_cost_begin(void)
 {
-  return clock();
+  return PIL_check_seconds_timer();
 }
 
-static float seq_estimate_render_cost_end(Scene *scene, clock_t begin)
+static float seq_estimate_render_cost_end(Scene *scene, double begin)
 {
-  clock_t end = clock();
-  float time_spent = (float)(end - begin);
-  float time_max = (1.0f / scene->r.frs_sec) * CLOCKS_PER_SEC;
+  float time_spent = (float)(PIL_check_seconds_timer() - begin);
+  float time_max = 1.0f / scene->r.frs_sec;
 
   if (time_max != 0) {
     return time_spent / time_max;
@@ -535,40 +537,76 @@ static void sequencer_image_transform_init(void *handle_v,
   handle->tot_line = tot_line;
 }
 
-static void *sequencer_image_transform_do_thread(void *data_v)
+static void sequencer_image_transform_matrix_get(const ImBuf *ibuf_source,
+                                                const int width,
+                                                const int height,
+                                                const StripTransform *transform,
+                                                const float scale_to_fit,
+                                                const float image_scale_factor,
+                                                float r_transform_matrix[3][3])
 {
-  const ImageTransformThreadData *data = (ImageTransformThreadData *)data_v;
-  const StripTransform *transform = data->transform;
-  const float scale_x = transform->scale_x * data->scale_to_fit;
-  const float scale_y = transform->scale_y * data->scale_to_fit;
-  const float scale_to_fit_offs_x = (data->ibuf_out->x - data->ibuf_source->x) / 2;
-  const float scale_to_fit_offs_y = (data->ibuf_out->y - data->ibuf_source->y) / 2;
-  const float translate_x = transform->xofs * data->image_scale_factor + scale_to_fit_offs_x;
-  const float translate_y = transform->yofs * data->image_scale_factor + scale_to_fit_offs_y;
-  const int width = data->ibuf_out->x;
-  const int height = data->ibuf_out->y;
+  const float scale_x = transform->scale_x * scale_to_fit;
+  const float scale_y = transform->scale_y * scale_to_fit;
+  const float scale_to_fit_offs_x = (width - ibuf_source->x) / 2;
+  const float scale_to_fit_offs_y = (height - ibuf_source->y) / 2;
+  const float translate_x = transform->xofs * image_scale_factor + scale_to_fit_offs_x;
+  const float translate_y = transform->yofs * image_scale_factor + scale_to_fit_offs_y;
   const float pivot[2] = {width / 2 - scale_to_fit_offs_x, height / 2 - scale_to_fit_offs_y};
-  float transform_matrix[3][3];
-  loc_rot_size_to_mat3(transform_matrix,
+  loc_rot_size_to_mat3(r_transform_matrix,
                        (const float[]){translate_x, translate_y},
                        transform->rotation,
                        (const float[]){scale_x, scale_y});
-  invert_m3(transform_matrix);
-  transform_pivot_set_m3(transform_matrix, pivot);
+  invert_m3(r_transform_matrix);
+  transform_pivot_set_m3(r_transform_matrix, pivot);
+}
+
+/**
+ * Sample lines of the transformed image into \a ibuf_out, which must be zeroed.
+ * The first line of \a ibuf_out is line \a out_start_line of the transformed image.
+ */
+static void sequencer_image_transform_lines(ImBuf *ibuf_source,
+                                            ImBuf *ibuf_out,
+                                            const float transform_matrix[3][3],
+                                            const bool for_render,
+                                            const int start_line,
+                                            const int tot_line,
+                                            const int out_start_line)
+{
+  const int width = ibuf_out->x;
 
-  for (int yi = data->start_line; yi < data->start_line + data->tot_line; yi++) {
+  for (int yi = start_line; yi < start_line + tot_line; yi++) {
     for (int xi = 0; xi < width; xi++) {
       float uv[2] = {xi, yi};
       mul_v2_m3v2(uv, transform_matrix, uv);
 
-      if (data->for_render) {
-        bilinear_interpolation(data->ibuf_source, data->ibuf_out, uv[0], uv[1], xi, yi);
+      if (for_render) {
+        bilinear_interpolation(ibuf_source, ibuf_out, uv[0], uv[1], xi, yi - out_start_line);
       }
       else {
-        nearest_interpolation(data->ibuf_source, data->ibuf_out, uv[0], uv[1], xi, yi);
+        nearest_interpolation(ibuf_source, ibuf_out, uv[0], uv[1], xi, yi - out_start_line);
       }
     }
   }
+}
+
+static void *sequencer_image_transform_do_thread(void *data_v)
+{
+  const ImageTransformThreadData *data = (ImageTransformThreadData *)data_v;
+  float transform_matrix[3][3];
+  sequencer_image_transform_matrix_get(data->ibuf_source,
+                                       data->ibuf_out->x,
+                                       data->ibuf_out->y,
+                                       data->transform,
+                                       data->scale_to_fit,
+                                       data->image_scale_factor,
+                                       transform_matrix);
+  sequencer_image_transform_lines(data->ibuf_source,
+                                  data->ibuf_out,
+                                  transform_matrix,
+                                  data->for_render,
+                                  data->start_line,
+                                  data->tot_line,
+                                  0);
 
   return NULL;
 }
@@ -608,6 +646,54 @@ static void multibuf(ImBuf *ibuf, const float fmul)
   }
 }
 
+static void sequencer_image_scale_factors_get(const SeqRenderData *context,
+                                              const ImBuf *ibuf,
+                                              float *r_scale_to_fit_factor,
+                                              float *r_preview_scale_factor)
+{
+  /* Calculate scale factor, so image fits in preview area with original aspect ratio. */
+  *r_scale_to_fit_factor = MIN2((float)context->rectx / (float)ibuf->x,
+                                (float)context->recty / (float)ibuf->y);
+
+  /* Get scale factor if preview resolution doesn't match project resolution. */
+  if (context->preview_render_size == SEQ_RENDER_SIZE_SCENE) {
+    *r_preview_scale_factor = (float)context->scene->r.size / 100;
+  }
+  else {
+    *r_preview_scale_factor = SEQ_rendersize_to_scale_factor(context->preview_render_size);
+  }
+}
+
+/* Clear the cropped borders of the image, \a ibuf is duplicated when it has other users. */
+static ImBuf *sequencer_image_crop(const Sequence *seq,
+                                   ImBuf *ibuf,
+                                   const float scale_to_fit_factor,
+                                   const float preview_scale_factor)
+{
+  ImBuf *cropped_ibuf = IMB_makeSingleUser(ibuf);
+
+  const int width = cropped_ibuf->x;
+  const int height = cropped_ibuf->y;
+  const StripCrop *c = seq->strip->crop;
+
+  const int left = c->left / scale_to_fit_factor * preview_scale_factor;
+  const int right = c->right / scale_to_fit_factor * preview_scale_factor;
+  const int top = c->top / scale_to_fit_factor * preview_scale_factor;
+  const int bottom = c->bottom / scale_to_fit_factor * preview_scale_factor;
+  const float col[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+
+  /* Left. */
+  IMB_rectfill_area_replace(cropped_ibuf, col, 0, 0, left, height);
+  /* Bottom. */
+  IMB_rectfill_area_replace(cropped_ibuf, col, left, 0, width, bottom);
+  /* Right. */
+  IMB_rectfill_area_replace(cropped_ibuf, col, width - right, bottom, width, height);
+  /* Top. */
+  IMB_rectfill_area_replace(cropped_ibuf, col, left, height - top, width - right, height);
+
+  return cropped_ibuf;
+}
+
 static ImBuf *input_preprocess(const SeqRenderData *context,
                                Sequence *seq,
                                float timeline_frame,
@@ -625,42 +711,13 @@ static ImBuf *input_preprocess(const SeqRenderData *context,
     IMB_filtery(preprocessed_ibuf);
   }
 
-  /* Calculate scale factor, so image fits in preview area with original aspect ratio. */
-  const float scale_to_fit_factor = MIN2((float)context->rectx / (float)ibuf->x,
-                                         (float)context->recty / (float)ibuf->y);
-
-  /* Get scale factor if preview resolution doesn't match project resolution. */
-  float preview_scale_factor;
-  if (context->preview_render_size == SEQ_RENDER_SIZE_SCENE) {
-    preview_scale_factor = (float)scene->r.size / 100;
-  }
-  else {
-    preview_scale_factor = SEQ_rendersize_to_scale_factor(context->preview_render_size);
-  }
+  float scale_to_fit_factor, preview_scale_factor;
+  sequencer_image_scale_factors_get(context, ibuf, &scale_to_fit_factor, &preview_scale_factor);
 
   if (sequencer_use_crop(seq)) {
     /* Change original image pointer to avoid another duplication in SEQ_USE_TRANSFORM. */
-    preprocessed_ibuf = IMB_makeSingleUser(ibuf);
+    preprocessed_ibuf = sequencer_image_crop(seq, ibuf, scale_to_fit_factor, preview_scale_factor);
     ibuf = preprocessed_ibuf;
-
-    const int width = ibuf->x;
-    const int height = ibuf->y;
-    const StripCrop *c = seq->strip->crop;
-
-    const int left = c->left / scale_to_fit_factor * preview_scale_factor;
-    const int right = c->right / scale_to_fit_factor * preview_scale_factor;
-    const int top = c->top / scale_to_fit_factor * preview_scale_factor;
-    const int bottom = c->bottom / scale_to_fit_factor * preview_scale_factor;
-    const float col[4] = {0.0f, 0.0f, 0.0f, 0.0f};
-
-    /* Left. */
-    IMB_rectfill_area_replace(preprocessed_ibuf, col, 0, 0, left, height);
-    /* Bottom. */
-    IMB_rectfill_area_replace(preprocessed_ibuf, col, left, 0, width, bottom);
-    /* Right. */
-    IMB_rectfill_area_replace(preprocessed_ibuf, col, width - right, bottom, width, height);
-    /* Top. */
-    IMB_rectfill_area_replace(preprocessed_ibuf, col, left, height - top, width - right, height);
   }
 
   if (sequencer_use_transform(seq) || context->rectx != ibuf->x || context->recty != ibuf->y) {
@@ -739,7 +796,7 @@ static ImBuf *seq_render_preprocess_ibuf(const SeqRenderData *context,
                                          Sequence *seq,
                                          ImBuf *ibuf,
                                          float timeline_frame,
-                                         clock_t begin,
+                                         double begin,
                                          bool use_preprocess,
                                          const bool is_proxy_image)
 {
@@ -1076,8 +1133,13 @@ static ImBuf *seq_render_image_strip(const SeqRenderData *context,
       localcontext.view_id = view_id;
 
       if (view_id != context->view_id) {
-        ibufs_arr[view_id] = seq_render_preprocess_ibuf(
-            &localcontext, seq, ibufs_arr[view_id], timeline_frame, clock(), true, false);
+        ibufs_arr[view_id] = seq_render_preprocess_ibuf(&localcontext,
+                                                        seq,
+                                                        ibufs_arr[view_id],
+                                                        timeline_frame,
+                                                        seq_estimate_render_cost_begin(),
+                                                        true,
+                                                        false);
       }
     }
 
@@ -1226,8 +1288,13 @@ static ImBuf *seq_render_movie_strip(const SeqRenderData *context,
       localcontext.view_id = view_id;
 
       if (view_id != context->view_id) {
-        ibuf_arr[view_id] = seq_render_preprocess_ibuf(
-            &localcontext, seq, ibuf_arr[view_id], timeline_frame, clock(), true, false);
+        ibuf_arr[view_id] = seq_render_preprocess_ibuf(&localcontext,
+                                                       seq,
+                                                       ibuf_arr[view_id],
+                                                       timeline_frame,
+                                                       seq_estimate_render_cost_begin(),
+                                                       true,
+                                                       false);
       }
     }
 
@@ -1800,22 +1867,14 @@ static ImBuf *do_render_strip_uncached(const SeqRenderData *context,
   return ibuf;
 }
 
-ImBuf *seq_render_strip(const SeqRenderData *context,
-                        SeqRenderState *state,
-                        Sequence *seq,
-                        float timeline_frame)
+/* Render the strip without preprocessing, or get it from the cache. */
+static ImBuf *seq_render_strip_raw(const SeqRenderData *context,
+                                   SeqRenderState *state,
+                                   Sequence *seq,
+                                   float timeline_frame,
+                                   bool *r_is_proxy_image)
 {
   ImBuf *ibuf = NULL;
-  bool use_preprocess = false;
-  bool is_proxy_image = false;
-
-  clock_t begin = seq_estimate_render_cost_begin();
-
-  ibuf = BKE_sequencer_cache_get(
-      context, seq, timeline_frame, SEQ_CACHE_STORE_PREPROCESSED, false);
-  if (ibuf != NULL) {
-    return ibuf;
-  }
 
   /* Proxies are not stored in cache. */
   if (!SEQ_can_use_proxy(seq, SEQ_rendersize_to_proxysize(context->preview_render_size))) {
@@ -1823,11 +1882,23 @@ ImBuf *seq_render_strip(const SeqRenderData *context,
   }
 
   if (ibuf == NULL) {
-    ibuf = do_render_strip_uncached(context, state, seq, timeline_frame, &is_proxy_image);
+    ibuf = do_render_strip_uncached(context, state, seq, timeline_frame, r_is_proxy_image);
   }
 
+  return ibuf;
+}
+
+/* Preprocess the raw image of the strip like #seq_render_strip does, \a ibuf is consumed. */
+static ImBuf *seq_render_strip_preprocess_raw(const SeqRenderData *context,
+                                              Sequence *seq,
+                                              float timeline_frame,
+                                              ImBuf *ibuf,
+                                              double begin,
+                                              const bool is_proxy_image)
+{
   if (ibuf) {
-    use_preprocess = BKE_sequencer_input_have_to_preprocess(context, seq, timeline_frame);
+    const bool use_preprocess = BKE_sequencer_input_have_to_preprocess(
+        context, seq, timeline_frame);
     ibuf = seq_render_preprocess_ibuf(
         context, seq, ibuf, timeline_frame, begin, use_preprocess, is_proxy_image);
   }
@@ -1840,6 +1911,28 @@ ImBuf *seq_render_strip(const SeqRenderData *context,
   return ibuf;
 }
 
+ImBuf *seq_render_strip(const SeqRenderData *context,
+                        SeqRenderState *state,
+                        Sequence *seq,
+                        float timeline_frame)
+{
+  ImBuf *ibuf = NULL;
+  bool is_proxy_image = false;
+
+  double begin = seq_estimate_render_cost_begin();
+
+  ibuf = BKE_sequencer_cache_get(
+      context, seq, timeline_frame, SEQ_CACHE_STORE_PREPROCESSED, false);
+  if (ibuf != NULL) {
+    return ibuf;
+  }
+
+  ibuf = seq_render_strip_raw(context, state, seq, timeline_frame, &is_proxy_image);
+
+  return seq_render_strip_preprocess_raw(
+      context, seq, timeline_frame, ibuf, begin, is_proxy_image);
+}
+
 static bool seq_must_swap_input_in_blend_mode(Sequence *seq)
 {
   bool swap_input = false;
@@ -1905,6 +1998,405 @@ static ImBuf *seq_render_strip_stack_apply_effect(
   return out;
 }
 
+/* Tiled compositing of the strip stack:
+ * Consecutive strips of the stack are composited tile by tile. For each tile, every strip is
+ * transformed, preprocessed and blended with the composite of the strips below it, while the
+ * tile is still in the CPU cache. Neither the preprocessed strip images nor the composites
+ * between the strips are allocated as a whole.
+ *
+ * Deinterlacing and crop change the source image before that, steps which need the whole
+ * preprocessed image make the strip use the regular path, see #seq_render_strip_stack_can_fuse.
+ * Strips whose composite is stored in the cache end the tiled run, so the composite exists as a
+ * whole for the cache. */
+
+/* Size in bytes of a tile buffer, which is a number of whole lines. */
+#define SEQ_FUSED_TILE_SIZE (256 * 1024)
+
+typedef struct FusedLayer {
+  Sequence *seq;
+  struct SeqEffectHandle sh;
+  float fac;
+  bool swap_input;
+  /* Raw image of the strip, deinterlaced and cropped. */
+  ImBuf *ibuf_source;
+  bool use_preprocess;
+  bool use_transform;
+  float transform_matrix[3][3];
+  float mul;
+  SeqModifierTiles *modifiers;
+} FusedLayer;
+
+typedef struct FusedStackData {
+  const SeqRenderData *context;
+  float timeline_frame;
+  const FusedLayer *layers;
+  int layers_len;
+  ImBuf *ibuf_below;
+  ImBuf *out;
+  bool is_float;
+  int tile_lines;
+} FusedStackData;
+
+typedef struct FusedStackTLS {
+  ImBuf *ibuf_layer;
+  ImBuf *ibuf_composite[2];
+} FusedStackTLS;
+
+/* Blend modes that only read the pixel they write, with the default effect initialization. */
+static bool seq_blend_mode_supports_fused(const Sequence *seq)
+{
+  switch (seq->blend_mode) {
+    case SEQ_TYPE_CROSS:
+    case SEQ_TYPE_ADD:
+    case SEQ_TYPE_SUB:
+    case SEQ_TYPE_MUL:
+    case SEQ_TYPE_ALPHAOVER:
+    case SEQ_TYPE_ALPHAUNDER:
+    case SEQ_TYPE_SCREEN:
+    case SEQ_TYPE_OVERLAY:
+    case SEQ_TYPE_COLOR_BURN:
+    case SEQ_TYPE_LINEAR_BURN:
+    case SEQ_TYPE_DARKEN:
+    case SEQ_TYPE_LIGHTEN:
+    case SEQ_TYPE_DODGE:
+    case SEQ_TYPE_SOFT_LIGHT:
+    case SEQ_TYPE_HARD_LIGHT:
+    case SEQ_TYPE_PIN_LIGHT:
+    case SEQ_TYPE_LIN_LIGHT:
+    case SEQ_TYPE_VIVID_LIGHT:
+    case SEQ_TYPE_BLEND_COLOR:
+    case SEQ_TYPE_HUE:
+    case SEQ_TYPE_SATURATION:
+    case SEQ_TYPE_VALUE:
+    case SEQ_TYPE_DIFFERENCE:
+    case SEQ_TYPE_EXCLUSION:
+      return true;
+  }
+  return false;
+}
+
+/* Only changed by tests, while nothing is rendered. */
+static bool use_fused_blend = true;
+
+void seq_render_fused_blend_use(bool use)
+{
+  use_fused_blend = use;
+}
+
+/**
+ * Whether the strip can be composited tile by tile, before it is rendered. Conversion to float
+ * and modifiers in linear space work on the whole image, as do modifiers that read other pixels
+ * than the one they write.
+ */
+static bool seq_render_strip_stack_can_fuse(const SeqRenderData *context, Sequence *seq)
+{
+  if (!use_fused_blend || context->is_proxy_render || !seq_blend_mode_supports_fused(seq)) {
+    return false;
+  }
+
+  if ((seq->flag & SEQ_MAKE_FLOAT) || !seq_modifier_stack_supports_tiles(seq)) {
+    return false;
+  }
+
+  /* The preprocessed image has to exist as a whole to be stored. */
+  return !BKE_sequencer_cache_is_type_stored(context, seq, SEQ_CACHE_STORE_PREPROCESSED);
+}
+
+/* View of lines of an image, without own buffers. */
+static void seq_imbuf_lines_view(const ImBuf *ibuf, int start_line, int tot_line, ImBuf *r_view)
+{
+  const size_t offset = (size_t)start_line * ibuf->x;
+
+  memset(r_view, 0, sizeof(*r_view));
+  r_view->x = ibuf->x;
+  r_view->y = tot_line;
+  r_view->planes = ibuf->planes;
+  r_view->channels = ibuf->channels;
+  if (ibuf->rect) {
+    r_view->rect = ibuf->rect + offset;
+  }
+  if (ibuf->rect_float) {
+    r_view->rect_float = ibuf->rect_float + offset * 4;
+  }
+}
+
+/**
+ * Prepare the strip to be composited tile by tile. \a ibuf is the raw image of the strip, which
+ * is owned by the layer afterwards. Preprocessing steps that work on the source image are done
+ * here, the others per tile in #seq_render_fused_layer_lines.
+ */
+static void seq_render_fused_layer_init(const SeqRenderData *context,
+                                        Sequence *seq,
+                                        float timeline_frame,
+                                        ImBuf *ibuf,
+                                        const bool is_proxy_image,
+                                        double begin,
+                                        FusedLayer *r_layer)
+{
+  memset(r_layer, 0, sizeof(*r_layer));
+  r_layer->seq = seq;
+  r_layer->sh = BKE_sequence_get_blend(seq);
+  r_layer->fac = seq->blend_opacity / 100.0f;
+  r_layer->swap_input = seq_must_swap_input_in_blend_mode(seq);
+
+  if (ibuf == NULL) {
+    ibuf = IMB_allocImBuf(context->rectx, context->recty, 32, IB_rect);
+    seq_imbuf_assign_spaces(context->scene, ibuf);
+    r_layer->ibuf_source = ibuf;
+    return;
+  }
+
+  r_layer->use_preprocess = BKE_sequencer_input_have_to_preprocess(
+                                context, seq, timeline_frame) ||
+                            ibuf->x != context->rectx || ibuf->y != context->recty;
+
+  if (!r_layer->use_preprocess) {
+    r_layer->ibuf_source = ibuf;
+    return;
+  }
+
+  /* Proxies are not stored in cache. */
+  if (!is_proxy_image) {
+    float cost = seq_estimate_render_cost_end(context->scene, begin);
+    BKE_sequencer_cache_put(context, seq, timeline_frame, SEQ_CACHE_STORE_RAW, ibuf, cost, false);
+  }
+
+  /* Deinterlace. */
+  if ((seq->flag & SEQ_FILTERY) && !ELEM(seq->type, SEQ_TYPE_MOVIE, SEQ_TYPE_MOVIECLIP)) {
+    ibuf = IMB_makeSingleUser(ibuf);
+    IMB_filtery(ibuf);
+  }
+
+  float scale_to_fit_factor, preview_scale_factor;
+  sequencer_image_scale_factors_get(context, ibuf, &scale_to_fit_factor, &preview_scale_factor);
+
+  if (sequencer_use_crop(seq)) {
+    ibuf = sequencer_image_crop(seq, ibuf, scale_to_fit_factor, preview_scale_factor);
+  }
+
+  r_layer->use_transform = sequencer_use_transform(seq) || ibuf->x != context->rectx ||
+                           ibuf->y != context->recty;
+  if (r_layer->use_transform) {
+    sequencer_image_transform_matrix_get(ibuf,
+                                         context->rectx,
+                                         context->recty,
+                                         seq->strip->transform,
+                                         scale_to_fit_factor,
+                                         preview_scale_factor,
+                                         r_layer->transform_matrix);
+  }
+
+  r_layer->mul = seq->mul;
+  if (seq->blend_mode == SEQ_BLEND_REPLACE) {
+    r_layer->mul *= seq->blend_opacity / 100.0f;
+  }
+
+  if (seq->modifiers.first) {
+    r_layer->modifiers = seq_modifier_stack_tiles_begin(
+        context, seq, timeline_frame, ibuf->rect_float != NULL);
+  }
+
+  r_layer->ibuf_source = ibuf;
+}
+
+static void seq_render_fused_layer_free(FusedLayer *layer)
+{
+  if (layer->modifiers) {
+    seq_modifier_stack_tiles_end(layer->modifiers);
+  }
+  IMB_freeImBuf(layer->ibuf_source);
+}
+
+/**
+ * Fill \a ibuf_tile with the preprocessed lines of the strip starting at \a start_line, in the
+ * same order as #input_preprocess does for the whole image.
+ */
+static void seq_render_fused_layer_lines(const SeqRenderData *context,
+                                         const FusedLayer *layer,
+                                         ImBuf *ibuf_tile,
+                                         const int start_line)
+{
+  const Sequence *seq = layer->seq;
+  ImBuf *ibuf_source = layer->ibuf_source;
+  const bool flip_y = layer->use_preprocess && (seq->flag & SEQ_FLIPY);
+  const int tot_line = ibuf_tile->y;
+
+  if (layer->use_transform) {
+    /* Interpolation only writes pixels inside of the source image. */
+    if (ibuf_tile->rect_float) {
+      memset(ibuf_tile->rect_float, 0, sizeof(float[4]) * ibuf_tile->x * tot_line);
+    }
+    else {
+      memset(ibuf_tile->rect, 0, sizeof(uint) * ibuf_tile->x * tot_line);
+    }
+  }
+
+  for (int line = 0; line < tot_line; line++) {
+    const int source_line = flip_y ? context->recty - 1 - (start_line + line) :
+                                     start_line + line;
+    if (layer->use_transform) {
+      sequencer_image_transform_lines(ibuf_source,
+                                      ibuf_tile,
+                                      layer->transform_matrix,
+                                      context->for_render,
+                                      source_line,
+                                      1,
+                                      source_line - line);
+    }
+    else if (ibuf_tile->rect_float) {
+      memcpy(ibuf_tile->rect_float + (size_t)4 * line * ibuf_tile->x,
+             ibuf_source->rect_float + (size_t)4 * source_line * ibuf_source->x,
+             sizeof(float[4]) * ibuf_tile->x);
+    }
+    else {
+      memcpy(ibuf_tile->rect + (size_t)line * ibuf_tile->x,
+             ibuf_source->rect + (size_t)source_line * ibuf_source->x,
+             sizeof(uint) * ibuf_tile->x);
+    }
+  }
+
+  if (!layer->use_preprocess) {
+    return;
+  }
+
+  if (seq->flag & SEQ_FLIPX) {
+    IMB_flipx(ibuf_tile);
+  }
+
+  if (seq->sat != 1.0f) {
+    IMB_saturation(ibuf_tile, seq->sat);
+  }
+
+  if (layer->mul != 1.0f) {
+    multibuf(ibuf_tile, layer->mul);
+  }
+
+  if (layer->modifiers) {
+    seq_modifier_stack_tiles_apply(layer->modifiers, ibuf_tile, start_line);
+  }
+}
+
+static void seq_render_fused_stack_tile(void *__restrict userdata,
+                                        const int tile,
+                                        const TaskParallelTLS *__restrict tls)
+{
+  const FusedStackData *data = (const FusedStackData *)userdata;
+  FusedStackTLS *tls_data = (FusedStackTLS *)tls->userdata_chunk;
+  const SeqRenderData *context = data->context;
+  const int start_line = tile * data->tile_lines;
+  const int tot_line = min_ii(data->tile_lines, context->recty - start_line);
+
+  if (tls_data->ibuf_layer == NULL) {
+    const int flags = data->is_float ? IB_rectfloat : IB_rect;
+    tls_data->ibuf_layer = IMB_allocImBuf(context->rectx, data->tile_lines, 32, flags);
+    /* Composites between the layers alternate between two buffers. */
+    for (int i = 0; i < min_ii(data->layers_len - 1, 2); i++) {
+      tls_data->ibuf_composite[i] = IMB_allocImBuf(context->rectx, data->tile_lines, 32, flags);
+    }
+  }
+
+  ImBuf layer_view, below_view, out_view;
+  seq_imbuf_lines_view(tls_data->ibuf_layer, 0, tot_line, &layer_view);
+  seq_imbuf_lines_view(data->ibuf_below, start_line, tot_line, &below_view);
+
+  for (int i = 0; i < data->layers_len; i++) {
+    const FusedLayer *layer = &data->layers[i];
+
+    if (i == data->layers_len - 1) {
+      seq_imbuf_lines_view(data->out, start_line, tot_line, &out_view);
+    }
+    else {
+      seq_imbuf_lines_view(tls_data->ibuf_composite[i % 2], 0, tot_line, &out_view);
+    }
+
+    seq_render_fused_layer_lines(context, layer, &layer_view, start_line);
+
+    ImBuf *ibuf1 = layer->swap_input ? &layer_view : &below_view;
+    ImBuf *ibuf2 = layer->swap_input ? &below_view : &layer_view;
+    layer->sh.execute_slice(context,
+                            layer->seq,
+                            data->timeline_frame,
+                            layer->fac,
+                            layer->fac,
+                            ibuf1,
+                            ibuf2,
+                            NULL,
+                            0,
+                            tot_line,
+                            &out_view);
+
+    below_view = out_view;
+  }
+}
+
+static void seq_render_fused_stack_tls_free(const void *__restrict UNUSED(userdata),
+                                            void *__restrict chunk)
+{
+  FusedStackTLS *tls_data = (FusedStackTLS *)chunk;
+  if (tls_data->ibuf_layer) {
+    IMB_freeImBuf(tls_data->ibuf_layer);
+  }
+  for (int i = 0; i < ARRAY_SIZE(tls_data->ibuf_composite); i++) {
+    if (tls_data->ibuf_composite[i]) {
+      IMB_freeImBuf(tls_data->ibuf_composite[i]);
+    }
+  }
+}
+
+/**
+ * Composite \a layers over \a ibuf_below tile by tile. All layers have the same image format,
+ * \a ibuf_below is converted to float when they are float, like #prepare_effect_imbufs does.
+ * \a ibuf_below and the layers are freed.
+ */
+static ImBuf *seq_render_fused_stack_composite(const SeqRenderData *context,
+                                               float timeline_frame,
+                                               ImBuf *ibuf_below,
+                                               FusedLayer *layers,
+                                               const int layers_len)
+{
+  Scene *scene = context->scene;
+  const bool is_float = layers[0].ibuf_source->rect_float != NULL;
+
+  if (is_float && !ibuf_below->rect_float) {
+    seq_imbuf_to_sequencer_space(scene, ibuf_below, true);
+  }
+
+  ImBuf *out = IMB_allocImBuf(
+      context->rectx, context->recty, 32, is_float ? IB_rectfloat : IB_rect);
+  if (is_float) {
+    IMB_colormanagement_assign_float_colorspace(out, scene->sequencer_colorspace_settings.name);
+  }
+
+  FusedStackData data = {
+      .context = context,
+      .timeline_frame = timeline_frame,
+      .layers = layers,
+      .layers_len = layers_len,
+      .ibuf_below = ibuf_below,
+      .out = out,
+      .is_float = is_float,
+  };
+
+  const size_t line_size = (size_t)context->rectx * (is_float ? sizeof(float[4]) : sizeof(uint));
+  data.tile_lines = clamp_i(SEQ_FUSED_TILE_SIZE / line_size, 1, context->recty);
+  const int tot_tiles = (context->recty + data.tile_lines - 1) / data.tile_lines;
+
+  FusedStackTLS tls_data = {NULL};
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.userdata_chunk = &tls_data;
+  settings.userdata_chunk_size = sizeof(tls_data);
+  settings.func_free = seq_render_fused_stack_tls_free;
+  BLI_task_parallel_range(0, tot_tiles, &data, seq_render_fused_stack_tile, &settings);
+
+  for (int i = 0; i < layers_len; i++) {
+    seq_render_fused_layer_free(&layers[i]);
+  }
+  IMB_freeImBuf(ibuf_below);
+
+  return out;
+}
+
 static ImBuf *seq_render_strip_stack(const SeqRenderData *context,
                                      SeqRenderState *state,
                                      ListBase *seqbasep,
@@ -1915,7 +2407,7 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context,
   int count;
   int i;
   ImBuf *out = NULL;
-  clock_t begin;
+  double begin;
 
   count = seq_get_shown_sequences(seqbasep, timeline_frame, chanshown, (Sequence **)&seq_arr);
 
@@ -1973,18 +2465,80 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context,
   }
 
   i++;
+
+  /* Strips above #out that are composited tile by tile, see #seq_render_fused_stack_tile. */
+  FusedLayer *layers = NULL;
+  int layers_len = 0;
+  bool layers_float = false;
+  double layers_begin = 0.0;
+
+  if (i < count) {
+    layers = MEM_malloc_arrayN(count - i, sizeof(*layers), __func__);
+  }
+
   for (; i < count; i++) {
     begin = seq_estimate_render_cost_begin();
     Sequence *seq = seq_arr[i];
 
     if (seq_get_early_out_for_blend_mode(seq) == EARLY_DO_EFFECT) {
-      ImBuf *ibuf1 = out;
-      ImBuf *ibuf2 = seq_render_strip(context, state, seq, timeline_frame);
+      ImBuf *ibuf_raw = NULL;
+      bool is_proxy_image = false;
+      bool use_fused = seq_render_strip_stack_can_fuse(context, seq);
+      const bool is_raw_rendered = use_fused;
+
+      if (use_fused) {
+        ibuf_raw = seq_render_strip_raw(context, state, seq, timeline_frame, &is_proxy_image);
+        const bool is_float = ibuf_raw && ibuf_raw->rect_float;
+
+        /* The composite is converted to float as a whole. */
+        if (layers_len != 0 && is_float != layers_float) {
+          out = seq_render_fused_stack_composite(
+              context, timeline_frame, out, layers, layers_len);
+          layers_len = 0;
+        }
+
+        if (layers_len == 0) {
+          /* The preprocessed strip is converted to float as a whole. */
+          use_fused = is_float || !out->rect_float;
+          layers_float = is_float;
+          layers_begin = begin;
+        }
+      }
+      else if (layers_len != 0) {
+        out = seq_render_fused_stack_composite(context, timeline_frame, out, layers, layers_len);
+        layers_len = 0;
+      }
 
-      out = seq_render_strip_stack_apply_effect(context, seq, timeline_frame, ibuf1, ibuf2);
+      if (use_fused) {
+        seq_render_fused_layer_init(context,
+                                    seq,
+                                    timeline_frame,
+                                    ibuf_raw,
+                                    is_proxy_image,
+                                    begin,
+                                    &layers[layers_len++]);
+      }
+      else {
+        ImBuf *ibuf1 = out;
+        ImBuf *ibuf2 = is_raw_rendered ?
+                           seq_render_strip_preprocess_raw(
+                               context, seq, timeline_frame, ibuf_raw, begin, is_proxy_image) :
+                           seq_render_strip(context, state, seq, timeline_frame);
+        out = seq_render_strip_stack_apply_effect(context, seq, timeline_frame, ibuf1, ibuf2);
+        IMB_freeImBuf(ibuf2);
+        IMB_freeImBuf(ibuf1);
+      }
+    }
 
-      IMB_freeImBuf(ibuf1);
-      IMB_freeImBuf(ibuf2);
+    if (layers_len != 0) {
+      /* Strips whose composite is stored, and the last one, get the whole composite. */
+      if (i < count - 1 &&
+          !BKE_sequencer_cache_is_type_stored(context, seq, SEQ_CACHE_STORE_COMPOSITE)) {
+        continue;
+      }
+      out = seq_render_fused_stack_composite(context, timeline_frame, out, layers, layers_len);
+      layers_len = 0;
+      begin = layers_begin;
     }
 
     float cost = seq_estimate_render_cost_end(context->scene, begin);
@@ -1992,6 +2546,10 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context,
         context, seq_arr[i], timeline_frame, SEQ_CACHE_STORE_COMPOSITE, out, cost, false);
   }
 
+  if (layers) {
+    MEM_freeN(layers);
+  }
+
   return out;
 }
 
@@ -2034,7 +2592,7 @@ ImBuf *SEQ_render_give_ibuf(const SeqRenderData *context, float timeline_frame,
 
   BKE_sequencer_cache_free_temp_cache(context->scene, context->task_id, timeline_frame);
 
-  clock_t begin = seq_estimate_render_cost_begin();
+  double begin = seq_estimate_render_cost_begin();
   float cost = 0;
 
   if (count && !out) {
@@ -2068,6 +2626,34 @@ ImBuf *SEQ_render_give_ibuf(const SeqRenderData *context, float timeline_frame,
   return out;
 }
 
+/**
+ * Store a frame rendered with #seq_render_give_ibuf_seqbase in the final image cache. Prefetching
+ * uses this for frames rendered in parallel, which can't use the cache while rendering.
+ */
+void seq_render_cache_put_final_out(const SeqRenderData *context,
+                                    float timeline_frame,
+                                    ImBuf *ibuf,
+                                    float cost)
+{
+  Editing *ed = BKE_sequencer_editing_get(context->scene, false);
+  Sequence *seq_arr[MAXSEQ + 1];
+
+  if (ed == NULL) {
+    return;
+  }
+
+  int count = seq_get_shown_sequences(ed->seqbasep, timeline_frame, 0, seq_arr);
+  if (count == 0) {
+    return;
+  }
+
+  /* Cache key linking is shared with the render in #SEQ_render_give_ibuf. */
+  BLI_mutex_lock(&seq_render_mutex);
+  BKE_sequencer_cache_put(
+      context, seq_arr[count - 1], timeline_frame, SEQ_CACHE_STORE_FINAL_OUT, ibuf, cost, false);
+  BLI_mutex_unlock(&seq_render_mutex);
+}
+
 ImBuf *seq_render_give_ibuf_seqbase(const SeqRenderData *context,
                                     float timeline_frame,
                                     int chan_shown,
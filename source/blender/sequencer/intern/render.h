@@ -50,6 +50,10 @@ struct ImBuf *seq_render_give_ibuf_seqbase(const struct SeqRenderData *context,
                                            float timeline_frame,
                                            int chan_shown,
                                            struct ListBase *seqbasep);
+void seq_render_cache_put_final_out(const struct SeqRenderData *context,
+                                    float timeline_frame,
+                                    struct ImBuf *ibuf,
+                                    float cost);
 struct ImBuf *seq_render_effect_execute_threaded(struct SeqEffectHandle *sh,
                                                  const SeqRenderData *context,
                                                  struct Sequence *seq,
@@ -73,6 +77,8 @@ struct ImBuf *seq_render_mask(const struct SeqRenderData *context,
                               float frame_index,
                               bool make_float);
 void seq_imbuf_assign_spaces(struct Scene *scene, struct ImBuf *ibuf);
+/* Composite strips of the stack tile by tile, for tests comparing both paths. */
+void seq_render_fused_blend_use(bool use);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,196 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <cstring>
+#include <vector>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_rand.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "disk_cache_codec.h"
+
+namespace blender::seq::tests {
+
+static const int codecs[] = {
+    SEQ_DISK_CACHE_CODEC_NONE, SEQ_DISK_CACHE_CODEC_LZO, SEQ_DISK_CACHE_CODEC_ZLIB};
+
+/* Image encoded with the chunk index, the same as it is written to a disk cache file. */
+struct EncodedImage {
+  std::vector<uint32_t> chunk_sizes;
+  std::vector<uchar> encoded;
+};
+
+/* Gradient with noise, so chunks compress but not to nothing. */
+static std::vector<float> image_float(int width, int height)
+{
+  std::vector<float> rect(size_t(width) * height * 4);
+  RNG *rng = BLI_rng_new(0);
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      float *pixel = &rect[(size_t(y) * width + x) * 4];
+      pixel[0] = float(x) / width + BLI_rng_get_float(rng) * 0.01f;
+      pixel[1] = float(y) / height;
+      pixel[2] = 0.5f;
+      pixel[3] = 1.0f;
+    }
+  }
+  BLI_rng_free(rng);
+  return rect;
+}
+
+static std::vector<uchar> image_byte_random(size_t size)
+{
+  std::vector<uchar> rect(size);
+  RNG *rng = BLI_rng_new(1);
+  for (uchar &value : rect) {
+    value = uchar(BLI_rng_get_uint(rng) & 0xff);
+  }
+  BLI_rng_free(rng);
+  return rect;
+}
+
+static EncodedImage encode(const void *data, size_t size_raw, int codec, int element_size)
+{
+  EncodedImage image;
+  image.chunk_sizes.resize(seq_disk_cache_chunks_num(size_raw));
+  size_t size_encoded = 0;
+  void *encoded = seq_disk_cache_encode(
+      data, size_raw, codec, 1, element_size, image.chunk_sizes.data(), &size_encoded);
+
+  /* Without compression the data is stored as it is. */
+  const uchar *encoded_data = encoded ? (const uchar *)encoded : (const uchar *)data;
+  image.encoded.assign(encoded_data, encoded_data + size_encoded);
+  MEM_SAFE_FREE(encoded);
+  return image;
+}
+
+static bool decode(
+    const EncodedImage &image, int codec, int element_size, void *r_data, size_t size)
+{
+  return seq_disk_cache_decode(image.encoded.data(),
+                               image.encoded.size(),
+                               image.chunk_sizes.data(),
+                               codec,
+                               element_size,
+                               r_data,
+                               size);
+}
+
+template<typename T>
+static void expect_round_trip(const std::vector<T> &rect, int codec, int element_size)
+{
+  const size_t size = sizeof(T) * rect.size();
+  EncodedImage image = encode(rect.data(), size, codec, element_size);
+
+  std::vector<T> decoded(rect.size());
+  EXPECT_TRUE(decode(image, codec, element_size, decoded.data(), size)) << "codec " << codec;
+  EXPECT_EQ(memcmp(rect.data(), decoded.data(), size), 0) << "codec " << codec;
+}
+
+class SequencerDiskCacheCodecTest : public testing::Test {
+ protected:
+  void SetUp() override
+  {
+    BLI_threadapi_init();
+  }
+
+  void TearDown() override
+  {
+    BLI_threadapi_exit();
+  }
+};
+
+TEST_F(SequencerDiskCacheCodecTest, RoundTrip)
+{
+  /* A single chunk and several chunks with a partial last one. */
+  const std::vector<float> rect_small = image_float(16, 8);
+  const std::vector<float> rect_large = image_float(301, 199);
+  ASSERT_EQ(seq_disk_cache_chunks_num(sizeof(float) * rect_small.size()), 1);
+  ASSERT_GT(seq_disk_cache_chunks_num(sizeof(float) * rect_large.size()), 1);
+
+  for (const int codec : codecs) {
+    if (!seq_disk_cache_codec_is_supported(codec)) {
+      continue;
+    }
+    expect_round_trip(rect_small, codec, sizeof(float));
+    expect_round_trip(rect_large, codec, sizeof(float));
+    expect_round_trip(rect_large, codec, 1);
+  }
+}
+
+TEST_F(SequencerDiskCacheCodecTest, Incompressible)
+{
+  /* Random chunks are stored as they are. */
+  const std::vector<uchar> rect = image_byte_random(SEQ_DISK_CACHE_CHUNK_SIZE + 100);
+  EncodedImage image = encode(rect.data(), rect.size(), SEQ_DISK_CACHE_CODEC_ZLIB, 1);
+  ASSERT_EQ(image.chunk_sizes.size(), 2u);
+  EXPECT_EQ(image.chunk_sizes[0], uint32_t(SEQ_DISK_CACHE_CHUNK_SIZE));
+  EXPECT_EQ(image.chunk_sizes[1], 100u);
+  expect_round_trip(rect, SEQ_DISK_CACHE_CODEC_ZLIB, 1);
+}
+
+TEST_F(SequencerDiskCacheCodecTest, CorruptedIndex)
+{
+  const std::vector<float> rect = image_float(301, 199);
+  const size_t size = sizeof(float) * rect.size();
+  std::vector<float> decoded(rect.size());
+
+  for (const int codec : codecs) {
+    if (!seq_disk_cache_codec_is_supported(codec)) {
+      continue;
+    }
+    const EncodedImage image = encode(rect.data(), size, codec, sizeof(float));
+
+    /* Sizes which don't add up to the size of the encoded data. */
+    EncodedImage image_corrupt = image;
+    image_corrupt.chunk_sizes[0] += 1;
+    EXPECT_FALSE(decode(image_corrupt, codec, sizeof(float), decoded.data(), size))
+        << "codec " << codec;
+
+    /* Sizes which add up, but don't match the chunks. */
+    image_corrupt = image;
+    image_corrupt.chunk_sizes[0] -= 1;
+    image_corrupt.chunk_sizes[1] += 1;
+    EXPECT_FALSE(decode(image_corrupt, codec, sizeof(float), decoded.data(), size))
+        << "codec " << codec;
+
+    /* A chunk larger than any encoded chunk can be. */
+    image_corrupt = image;
+    image_corrupt.chunk_sizes[0] = UINT32_MAX;
+    EXPECT_FALSE(decode(image_corrupt, codec, sizeof(float), decoded.data(), size))
+        << "codec " << codec;
+
+    /* An index of an image with a different size. */
+    EXPECT_FALSE(decode(image, codec, sizeof(float), decoded.data(), size / 2))
+        << "codec " << codec;
+  }
+}
+
+TEST_F(SequencerDiskCacheCodecTest, UnsupportedCodec)
+{
+  const int codec_unknown = 100;
+  EXPECT_FALSE(seq_disk_cache_codec_is_supported(codec_unknown));
+
+  /* Images are stored as they are with codecs which are not supported. */
+  const std::vector<float> rect = image_float(16, 8);
+  const size_t size = sizeof(float) * rect.size();
+  uint32_t chunk_size = 0;
+  size_t size_encoded = 0;
+  EXPECT_EQ(seq_disk_cache_encode(
+                rect.data(), size, codec_unknown, 1, sizeof(float), &chunk_size, &size_encoded),
+            nullptr);
+  EXPECT_EQ(chunk_size, size);
+  EXPECT_EQ(size_encoded, size);
+
+  /* Compressed chunks of a codec which is not supported can't be decoded. */
+  const EncodedImage image = encode(rect.data(), size, SEQ_DISK_CACHE_CODEC_ZLIB, sizeof(float));
+  ASSERT_LT(image.encoded.size(), size);
+  std::vector<float> decoded(rect.size());
+  EXPECT_FALSE(decode(image, codec_unknown, sizeof(float), decoded.data(), size));
+}
+
+}  // namespace blender::seq::tests
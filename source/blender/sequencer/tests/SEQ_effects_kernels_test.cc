@@ -0,0 +1,171 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "BLI_rand.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_sequence_types.h"
+
+#include "effects_kernels.h"
+
+namespace blender::seq::tests {
+
+/* Widths around the SIMD width, to include rows with a scalar remainder. */
+static const int widths[] = {1, 2, 3, 4, 5, 7, 8, 9, 13, 16, 37};
+/* Factors of even and odd rows, including factors outside of [0, 1] from animated curves. */
+static const float factors[][2] = {
+    {0.0f, 1.0f}, {0.35f, 0.8f}, {0.5f, 0.5f}, {1.0f, 0.0f}, {-0.2f, 1.3f}};
+static const int height = 3;
+
+template<typename T>
+using KernelFn = void (*)(const T *rect1, const T *rect2, T *out, int width, float fac);
+
+static void fill(std::vector<uchar> &rect, int seed)
+{
+  RNG *rng = BLI_rng_new(seed);
+  for (uchar &value : rect) {
+    value = uchar(BLI_rng_get_uint(rng) & 0xff);
+  }
+  BLI_rng_free(rng);
+}
+
+static void fill(std::vector<float> &rect, int seed)
+{
+  RNG *rng = BLI_rng_new(seed);
+  for (size_t i = 0; i < rect.size(); i += 4) {
+    /* Include transparent and opaque pixels, some kernels have special cases for those, and
+     * values outside of [0, 1]. */
+    const float alpha = std::clamp(BLI_rng_get_float(rng) * 1.2f - 0.1f, 0.0f, 1.0f);
+    rect[i + 0] = BLI_rng_get_float(rng) * alpha;
+    rect[i + 1] = BLI_rng_get_float(rng) * alpha * 2.0f;
+    rect[i + 2] = BLI_rng_get_float(rng) - 0.25f;
+    rect[i + 3] = alpha;
+  }
+  BLI_rng_free(rng);
+}
+
+static void kernel_rows(KernelFn<uchar> kernel,
+                        const std::vector<uchar> &rect1,
+                        const std::vector<uchar> &rect2,
+                        std::vector<uchar> &out,
+                        int width,
+                        const float fac[2])
+{
+  seq_kernel_rows_byte(
+      kernel, rect1.data(), rect2.data(), out.data(), width, height, fac[0], fac[1]);
+}
+
+static void kernel_rows(KernelFn<float> kernel,
+                        const std::vector<float> &rect1,
+                        const std::vector<float> &rect2,
+                        std::vector<float> &out,
+                        int width,
+                        const float fac[2])
+{
+  seq_kernel_rows_float(
+      kernel, rect1.data(), rect2.data(), out.data(), width, height, fac[0], fac[1]);
+}
+
+/* The SIMD kernels have to give exactly the same results as the scalar ones. */
+template<typename T> static void expect_simd_matches_scalar(KernelFn<T> kernel)
+{
+  for (const int width : widths) {
+    const size_t len = size_t(width) * height * 4;
+    std::vector<T> rect1(len), rect2(len), out_scalar(len), out_simd(len);
+    fill(rect1, width);
+    fill(rect2, width + 100);
+    for (const float *fac : factors) {
+      seq_effect_kernels_use_simd(false);
+      kernel_rows(kernel, rect1, rect2, out_scalar, width, fac);
+      seq_effect_kernels_use_simd(true);
+      kernel_rows(kernel, rect1, rect2, out_simd, width, fac);
+      EXPECT_EQ(memcmp(out_scalar.data(), out_simd.data(), sizeof(T) * len), 0)
+          << "width " << width << ", factors " << fac[0] << ", " << fac[1];
+    }
+  }
+}
+
+template<int blend_mode>
+static void blend_float(const float *rect1, const float *rect2, float *out, int width, float fac)
+{
+  EXPECT_TRUE(seq_kernel_blend_float(blend_mode, rect1, rect2, out, width, fac));
+}
+
+class SequencerEffectsKernelsTest : public testing::Test {
+ protected:
+  void SetUp() override
+  {
+    if (!seq_effect_kernels_simd_supported()) {
+      GTEST_SKIP() << "SIMD kernels are not supported";
+    }
+  }
+
+  void TearDown() override
+  {
+    seq_effect_kernels_use_simd(true);
+  }
+};
+
+TEST_F(SequencerEffectsKernelsTest, AlphaOverFloat)
+{
+  expect_simd_matches_scalar<float>(seq_kernel_alphaover_float);
+}
+
+TEST_F(SequencerEffectsKernelsTest, Cross)
+{
+  expect_simd_matches_scalar<uchar>(seq_kernel_cross_byte);
+  expect_simd_matches_scalar<float>(seq_kernel_cross_float);
+}
+
+TEST_F(SequencerEffectsKernelsTest, Add)
+{
+  expect_simd_matches_scalar<uchar>(seq_kernel_add_byte);
+  expect_simd_matches_scalar<float>(seq_kernel_add_float);
+}
+
+TEST_F(SequencerEffectsKernelsTest, Sub)
+{
+  expect_simd_matches_scalar<uchar>(seq_kernel_sub_byte);
+  expect_simd_matches_scalar<float>(seq_kernel_sub_float);
+}
+
+TEST_F(SequencerEffectsKernelsTest, Mul)
+{
+  expect_simd_matches_scalar<uchar>(seq_kernel_mul_byte);
+  expect_simd_matches_scalar<float>(seq_kernel_mul_float);
+}
+
+TEST_F(SequencerEffectsKernelsTest, BlendModesFloat)
+{
+  expect_simd_matches_scalar<float>(blend_float<SEQ_TYPE_ADD>);
+  expect_simd_matches_scalar<float>(blend_float<SEQ_TYPE_SUB>);
+  expect_simd_matches_scalar<float>(blend_float<SEQ_TYPE_MUL>);
+  expect_simd_matches_scalar<float>(blend_float<SEQ_TYPE_DARKEN>);
+  expect_simd_matches_scalar<float>(blend_float<SEQ_TYPE_LIGHTEN>);
+  expect_simd_matches_scalar<float>(blend_float<SEQ_TYPE_SCREEN>);
+  expect_simd_matches_scalar<float>(blend_float<SEQ_TYPE_DIFFERENCE>);
+  EXPECT_FALSE(seq_kernel_blend_float(SEQ_TYPE_OVERDROP, nullptr, nullptr, nullptr, 0, 1.0f));
+}
+
+TEST(SequencerEffectsKernels, RowFactors)
+{
+  /* Even rows use the first factor, odd rows the second one. */
+  const int width = 2;
+  std::vector<float> rect1(size_t(width) * height * 4, 0.0f);
+  std::vector<float> rect2(rect1.size(), 1.0f);
+  std::vector<float> out(rect1.size());
+  seq_kernel_rows_float(
+      seq_kernel_cross_float, rect1.data(), rect2.data(), out.data(), width, height, 0.25f, 0.75f);
+  for (int y = 0; y < height; y++) {
+    for (int i = 0; i < width * 4; i++) {
+      EXPECT_FLOAT_EQ(out[y * width * 4 + i], (y & 1) ? 0.75f : 0.25f) << "row " << y;
+    }
+  }
+}
+
+}  // namespace blender::seq::tests
@@ -0,0 +1,58 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <cstddef>
+
+#include "BLI_utildefines.h"
+
+#include "image_cache.h"
+
+namespace blender::seq::tests {
+
+static const size_t megabyte = 1024 * 1024;
+
+TEST(SequencerImageCache, RecycleScoreCost)
+{
+  /* Frames which are cheap to render again are recycled first. */
+  EXPECT_LT(seq_cache_recycle_score(0.5f, 8 * megabyte, 0.0f, 1.0f),
+            seq_cache_recycle_score(2.0f, 8 * megabyte, 0.0f, 1.0f));
+  /* For the memory they use. */
+  EXPECT_LT(seq_cache_recycle_score(1.0f, 32 * megabyte, 0.0f, 1.0f),
+            seq_cache_recycle_score(1.0f, 8 * megabyte, 0.0f, 1.0f));
+  EXPECT_FLOAT_EQ(seq_cache_recycle_score(1.0f, 8 * megabyte, 0.0f, 1.0f),
+                  seq_cache_recycle_score(4.0f, 32 * megabyte, 0.0f, 1.0f));
+}
+
+TEST(SequencerImageCache, RecycleScoreDistance)
+{
+  /* Frames far from the playhead are recycled first. */
+  EXPECT_LT(seq_cache_recycle_score(1.0f, 8 * megabyte, 0.0f, 10.0f),
+            seq_cache_recycle_score(1.0f, 8 * megabyte, 0.0f, 1.0f));
+  /* Frames behind the playhead before frames ahead of it. */
+  EXPECT_LT(seq_cache_recycle_score(1.0f, 8 * megabyte, 0.0f, -2.0f),
+            seq_cache_recycle_score(1.0f, 8 * megabyte, 0.0f, 2.0f));
+  EXPECT_FLOAT_EQ(seq_cache_recycle_score(1.0f, 8 * megabyte, 0.0f, -2.0f),
+                  seq_cache_recycle_score(1.0f, 8 * megabyte, 0.0f, 4.0f));
+}
+
+TEST(SequencerImageCache, RecycleScoreClock)
+{
+  /* Frames which weren't used since other frames were recycled go first, even when they are
+   * expensive. */
+  EXPECT_LT(seq_cache_recycle_score(10.0f, 8 * megabyte, 0.0f, 0.0f),
+            seq_cache_recycle_score(0.0f, 8 * megabyte, 2.0f, 0.0f));
+  /* A frame which is used again gets the clock of the last recycled frame. */
+  const float score_recycled = seq_cache_recycle_score(1.0f, 8 * megabyte, 0.0f, 0.0f);
+  EXPECT_GT(seq_cache_recycle_score(1.0f, 8 * megabyte, score_recycled, 0.0f), score_recycled);
+}
+
+TEST(SequencerImageCache, RecycleScoreEmpty)
+{
+  /* Frames without images still get a finite score. */
+  const float score = seq_cache_recycle_score(1.0f, 0, 0.0f, 0.0f);
+  EXPECT_GT(score, 0.0f);
+  EXPECT_LT(score, 1e6f);
+}
+
+}  // namespace blender::seq::tests
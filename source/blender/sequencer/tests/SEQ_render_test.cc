@@ -0,0 +1,214 @@
+/* Apache License, Version 2.0 */
+
+#include "blendfile_loading_base_test.h"
+
+#include <cstring>
+
+#include "BKE_main.h"
+#include "BKE_scene.h"
+
+#include "BLI_math_vector.h"
+#include "BLI_string.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_scene_types.h"
+#include "DNA_sequence_types.h"
+#include "DNA_space_types.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+#include "SEQ_sequencer.h"
+
+#include "effects.h"
+#include "render.h"
+
+namespace blender::seq::tests {
+
+class SequencerRenderTest : public BlendfileLoadingBaseTest {
+ protected:
+  static const int width = 64;
+  static const int height = 48;
+
+  Main *bmain_ = nullptr;
+  Scene *scene_ = nullptr;
+
+  void SetUp() override
+  {
+    BlendfileLoadingBaseTest::SetUp();
+    bmain_ = BKE_main_new();
+    scene_ = BKE_scene_add(bmain_, "Scene");
+    scene_->r.size = 100;
+    Editing *ed = BKE_sequencer_editing_get(scene_, true);
+    /* No prefetching, every render has to go through the stack. */
+    ed->cache_flag = 0;
+  }
+
+  void TearDown() override
+  {
+    seq_render_fused_blend_use(true);
+    BKE_main_free(bmain_);
+    BlendfileLoadingBaseTest::TearDown();
+  }
+
+  Sequence *color_strip_add(int channel, const float color[3], int blend_mode)
+  {
+    Editing *ed = BKE_sequencer_editing_get(scene_, false);
+    Sequence *seq = BKE_sequence_alloc(ed->seqbasep, 1, channel, SEQ_TYPE_COLOR);
+    BLI_snprintf(seq->name + 2, sizeof(seq->name) - 2, "Color%d", channel);
+    struct SeqEffectHandle sh = BKE_sequence_get_effect(seq);
+    sh.init(seq);
+    copy_v3_v3(((SolidColorVars *)seq->effectdata)->col, color);
+    seq->len = 1;
+    BKE_sequence_tx_set_final_right(seq, 10);
+    seq->blend_mode = blend_mode;
+    BKE_sequence_calc(scene_, seq);
+    return seq;
+  }
+
+  ImBuf *render(bool use_fused_blend)
+  {
+    seq_render_fused_blend_use(use_fused_blend);
+    SeqRenderData context;
+    SEQ_render_new_render_data(
+        bmain_, nullptr, scene_, width, height, SEQ_RENDER_SIZE_SCENE, true, &context);
+    context.skip_cache = true;
+    return SEQ_render_give_ibuf(&context, 1.0f, 0);
+  }
+
+  /* The fused path has to give exactly the same result as preprocessing and blending. */
+  void expect_fused_matches_unfused()
+  {
+    ImBuf *ibuf_unfused = render(false);
+    ImBuf *ibuf_fused = render(true);
+    ASSERT_NE(ibuf_unfused, nullptr);
+    ASSERT_NE(ibuf_fused, nullptr);
+    ASSERT_EQ(ibuf_fused->x, width);
+    ASSERT_EQ(ibuf_fused->y, height);
+    ASSERT_EQ(ibuf_unfused->rect != nullptr, ibuf_fused->rect != nullptr);
+    ASSERT_EQ(ibuf_unfused->rect_float != nullptr, ibuf_fused->rect_float != nullptr);
+
+    if (ibuf_fused->rect) {
+      EXPECT_EQ(memcmp(ibuf_unfused->rect, ibuf_fused->rect, sizeof(uint) * width * height), 0);
+    }
+    if (ibuf_fused->rect_float) {
+      EXPECT_EQ(memcmp(ibuf_unfused->rect_float,
+                       ibuf_fused->rect_float,
+                       sizeof(float[4]) * width * height),
+                0);
+    }
+
+    IMB_freeImBuf(ibuf_unfused);
+    IMB_freeImBuf(ibuf_fused);
+  }
+};
+
+static const float background_color[3] = {0.8f, 0.2f, 0.1f};
+static const float strip_color[3] = {0.1f, 0.5f, 0.9f};
+
+TEST_F(SequencerRenderTest, FusedTransform)
+{
+  color_strip_add(1, background_color, SEQ_TYPE_CROSS);
+  Sequence *seq = color_strip_add(2, strip_color, SEQ_TYPE_ALPHAOVER);
+  seq->blend_opacity = 60.0f;
+  StripTransform *transform = seq->strip->transform;
+  transform->xofs = 10.0f;
+  transform->yofs = -5.0f;
+  transform->scale_x = 0.5f;
+  transform->scale_y = 0.75f;
+  transform->rotation = 0.3f;
+
+  expect_fused_matches_unfused();
+}
+
+TEST_F(SequencerRenderTest, FusedTransformCrop)
+{
+  color_strip_add(1, background_color, SEQ_TYPE_CROSS);
+  Sequence *seq = color_strip_add(2, strip_color, SEQ_TYPE_ADD);
+  seq->blend_opacity = 80.0f;
+  StripTransform *transform = seq->strip->transform;
+  transform->xofs = -7.0f;
+  transform->scale_x = 1.5f;
+  transform->rotation = -0.2f;
+  StripCrop *crop = seq->strip->crop;
+  crop->left = 5;
+  crop->right = 3;
+  crop->top = 8;
+  crop->bottom = 2;
+
+  expect_fused_matches_unfused();
+}
+
+TEST_F(SequencerRenderTest, FusedStack)
+{
+  const float color_a[3] = {0.9f, 0.7f, 0.2f};
+  const float color_b[3] = {0.3f, 0.9f, 0.4f};
+
+  color_strip_add(1, background_color, SEQ_TYPE_CROSS);
+  Sequence *seq = color_strip_add(2, strip_color, SEQ_TYPE_ALPHAOVER);
+  seq->blend_opacity = 70.0f;
+  seq->strip->transform->xofs = 12.0f;
+  seq->strip->transform->rotation = 0.5f;
+  seq->flag |= SEQ_FLIPY;
+
+  seq = color_strip_add(3, color_a, SEQ_TYPE_SCREEN);
+  seq->blend_opacity = 50.0f;
+  seq->strip->transform->scale_y = 0.5f;
+  seq->strip->crop->left = 10;
+  seq->flag |= SEQ_FLIPX;
+  seq->sat = 0.4f;
+
+  seq = color_strip_add(4, color_b, SEQ_TYPE_MUL);
+  seq->blend_opacity = 40.0f;
+  seq->mul = 1.3f;
+
+  expect_fused_matches_unfused();
+}
+
+TEST_F(SequencerRenderTest, FusedModifiers)
+{
+  color_strip_add(1, background_color, SEQ_TYPE_CROSS);
+  Sequence *seq = color_strip_add(2, strip_color, SEQ_TYPE_ALPHAOVER);
+  seq->blend_opacity = 90.0f;
+  seq->strip->transform->yofs = 6.0f;
+  seq->strip->transform->scale_x = 0.8f;
+
+  ColorBalanceModifierData *cbmd = (ColorBalanceModifierData *)BKE_sequence_modifier_new(
+      seq, nullptr, seqModifierType_ColorBalance);
+  cbmd->color_balance.lift[0] = 1.2f;
+  cbmd->color_balance.gamma[1] = 0.8f;
+  cbmd->color_balance.gain[2] = 1.1f;
+  BrightContrastModifierData *bcmd = (BrightContrastModifierData *)BKE_sequence_modifier_new(
+      seq, nullptr, seqModifierType_BrightContrast);
+  bcmd->bright = 10.0f;
+  bcmd->contrast = 20.0f;
+  BKE_sequence_modifier_new(seq, nullptr, seqModifierType_Curves);
+  BKE_sequence_modifier_new(seq, nullptr, seqModifierType_HueCorrect);
+
+  expect_fused_matches_unfused();
+}
+
+/* Strips that need their whole preprocessed image split the stack into runs of fused strips. */
+TEST_F(SequencerRenderTest, FusedStackWithUnfusedStrip)
+{
+  const float color_a[3] = {0.9f, 0.7f, 0.2f};
+  const float color_b[3] = {0.3f, 0.9f, 0.4f};
+
+  color_strip_add(1, background_color, SEQ_TYPE_CROSS);
+  Sequence *seq = color_strip_add(2, strip_color, SEQ_TYPE_ADD);
+  seq->blend_opacity = 30.0f;
+  seq->strip->transform->rotation = -0.4f;
+
+  seq = color_strip_add(3, color_a, SEQ_TYPE_ALPHAOVER);
+  seq->blend_opacity = 60.0f;
+  seq->strip->transform->scale_x = 0.6f;
+  BKE_sequence_modifier_new(seq, nullptr, seqModifierType_Tonemap);
+
+  seq = color_strip_add(4, color_b, SEQ_TYPE_OVERLAY);
+  seq->blend_opacity = 80.0f;
+  seq->strip->transform->xofs = -9.0f;
+
+  expect_fused_matches_unfused();
+}
+
+}  // namespace blender::seq::tests
@@ -0,0 +1,272 @@
+/* Apache License, Version 2.0 */
+
+/**
+ * Benchmarks for the disk cache codecs, comparing encode and decode throughput with the single
+ * zlib stream the disk cache used before. Images are written to a temporary file and read back,
+ * the chunked codecs read through memory mapping like the disk cache does.
+ *
+ * Every case reports the best of `--perf-repeat` runs in megabytes of raw image data per second.
+ *
+ * Build all sequencer benchmarks with the `sequencer_perf` target.
+ */
+
+#include "testing/testing.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_fileops.h"
+#include "BLI_mmap.h"
+#include "BLI_rand.h"
+#include "BLI_threads.h"
+#include "BLI_timeit.hh"
+#include "BLI_utildefines.h"
+
+#include "disk_cache_codec.h"
+
+DEFINE_int32(perf_repeat, 3, "Number of runs per benchmark, the fastest run is reported.");
+
+namespace blender::tests {
+
+using timeit::Clock;
+using timeit::Nanoseconds;
+
+struct Resolution {
+  const char *name;
+  int width;
+  int height;
+};
+
+static const Resolution resolutions[] = {
+    {"1080p", 1920, 1080},
+    {"4K", 3840, 2160},
+};
+
+struct Timings {
+  Nanoseconds encode = Nanoseconds::max();
+  Nanoseconds decode = Nanoseconds::max();
+  size_t size_encoded = 0;
+};
+
+template<typename T> struct Frame {
+  T *rect;
+  T *rect_decoded;
+  int width;
+  int height;
+
+  Frame(int width, int height) : width(width), height(height)
+  {
+    rect = (T *)MEM_mallocN(size(), __func__);
+    rect_decoded = (T *)MEM_mallocN(size(), __func__);
+    fill();
+  }
+
+  ~Frame()
+  {
+    MEM_freeN(rect);
+    MEM_freeN(rect_decoded);
+  }
+
+  size_t size() const
+  {
+    return sizeof(T[4]) * size_t(width) * size_t(height);
+  }
+
+  int element_size() const
+  {
+    return sizeof(T);
+  }
+
+  /* Gradients with a bit of noise, closer to footage than random data. */
+  void fill()
+  {
+    RNG *rng = BLI_rng_new(0);
+    for (int y = 0; y < height; y++) {
+      for (int x = 0; x < width; x++) {
+        const float u = float(x) / float(width);
+        const float v = float(y) / float(height);
+        const float noise = BLI_rng_get_float(rng) * 0.02f;
+        T *pixel = rect + (size_t(y) * width + x) * 4;
+        store(pixel + 0, u + noise);
+        store(pixel + 1, v + noise);
+        store(pixel + 2, 0.5f + 0.5f * sinf(u * 10.0f + v * 5.0f));
+        store(pixel + 3, 1.0f);
+      }
+    }
+    BLI_rng_free(rng);
+  }
+
+  static void store(T *value, float f);
+
+  bool is_decoded_equal() const
+  {
+    return memcmp(rect, rect_decoded, size()) == 0;
+  }
+};
+
+template<> void Frame<uchar>::store(uchar *value, float f)
+{
+  *value = uchar(std::clamp(f, 0.0f, 1.0f) * 255.0f);
+}
+
+template<> void Frame<float>::store(float *value, float f)
+{
+  *value = f;
+}
+
+/* The format used by the disk cache before, a single zlib stream per image. */
+template<typename T> static Timings benchmark_zlib_stream(Frame<T> &frame, int level)
+{
+  memset(frame.rect_decoded, 0, frame.size());
+  Timings timings;
+  for (int repeat = 0; repeat < FLAGS_perf_repeat; repeat++) {
+    FILE *file = tmpfile();
+
+    Clock::time_point start = Clock::now();
+    timings.size_encoded = BLI_gzip_mem_to_file_at_pos(frame.rect, frame.size(), file, 0, level);
+    fflush(file);
+    timings.encode = std::min<Nanoseconds>(timings.encode, Clock::now() - start);
+
+    start = Clock::now();
+    const size_t size_decoded = BLI_ungzip_file_to_mem_at_pos(
+        frame.rect_decoded, frame.size(), file, 0);
+    timings.decode = std::min<Nanoseconds>(timings.decode, Clock::now() - start);
+
+    EXPECT_EQ(size_decoded, frame.size());
+    fclose(file);
+  }
+  return timings;
+}
+
+template<typename T> static Timings benchmark_chunked(Frame<T> &frame, int codec, int level)
+{
+  memset(frame.rect_decoded, 0, frame.size());
+  const int chunks_num = seq_disk_cache_chunks_num(frame.size());
+  const size_t index_size = sizeof(uint32_t) * chunks_num;
+  uint32_t *chunk_sizes = (uint32_t *)MEM_mallocN(index_size, __func__);
+
+  Timings timings;
+  for (int repeat = 0; repeat < FLAGS_perf_repeat; repeat++) {
+    FILE *file = tmpfile();
+
+    Clock::time_point start = Clock::now();
+    void *encoded = seq_disk_cache_encode(frame.rect,
+                                          frame.size(),
+                                          codec,
+                                          level,
+                                          frame.element_size(),
+                                          chunk_sizes,
+                                          &timings.size_encoded);
+    fwrite(chunk_sizes, 1, index_size, file);
+    fwrite(encoded ? encoded : frame.rect, 1, timings.size_encoded, file);
+    fflush(file);
+    timings.encode = std::min<Nanoseconds>(timings.encode, Clock::now() - start);
+    MEM_SAFE_FREE(encoded);
+
+    start = Clock::now();
+    BLI_mmap_file *mmap_file = BLI_mmap_open(fileno(file));
+    if (mmap_file == nullptr) {
+      ADD_FAILURE() << "Failed to map file";
+      fclose(file);
+      break;
+    }
+    const uchar *data = (const uchar *)BLI_mmap_get_pointer(mmap_file);
+    const bool is_valid = seq_disk_cache_decode(data + index_size,
+                                                timings.size_encoded,
+                                                (const uint32_t *)data,
+                                                codec,
+                                                frame.element_size(),
+                                                frame.rect_decoded,
+                                                frame.size());
+    BLI_mmap_free(mmap_file);
+    timings.decode = std::min<Nanoseconds>(timings.decode, Clock::now() - start);
+
+    EXPECT_TRUE(is_valid);
+    fclose(file);
+  }
+
+  MEM_freeN(chunk_sizes);
+  return timings;
+}
+
+static double megabytes_per_second(size_t size, Nanoseconds time)
+{
+  return double(size) / (1024.0 * 1024.0) / (double(std::max<int64_t>(time.count(), 1)) / 1e9);
+}
+
+static void print_timings(const char *name, const Resolution &resolution, size_t size, Timings t)
+{
+  printf("%-12s %-6s encode %8.1f MB/s, decode %8.1f MB/s, ratio %5.2f\n",
+         name,
+         resolution.name,
+         megabytes_per_second(size, t.encode),
+         megabytes_per_second(size, t.decode),
+         double(size) / double(std::max<size_t>(t.size_encoded, 1)));
+}
+
+template<typename T> static void benchmark_codecs(const char *type_name)
+{
+  printf("%s images:\n", type_name);
+
+  for (const Resolution &resolution : resolutions) {
+    Frame<T> frame(resolution.width, resolution.height);
+
+    print_timings("zlib stream", resolution, frame.size(), benchmark_zlib_stream(frame, 1));
+    EXPECT_TRUE(frame.is_decoded_equal()) << "zlib stream at " << resolution.name;
+
+    print_timings("none",
+                  resolution,
+                  frame.size(),
+                  benchmark_chunked(frame, SEQ_DISK_CACHE_CODEC_NONE, 0));
+    EXPECT_TRUE(frame.is_decoded_equal()) << "none at " << resolution.name;
+
+    if (seq_disk_cache_codec_is_supported(SEQ_DISK_CACHE_CODEC_LZO)) {
+      print_timings("lzo",
+                    resolution,
+                    frame.size(),
+                    benchmark_chunked(frame, SEQ_DISK_CACHE_CODEC_LZO, 0));
+      EXPECT_TRUE(frame.is_decoded_equal()) << "lzo at " << resolution.name;
+    }
+
+    print_timings("zlib chunks",
+                  resolution,
+                  frame.size(),
+                  benchmark_chunked(frame, SEQ_DISK_CACHE_CODEC_ZLIB, 1));
+    EXPECT_TRUE(frame.is_decoded_equal()) << "zlib chunks at " << resolution.name;
+  }
+}
+
+/* -------------------------------------------------------------------- */
+/** \name Benchmarks
+ * \{ */
+
+class SequencerDiskCachePerformance : public ::testing::Test {
+ protected:
+  void SetUp() override
+  {
+    BLI_threadapi_init();
+  }
+
+  void TearDown() override
+  {
+    BLI_threadapi_exit();
+  }
+};
+
+TEST_F(SequencerDiskCachePerformance, Byte)
+{
+  benchmark_codecs<uchar>("Byte");
+}
+
+TEST_F(SequencerDiskCachePerformance, Float)
+{
+  benchmark_codecs<float>("Float");
+}
+
+/** \} */
+
+}  // namespace blender::tests
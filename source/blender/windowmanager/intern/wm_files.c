@@ -94,6 +94,10 @@
 #include "BLO_undofile.h" /* to save from an undo memfile */
 #include "BLO_writefile.h"
 
+#ifdef WITH_COMPOSITOR
+#  include "COM_compositor.h"
+#endif
+
 #include "RNA_access.h"
 #include "RNA_define.h"
 
@@ -555,6 +559,9 @@ static void wm_file_read_pre(bContext *C, bool use_data, bool UNUSED(use_userdef
   if (use_data) {
     BKE_callback_exec_null(CTX_data_main(C), BKE_CB_EVT_LOAD_PRE);
     BLI_timer_on_file_load();
+#ifdef WITH_COMPOSITOR
+    COM_clearCaches();
+#endif
   }
 
   /* Always do this as both startup and preferences may have loaded in many font's
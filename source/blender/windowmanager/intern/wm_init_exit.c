@@ -47,6 +47,7 @@
 #include "BLI_task.h"
 #include "BLI_threads.h"
 #include "BLI_timer.h"
+#include "BLI_trace.h"
 #include "BLI_utildefines.h"
 
 #include "BLO_undofile.h"
@@ -649,6 +650,9 @@ void WM_exit_ex(bContext *C, const bool do_python)
 
   DNA_sdna_current_free();
 
+  /* Writes the trace file when enabled with `--trace`, all worker threads are done by now. */
+  BLI_trace_exit();
+
   BLI_threadapi_exit();
   BLI_task_scheduler_exit();
 
@@ -41,6 +41,7 @@
 #  include "BLI_string_utf8.h"
 #  include "BLI_system.h"
 #  include "BLI_threads.h"
+#  include "BLI_trace.h"
 #  include "BLI_utildefines.h"
 
 #  include "BLO_readfile.h" /* only for BLO_has_bfile_extension */
@@ -597,6 +598,7 @@ static int arg_handle_print_help(int UNUSED(argc), const char **UNUSED(argv), vo
 #  endif
   BLI_args_print_arg_doc(ba, "--debug-all");
   BLI_args_print_arg_doc(ba, "--debug-io");
+  BLI_args_print_arg_doc(ba, "--trace");
 
   printf("\n");
   BLI_args_print_arg_doc(ba, "--debug-fpe");
@@ -1003,6 +1005,21 @@ static int arg_handle_debug_mode_io(int UNUSED(argc),
   return 0;
 }
 
+static const char arg_handle_trace_set_doc[] =
+    "<filename>\n"
+    "\tRecord a trace of depsgraph evaluation, modifiers, file I/O and compositing,\n"
+    "\twritten on exit as Chrome trace JSON (open in 'chrome://tracing' or Perfetto).";
+static int arg_handle_trace_set(int argc, const char **argv, void *UNUSED(data))
+{
+  const char *arg_id = "--trace";
+  if (argc > 1) {
+    BLI_trace_init(argv[1]);
+    return 1;
+  }
+  printf("\nError: '%s' no args given.\n", arg_id);
+  return 0;
+}
+
 static const char arg_handle_debug_mode_all_doc[] =
     "\n\t"
     "Enable all debug messages.";
@@ -2100,6 +2117,7 @@ void main_args_setup(bContext *C, bArgs *ba)
   BLI_args_add(ba, NULL, "--debug-all", CB(arg_handle_debug_mode_all), NULL);
 
   BLI_args_add(ba, NULL, "--debug-io", CB(arg_handle_debug_mode_io), NULL);
+  BLI_args_add(ba, NULL, "--trace", CB(arg_handle_trace_set), NULL);
 
   BLI_args_add(ba, NULL, "--debug-fpe", CB(arg_handle_debug_fpe_set), NULL);
 
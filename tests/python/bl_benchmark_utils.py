@@ -0,0 +1,50 @@
+# Apache License, Version 2.0
+
+# Shared by the benchmark scripts, which print their results as JSON.
+#
+# The benchmarks also run as regular tests with small inputs, to make sure the scripts keep
+# working. Timings of those runs don't mean anything, run the scripts without arguments to
+# measure performance.
+
+import json
+import sys
+import time
+
+
+def argparse_create(description, repeat=3):
+    """Argument parser with the options of every benchmark."""
+    import argparse
+
+    parser = argparse.ArgumentParser(description=description)
+    parser.add_argument("--repeat", dest="repeat", type=int, default=repeat, help="Number of timed runs")
+    return parser
+
+
+def time_repeat(fn, repeat, setup=None):
+    """Wall clock time of every one of `repeat` calls to `fn`, `setup` is called before each call
+    and isn't timed."""
+    timings = []
+    for _ in range(repeat):
+        if setup is not None:
+            setup()
+        time_start = time.perf_counter()
+        fn()
+        timings.append(time.perf_counter() - time_start)
+    return timings
+
+
+def timings_summary(timings, **items):
+    """Timings and the best of them. Every keyword gives the number of items processed by one run,
+    which is reported per second of the best run under that name."""
+    best = min(timings)
+    summary = {"timings": timings, "best": best}
+    for name, num in items.items():
+        summary[name] = num / best
+    return summary
+
+
+def main(run, parser):
+    """Run the benchmark with the arguments after `--` and print the results of `run(args)`."""
+    argv = sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else []
+    args = parser.parse_args(argv)
+    print(json.dumps(run(args), indent=2))
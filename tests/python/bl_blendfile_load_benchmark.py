@@ -0,0 +1,60 @@
+# Apache License, Version 2.0
+
+# Benchmark for .blend file loading, not part of the regular test suite.
+#
+# Compare serial and parallel data decoding by running with a different number of threads:
+#
+#   ./blender.bin --background -noaudio -t 1 --python tests/python/bl_blendfile_load_benchmark.py
+#   ./blender.bin --background -noaudio -t 0 --python tests/python/bl_blendfile_load_benchmark.py
+#
+# Pass `-- --input FILE` to time loading an existing file instead of a generated one.
+# Results are printed as JSON.
+
+import bpy
+import os
+import sys
+import tempfile
+
+sys.path.append(os.path.dirname(os.path.realpath(__file__)))
+import bl_benchmark_utils
+
+
+def generate_file(filepath, objects_len, subdivisions):
+    bpy.ops.wm.read_factory_settings(use_empty=True)
+    for i in range(objects_len):
+        bpy.ops.mesh.primitive_ico_sphere_add(subdivisions=subdivisions, location=(i * 2.0, 0.0, 0.0))
+    bpy.ops.wm.save_as_mainfile(filepath=filepath, check_existing=False, compress=False)
+
+
+def time_load(filepath, repeat):
+    return bl_benchmark_utils.time_repeat(
+        lambda: bpy.ops.wm.open_mainfile(filepath=filepath, load_ui=False),
+        repeat,
+        setup=lambda: bpy.ops.wm.read_factory_settings(use_empty=True),
+    )
+
+
+def argparse_create():
+    parser = bl_benchmark_utils.argparse_create("Benchmark .blend file loading.", repeat=5)
+    parser.add_argument("--input", dest="input", default="", help="File to load (generated when empty)")
+    parser.add_argument("--objects", dest="objects", type=int, default=200, help="Generated objects")
+    parser.add_argument("--subdivisions", dest="subdivisions", type=int, default=6, help="Mesh density")
+    return parser
+
+
+def run(args):
+    filepath = args.input
+    if not filepath:
+        filepath = os.path.join(tempfile.gettempdir(), "blendfile_load_benchmark.blend")
+        generate_file(filepath, args.objects, args.subdivisions)
+
+    timings = time_load(filepath, args.repeat)
+    return {
+        "file": filepath,
+        "file_size": os.path.getsize(filepath),
+        **bl_benchmark_utils.timings_summary(timings),
+    }
+
+
+if __name__ == '__main__':
+    bl_benchmark_utils.main(run, argparse_create())
@@ -0,0 +1,103 @@
+# Apache License, Version 2.0
+
+# Benchmark for color grading in the compositor, not part of the regular test suite.
+#
+# Compares the tiled execution mode, which processes one pixel per call, with the full frame
+# execution mode, which processes rows of pixels at once:
+#
+#   ./blender.bin --background -noaudio --factory-startup --python tests/python/bl_compositor_benchmark.py
+#
+# Pass `-- --size 4096` to change the image resolution, `-- --threads 1` to compare single threaded.
+# Results are printed as JSON.
+
+import bpy
+import os
+import sys
+
+sys.path.append(os.path.dirname(os.path.realpath(__file__)))
+import bl_benchmark_utils
+
+
+MIX_BLEND_TYPES = ('MIX', 'ADD', 'SUBTRACT', 'MULTIPLY', 'SCREEN', 'DIFFERENCE', 'DARKEN', 'LIGHTEN')
+
+
+def scene_create(size):
+    bpy.ops.wm.read_factory_settings(use_empty=True)
+    scene = bpy.context.scene
+    scene.render.resolution_x = size
+    scene.render.resolution_y = size
+    scene.render.resolution_percentage = 100
+    scene.use_nodes = True
+
+    image = bpy.data.images.new("Grid", size, size, alpha=True, float_buffer=True)
+    image.generated_type = 'COLOR_GRID'
+
+    # Without render layer nodes the scene itself is not rendered, only the compositor runs.
+    tree = scene.node_tree
+    tree.nodes.clear()
+    image_node = tree.nodes.new("CompositorNodeImage")
+    image_node.image = image
+    # Straight alpha, to include the conversion to premultiplied alpha.
+    image_node.use_straight_alpha_output = True
+    socket = image_node.outputs["Image"]
+
+    node = tree.nodes.new("CompositorNodeColorBalance")
+    node.correction_method = 'LIFT_GAMMA_GAIN'
+    node.lift = (1.1, 1.0, 0.9)
+    node.gamma = (0.9, 1.0, 1.1)
+    tree.links.new(socket, node.inputs["Image"])
+    socket = node.outputs["Image"]
+
+    node = tree.nodes.new("CompositorNodeCurveRGB")
+    node.mapping.curves[3].points[0].location = (0.0, 0.1)
+    node.mapping.update()
+    tree.links.new(socket, node.inputs["Image"])
+    socket = node.outputs["Image"]
+
+    for blend_type in MIX_BLEND_TYPES:
+        node = tree.nodes.new("CompositorNodeMixRGB")
+        node.blend_type = blend_type
+        node.inputs["Fac"].default_value = 0.5
+        tree.links.new(socket, node.inputs[1])
+        tree.links.new(image_node.outputs["Image"], node.inputs[2])
+        socket = node.outputs["Image"]
+
+    node = tree.nodes.new("CompositorNodeAlphaOver")
+    tree.links.new(image_node.outputs["Image"], node.inputs[1])
+    tree.links.new(socket, node.inputs[2])
+    socket = node.outputs["Image"]
+
+    composite = tree.nodes.new("CompositorNodeComposite")
+    tree.links.new(socket, composite.inputs["Image"])
+    return scene
+
+
+def time_render(scene, execution_mode, repeat):
+    scene.node_tree.execution_mode = execution_mode
+    return bl_benchmark_utils.time_repeat(bpy.ops.render.render, repeat)
+
+
+def argparse_create():
+    parser = bl_benchmark_utils.argparse_create("Benchmark compositor color grading operations.")
+    parser.add_argument("--size", dest="size", type=int, default=2048, help="Image resolution")
+    parser.add_argument("--threads", dest="threads", type=int, default=0, help="Number of threads")
+    return parser
+
+
+def run(args):
+    scene = scene_create(args.size)
+    if args.threads:
+        scene.render.threads_mode = 'FIXED'
+        scene.render.threads = args.threads
+
+    results = {"size": args.size}
+    for execution_mode in ('TILED', 'FULL_FRAME'):
+        timings = time_render(scene, execution_mode, args.repeat)
+        results[execution_mode.lower()] = bl_benchmark_utils.timings_summary(
+            timings, pixels_per_second=args.size * args.size)
+    results["speedup"] = results["tiled"]["best"] / results["full_frame"]["best"]
+    return results
+
+
+if __name__ == '__main__':
+    bl_benchmark_utils.main(run, argparse_create())
@@ -0,0 +1,96 @@
+# Apache License, Version 2.0
+
+# Benchmark for point cache reading & writing, not part of the regular test suite.
+#
+# Compare serial and parallel cache processing by running with a different number of threads:
+#
+#   ./blender.bin --background -noaudio --factory-startup -t 1 --python tests/python/bl_pointcache_benchmark.py
+#   ./blender.bin --background -noaudio --factory-startup -t 0 --python tests/python/bl_pointcache_benchmark.py
+#
+# Pass `-- --disk` to benchmark a disk cache (the .blend file is saved in a temporary directory),
+# and `-- --single-file` to use the single file disk cache layout.
+# Results are printed as JSON.
+
+import bpy
+import os
+import sys
+import tempfile
+import time
+
+sys.path.append(os.path.dirname(os.path.realpath(__file__)))
+import bl_benchmark_utils
+
+
+def scene_create(subdivisions, frames):
+    bpy.ops.wm.read_factory_settings(use_empty=True)
+    scene = bpy.context.scene
+    scene.frame_start = 1
+    scene.frame_end = frames
+
+    bpy.ops.mesh.primitive_grid_add(x_subdivisions=subdivisions, y_subdivisions=subdivisions, size=2.0)
+    ob = bpy.context.object
+    cloth = ob.modifiers.new(name="Cloth", type='CLOTH')
+    cloth.settings.quality = 1
+    cloth.collision_settings.use_self_collision = False
+    cloth.point_cache.frame_start = 1
+    cloth.point_cache.frame_end = frames
+    return ob, cloth.point_cache
+
+
+def time_bake(point_cache):
+    override = {"scene": bpy.context.scene, "point_cache": point_cache}
+    time_start = time.perf_counter()
+    bpy.ops.ptcache.bake(override, bake=True)
+    return time.perf_counter() - time_start
+
+
+def time_scrub(frames, repeat):
+    scene = bpy.context.scene
+
+    def scrub():
+        # Jump around, so frames are read from the cache instead of being simulated in order.
+        for frame in range(frames, 0, -1):
+            scene.frame_set(frame)
+        # Sub-frames use interpolation between cached frames.
+        for frame in range(1, frames):
+            scene.frame_set(frame, subframe=0.5)
+
+    return bl_benchmark_utils.time_repeat(scrub, repeat)
+
+
+def argparse_create():
+    parser = bl_benchmark_utils.argparse_create("Benchmark point cache reading and writing.")
+    parser.add_argument("--subdivisions", dest="subdivisions", type=int, default=500, help="Grid resolution")
+    parser.add_argument("--frames", dest="frames", type=int, default=20, help="Number of cached frames")
+    parser.add_argument("--disk", dest="disk", action="store_true", help="Use a disk cache")
+    parser.add_argument("--single-file", dest="single_file", action="store_true",
+                        help="Use the single file disk cache layout")
+    return parser
+
+
+def run(args):
+    ob, point_cache = scene_create(args.subdivisions, args.frames)
+    if args.disk or args.single_file:
+        tempdir = tempfile.mkdtemp()
+        bpy.ops.wm.save_as_mainfile(filepath=os.path.join(tempdir, "pointcache_benchmark.blend"))
+        point_cache = ob.modifiers["Cloth"].point_cache
+        point_cache.use_disk_cache = True
+        point_cache.use_disk_cache_single_file = args.single_file
+
+    bake_time = time_bake(point_cache)
+    timings = time_scrub(args.frames, args.repeat)
+    points = len(ob.data.vertices)
+    frames_read = (args.frames * 2 - 1)
+
+    return {
+        "points": points,
+        "frames": args.frames,
+        "disk": point_cache.use_disk_cache,
+        "single_file": point_cache.use_disk_cache_single_file,
+        "bake_time": bake_time,
+        "scrub": bl_benchmark_utils.timings_summary(timings, points_per_second=points * frames_read),
+    }
+
+
+if __name__ == '__main__':
+    bl_benchmark_utils.main(run, argparse_create())